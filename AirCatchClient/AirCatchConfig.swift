@@ -0,0 +1,71 @@
+//
+//  AirCatchConfig.swift
+//  AirCatchClient
+//
+//  Tunables shared across the client app.
+//
+
+import Foundation
+
+enum AirCatchConfig {
+    nonisolated static let udpPort: UInt16 = 5555
+    nonisolated static let tcpPort: UInt16 = 5556
+    nonisolated static let bonjourServiceType = "_aircatch._udp."
+    nonisolated static let bonjourTCPServiceType = "_aircatch._tcp."
+
+    // Remote (Internet) relay/signaling
+    nonisolated static let remoteRelayURL: String = "wss://aircatch.duckdns.org/ws"
+    
+    // Remote direct path (UDP hole punching, relay stays as fallback)
+    nonisolated static let directPathEnabled = true
+    nonisolated static let directPathCheckTimeout: TimeInterval = 5.0  // Stop punching after this
+    nonisolated static let directPathIdleTimeout: TimeInterval = 3.0   // Fall back to relay after this much silence
+    nonisolated static let relayDatagramEnabled = true                  // Relayed UDP port pair when direct fails
+    
+    // Port aliases for clarity
+    nonisolated static let defaultUDPPort: UInt16 = 5555
+    nonisolated static let defaultTCPPort: UInt16 = 5556
+    
+    // Network constants
+    static let maxUDPPayloadSize: Int = 1200  // Safe UDP payload size (below MTU)
+    nonisolated static let maxTCPPayloadSize: Int = 32 * 1024 * 1024  // Larger TCP length fields are treated as corrupt
+    nonisolated static let rekeyInterval: UInt64 = 1 << 20              // Packets sealed per key before the sender ratchets
+    
+    // Streaming defaults (optimized for HEVC on Apple Silicon)
+    static let defaultBitrate: Int = 16_000_000  // 16 Mbps - HEVC sweet spot
+    static let defaultFrameRate: Int = 60        // Always 60 FPS
+    static let maxTouchEventsPerSecond: Int = 60
+    static let reconnectMaxAttempts = 5
+    static let reconnectBaseDelay: TimeInterval = 1.0
+    static let sessionResumeGracePeriod: TimeInterval = 10.0  // Host keeps a dropped session's stream this long
+    static let inputLaneRedundancy: Int = 4      // Recent events repeated in each input datagram
+    
+    // Connection racing (LAN variants and relay)
+    static let lanRaceStagger: TimeInterval = 0.25       // Head start of the preferred LAN variant
+    static let relayRaceDelay: TimeInterval = 1.5        // Relay joins if nothing is acknowledged by then
+    static let raceHandshakeTimeout: TimeInterval = 3.0  // Abandon a slow first handshake when the other path is ready
+    static let resumeRetryDelay: TimeInterval = 0.25     // Reconnect spacing while the host holds a dropped session
+    
+    // Frame delivery (reassembly -> decoder -> main thread)
+    nonisolated static let maxQueuedDecodeFrames: Int = 3                  // Deeper backlog means the decoder is behind
+    nonisolated static let maxBurstDecodeFrames: Int = 12                  // Hard cap; a deeper backlog is discarded at once
+    nonisolated static let decoderBehindThreshold: TimeInterval = 0.25     // Behind this long: discard up to the next keyframe
+    nonisolated static let keyframeRetryInterval: TimeInterval = 0.5       // Re-request until the keyframe arrives
+    nonisolated static let mainThreadStallThreshold: TimeInterval = 0.033  // Two frame intervals at 60 fps
+    
+    // Remote Mode Specifics
+    static let remoteFrameRate: Int = 30
+    static let remoteBitrate: Int = 6_000_000     // 6 Mbps (target range: 4-10)
+    static let remoteMinBitrate: Int = 4_000_000  // Floor for adaptive
+    static let remoteMaxBitrate: Int = 10_000_000 // Ceiling for adaptive
+    static let remoteMinFPS: Int = 20             // Floor when congested
+    static let remoteMaxFPS: Int = 30             // Target FPS
+    static let remoteGOPDuration: Double = 0.5    // Short GOP (0.5s) for faster recovery
+    
+    // Resolution limits
+    static let maxRenderPixels: Double = 8_000_000  // ~8MP cap for render resolution
+    
+    // Frame cache settings
+    static let frameCacheTTL: TimeInterval = 1.0  // Seconds before cached frames expire
+    static let frameCacheLimit: Int = 240         // Most frames cached for retransmits (2 s at 120 fps)
+}
@@ -100,36 +100,37 @@ final class AudioPlayer {
         guard isRunning, data.count > 8 else { return }
         
         packetCount += 1
-        
-        // Skip 8-byte timestamp header
-        let pcmData = Data(data.dropFirst(8))
-        
+
+        // PCM follows the 8-byte timestamp header
+        let pcmByteCount = data.count - 8
+
         guard let format = audioFormat else { return }
-        
+
         // Calculate frame count assuming Interleaved Stereo Input (L R L R)
         // 2 channels * 4 bytes/sample = 8 bytes/frame
         let bytesPerFrame: UInt32 = 8
-        let frameCount = UInt32(pcmData.count) / bytesPerFrame
-        
+        let frameCount = UInt32(pcmByteCount) / bytesPerFrame
+
         guard frameCount > 0 else { return }
-        
+
         // Create audio buffer (Stereo, Non-Interleaved)
         guard let buffer = AVAudioPCMBuffer(pcmFormat: format, frameCapacity: frameCount) else {
             return
         }
         buffer.frameLength = frameCount
-        
-        // De-interleave: Copy L R L R... to [L L L...] and [R R R...]
-        pcmData.withUnsafeBytes { rawBufferPointer in
-            guard let src = rawBufferPointer.bindMemory(to: Float.self).baseAddress else { return }
-            
-            if let dstLeft = buffer.floatChannelData?[0], let dstRight = buffer.floatChannelData?[1] {
-                // Perform de-interleaving loop
-                for i in 0..<Int(frameCount) {
-                    dstLeft[i] = src[i*2]
-                    dstRight[i] = src[i*2+1]
-                }
-            }
+
+        // De-interleave straight from the packet: L R L R... to [L L L...] and [R R R...]
+        data.withUnsafeBytes { rawBufferPointer in
+            guard let base = rawBufferPointer.baseAddress,
+                  let dstLeft = buffer.floatChannelData?[0],
+                  let dstRight = buffer.floatChannelData?[1] else { return }
+
+            PCMKernels.deinterleave(
+                base.advanced(by: 8),
+                left: dstLeft,
+                right: dstRight,
+                frameCount: Int(frameCount)
+            )
         }
         
         // --- Drift Correction ---
@@ -164,7 +165,7 @@ final class AudioPlayer {
         
         #if DEBUG
         if packetCount == 1 {
-            AirCatchLog.debug("First audio packet: \(pcmData.count) bytes, \(frameCount) frames (Stereo De-interleave)", category: .general)
+            AirCatchLog.debug("First audio packet: \(pcmByteCount) bytes, \(frameCount) frames (Stereo De-interleave)", category: .general)
         }
         #endif
     }
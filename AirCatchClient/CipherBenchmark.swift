@@ -0,0 +1,45 @@
+//
+//  CipherBenchmark.swift
+//  AirCatchClient
+//
+//  Startup benchmark that ranks the AEAD ciphers on this device.
+//
+
+import Foundation
+import CryptoKit
+
+/// Seal throughput of each cipher on this device, measured once per launch.
+///
+/// AES-GCM wins wherever the CPU has AES instructions (every Apple silicon Mac and
+/// iPad); ChaCha20-Poly1305 is ahead on cores without them. The ranking orders
+/// `HandshakeRequest.supportedCiphers` and the host's pick among them.
+nonisolated enum CipherBenchmark {
+
+    /// Frame-sized input, sealed `rounds` times per cipher (about 2 ms in total on Apple silicon)
+    private static let sampleSize = 64 * 1024
+    private static let rounds = 16
+
+    /// Ciphers, fastest first. The first access runs the benchmark.
+    static let ranking: [AEADCipher] = {
+        let key = SymmetricKey(size: .bits256)
+        let sample = Data(count: sampleSize)
+        var nonces = NonceSequence(isHost: false)
+        var results: [(cipher: AEADCipher, bytesPerSecond: Double)] = []
+
+        for cipher in AEADCipher.allCases {
+            let backend = cipher.backend
+            // One untimed round warms up the implementation
+            _ = try? backend.seal(sample, using: key, nonce: nonces.next(), authenticating: Data())
+            let start = DispatchTime.now().uptimeNanoseconds
+            for _ in 0..<rounds {
+                _ = try? backend.seal(sample, using: key, nonce: nonces.next(), authenticating: Data())
+            }
+            let elapsed = max(1, DispatchTime.now().uptimeNanoseconds - start)
+            results.append((cipher, Double(sampleSize * rounds) / (Double(elapsed) / 1_000_000_000)))
+        }
+
+        let summary = results.map { "\($0.cipher.rawValue) \(Int($0.bytesPerSecond / 1_000_000)) MB/s" }.joined(separator: ", ")
+        AirCatchLog.info("E2EE cipher benchmark: \(summary)", category: .network)
+        return results.sorted { $0.bytesPerSecond > $1.bytesPerSecond }.map { $0.cipher }
+    }()
+}
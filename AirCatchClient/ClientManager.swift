@@ -8,6 +8,7 @@
 import Foundation
 import Network
 import Combine
+import os
 import UIKit
 import MultipeerConnectivity
 
@@ -101,11 +102,27 @@ final class ClientManager: ObservableObject {
     
     // MARK: - Published State
     
-    @Published var state: ConnectionState = .disconnected
+    @Published var state: ConnectionState = .disconnected {
+        didSet {
+            if state == .connected, oldValue != .connected {
+                videoIntake.withLock { $0.awaitingFirstFrame = true }
+            }
+            if state == .streaming, oldValue != .streaming, let path = activePath {
+                startupTimeline?.mark(.firstFrame, on: path)
+                if let summary = startupTimeline?.summary {
+                    AirCatchLog.info(" Startup: \(summary)", category: .network)
+                }
+            }
+        }
+    }
     // REMOVED: @Published var latestFrameData: Data? - Causes SwiftUI thrashing
     
-    // High-performance video path (Direct to Metal)
-    let videoFrameSubject = PassthroughSubject<Data, Never>()
+    // High-performance video path: reassembly -> decoder, without the main thread
+    nonisolated let videoFrames = VideoFrameHandoff(onKeyframeNeeded: {
+        Task { @MainActor in
+            ClientManager.shared.sendControl(type: .keyframeRequest, payload: Data())
+        }
+    })
     
     @Published var discoveredHosts: [DiscoveredHost] = []
     @Published private(set) var connectedHost: DiscoveredHost?
@@ -116,6 +133,12 @@ final class ClientManager: ObservableObject {
     
     /// Debug: Detailed connection status
     @Published var debugConnectionStatus: String = "Idle"
+
+    /// Startup-time breakdown of the current connect (resolve, connect, handshake, first frame)
+    @Published private(set) var startupTimeline: ConnectionTimeline?
+    
+    /// A dropped session is being resumed; the video view keeps its last frame and decoder
+    @Published private(set) var isResumingSession = false
     
     /// PIN entered by user for pairing
     @Published var enteredPIN: String = ""
@@ -154,7 +177,7 @@ final class ClientManager: ObservableObject {
     private let bonjourBrowser = BonjourBrowser()
     private let mpcClient = MPCAirCatchClient()
     private let audioPlayer = AudioPlayer()
-    private let crypto = CryptoManager()  // E2EE decryption
+    private nonisolated let crypto = CryptoManager()  // E2EE decryption
     private var cancellables = Set<AnyCancellable>()
 
     private enum ActiveLink {
@@ -163,10 +186,27 @@ final class ClientManager: ObservableObject {
     }
 
     private var activeLink: ActiveLink = .network
-    private var remoteActive: Bool = false
+    private var remoteActive: Bool = false {
+        didSet { videoIntake.withLock { $0.lossless = !remoteActive } }
+    }
+    
+    // Input lane (UDP, sequenced, redundant)
+    private var inputSequence: UInt32 = 0
+    private var inputLaneId = UInt32.random(in: 1...UInt32.max)
+    private var recentInputEvents: [InputLaneEvent] = []
     
     // Video Reassembly
-    private let reassembler = VideoReassembler()
+    private nonisolated let reassembler = VideoReassembler()
+    
+    /// What the network queue needs to take video chunks without the main thread
+    private nonisolated struct VideoIntake {
+        /// Path carrying the session (nil while racing: any)
+        var path: ConnectionTimeline.Path?
+        var lossless = true
+        /// The next complete frame moves `state` to `.streaming`
+        var awaitingFirstFrame = false
+    }
+    private nonisolated let videoIntake = OSAllocatedUnfairLock(initialState: VideoIntake())
 
     // Remote telemetry
     private var remotePingTimer: Timer?
@@ -178,6 +218,11 @@ final class ClientManager: ObservableObject {
         setupMPCCallbacks()
         setupAutoConnectLogic()
         // Do not start discovery immediately on init
+        
+        // Rank the ciphers off the main thread before the first handshake lists them
+        DispatchQueue.global(qos: .utility).async {
+            _ = CipherBenchmark.ranking
+        }
     }
     
     // MARK: - Lifecycle
@@ -204,6 +249,7 @@ final class ClientManager: ObservableObject {
     }
     
     func disconnect(shouldRetry: Bool = false) {
+        cancelConnectionRace()
         networkManager.stopAll()
         remoteTransport.stop()
         stopRemoteTelemetry()
@@ -215,8 +261,12 @@ final class ClientManager: ObservableObject {
         remoteActive = false
         
         if shouldRetry {
+            if sessionDroppedAt == nil {
+                sessionDroppedAt = ProcessInfo.processInfo.systemUptime
+            }
              attemptReconnect()
         } else {
+            forgetResumableSession()
             connectedHost = nil
             state = .disconnected
             // Restart discovery
@@ -329,7 +379,7 @@ final class ClientManager: ObservableObject {
         mpcClient.onPacketReceived = { [weak self] packet in
             guard let self else { return }
             switch packet.type {
-            case .handshakeAck, .pairingFailed, .disconnect:
+            case .handshakeAck, .sessionKeys, .pairingFailed, .disconnect:
                 self.handleTCPPacket(packet)
             case .videoFrame, .videoFrameChunk:
                 self.handleAirCatchPacket(packet)
@@ -382,62 +432,17 @@ final class ClientManager: ObservableObject {
         state = .connecting
         connectedHost = host
         reconnectAttempts = 0 // Reset on manual connect
+        forgetResumableSession()
         
         // E2EE: Derive encryption key from PIN
         crypto.deriveKey(from: enteredPIN)
+        remoteTransport.setDirectPathKey(nil)
 
         // MultipeerConnectivity is kept for discovery, but we always use Network.framework
-        // for the actual stream/control connection.
-        
-        // Resolve the service endpoint to get IP address
-        if connectionOption == .remote {
-            connectRemote(host: host)
-        } else {
-            resolveAndConnect(host: host)
-        }
+        // (LAN) or the relay for the actual stream/control connection.
+        startConnectionRace(host: host)
     }
 
-    private func connectRemote(host: DiscoveredHost) {
-        #if DEBUG
-        debugConnectionStatus = "Connecting (Remote)..."
-        AirCatchLog.info(" Connecting (Remote) to session \(enteredPIN)")
-        #endif
-
-        guard enteredPIN.count == 6 else {
-            state = .error("Enter a 6-character PIN")
-            return
-        }
-
-        remoteActive = true
-        activeLink = .network
-
-        remoteTransport.start(
-            sessionId: enteredPIN,
-            onTCPPacket: { [weak self] packet in
-                self?.handleTCPPacket(packet)
-            },
-            onUDPPacket: { [weak self] packet in
-                self?.handleUDPPacket(packet)
-            },
-            onStateChange: { [weak self] state in
-                guard let self else { return }
-                switch state {
-                case .connecting:
-                    self.debugConnectionStatus = "Remote: Connecting..."
-                case .ready:
-                    self.debugConnectionStatus = "Remote: Connected"
-                    self.startRemoteTelemetry()
-                    self.sendHandshake()
-                case .failed(let error):
-                    self.state = .error("Remote failed: \(error)")
-                case .idle:
-                    self.debugConnectionStatus = "Remote: Idle"
-                }
-            }
-        )
-    }
-
-
     private func sendHandshakeViaAirCatch() {
         let windowScenes = UIApplication.shared.connectedScenes
             .compactMap { $0 as? UIWindowScene }
@@ -470,6 +475,7 @@ final class ClientManager: ObservableObject {
         AirCatchLog.info("   Scale: \(scale)x", category: .video)
         #endif
 
+        let keyShare = crypto.keyShare()
         let request = HandshakeRequest(
             clientName: UIDevice.current.name,
             clientVersion: "1.0",
@@ -487,8 +493,13 @@ final class ClientManager: ObservableObject {
             requestAudio: audioEnabled,
             preferLowLatency: true,
             losslessVideo: true,
-            pin: enteredPIN.isEmpty ? nil : enteredPIN,
-            optimizeForHostDisplay: optimizeForHostDisplay
+            optimizeForHostDisplay: optimizeForHostDisplay,
+            supportsDirtyRegions: true,
+            supportsFrameLayers: true,
+            supportsSegmentedSealing: true,
+            keyShare: keyShare,
+            supportedCiphers: CipherBenchmark.ranking.map { $0.rawValue },
+            pinProof: pinProof(over: keyShare)
         )
 
         if let data = try? JSONEncoder().encode(request) {
@@ -571,14 +582,14 @@ final class ClientManager: ObservableObject {
         case .videoFrame:
             // E2EE: Decrypt video frame
             let frameData = crypto.decrypt(packet.payload) ?? packet.payload
-            videoFrameSubject.send(frameData)
+            videoFrames.deliver(frameData)
             if state == .connected {
                 state = .streaming
                 reconnectAttempts = 0
                 debugConnectionStatus = "Streaming (AirCatch)"
             }
-        case .videoFrameChunk:
-            handleVideoChunk(packet.payload)
+        case .videoFrameChunk, .videoFrameChunkLayered:
+            handleVideoChunk(packet.payload, layered: packet.type == .videoFrameChunkLayered)
             if state == .connected {
                 state = .streaming
                 reconnectAttempts = 0
@@ -622,7 +633,7 @@ final class ClientManager: ObservableObject {
 
     private func startRemoteTelemetry() {
         stopRemoteTelemetry()
-        guard connectionOption == .remote else { return }
+        guard remoteActive else { return }
 
         remotePingTimer = Timer.scheduledTimer(withTimeInterval: 2.0, repeats: true) { [weak self] _ in
             guard let weakSelf = self else { return }
@@ -640,7 +651,7 @@ final class ClientManager: ObservableObject {
     }
 
     private func sendRemotePingAndReport() {
-        guard connectionOption == .remote else { return }
+        guard remoteActive else { return }
         let now = Date().timeIntervalSince1970
         lastPingTimestamp = now
         let ping = PingPacket(timestamp: now)
@@ -656,115 +667,295 @@ final class ClientManager: ObservableObject {
     
     private func attemptReconnect() {
         guard reconnectAttempts < maxReconnectAttempts, let host = connectedHost else {
+            forgetResumableSession()
             state = .disconnected
             startDiscovery()
             return
         }
         
-        reconnectAttempts += 1
-        let delay = pow(2.0, Double(reconnectAttempts)) // 2, 4, 8, 16...
+        // Inside the host's resume window a retry costs one round trip, so retry
+        // quickly and don't count it; after that, back off as usual
+        let resuming = canResumeSession
+        isResumingSession = resuming && videoRequested
+        if !resuming {
+            reconnectAttempts += 1
+        }
+        let delay = resuming ? AirCatchConfig.resumeRetryDelay : pow(2.0, Double(reconnectAttempts)) // 2, 4, 8, 16...
         #if DEBUG
         AirCatchLog.info(" Reconnecting in \(delay)s (Attempt \(reconnectAttempts))")
         #endif
         state = .connecting // Updates UI to "Connecting..."
         
         DispatchQueue.main.asyncAfter(deadline: .now() + delay) { [weak self] in
-            if self?.connectionOption == .remote {
-                self?.connectRemote(host: host)
+            self?.startConnectionRace(host: host)
+        }
+    }
+    
+    // MARK: - Session Resume
+    
+    /// Ticket from the last handshake ack, and whether it was issued over the relay
+    private var resumeTicket: (ticket: String, isRemote: Bool)?
+    /// When the current session dropped; kept across reconnect attempts
+    private var sessionDroppedAt: TimeInterval?
+    
+    /// Whether the host should still be holding the dropped session.
+    private var canResumeSession: Bool {
+        guard resumeTicket != nil, let sessionDroppedAt else { return false }
+        return ProcessInfo.processInfo.systemUptime - sessionDroppedAt < AirCatchConfig.sessionResumeGracePeriod
+    }
+    
+    private func forgetResumableSession() {
+        resumeTicket = nil
+        sessionDroppedAt = nil
+        isResumingSession = false
+    }
+    
+    /// Asks the host to reattach us to the parked session instead of starting a new one.
+    /// The host answers with the session's `HandshakeAck` and forces a keyframe, which the
+    /// kept decoder (cached parameter sets) can show right away.
+    private func sendSessionResume(ticket: String, via path: ConnectionTimeline.Path) {
+        let request = SessionResumeRequest(ticket: ticket, pinProof: pinProof(over: Data(ticket.utf8)))
+        guard let data = try? JSONEncoder().encode(request) else { return }
+        
+        // Resumed session: a fresh lane, so the host starts a new sequence window
+        inputSequence = 0
+        inputLaneId = UInt32.random(in: 1...UInt32.max)
+        recentInputEvents.removeAll()
+        startupTimeline?.droppedAt = sessionDroppedAt
+        
+        if path.isLocal {
+            networkManager.sendTCP(type: .sessionResume, payload: data)
+        } else {
+            remoteTransport.sendTCP(type: .sessionResume, payload: data)
+        }
+        #if DEBUG
+        AirCatchLog.info(" Sent session resume (\(path.rawValue))")
+        #endif
+    }
+    
+    // MARK: - Connection Racing
+
+    /// Progress of one transport path during a connect.
+    private enum PathState {
+        case idle
+        /// Bonjour endpoint resolution (LAN only)
+        case resolving
+        case connecting
+        /// Transport is up; waiting for its turn to handshake
+        case ready
+        case handshaking
+        case acknowledged
+        /// Failed, abandoned, or not available for this host
+        case closed
+    }
+
+    /// Bumped on every connect and disconnect so callbacks from an abandoned race are ignored
+    private var raceGeneration = 0
+    private var lanState: PathState = .closed
+    private var relayState: PathState = .closed
+    /// Resolution probes still running, one per LAN variant
+    private var lanProbes: [NWConnection] = []
+    private var lanProbesRemaining = 0
+    /// LAN variant whose probe resolved first
+    private var lanPath: ConnectionTimeline.Path = .localNetwork
+    /// Path whose handshake the host acknowledged; it carries the session
+    private var activePath: ConnectionTimeline.Path? {
+        didSet { videoIntake.withLock { $0.path = activePath } }
+    }
+    private var handshakeInFlight: (path: ConnectionTimeline.Path, sentAt: TimeInterval, isResume: Bool)?
+    private var relayFailureReason: String?
+
+    /// Races every transport that can reach `host`, Happy Eyeballs style.
+    ///
+    /// LAN endpoint resolution starts right away: the preferred variant first, the
+    /// other one `lanRaceStagger` later, and the first to resolve connects. The relay
+    /// joins after `relayRaceDelay` if nothing has been acknowledged by then, or
+    /// straight away when it is the only path (or the LAN already failed).
+    ///
+    /// Only one handshake is in flight at a time, so the host never starts two
+    /// sessions at once; a transport that comes up while the other one is
+    /// handshaking waits its turn. The first acknowledged path carries the session.
+    /// A LAN path acknowledged after the relay won takes the session over and the
+    /// relay is closed.
+    private func startConnectionRace(host: DiscoveredHost) {
+        cancelConnectionRace()
+        networkManager.stopAll()
+        remoteTransport.stop()
+        stopRemoteTelemetry()
+
+        let generation = raceGeneration
+        startupTimeline = ConnectionTimeline()
+
+        let lanEndpoint = connectionOption == .remote ? nil : host.endpoint
+        let canRelay = enteredPIN.count == 6
+
+        guard lanEndpoint != nil || canRelay else {
+            if connectionOption == .remote {
+                state = .error("Enter a 6-character PIN")
             } else {
-                self?.resolveAndConnect(host: host)
+                #if DEBUG
+                AirCatchLog.info(" No Bonjour endpoint for host: \(host.name)")
+                #endif
+                disconnect(shouldRetry: true)
+            }
+            return
+        }
+
+        if let lanEndpoint {
+            // With P2P allowed, infrastructure Wi-Fi still races it: AWDL can be slow to come up
+            let paths: [ConnectionTimeline.Path] = connectionOption.includePeerToPeer
+                ? [.peerToPeer, .localNetwork]
+                : [.localNetwork]
+            raceLAN(to: lanEndpoint, over: paths, generation: generation)
+        }
+
+        guard canRelay else { return }
+        relayState = .idle
+        if lanEndpoint == nil {
+            startRelayAttempt(generation: generation)
+        } else {
+            DispatchQueue.main.asyncAfter(deadline: .now() + AirCatchConfig.relayRaceDelay) { [weak self] in
+                guard let self, generation == self.raceGeneration else { return }
+                guard self.activePath == nil, self.relayState == .idle else { return }
+                self.startRelayAttempt(generation: generation)
             }
         }
     }
-    
-    private func resolveAndConnect(host: DiscoveredHost) {
+
+    /// Forgets the current race. Transports are torn down by the caller.
+    private func cancelConnectionRace() {
+        raceGeneration += 1
+        stopLANProbes()
+        lanProbesRemaining = 0
+        lanState = .closed
+        relayState = .closed
+        activePath = nil
+        handshakeInFlight = nil
+        relayFailureReason = nil
+    }
+
+    // MARK: LAN
+
+    private func raceLAN(to endpoint: NWEndpoint, over paths: [ConnectionTimeline.Path], generation: Int) {
         #if DEBUG
         debugConnectionStatus = "Resolving endpoint..."
         #endif
+        lanState = .resolving
+        lanProbesRemaining = paths.count
 
-        guard let endpoint = host.endpoint else {
-            #if DEBUG
-            AirCatchLog.info(" No Bonjour endpoint for host: \(host.name)")
-            #endif
-            disconnect(shouldRetry: true)
-            return
+        for (index, path) in paths.enumerated() {
+            let delay = Double(index) * AirCatchConfig.lanRaceStagger
+            DispatchQueue.main.asyncAfter(deadline: .now() + delay) { [weak self] in
+                guard let self, generation == self.raceGeneration, self.lanState == .resolving else { return }
+                self.startLANProbe(to: endpoint, path: path, generation: generation)
+            }
         }
-        
-        // Create a connection to resolve the endpoint
-        // Bonjour service is UDP, so we use UDP to resolving the endpoint
+    }
+
+    private func startLANProbe(to endpoint: NWEndpoint, path: ConnectionTimeline.Path, generation: Int) {
+        // Bonjour service is UDP, so we use UDP to resolve the endpoint
         let parameters = NWParameters.udp
-        parameters.includePeerToPeer = connectionOption.includePeerToPeer
+        parameters.includePeerToPeer = path == .peerToPeer
         let connection = NWConnection(to: endpoint, using: parameters)
-        
+
         connection.stateUpdateHandler = { (newState: NWConnection.State) in
-            Task { @MainActor in
-                ClientManager.shared.debugConnectionStatus = "Endpoint state: \(newState)"
-            }
             switch newState {
             case .ready:
                 // Connection established - get the resolved IP
-                if let path = connection.currentPath,
-                   let endpoint = path.remoteEndpoint,
-                   case .hostPort(let resolvedHost, _) = endpoint {
-                    let hostString = "\(resolvedHost)"
-                    
-                    // Stop listening to updates so we don't log "cancelled"
-                    connection.stateUpdateHandler = nil
-                    connection.cancel()
-                    
-                    Task { @MainActor in
-                        ClientManager.shared.establishConnection(hostIP: hostString)
-                    }
+                guard let remoteEndpoint = connection.currentPath?.remoteEndpoint,
+                      case .hostPort(let resolvedHost, _) = remoteEndpoint else { return }
+                let hostString = "\(resolvedHost)"
+                Task { @MainActor in
+                    ClientManager.shared.lanProbeResolved(path: path, hostIP: hostString, generation: generation)
                 }
             case .failed(let error):
-                AirCatchLog.info(" Resolution failed: \(error)")
-                connection.stateUpdateHandler = nil
-                connection.cancel()
                 Task { @MainActor in
-                     ClientManager.shared.disconnect(shouldRetry: true)
+                    AirCatchLog.info(" Resolution failed (\(path.rawValue)): \(error)")
+                    ClientManager.shared.lanProbeFailed(connection, generation: generation)
                 }
             default:
                 break
             }
         }
-        
+
+        lanProbes.append(connection)
         connection.start(queue: .global())
     }
-    
-    private func establishConnection(hostIP: String) {
+
+    private func lanProbeResolved(path: ConnectionTimeline.Path, hostIP: String, generation: Int) {
+        guard generation == raceGeneration, lanState == .resolving else { return }
+        stopLANProbes()
+        lanPath = path
+        lanState = .connecting
+        startupTimeline?.mark(.resolved, on: path)
+        establishConnection(hostIP: hostIP, generation: generation)
+    }
+
+    private func lanProbeFailed(_ probe: NWConnection, generation: Int) {
+        guard generation == raceGeneration, lanState == .resolving else { return }
+        probe.stateUpdateHandler = nil
+        probe.cancel()
+        lanProbes.removeAll { $0 === probe }
+        lanProbesRemaining -= 1
+        if lanProbesRemaining == 0 {
+            pathFailed(lanPath, generation: generation)
+        }
+    }
+
+    private func stopLANProbes() {
+        for probe in lanProbes {
+            // Stop listening to updates so we don't log "cancelled"
+            probe.stateUpdateHandler = nil
+            probe.cancel()
+        }
+        lanProbes.removeAll()
+    }
+
+    private func establishConnection(hostIP: String, generation: Int) {
         #if DEBUG
         debugConnectionStatus = "Connecting to \(hostIP)..."
         AirCatchLog.info(" Connecting to \(hostIP)")
         #endif
-        
+
+        let path = lanPath
+        let includePeerToPeer = path == .peerToPeer
         let tcpPort = connectedHost?.tcpPort ?? AirCatchConfig.tcpPort
         let udpPort = connectedHost?.udpPort ?? AirCatchConfig.udpPort
 
         // Connect TCP for touch events and handshake
-        // We now wait for onConnected to send the handshake to avoid race condition
+        // The handshake waits for onConnected (and its turn in the race)
         networkManager.connectTCP(
             to: hostIP,
             port: tcpPort,
-            includePeerToPeer: connectionOption.includePeerToPeer,
+            includePeerToPeer: includePeerToPeer,
             requiredInterfaceType: nil,
             onConnected: { _ in
-            Task { @MainActor in
-                ClientManager.shared.sendHandshake()
+                Task { @MainActor in
+                    ClientManager.shared.transportReady(path, generation: generation)
+                }
+            },
+            onFailed: {
+                Task { @MainActor in
+                    ClientManager.shared.pathFailed(path, generation: generation)
+                }
             }
-        }) { packet, _ in
-            ClientManager.shared.handleTCPPacket(packet)
+        ) { packet, _ in
+            ClientManager.shared.handleControlPacket(packet, from: path, generation: generation)
         }
-        
+
         // Connect UDP for video frames
         networkManager.connectUDP(
             to: hostIP,
             port: udpPort,
-            includePeerToPeer: connectionOption.includePeerToPeer,
+            includePeerToPeer: includePeerToPeer,
             requiredInterfaceType: nil
         ) { packet, _ in
+            guard ClientManager.shared.carriesSession(path) else { return }
             ClientManager.shared.handleUDPPacket(packet)
+        } onNetworkQueue: { [weak self] packet in
+            self?.receiveVideoOffMain(packet, via: path) ?? false
         }
-        
+
         // Send a dummy UDP packet to "punch a hole" / register the connection with the Host listener
         // The Host needs to receive at least one packet to know we are here listening for broadcast
         Task {
@@ -775,8 +966,238 @@ final class ClientManager: ObservableObject {
             #endif
         }
     }
-    
-    private func sendHandshake() {
+
+    // MARK: Relay
+
+    private func startRelayAttempt(generation: Int) {
+        #if DEBUG
+        AirCatchLog.info(" Connecting (Remote) to session \(enteredPIN)")
+        #endif
+        relayState = .connecting
+
+        remoteTransport.start(
+            sessionId: enteredPIN,
+            onTCPPacket: { [weak self] packet in
+                self?.handleControlPacket(packet, from: .relay, generation: generation)
+            },
+            onUDPPacket: { [weak self] packet in
+                guard let self, generation == self.raceGeneration, self.carriesSession(.relay) else { return }
+                self.handleUDPPacket(packet)
+            },
+            onStateChange: { [weak self] state in
+                guard let self, generation == self.raceGeneration else { return }
+                switch state {
+                case .connecting:
+                    if self.activePath == nil {
+                        self.debugConnectionStatus = "Remote: Connecting..."
+                    }
+                case .ready:
+                    self.transportReady(.relay, generation: generation)
+                case .failed(let error):
+                    if self.activePath == .relay {
+                        self.state = .error("Remote failed: \(error)")
+                    } else {
+                        self.pathFailed(.relay, generation: generation, reason: error)
+                    }
+                case .idle:
+                    break
+                }
+            },
+            onDirectPathChange: { [weak self] direct in
+                guard let self, self.activePath == .relay else { return }
+                self.debugConnectionStatus = direct ? "Remote: Direct (UDP)" : "Remote: Relay"
+            }
+        )
+    }
+
+    private func closeRelayAttempt() {
+        guard relayState != .closed else { return }
+        relayState = .closed
+        remoteTransport.stop()
+        stopRemoteTelemetry()
+    }
+
+    // MARK: Handshake Arbitration
+
+    /// Whether packets from `path` belong to the session (any path may deliver before a winner exists).
+    private func carriesSession(_ path: ConnectionTimeline.Path) -> Bool {
+        activePath == nil || activePath == path
+    }
+
+    private func transportReady(_ path: ConnectionTimeline.Path, generation: Int) {
+        guard generation == raceGeneration else { return }
+        if path.isLocal {
+            guard lanState == .connecting else { return }
+            lanState = .ready
+        } else {
+            guard relayState == .connecting else { return }
+            relayState = .ready
+        }
+        startupTimeline?.mark(.transportReady, on: path)
+        checkHandshakeTimeout(generation: generation)
+        advanceHandshake(generation: generation)
+    }
+
+    /// Sends the next handshake, one at a time. LAN goes first when both are ready.
+    private func advanceHandshake(generation: Int) {
+        guard handshakeInFlight == nil else { return }
+
+        if activePath?.isLocal == true {
+            // The LAN carries the session; the relay is no longer needed
+            closeRelayAttempt()
+        } else if lanState == .ready {
+            // First handshake, or a migration off the relay
+            sendRaceHandshake(via: lanPath, generation: generation)
+        } else if activePath == nil, relayState == .ready {
+            sendRaceHandshake(via: .relay, generation: generation)
+        }
+    }
+
+    private func sendRaceHandshake(via path: ConnectionTimeline.Path, generation: Int) {
+        if path.isLocal {
+            lanState = .handshaking
+        } else {
+            relayState = .handshaking
+        }
+        if activePath == nil {
+            debugConnectionStatus = "Handshaking (\(path.rawValue))..."
+        }
+        // A resume only fits the kind of path (LAN or relay) the session ran on
+        if let ticket = resumeTicket, canResumeSession, ticket.isRemote == !path.isLocal {
+            handshakeInFlight = (path, ProcessInfo.processInfo.systemUptime, true)
+            sendSessionResume(ticket: ticket.ticket, via: path)
+        } else {
+            handshakeInFlight = (path, ProcessInfo.processInfo.systemUptime, false)
+            sendHandshake(via: path)
+        }
+
+        DispatchQueue.main.asyncAfter(deadline: .now() + AirCatchConfig.raceHandshakeTimeout) { [weak self] in
+            guard let self, generation == self.raceGeneration else { return }
+            self.checkHandshakeTimeout(generation: generation)
+        }
+    }
+
+    /// Gives up on a slow first handshake once the other path is ready to try instead.
+    private func checkHandshakeTimeout(generation: Int) {
+        guard activePath == nil, let inFlight = handshakeInFlight else { return }
+        guard ProcessInfo.processInfo.systemUptime - inFlight.sentAt >= AirCatchConfig.raceHandshakeTimeout else { return }
+        let otherReady = inFlight.path.isLocal ? relayState == .ready : lanState == .ready
+        guard otherReady else { return }
+        AirCatchLog.info(" Handshake over \(inFlight.path.rawValue) timed out, trying the other path")
+        pathFailed(inFlight.path, generation: generation)
+    }
+
+    /// Control packets from one path of the race.
+    private func handleControlPacket(_ packet: Packet, from path: ConnectionTimeline.Path, generation: Int) {
+        guard generation == raceGeneration else { return }
+        switch packet.type {
+        case .handshakeAck:
+            handshakeAcknowledged(packet.payload, via: path)
+        case .sessionResumeRejected:
+            guard let inFlight = handshakeInFlight, inFlight.path == path, inFlight.isResume else { return }
+            // The host no longer holds the session; start a new one on the same path
+            AirCatchLog.info(" Session resume rejected, sending a full handshake", category: .network)
+            resumeTicket = nil
+            startupTimeline?.droppedAt = nil
+            handshakeInFlight = (path, ProcessInfo.processInfo.systemUptime, false)
+            sendHandshake(via: path)
+        case .sessionKeys:
+            handleSessionKeys(packet.payload)
+        case .streamStartupReport:
+            // Sent at the host's first frame, which can overtake the ack
+            guard let report = try? JSONDecoder().decode(StreamStartupReport.self, from: packet.payload) else { return }
+            startupTimeline?.hostStartup = report
+            AirCatchLog.info(" Host stream startup: time to first frame \(report.firstFrameMs) ms", category: .network)
+        case .disconnect where activePath != path:
+            // A path that isn't carrying the session dropped; the race goes on without it
+            pathFailed(path, generation: generation)
+        case .pairingFailed:
+            // Wrong PIN fails every path alike
+            cancelConnectionRace()
+            networkManager.stopAll()
+            remoteTransport.stop()
+            handleTCPPacket(packet)
+        default:
+            guard carriesSession(path) else { return }
+            handleTCPPacket(packet)
+        }
+    }
+
+    private func handshakeAcknowledged(_ payload: Data, via path: ConnectionTimeline.Path) {
+        guard let inFlight = handshakeInFlight, inFlight.path == path else { return }
+        handshakeInFlight = nil
+        if path.isLocal {
+            lanState = .acknowledged
+        } else {
+            relayState = .acknowledged
+        }
+
+        let migrating = activePath != nil
+        activePath = path
+        remoteActive = !path.isLocal
+        startupTimeline?.mark(.handshakeAcked, on: path)
+        startupTimeline?.activate(path)
+
+        if path.isLocal {
+            // The host moved the stream here when it took this handshake
+            closeRelayAttempt()
+            if migrating {
+                reassembler.reset()
+                AirCatchLog.info(" Session migrated from relay to \(path.rawValue)", category: .network)
+            }
+        } else {
+            startRemoteTelemetry()
+        }
+        
+        if inFlight.isResume {
+            // Frames in flight around the drop reference pictures we never got
+            reassembler.reset(awaitingKeyframe: true)
+            AirCatchLog.info(" Session resumed over \(path.rawValue)", category: .network)
+        }
+        sessionDroppedAt = nil
+        isResumingSession = false
+
+        handleHandshakeAck(payload)
+        debugConnectionStatus = "Connected (\(path.rawValue))"
+
+        // A LAN path that came up meanwhile can take over from the relay now
+        advanceHandshake(generation: raceGeneration)
+    }
+
+    /// Drops one path of the race. Failures of the path carrying the session go through `disconnect`.
+    private func pathFailed(_ path: ConnectionTimeline.Path, generation: Int, reason: String? = nil) {
+        guard generation == raceGeneration, activePath != path else { return }
+        if path.isLocal {
+            guard lanState != .closed else { return }
+            lanState = .closed
+            stopLANProbes()
+            networkManager.stopAll()
+        } else {
+            guard relayState != .closed else { return }
+            relayFailureReason = reason
+            closeRelayAttempt()
+        }
+        if handshakeInFlight?.path == path {
+            handshakeInFlight = nil
+        }
+
+        // The session carries on over the relay; this was a migration attempt
+        guard activePath == nil else { return }
+
+        if relayState == .idle {
+            // Don't wait out the race delay
+            startRelayAttempt(generation: generation)
+        } else if lanState != .closed || relayState != .closed {
+            advanceHandshake(generation: generation)
+        } else if connectionOption == .remote {
+            state = .error("Remote failed: \(relayFailureReason ?? "unreachable")")
+        } else {
+            disconnect(shouldRetry: true)
+        }
+    }
+
+    /// Sends the handshake over one transport path.
+    private func sendHandshake(via path: ConnectionTimeline.Path) {
         // Prefer an active UIWindowScene screen. Avoids deprecated UIScreen.main / UIScreen.screens.
         let windowScenes = UIApplication.shared.connectedScenes
             .compactMap { $0 as? UIWindowScene }
@@ -809,6 +1230,7 @@ final class ClientManager: ObservableObject {
         AirCatchLog.info("   Scale: \(scale)x", category: .video)
         #endif
 
+        let keyShare = crypto.keyShare()
         let request = HandshakeRequest(
             clientName: UIDevice.current.name,
             clientVersion: "1.0",
@@ -819,43 +1241,91 @@ final class ClientManager: ObservableObject {
             nativeBoundsWidth: Int(nativeBounds.width),
             nativeBoundsHeight: Int(nativeBounds.height),
             preferredQuality: selectedPreset,
-            connectionMode: currentConnectionMode(),
+            connectionMode: connectionMode(for: path),
             codecPreference: .auto,
             displayConfig: nil,  // Mirror mode only (extend display removed)
             requestVideo: pendingRequestVideo,
             requestAudio: audioEnabled,
             preferLowLatency: true,
-            losslessVideo: connectionOption == .remote ? false : true,
-            pin: enteredPIN.isEmpty ? nil : enteredPIN,
-            optimizeForHostDisplay: optimizeForHostDisplay
+            losslessVideo: path.isLocal,
+            optimizeForHostDisplay: optimizeForHostDisplay,
+            supportsDirtyRegions: true,
+            supportsInputLane: path.isLocal,
+            supportsFrameLayers: true,
+            supportsSegmentedSealing: true,
+            keyShare: keyShare,
+            supportedCiphers: CipherBenchmark.ranking.map { $0.rawValue },
+            pinProof: pinProof(over: keyShare)
         )
         
+        // Every handshake opens a fresh lane, so the host starts a new sequence window
+        inputSequence = 0
+        inputLaneId = UInt32.random(in: 1...UInt32.max)
+        recentInputEvents.removeAll()
+        
         if let data = try? JSONEncoder().encode(request) {
-            sendControl(type: .handshake, payload: data)
+            if path.isLocal {
+                networkManager.sendTCP(type: .handshake, payload: data)
+            } else {
+                remoteTransport.sendTCP(type: .handshake, payload: data)
+            }
             #if DEBUG
-            AirCatchLog.info(" Sent handshake: video=\(pendingRequestVideo) preset=\(selectedPreset.displayName)")
+            AirCatchLog.info(" Sent handshake (\(path.rawValue)): video=\(pendingRequestVideo) preset=\(selectedPreset.displayName)")
             #endif
         }
     }
 
-    private func currentConnectionMode() -> ConnectionMode {
-        switch connectionOption {
-        case .udpPeerToPeerAWDL:
+    private func connectionMode(for path: ConnectionTimeline.Path) -> ConnectionMode {
+        switch path {
+        case .peerToPeer:
             return .localPeerToPeer
-        case .udpNetworkFramework:
+        case .localNetwork:
             return .localNetwork
-        case .remote:
+        case .relay:
             return .remote
         }
     }
 
     private func sendControl(type: PacketType, payload: Data) {
-        if connectionOption == .remote {
+        if remoteActive {
             remoteTransport.sendTCP(type: type, payload: payload)
         } else {
             networkManager.sendTCP(type: type, payload: payload)
         }
     }
+    
+    /// Input rides the UDP lane when the host accepted it on a local network link.
+    private var inputLaneActive: Bool {
+        activeLink == .network && !remoteActive && screenInfo?.inputLane == true && crypto.isReady
+    }
+    
+    /// Sends an input event on the UDP input lane, away from video and control traffic on TCP.
+    /// Each datagram repeats the most recent events so a lost datagram loses nothing.
+    /// Transitions (`reliable`) are also copied over TCP; the host keeps whichever arrives first.
+    /// - Returns: false when the lane is inactive and the caller should use the regular path.
+    private func sendOnInputLane(reliable: Bool, _ fill: (inout InputLaneEvent) -> Void) -> Bool {
+        guard inputLaneActive else { return false }
+        
+        inputSequence &+= 1
+        var event = InputLaneEvent(sequenceNumber: inputSequence)
+        fill(&event)
+        
+        recentInputEvents.append(event)
+        if recentInputEvents.count > AirCatchConfig.inputLaneRedundancy {
+            recentInputEvents.removeFirst(recentInputEvents.count - AirCatchConfig.inputLaneRedundancy)
+        }
+        
+        if let data = try? JSONEncoder().encode(InputBatch(events: recentInputEvents, laneId: inputLaneId)),
+           let encrypted = crypto.encrypt(data) {
+            networkManager.sendUDP(type: .inputBatch, payload: encrypted)
+        }
+        if reliable,
+           let data = try? JSONEncoder().encode(InputBatch(events: [event], laneId: inputLaneId)),
+           let encrypted = crypto.encrypt(data) {
+            sendControl(type: .inputBatch, payload: encrypted)
+        }
+        return true
+    }
 
     /// Caps the streaming render resolution to improve sharp text and reduce encoder pressure.
     ///
@@ -888,10 +1358,12 @@ final class ClientManager: ObservableObject {
         switch packet.type {
         case .handshakeAck:
             handleHandshakeAck(packet.payload)
+        case .sessionKeys:
+            handleSessionKeys(packet.payload)
         case .videoFrame:
             // E2EE: Decrypt video frames received via TCP
             let frameData = crypto.decrypt(packet.payload) ?? packet.payload
-            videoFrameSubject.send(frameData)
+            videoFrames.deliver(frameData)
             if state == .connected {
                 state = .streaming
                 reconnectAttempts = 0
@@ -933,12 +1405,12 @@ final class ClientManager: ObservableObject {
         case .videoFrame:
             // E2EE: Decrypt UDP complete frame (legacy/fallback)
             let frameData = crypto.decrypt(packet.payload) ?? packet.payload
-            videoFrameSubject.send(frameData)
+            videoFrames.deliver(frameData)
             updateStreamingState()
             
-        case .videoFrameChunk:
+        case .videoFrameChunk, .videoFrameChunkLayered:
             // Handle fragmented video frame (chunks are already encrypted as a whole frame)
-            handleVideoChunk(packet.payload)
+            handleVideoChunk(packet.payload, layered: packet.type == .videoFrameChunkLayered)
             
         case .audioPCM:
             // E2EE: Decrypt audio packet
@@ -961,40 +1433,80 @@ final class ClientManager: ObservableObject {
         }
     }
     
-    private func handleVideoChunk(_ data: Data) {
+    private func handleVideoChunk(_ data: Data, layered: Bool) {
+        processVideoChunk(data, layered: layered, losslessEnabled: !remoteActive)
+    }
+    
+    /// LAN UDP fast path, called on the network queue: video chunks for the path
+    /// carrying the session go to reassembly without waiting on the main thread.
+    /// - Returns: false for packets that still need `handleUDPPacket`.
+    nonisolated func receiveVideoOffMain(_ packet: Packet, via path: ConnectionTimeline.Path) -> Bool {
+        guard packet.type == .videoFrameChunk || packet.type == .videoFrameChunkLayered else { return false }
+        let intake = videoIntake.withLock { $0 }
+        guard intake.path == nil || intake.path == path else { return true }
+        processVideoChunk(packet.payload, layered: packet.type == .videoFrameChunkLayered, losslessEnabled: intake.lossless)
+        return true
+    }
+    
+    /// Any thread. Completed frames are decrypted on the reassembly queue and handed to the decoder.
+    private nonisolated func processVideoChunk(_ data: Data, layered: Bool, losslessEnabled: Bool) {
         guard data.count > 8 else { return }
-        // Safe byte-by-byte parsing to avoid unaligned memory access crashes
-        let frameId = UInt32(data[0]) << 24 | UInt32(data[1]) << 16 | UInt32(data[2]) << 8 | UInt32(data[3])
-        let chunkIdx = Int(UInt16(data[4]) << 8 | UInt16(data[5]))
-        
-        if frameId % 60 == 0 && chunkIdx == 0 {
-             // AirCatchLog.info(" Rx Chunk: F\(frameId) C\(chunkIdx)") -- Removed for performance
-        }
         
+        let crypto = self.crypto
+        let videoFrames = self.videoFrames
+        let videoIntake = self.videoIntake
         reassembler.process(
             chunk: data,
-            losslessEnabled: connectionOption == .remote ? false : true,
-            onNack: { [weak self] frameId, missingChunkIndices in
-                guard let self else { return }
-                guard self.activeLink == .network else { return }
+            layered: layered,
+            losslessEnabled: losslessEnabled,
+            onNack: { frameId, missingChunkIndices in
                 guard !missingChunkIndices.isEmpty else { return }
-                let request = VideoChunkNackRequest(frameId: frameId, missingChunkIndices: missingChunkIndices)
-                if let payload = try? JSONEncoder().encode(request) {
-                    self.sendControl(type: .videoFrameChunkNack, payload: payload)
+                Task { @MainActor in
+                    let manager = ClientManager.shared
+                    guard manager.activeLink == .network else { return }
+                    let request = VideoChunkNackRequest(frameId: frameId, missingChunkIndices: missingChunkIndices)
+                    if let payload = try? JSONEncoder().encode(request) {
+                        manager.sendControl(type: .videoFrameChunkNack, payload: payload)
+                    }
                 }
             },
-            onComplete: { [weak self] fullFrame in
-            Task { @MainActor [weak self] in
-                guard let self else { return }
+            onKeyframeNeeded: {
+                Task { @MainActor in
+                    ClientManager.shared.sendControl(type: .keyframeRequest, payload: Data())
+                }
+            },
+            onComplete: { fullFrame in
                 // E2EE: Decrypt reassembled frame (chunks form the encrypted payload)
-                let decryptedFrame = self.crypto.decrypt(fullFrame) ?? fullFrame
-                self.videoFrameSubject.send(decryptedFrame)
-                self.updateStreamingState()
+                let decryptedFrame = crypto.decrypt(fullFrame) ?? fullFrame
+                videoFrames.deliver(decryptedFrame)
+                let isFirstFrame = videoIntake.withLock { intake -> Bool in
+                    defer { intake.awaitingFirstFrame = false }
+                    return intake.awaitingFirstFrame
+                }
+                if isFirstFrame {
+                    Task { @MainActor in
+                        ClientManager.shared.updateStreamingState()
+                    }
+                }
             }
-        })
+        )
     }
 
     
+    /// Proof of the entered PIN bound to `context`; the PIN itself is never sent.
+    private func pinProof(over context: Data) -> Data? {
+        enteredPIN.isEmpty ? nil : KeySchedule.pinProof(pin: enteredPIN, context: context)
+    }
+    
+    /// The host answers the handshake's key share before it starts streaming,
+    /// so frames are sealed under the session keys from the first one.
+    private func handleSessionKeys(_ payload: Data) {
+        guard let answer = try? JSONDecoder().decode(SessionKeyShare.self, from: payload) else { return }
+        if crypto.completeKeyExchange(answer) {
+            remoteTransport.setDirectPathKey(crypto.directPathKey)
+        }
+    }
+    
     private func handleHandshakeAck(_ payload: Data) {
         guard let ack = try? JSONDecoder().decode(HandshakeAck.self, from: payload) else {
             #if DEBUG
@@ -1005,6 +1517,9 @@ final class ClientManager: ObservableObject {
         
         screenInfo = ack
         state = .connected
+        if let ticket = ack.resumeTicket, let activePath {
+            resumeTicket = (ticket, !activePath.isLocal)
+        }
         
         #if DEBUG
         AirCatchLog.info(" Connected! Screen: \(ack.width)x\(ack.height) @ \(ack.frameRate)fps")
@@ -1030,6 +1545,10 @@ final class ClientManager: ObservableObject {
             eventType: eventType
         )
         
+        // Motion is superseded by the next sample, so it only needs the lane's redundancy
+        let isMotion = eventType == .moved || eventType == .dragMoved
+        if sendOnInputLane(reliable: !isMotion, { $0.touch = event }) { return }
+        
         if let data = try? JSONEncoder().encode(event) {
             switch activeLink {
             case .aircatch:
@@ -1047,6 +1566,7 @@ final class ClientManager: ObservableObject {
         // macOS interprets cmd+scroll as zoom in many apps
         let zoomDelta = (scale - 1.0) * 10.0  // Convert scale to scroll-like delta
         let event = ScrollEvent(deltaX: 0, deltaY: zoomDelta)
+        if sendOnInputLane(reliable: false, { $0.scroll = event }) { return }
         if let data = try? JSONEncoder().encode(event) {
             switch activeLink {
             case .aircatch:
@@ -1061,6 +1581,7 @@ final class ClientManager: ObservableObject {
     func sendScrollEvent(deltaX: Double, deltaY: Double) {
         guard state == .connected || state == .streaming else { return }
         let event = ScrollEvent(deltaX: deltaX, deltaY: deltaY)
+        if sendOnInputLane(reliable: false, { $0.scroll = event }) { return }
         if let data = try? JSONEncoder().encode(event) {
             switch activeLink {
             case .aircatch:
@@ -1094,6 +1615,7 @@ final class ClientManager: ObservableObject {
     func sendMediaKeyEvent(mediaKey: Int32, keyCode: UInt16) {
         guard state == .connected || state == .streaming else { return }
         let event = MediaKeyEvent(mediaKey: mediaKey, keyCode: keyCode)
+        if sendOnInputLane(reliable: true, { $0.mediaKey = event }) { return }
         if let data = try? JSONEncoder().encode(event) {
             switch activeLink {
             case .aircatch:
@@ -1108,45 +1630,66 @@ final class ClientManager: ObservableObject {
 
 // MARK: - Video Reassembler (Thread-Safe)
 
-private final class VideoReassembler {
+/// Layered chunks (`FrameLayerTag`) add a decode-chain policy: droppable frames are
+/// never NACKed and are the first to go when frames pile up, and once a reference
+/// frame is given up, completed frames are discarded until the next keyframe.
+private nonisolated final class VideoReassembler {
     private struct FrameAssembly {
         var totalChunks: Int
         var chunks: [Int: Data]
         var firstSeenAt: TimeInterval
         var lastNackSentAt: TimeInterval
         var nackedIndices: Set<Int>
+        var tag: FrameLayerTag?
     }
 
     private var reassemblyBuffer: [UInt32: FrameAssembly] = [:]
     private let queue = DispatchQueue(label: "com.aircatch.reassembly")
     private var chunkCount = 0
     private var frameCount = 0
+    /// A reference frame was lost; only a keyframe can be decoded next (layered streams only)
+    private var awaitingKeyframe = false
+    private var discardedFrameCount = 0
+    
+    /// Forgets partial frames, e.g. when the stream moves to another path and frame ids restart.
+    /// - Parameter awaitingKeyframe: Discard completed frames until the next keyframe
+    ///   (layered streams), for a stream that continued while we were away.
+    func reset(awaitingKeyframe: Bool = false) {
+        queue.async {
+            self.reassemblyBuffer.removeAll()
+            self.awaitingKeyframe = awaitingKeyframe
+        }
+    }
     
     func process(
         chunk data: Data,
+        layered: Bool,
         losslessEnabled: Bool,
         onNack: @escaping (UInt32, [UInt16]) -> Void,
+        onKeyframeNeeded: @escaping () -> Void,
         onComplete: @escaping (Data) -> Void
     ) {
-        // Header: [FrameId: 4][ChunkIdx: 2][TotalChunks: 2]
-        guard data.count > 8 else { return }
+        // Header: [FrameId: 4][ChunkIdx: 2][TotalChunks: 2], plus [Tag: 1] when layered
+        let headerSize = layered ? 9 : 8
+        guard data.count > headerSize else { return }
         
         // Safe byte-by-byte parsing to avoid unaligned memory access crashes
         let frameId = UInt32(data[0]) << 24 | UInt32(data[1]) << 16 | UInt32(data[2]) << 8 | UInt32(data[3])
         let chunkIdx = Int(UInt16(data[4]) << 8 | UInt16(data[5]))
         let totalChunks = Int(UInt16(data[6]) << 8 | UInt16(data[7]))
-        let chunkData = data.subdata(in: 8..<data.count)
-        
-        chunkCount += 1
-        #if DEBUG
-        if chunkCount <= 10 {
-            AirCatchLog.debug(" Chunk \(chunkCount): F\(frameId) C\(chunkIdx)/\(totalChunks) size=\(chunkData.count)")
-        }
-        #endif
+        let tag = layered ? FrameLayerTag(byte: data[8]) : nil
+        let chunkData = data.subdata(in: headerSize..<data.count)
         
         queue.async { [weak self] in
             guard let self else { return }
 
+            self.chunkCount += 1
+            #if DEBUG
+            if self.chunkCount <= 10 {
+                AirCatchLog.debug(" Chunk \(self.chunkCount): F\(frameId) C\(chunkIdx)/\(totalChunks) size=\(chunkData.count)")
+            }
+            #endif
+
             let now = Date().timeIntervalSinceReferenceDate
             let nackDelay: TimeInterval = 0.02
             let nackMinInterval: TimeInterval = 0.03
@@ -1154,10 +1697,23 @@ private final class VideoReassembler {
             
             // Cleanup old frames - collect keys first to avoid mutation during iteration
             if self.reassemblyBuffer.count > 8 {
+                // Backed up: give up on droppable frames first, nothing references them
+                let droppableKeys = self.reassemblyBuffer
+                    .filter { $0.value.tag?.isDroppable == true && now - $0.value.firstSeenAt > nackDelay }
+                    .map { $0.key }
+                for key in droppableKeys { self.reassemblyBuffer.removeValue(forKey: key) }
+
                 let keysToRemove = self.reassemblyBuffer
                     .filter { now - $0.value.firstSeenAt > 1.0 }
                     .map { $0.key }
-                for key in keysToRemove { self.reassemblyBuffer.removeValue(forKey: key) }
+                for key in keysToRemove {
+                    // Losing a tagged reference frame breaks every frame after it
+                    if let lost = self.reassemblyBuffer.removeValue(forKey: key)?.tag,
+                       !lost.isDroppable, !self.awaitingKeyframe {
+                        self.awaitingKeyframe = true
+                        onKeyframeNeeded()
+                    }
+                }
             }
             
             // Store chunk
@@ -1170,7 +1726,8 @@ private final class VideoReassembler {
                     chunks: chunksDict,
                     firstSeenAt: now,
                     lastNackSentAt: 0,
-                    nackedIndices: []
+                    nackedIndices: [],
+                    tag: tag
                 )
             }
             // If totalChunks changes (shouldn't), trust the latest header.
@@ -1199,12 +1756,28 @@ private final class VideoReassembler {
                 }
                 #endif
                 self.reassemblyBuffer.removeValue(forKey: frameId)
+
+                if let tag = assembly.tag {
+                    if tag.isKeyframe {
+                        self.awaitingKeyframe = false
+                    } else if self.awaitingKeyframe {
+                        // References a lost frame; decoding it would only show artifacts
+                        self.discardedFrameCount += 1
+                        #if DEBUG
+                        if self.discardedFrameCount % 60 == 1 {
+                            AirCatchLog.debug(" Discarded \(self.discardedFrameCount) frames waiting for a keyframe")
+                        }
+                        #endif
+                        return
+                    }
+                }
                 onComplete(fullFrame)
                 return
             }
 
             // Lossless mode: request retransmit of missing chunks once we’ve waited long enough.
-            if losslessEnabled, var assembly = self.reassemblyBuffer[frameId] {
+            // Droppable frames aren't worth a retransmit; the next frame doesn't need them.
+            if losslessEnabled, tag?.isDroppable != true, var assembly = self.reassemblyBuffer[frameId] {
                 let age = now - assembly.firstSeenAt
                 if age >= nackDelay, now - assembly.lastNackSentAt >= nackMinInterval {
                     var missing: [UInt16] = []
@@ -0,0 +1,115 @@
+//
+//  ConnectionTimeline.swift
+//  AirCatchClient
+//
+//  Startup-time breakdown of one connect, per transport path.
+//
+
+import Foundation
+
+/// Milestones of a connect, measured from the moment it started.
+///
+/// Every path raced during the connect records its own milestones; the summary
+/// describes the path that carries the session (the first to finish the
+/// handshake, or the one the session migrated to).
+struct ConnectionTimeline: Equatable {
+
+    enum Path: String {
+        case peerToPeer = "LAN (P2P)"
+        case localNetwork = "LAN"
+        case relay = "Relay"
+
+        var isLocal: Bool { self != .relay }
+    }
+
+    enum Milestone: Int, CaseIterable {
+        /// Bonjour endpoint resolved to an address (LAN only)
+        case resolved
+        /// TCP connected, or relay WebSocket open
+        case transportReady
+        case handshakeAcked
+        case firstFrame
+
+        var label: String {
+            switch self {
+            case .resolved: return "resolve"
+            case .transportReady: return "connect"
+            case .handshakeAcked: return "handshake"
+            case .firstFrame: return "first frame"
+            }
+        }
+    }
+
+    let startedAt: TimeInterval
+    /// Path carrying the session
+    private(set) var activePath: Path?
+    /// Path the session started on, when it later migrated
+    private(set) var migratedFrom: Path?
+    /// Seconds since `startedAt`, per path
+    private(set) var marks: [Path: [Milestone: TimeInterval]] = [:]
+    /// When the session being resumed dropped (nil for a new session)
+    var droppedAt: TimeInterval?
+    /// The host's side of stream startup, measured from its handshake
+    var hostStartup: StreamStartupReport?
+
+    init(startedAt: TimeInterval = ProcessInfo.processInfo.systemUptime) {
+        self.startedAt = startedAt
+    }
+
+    /// Records a milestone once per path; repeats are ignored.
+    mutating func mark(_ milestone: Milestone, on path: Path, at now: TimeInterval = ProcessInfo.processInfo.systemUptime) {
+        guard marks[path]?[milestone] == nil else { return }
+        marks[path, default: [:]][milestone] = now - startedAt
+    }
+
+    /// Moves the session to `path` (first handshake, or a migration).
+    mutating func activate(_ path: Path) {
+        if let activePath, activePath != path {
+            migratedFrom = activePath
+        }
+        activePath = path
+    }
+
+    /// Seconds from the start of the connect to the first frame on the active path.
+    var timeToFirstFrame: TimeInterval? {
+        activePath.flatMap { marks[$0]?[.firstFrame] }
+    }
+
+    /// Seconds from the drop to the first frame of a resumed session.
+    var recoveryTime: TimeInterval? {
+        guard let droppedAt, let timeToFirstFrame else { return nil }
+        return startedAt + timeToFirstFrame - droppedAt
+    }
+
+    /// e.g. "LAN (P2P): resolve 40 ms, connect 12 ms, handshake 310 ms, first frame 95 ms (total 457 ms)".
+    /// Stages are durations between consecutive milestones.
+    var summary: String {
+        guard let path = activePath, let pathMarks = marks[path] else { return "Connecting..." }
+
+        var stages: [String] = []
+        var previous: TimeInterval = 0
+        for milestone in Milestone.allCases {
+            guard let at = pathMarks[milestone] else { continue }
+            stages.append("\(milestone.label) \(Self.milliseconds(at - previous))")
+            previous = at
+        }
+
+        var text = "\(path.rawValue): " + stages.joined(separator: ", ")
+        text += " (total \(Self.milliseconds(previous)))"
+        if let migratedFrom {
+            text += ", migrated from \(migratedFrom.rawValue)"
+        }
+        if let recoveryTime {
+            text += ", resumed \(Self.milliseconds(recoveryTime)) after the drop"
+        }
+        if let hostStartup {
+            let display = hostStartup.displayReadyMs.map { "display \($0) ms, " } ?? ""
+            text += "; host: \(display)encoder \(hostStartup.encoderReadyMs) ms, first frame \(hostStartup.firstFrameMs) ms"
+        }
+        return text
+    }
+
+    private static func milliseconds(_ seconds: TimeInterval) -> String {
+        "\(Int((max(0, seconds) * 1000).rounded())) ms"
+    }
+}
@@ -49,7 +49,7 @@ struct ContentView: View {
                     }
                 }
                 .overlay {
-                    if clientManager.videoRequested && (clientManager.state == .connected || clientManager.state == .streaming) {
+                    if clientManager.videoRequested && (clientManager.state == .connected || clientManager.state == .streaming || clientManager.isResumingSession) {
                         VideoStreamOverlay()
                             .environmentObject(clientManager)
                             .transition(.opacity)
@@ -2,24 +2,43 @@
 //  CryptoManager.swift
 //  AirCatchClient
 //
-//  End-to-end encryption using PIN-derived AES-256-GCM.
+//  End-to-end encryption with negotiated AEAD session keys (X25519 + PIN).
 //
 
 import Foundation
 import CryptoKit
+import os
 
-/// Provides end-to-end encryption using AES-256-GCM with PIN-derived key.
-/// This ensures neither network sniffers nor the relay server can read data.
-final class CryptoManager {
-    private var key: SymmetricKey?
+/// Provides end-to-end encryption using AES-256-GCM or ChaCha20-Poly1305.
+/// Network observers can't read traffic. The relay can't either while it only forwards,
+/// but it learns the PIN (the session ID), so it could intercept pairing.
+/// Frames are decrypted on the reassembly queue, so the keys are behind a lock.
+///
+/// Traffic starts on the PIN-derived key. Every handshake carries this client's
+/// X25519 key share; the host's `.sessionKeys` answer unwraps the session secret,
+/// and `KeySchedule` takes over with one ratcheting chain per direction.
+nonisolated final class CryptoManager {
+    /// Bytes sealing adds in front of and behind the ciphertext: nonce (12) + tag (16)
+    static let sealOverhead = FrameSealer.overhead
+
+    private struct State {
+        var schedule: KeySchedule?
+        var pin = ""
+        /// Ephemeral key behind this connect's key share (kept across racing paths and resumes)
+        var exchangeKey: Curve25519.KeyAgreement.PrivateKey?
+        /// Salt of the installed session; a repeated answer for it is ignored
+        var sessionSalt: Data?
+    }
+
+    private let state = OSAllocatedUnfairLock(initialState: State())
     private static let salt = "AirCatch-E2EE-v1".data(using: .utf8)!
     private static let info = "AirCatch-Session".data(using: .utf8)!
     
     /// Derives a 256-bit AES key from the PIN using HKDF.
-    /// Call this when PIN is generated (host) or entered (client).
+    /// Call this when PIN is generated (host) or entered (client). Forgets any session.
     func deriveKey(from pin: String) {
         guard !pin.isEmpty else {
-            key = nil
+            state.withLock { $0 = State() }
             return
         }
         
@@ -28,12 +47,13 @@ final class CryptoManager {
         // Use HKDF to derive a strong key from the short PIN
         // Salt ensures different apps with same PIN get different keys
         // Info adds context to the derivation
-        key = HKDF<SHA256>.deriveKey(
+        let key = HKDF<SHA256>.deriveKey(
             inputKeyMaterial: SymmetricKey(data: pinData),
             salt: Self.salt,
             info: Self.info,
             outputByteCount: 32  // 256 bits for AES-256
         )
+        state.withLock { $0 = State(schedule: KeySchedule(staticKey: key, role: .client), pin: pin) }
         
         #if DEBUG
         AirCatchLog.info("E2EE: Key derived from PIN", category: .network)
@@ -42,27 +62,115 @@ final class CryptoManager {
     
     /// Clears the encryption key (call on disconnect).
     func clearKey() {
-        key = nil
+        state.withLock { $0 = State() }
+    }
+    
+    // MARK: - Key Exchange
+    
+    /// This client's X25519 public key for `HandshakeRequest.keyShare`.
+    func keyShare() -> Data {
+        state.withLock { state in
+            let key = state.exchangeKey ?? Curve25519.KeyAgreement.PrivateKey()
+            state.exchangeKey = key
+            return key.publicKey.rawRepresentation
+        }
+    }
+    
+    /// Unwraps the session secret from the host's answer and switches to session keys.
+    /// - Returns: false when the answer doesn't match our key share or PIN.
+    @discardableResult
+    func completeKeyExchange(_ answer: SessionKeyShare) -> Bool {
+        let current = state.withLock { ($0.exchangeKey, $0.pin, $0.sessionSalt) }
+        guard let exchangeKey = current.0 else { return false }
+        // Racing paths each get an answer for the same session
+        if current.2 == answer.salt { return true }
+        
+        do {
+            let hostKey = try Curve25519.KeyAgreement.PublicKey(rawRepresentation: answer.publicKey)
+            let agreement = try exchangeKey.sharedSecretFromKeyAgreement(with: hostKey)
+            let wrappingKey = KeySchedule.wrappingKey(
+                agreement: agreement,
+                pin: current.1,
+                salt: answer.salt,
+                clientShare: exchangeKey.publicKey.rawRepresentation,
+                hostShare: answer.publicKey
+            )
+            guard let cipher = answer.cipher.map({ AEADCipher(rawValue: $0) }) ?? .aes256GCM else {
+                AirCatchLog.error("E2EE: Host picked an unknown cipher \(answer.cipher ?? "")", category: .network)
+                return false
+            }
+            // Older hosts send no confirmation; their answers use the shared chain from epoch 0
+            if let confirmation = answer.confirmation {
+                let confirmationKey = KeySchedule.confirmationKey(
+                    agreement: agreement,
+                    pin: current.1,
+                    salt: answer.salt,
+                    clientShare: exchangeKey.publicKey.rawRepresentation,
+                    hostShare: answer.publicKey
+                )
+                guard HMAC<SHA256>.isValidAuthenticationCode(confirmation, authenticating: KeySchedule.confirmedFields(of: answer), using: confirmationKey) else {
+                    AirCatchLog.error("E2EE: Host failed key confirmation", category: .network)
+                    return false
+                }
+            }
+            let confirmed = answer.confirmation != nil
+            let secret = try AES.GCM.open(AES.GCM.SealedBox(combined: answer.sealedSecret), using: wrappingKey)
+            let schedule = KeySchedule(
+                secret: SymmetricKey(data: secret),
+                salt: answer.salt,
+                role: .client,
+                cipher: cipher,
+                rekeyInterval: AirCatchConfig.rekeyInterval,
+                peer: confirmed ? answer.peerId ?? 0 : 0,
+                receiveEpoch: confirmed ? answer.hostEpoch ?? 0 : 0
+            )
+            state.withLock { state in
+                state.schedule = schedule
+                state.sessionSalt = answer.salt
+            }
+            AirCatchLog.info("E2EE: Session keys established (\(cipher.rawValue))", category: .network)
+            return true
+        } catch {
+            AirCatchLog.error("E2EE: Key exchange failed - \(error)", category: .network)
+            return false
+        }
     }
     
     /// Returns true if encryption is ready.
     var isReady: Bool {
-        key != nil
+        state.withLock { $0.schedule != nil }
     }
     
-    /// Encrypts plaintext data using AES-256-GCM.
+    /// Key for direct-path checks, derived from the session secret; nil while on the PIN key.
+    var directPathKey: SymmetricKey? {
+        state.withLock { $0.schedule?.directPathKey }
+    }
+    
+    /// Encrypts plaintext data with the session cipher.
     /// Returns: nonce (12) + ciphertext + tag (16), or nil on failure.
     func encrypt(_ plaintext: Data) -> Data? {
-        guard let key = key else {
+        var output = Data(count: plaintext.count + Self.sealOverhead)
+        let count = output.withUnsafeMutableBytes { seal(plaintext, into: $0) }
+        return count == nil ? nil : output
+    }
+
+    /// Seals `plaintext` into caller-owned memory as nonce (12) + ciphertext + tag (16)
+    /// with the session's cipher, the same layout as `AES.GCM.SealedBox.combined`.
+    /// - Returns: Bytes written (`plaintext.count + sealOverhead`), or nil on failure.
+    func seal<Plaintext: DataProtocol>(_ plaintext: Plaintext, into output: UnsafeMutableRawBufferPointer) -> Int? {
+        guard let sealing = state.withLock({ state -> (key: SymmetricKey, nonce: AES.GCM.Nonce, backend: AEADBackend.Type)? in
+            guard let cipher = state.schedule?.cipher, let next = state.schedule?.nextSealing() else { return nil }
+            return (next.key, next.nonce, cipher.backend)
+        }) else {
             #if DEBUG
             AirCatchLog.error("E2EE: Encrypt failed - no key", category: .network)
             #endif
             return nil
         }
+        guard output.count >= plaintext.count + Self.sealOverhead else { return nil }
         
         do {
-            let sealed = try AES.GCM.seal(plaintext, using: key)
-            return sealed.combined  // nonce + ciphertext + tag
+            return try FrameSealer.seal(plaintext, using: sealing.key, nonce: sealing.nonce, backend: sealing.backend, into: output)
         } catch {
             #if DEBUG
             AirCatchLog.error("E2EE: Encrypt failed - \(error)", category: .network)
@@ -71,10 +179,10 @@ final class CryptoManager {
         }
     }
     
-    /// Decrypts ciphertext (nonce + ciphertext + tag) using AES-256-GCM.
+    /// Decrypts ciphertext (nonce + ciphertext + tag) with the session cipher.
     /// Returns plaintext or nil if decryption fails (wrong key, tampered data).
     func decrypt(_ ciphertext: Data) -> Data? {
-        guard let key = key else {
+        guard isReady else {
             #if DEBUG
             AirCatchLog.error("E2EE: Decrypt failed - no key", category: .network)
             #endif
@@ -89,9 +197,22 @@ final class CryptoManager {
             return nil
         }
         
+        // Large host frames may be sealed as segments; a single box never starts with the tag
+        if ciphertext.first == FrameSealer.segmentedTag, let plaintext = openSegments(ciphertext) {
+            return plaintext
+        }
+        
+        guard let opening = openingKey(for: ciphertext.prefix(12)) else {
+            #if DEBUG
+            AirCatchLog.error("E2EE: Decrypt failed - unknown key epoch", category: .network)
+            #endif
+            return nil
+        }
+        
         do {
-            let box = try AES.GCM.SealedBox(combined: ciphertext)
-            return try AES.GCM.open(box, using: key)
+            let plaintext = try opening.backend.open(ciphertext, using: opening.key, authenticating: Data())
+            confirm(opening)
+            return plaintext
         } catch {
             #if DEBUG
             AirCatchLog.error("E2EE: Decrypt failed - \(error)", category: .network)
@@ -99,4 +220,35 @@ final class CryptoManager {
             return nil
         }
     }
+
+    /// Opens a frame the host sealed as `FrameSealer` segments, concurrently.
+    /// - Returns: nil when the layout doesn't add up or any segment fails to open.
+    private func openSegments(_ sealed: Data) -> Data? {
+        var opening: (key: SymmetricKey, backend: AEADBackend.Type, position: KeySchedule.Opening)?
+        let plaintext = FrameSealer.openSegments(sealed) { firstNonce in
+            // All segments share the first one's key epoch
+            opening = openingKey(for: firstNonce)
+            return opening.map { ($0.key, $0.backend) }
+        }
+        guard let plaintext, let opening else {
+            #if DEBUG
+            AirCatchLog.error("E2EE: Segmented decrypt failed", category: .network)
+            #endif
+            return nil
+        }
+        confirm(opening)
+        return plaintext
+    }
+
+    private func openingKey(for nonce: Data) -> (key: SymmetricKey, backend: AEADBackend.Type, position: KeySchedule.Opening)? {
+        state.withLock { state in
+            guard let schedule = state.schedule, let opening = schedule.openingKey(for: nonce) else { return nil }
+            return (opening.key, schedule.cipher.backend, opening)
+        }
+    }
+
+    /// A box of `opening`'s epoch authenticated; the receiving chain may move forward.
+    private func confirm(_ opening: (key: SymmetricKey, backend: AEADBackend.Type, position: KeySchedule.Opening)) {
+        state.withLock { $0.schedule?.didOpen(opening.position) }
+    }
 }
@@ -0,0 +1,447 @@
+//
+//  DirectPath.swift
+//  AirCatchClient
+//
+//  ICE-lite style UDP hole punching for Remote mode.
+//
+
+import Foundation
+import Network
+import CryptoKit
+import os
+
+/// Opens a direct UDP path to the remote peer while the relay carries the session.
+///
+/// Candidates (LAN addresses plus the STUN-mapped address) are exchanged as relay
+/// `candidate` messages. Both sides then send authenticated checks to every remote
+/// candidate from the same local port that was used for STUN, which opens the NAT
+/// mappings in both directions. The controlling side (host) nominates the first
+/// candidate that answers. Datagrams on the selected path use the relay's
+/// `[type][payload]` framing, so the chunked video path works unchanged.
+///
+/// Checks are authenticated with a key derived from the negotiated session secret
+/// (`setKey`), so nothing is checked before the key exchange completes. They
+/// continue once per second as keepalives. After
+/// `AirCatchConfig.directPathIdleTimeout` of silence the path is dropped and the
+/// transport falls back to the relay; the side that notices gathers again and
+/// re-offers after a backoff, as it does when no candidate pair answered.
+nonisolated final class DirectPath {
+
+    struct Candidate: Codable, Hashable {
+        let ip: String
+        let port: UInt16
+        let kind: String  // "host" (LAN address) or "srflx" (STUN-mapped)
+    }
+
+    struct Offer: Codable {
+        let candidates: [Candidate]
+        /// Set when answering the peer's offer, so offers don't ping-pong
+        let reply: Bool
+    }
+
+    private enum CheckKind: UInt8 {
+        case request = 0x01
+        case response = 0x02
+        case nominate = 0x03
+    }
+
+    /// First byte of a check datagram. Never a valid `PacketType`.
+    private static let checkMagic: UInt8 = 0xAC
+    /// [magic 1][kind 1][transaction 8][HMAC-SHA256 32]
+    private static let checkLength = 42
+    private static let checkInterval: DispatchTimeInterval = .milliseconds(100)
+    private static let keepaliveTicks = 10
+    /// Re-punch delays double from the first to the last
+    private static let repunchBackoff: (first: TimeInterval, last: TimeInterval) = (1, 30)
+
+    private let isControlling: Bool
+    private let queue = DispatchQueue(label: "com.aircatch.directpath")
+    private let selected = OSAllocatedUnfairLock<NWConnection?>(initialState: nil)
+
+    // State below is only touched on `queue`
+    private var key: SymmetricKey?
+    private var generation = 0
+    private var repunchAttempts = 0
+    private var localPort: UInt16 = 0
+    private var localCandidates: [Candidate] = []
+    private var gathered = false
+    private var needsReply = false
+    private var remoteCandidates: [Candidate] = []
+    private var checks: [Candidate: NWConnection] = [:]
+    private var timer: DispatchSourceTimer?
+    private var tickCount = 0
+    private var checkDeadline: DispatchTime = .now()
+    private var lastReceived: DispatchTime = .now()
+
+    private var sendSignal: ((String) -> Void)?
+    private var onPacket: (@MainActor (Packet) -> Void)?
+    private var onPathChange: (@MainActor (Bool) -> Void)?
+
+    /// - Parameter isControlling: The controlling side picks the path; the other follows its nomination.
+    init(isControlling: Bool) {
+        self.isControlling = isControlling
+    }
+
+    /// Whether datagrams currently bypass the relay.
+    var isActive: Bool {
+        selected.withLock { $0 != nil }
+    }
+
+    // MARK: - Lifecycle
+
+    /// Gathers local candidates and offers them to the peer through `sendSignal`.
+    /// Connectivity checks wait for `setKey`.
+    func start(
+        sendSignal: @escaping (String) -> Void,
+        onPacket: @MainActor @escaping (Packet) -> Void,
+        onPathChange: (@MainActor (Bool) -> Void)? = nil
+    ) {
+        queue.async {
+            self.teardown()
+            self.generation += 1
+            self.key = nil
+            self.repunchAttempts = 0
+            self.sendSignal = sendSignal
+            self.onPacket = onPacket
+            self.onPathChange = onPathChange
+            guard AirCatchConfig.directPathEnabled else { return }
+            self.gather()
+        }
+    }
+
+    func stop() {
+        queue.async {
+            self.teardown()
+            self.generation += 1
+            self.sendSignal = nil
+        }
+    }
+
+    /// Sets the key that authenticates checks, derived from the negotiated session
+    /// secret (`CryptoManager.directPathKey`), so only the peer that completed the
+    /// key exchange can open a path. nil (session over) drops the path and stops checking.
+    func setKey(_ key: SymmetricKey?) {
+        queue.async {
+            guard self.key?.withUnsafeBytes({ Data($0) }) != key?.withUnsafeBytes({ Data($0) }) else { return }
+            self.dropPath()
+            self.cancelChecks()
+            self.key = key
+            if key != nil, self.gathered, !self.remoteCandidates.isEmpty {
+                self.beginChecks()
+            }
+        }
+    }
+
+    /// Handles a `candidate` payload relayed from the peer.
+    func handleSignal(_ payload: String) {
+        guard let data = payload.data(using: .utf8),
+              let offer = try? JSONDecoder().decode(Offer.self, from: data) else { return }
+
+        queue.async {
+            guard AirCatchConfig.directPathEnabled, self.sendSignal != nil else { return }
+
+            if !offer.reply {
+                // A fresh offer means the peer (re)started; any old path is stale
+                self.dropPath()
+                if self.gathered {
+                    self.sendOffer(reply: true)
+                } else {
+                    self.needsReply = true
+                }
+            }
+
+            self.remoteCandidates = offer.candidates
+            if self.gathered {
+                self.beginChecks()
+            }
+        }
+    }
+
+    // MARK: - Sending
+
+    /// Sends a datagram on the direct path.
+    /// - Returns: false when no path is selected and the caller should use the relay.
+    func send(type: PacketType, payload: Data) -> Bool {
+        guard let connection = selected.withLock({ $0 }) else { return false }
+        var datagram = Data()
+        datagram.reserveCapacity(1 + payload.count)
+        datagram.append(type.rawValue)
+        datagram.append(payload)
+        connection.send(content: datagram, completion: .idempotent)
+        return true
+    }
+
+    // MARK: - Gathering
+
+    private func gather() {
+        let currentGeneration = generation
+        localPort = UInt16.random(in: 49152...65000)
+        localCandidates = Self.interfaceAddresses().map { Candidate(ip: $0, port: localPort, kind: "host") }
+
+        // STUN from the same port the checks use, so the mapped address is the one peers can reach
+        StunClient.discoverMappedAddress(localPort: localPort) { [weak self] mapped in
+            guard let self else { return }
+            self.queue.async {
+                guard currentGeneration == self.generation, !self.gathered else { return }
+                if let mapped {
+                    self.localCandidates.append(Candidate(ip: mapped.ip, port: mapped.port, kind: "srflx"))
+                }
+                self.gathered = true
+                AirCatchLog.info("Direct path: \(self.localCandidates.count) local candidates on port \(self.localPort)", category: .network)
+
+                self.sendOffer(reply: self.needsReply)
+                self.needsReply = false
+                if !self.remoteCandidates.isEmpty {
+                    self.beginChecks()
+                }
+            }
+        }
+    }
+
+    private func sendOffer(reply: Bool) {
+        guard let data = try? JSONEncoder().encode(Offer(candidates: localCandidates, reply: reply)),
+              let text = String(data: data, encoding: .utf8) else { return }
+        sendSignal?(text)
+    }
+
+    // MARK: - Connectivity Checks
+
+    private func beginChecks() {
+        guard key != nil, !isActive else { return }
+        cancelChecks()
+
+        for candidate in remoteCandidates where checks[candidate] == nil {
+            guard let connection = makeConnection(to: candidate) else { continue }
+            checks[candidate] = connection
+        }
+        guard !checks.isEmpty else { return }
+
+        checkDeadline = .now() + AirCatchConfig.directPathCheckTimeout
+        startTimer()
+    }
+
+    private func makeConnection(to candidate: Candidate) -> NWConnection? {
+        guard let remotePort = NWEndpoint.Port(rawValue: candidate.port),
+              let boundPort = NWEndpoint.Port(rawValue: localPort) else { return nil }
+
+        let parameters = NWParameters.udp
+        parameters.allowLocalEndpointReuse = true
+        parameters.requiredLocalEndpoint = .hostPort(host: .ipv4(.any), port: boundPort)
+
+        let connection = NWConnection(host: NWEndpoint.Host(candidate.ip), port: remotePort, using: parameters)
+        connection.start(queue: queue)
+        receive(on: connection)
+        return connection
+    }
+
+    private func receive(on connection: NWConnection) {
+        connection.receiveMessage { [weak self] data, _, _, error in
+            guard let self else { return }
+            if let data, !data.isEmpty {
+                self.handleDatagram(data, on: connection)
+            }
+            if error == nil, connection.state != .cancelled {
+                self.receive(on: connection)
+            }
+        }
+    }
+
+    private func handleDatagram(_ data: Data, on connection: NWConnection) {
+        if data.first == Self.checkMagic {
+            handleCheck(data, on: connection)
+            return
+        }
+
+        let current = selected.withLock { $0 }
+        if current == nil, !isControlling, checks.values.contains(where: { $0 === connection }) {
+            // Media before the nomination arrived: the host already uses this path
+            select(connection)
+        } else if current !== connection {
+            return
+        }
+        lastReceived = .now()
+
+        guard let type = PacketType(rawValue: data[data.startIndex]) else { return }
+        let packet = Packet(type: type, payload: Data(data.dropFirst()))
+        let onPacket = self.onPacket
+        Task { @MainActor in
+            onPacket?(packet)
+        }
+    }
+
+    private func handleCheck(_ data: Data, on connection: NWConnection) {
+        guard let key, data.count == Self.checkLength,
+              let kind = CheckKind(rawValue: data[data.startIndex + 1]) else { return }
+        let body = data.prefix(10)
+        guard HMAC<SHA256>.isValidAuthenticationCode(data.suffix(32), authenticating: body, using: key) else { return }
+        let transaction = body.suffix(8).reduce(UInt64(0)) { $0 << 8 | UInt64($1) }
+
+        let current = selected.withLock { $0 }
+        if current === connection {
+            lastReceived = .now()
+        }
+
+        switch kind {
+        case .request:
+            sendCheck(.response, transaction: transaction, on: connection)
+        case .response:
+            if current == nil, isControlling {
+                select(connection)
+                sendCheck(.nominate, transaction: UInt64.random(in: 0...UInt64.max), on: connection)
+            }
+        case .nominate:
+            if current == nil, !isControlling {
+                select(connection)
+            }
+            sendCheck(.response, transaction: transaction, on: connection)
+        }
+    }
+
+    private func sendCheck(_ kind: CheckKind, transaction: UInt64, on connection: NWConnection) {
+        guard let key else { return }
+        var datagram = Data([Self.checkMagic, kind.rawValue])
+        withUnsafeBytes(of: transaction.bigEndian) { datagram.append(contentsOf: $0) }
+        datagram.append(contentsOf: HMAC<SHA256>.authenticationCode(for: datagram, using: key))
+        connection.send(content: datagram, completion: .idempotent)
+    }
+
+    // MARK: - Path Selection
+
+    private func select(_ connection: NWConnection) {
+        selected.withLock { $0 = connection }
+        lastReceived = .now()
+        repunchAttempts = 0
+        for (candidate, other) in checks where other !== connection {
+            other.cancel()
+            checks[candidate] = nil
+        }
+
+        let endpoint = checks.first { $0.value === connection }?.key
+        AirCatchLog.info("Direct path selected: \(endpoint?.ip ?? "?"):\(endpoint?.port ?? 0) (\(endpoint?.kind ?? "?"))", category: .network)
+        notifyPathChange(true)
+    }
+
+    /// Forgets the selected path; traffic goes back to the relay.
+    private func dropPath() {
+        guard let connection = selected.withLock({ (current: inout NWConnection?) -> NWConnection? in
+            defer { current = nil }
+            return current
+        }) else { return }
+
+        connection.cancel()
+        cancelChecks()
+        AirCatchLog.info("Direct path lost, falling back to relay", category: .network)
+        notifyPathChange(false)
+    }
+
+    private func notifyPathChange(_ active: Bool) {
+        let onPathChange = self.onPathChange
+        Task { @MainActor in
+            onPathChange?(active)
+        }
+    }
+
+    // MARK: - Timer
+
+    private func startTimer() {
+        timer?.cancel()
+        tickCount = 0
+        let source = DispatchSource.makeTimerSource(queue: queue)
+        source.schedule(deadline: .now(), repeating: Self.checkInterval)
+        source.setEventHandler { [weak self] in
+            self?.tick()
+        }
+        source.resume()
+        timer = source
+    }
+
+    private func tick() {
+        tickCount += 1
+
+        if let connection = selected.withLock({ $0 }) {
+            if DispatchTime.now() > lastReceived + AirCatchConfig.directPathIdleTimeout {
+                dropPath()
+                scheduleRepunch()
+                return
+            }
+            // Controlling side keeps re-nominating so a lost nomination heals itself
+            if tickCount % Self.keepaliveTicks == 0 {
+                sendCheck(isControlling ? .nominate : .request, transaction: UInt64.random(in: 0...UInt64.max), on: connection)
+            }
+            return
+        }
+
+        guard DispatchTime.now() < checkDeadline else {
+            AirCatchLog.info("Direct path: no candidate pair answered, staying on relay", category: .network)
+            cancelChecks()
+            scheduleRepunch()
+            return
+        }
+        for connection in checks.values {
+            sendCheck(.request, transaction: UInt64.random(in: 0...UInt64.max), on: connection)
+        }
+    }
+
+    // MARK: - Re-punching
+
+    /// Gathers again after a backoff and offers fresh candidates. The fresh offer makes
+    /// the peer drop its side of a dead path and answer, so both ends check anew; a new
+    /// STUN binding also covers a NAT that remapped the old port.
+    private func scheduleRepunch() {
+        let delay = min(Self.repunchBackoff.first * pow(2, Double(repunchAttempts)), Self.repunchBackoff.last)
+        repunchAttempts += 1
+        let currentGeneration = generation
+        queue.asyncAfter(deadline: .now() + delay) { [weak self] in
+            guard let self, currentGeneration == self.generation,
+                  self.sendSignal != nil, self.key != nil, !self.isActive, self.timer == nil else { return }
+            AirCatchLog.info("Direct path: re-punching (attempt \(self.repunchAttempts))", category: .network)
+            self.cancelChecks()
+            self.generation += 1
+            self.gathered = false
+            self.needsReply = false
+            self.gather()
+        }
+    }
+
+    private func cancelChecks() {
+        timer?.cancel()
+        timer = nil
+        for connection in checks.values {
+            connection.cancel()
+        }
+        checks.removeAll()
+    }
+
+    private func teardown() {
+        dropPath()
+        cancelChecks()
+        gathered = false
+        needsReply = false
+        localCandidates.removeAll()
+        remoteCandidates.removeAll()
+    }
+
+    // MARK: - Interfaces
+
+    /// Non-loopback IPv4 addresses of interfaces that are up.
+    private static func interfaceAddresses() -> [String] {
+        var addresses: [String] = []
+        var ifaddr: UnsafeMutablePointer<ifaddrs>?
+        guard getifaddrs(&ifaddr) == 0, let first = ifaddr else { return [] }
+        defer { freeifaddrs(ifaddr) }
+
+        for pointer in sequence(first: first, next: { $0.pointee.ifa_next }) {
+            let flags = Int32(pointer.pointee.ifa_flags)
+            guard let address = pointer.pointee.ifa_addr,
+                  address.pointee.sa_family == UInt8(AF_INET),
+                  flags & IFF_UP != 0,
+                  flags & IFF_LOOPBACK == 0 else { continue }
+
+            var host = [CChar](repeating: 0, count: Int(NI_MAXHOST))
+            if getnameinfo(address, socklen_t(address.pointee.sa_len), &host, socklen_t(host.count), nil, 0, NI_NUMERICHOST) == 0 {
+                addresses.append(String(cString: host))
+            }
+        }
+        return addresses
+    }
+}
@@ -0,0 +1,36 @@
+//
+//  FrameLayerTag.swift
+//  AirCatchClient
+//
+//  Temporal-layer tag carried in layered video chunk headers.
+//
+
+import Foundation
+
+/// Temporal-layer tag of a video frame, carried unencrypted in every
+/// `.videoFrameChunkLayered` chunk header: `[FrameId: 4][ChunkIdx: 2][TotalChunks: 2][Tag: 1]`.
+///
+/// Sent only to clients that set `HandshakeRequest.supportsFrameLayers`. The relay,
+/// the host pacer and the client reassembler read it to discard droppable frames
+/// first under congestion. Tag byte: `[Keyframe: 1 bit][Droppable: 1 bit][Reserved: 2][Layer: 4]`.
+nonisolated struct FrameLayerTag: Equatable {
+    /// 0 is the base layer; higher layers only reference lower ones
+    let temporalLayer: UInt8
+    let isKeyframe: Bool
+    /// No later frame predicts from this one
+    let isDroppable: Bool
+
+    init(temporalLayer: UInt8, isKeyframe: Bool, isDroppable: Bool) {
+        self.temporalLayer = temporalLayer & 0x0F
+        self.isKeyframe = isKeyframe
+        self.isDroppable = isDroppable
+    }
+
+    init(byte: UInt8) {
+        self.init(temporalLayer: byte & 0x0F, isKeyframe: byte & 0x80 != 0, isDroppable: byte & 0x40 != 0)
+    }
+
+    var byte: UInt8 {
+        (isKeyframe ? 0x80 : 0) | (isDroppable ? 0x40 : 0) | temporalLayer
+    }
+}
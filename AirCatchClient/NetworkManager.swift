@@ -16,9 +16,13 @@ final class NetworkManager {
     // MARK: - UDP Components
     private var udpClientConnection: NWConnection?
     private var udpReceiveHandler: (@MainActor (Packet, NWEndpoint?) -> Void)?
+    /// Sees each UDP packet first, on the network queue; true means handled
+    private var udpFastPathHandler: ((Packet) -> Bool)?
     
     // MARK: - TCP Components
     private var tcpClientConnection: NWConnection?
+    /// Connection still being set up, so a cancelled connect can't turn ready later
+    private var tcpPendingConnection: NWConnection?
     private var tcpReceiveHandler: (@MainActor (Packet, NWConnection) -> Void)?
 
     private init() {}
@@ -29,9 +33,11 @@ final class NetworkManager {
         port: UInt16,
         includePeerToPeer: Bool = true,
         requiredInterfaceType: NWInterface.InterfaceType? = nil,
-        onPacket: @MainActor @escaping (Packet, NWEndpoint?) -> Void
+        onPacket: @MainActor @escaping (Packet, NWEndpoint?) -> Void,
+        onNetworkQueue fastPath: ((Packet) -> Bool)? = nil
     ) {
         udpReceiveHandler = onPacket
+        udpFastPathHandler = fastPath
 
         guard let nwPort = NWEndpoint.Port(rawValue: port) else {
             AirCatchLog.error("Invalid UDP port \(port)")
@@ -85,6 +91,7 @@ final class NetworkManager {
         includePeerToPeer: Bool = true,
         requiredInterfaceType: NWInterface.InterfaceType? = nil,
         onConnected: ((NWConnection) -> Void)? = nil,
+        onFailed: (() -> Void)? = nil,
         onPacket: @MainActor @escaping (Packet, NWConnection) -> Void
     ) {
         tcpReceiveHandler = onPacket
@@ -117,10 +124,12 @@ final class NetworkManager {
             switch state {
             case .ready:
                 AirCatchLog.info("TCP connected to \(host):\(port)", category: .network)
+                self?.tcpPendingConnection = nil
                 self?.tcpClientConnection = connection
                 onConnected?(connection)
             case .failed(let error):
                 AirCatchLog.error("TCP connection failed: \(error)", category: .network)
+                onFailed?()
             case .cancelled:
                 break
             default:
@@ -129,6 +138,7 @@ final class NetworkManager {
         }
         
         prepareTCPConnection(connection)
+        tcpPendingConnection = connection
         connection.start(queue: queue)
     }
     
@@ -151,10 +161,13 @@ final class NetworkManager {
         udpClientConnection?.cancel()
         udpClientConnection = nil
         udpReceiveHandler = nil
+        udpFastPathHandler = nil
     }
     
     /// Tears down all TCP resources.
     func stopTCP() {
+        tcpPendingConnection?.cancel()
+        tcpPendingConnection = nil
         tcpClientConnection?.cancel()
         tcpClientConnection = nil
         tcpReceiveHandler = nil
@@ -187,7 +200,8 @@ final class NetworkManager {
                 AirCatchLog.error("UDP receive error: \(error)")
             }
 
-            if let data, let packet = self.parsePacket(from: data) {
+            if let data, let packet = self.parsePacket(from: data),
+               self.udpFastPathHandler?(packet) != true {
                 let handler = self.udpReceiveHandler
                 Task { @MainActor in
                     handler?(packet, connection.endpoint)
@@ -210,68 +224,47 @@ final class NetworkManager {
         // Note: connection.start() is called in connectTCP() after this function
     }
     
-    private func tcpReceiveLoop(on connection: NWConnection) {
-        // First read the header (1 byte type + 4 bytes length)
-        connection.receive(minimumIncompleteLength: 5, maximumLength: 5) { [weak self] data, _, isComplete, error in
+    private func tcpReceiveLoop(on connection: NWConnection, framer: PacketFramer = PacketFramer(maxPayloadSize: AirCatchConfig.maxTCPPayloadSize)) {
+        // Read whatever has arrived; the framer emits every packet it completes
+        connection.receive(minimumIncompleteLength: 1, maximumLength: PacketFramer.readSize) { [weak self] data, _, isComplete, error in
             guard let self else { return }
             
-            if let error {
-                AirCatchLog.error("TCP receive error: \(error)")
-                return
-            }
-            
-            if isComplete {
-                // Connection closed
-                let handler = self.tcpReceiveHandler
-                Task { @MainActor in
-                    handler?(Packet(type: .disconnect, payload: Data()), connection)
+            var packets: [Packet] = []
+            var closed = false
+            if let data, !data.isEmpty {
+                do {
+                    packets = try framer.append(data)
+                } catch {
+                    AirCatchLog.error("TCP framing error, closing connection: \(error)")
+                    connection.cancel()
+                    closed = true
                 }
-                return
             }
-            
-            guard let data, data.count == 5 else {
-                if connection.state == .ready {
-                    self.tcpReceiveLoop(on: connection)
-                }
-                return
-            }
-            
-            guard let type = PacketType(rawValue: data[0]) else {
-                self.tcpReceiveLoop(on: connection)
-                return
+            if error == nil, isComplete {
+                // Connection closed
+                closed = true
             }
             
-            // Parse payload length (big endian)
-            let length = Int(data[1]) << 24 | Int(data[2]) << 16 | Int(data[3]) << 8 | Int(data[4])
-            
-            if length == 0 {
+            // One hop to the main actor per read, however many packets it completed
+            if !packets.isEmpty || closed {
                 let handler = self.tcpReceiveHandler
                 Task { @MainActor in
-                    handler?(Packet(type: type, payload: Data()), connection)
+                    for packet in packets {
+                        handler?(packet, connection)
+                    }
+                    if closed {
+                        handler?(Packet(type: .disconnect, payload: Data()), connection)
+                    }
                 }
-                self.tcpReceiveLoop(on: connection)
+            }
+            
+            if let error {
+                AirCatchLog.error("TCP receive error: \(error)")
                 return
             }
             
-            // Read the payload
-            connection.receive(minimumIncompleteLength: length, maximumLength: length) { [weak self] payloadData, _, _, error in
-                guard let self else { return }
-                
-                if let error {
-                    AirCatchLog.error("TCP payload receive error: \(error)")
-                }
-                
-                if let payloadData {
-                    let handler = self.tcpReceiveHandler
-                    let packet = Packet(type: type, payload: payloadData)
-                    Task { @MainActor in
-                        handler?(packet, connection)
-                    }
-                }
-                
-                if connection.state == .ready {
-                    self.tcpReceiveLoop(on: connection)
-                }
+            if !closed {
+                self.tcpReceiveLoop(on: connection, framer: framer)
             }
         }
     }
@@ -0,0 +1,194 @@
+//
+//  PCMKernels.swift
+//  AirCatchClient
+//
+//  SIMD kernels for PCM interleave/de-interleave, format conversion and gain.
+//
+
+import Foundation
+
+/// Allocation-free PCM kernels used on the real-time audio path.
+///
+/// All kernels operate on caller-provided buffers so the audio callbacks never
+/// allocate per packet. Only the Swift standard library `SIMD` types are used,
+/// which keeps the kernels portable (no Accelerate dependency).
+enum PCMKernels {
+
+    // MARK: - Interleave / De-interleave
+
+    /// Interleaves planar stereo into `L0 R0 L1 R1 ...`.
+    /// - Parameters:
+    ///   - left: Left channel samples (`frameCount` floats)
+    ///   - right: Right channel samples (`frameCount` floats)
+    ///   - output: Destination with room for `frameCount * 2` floats
+    nonisolated static func interleave(
+        left: UnsafePointer<Float>,
+        right: UnsafePointer<Float>,
+        into output: UnsafeMutablePointer<Float>,
+        frameCount: Int
+    ) {
+        let l = UnsafeRawPointer(left)
+        let r = UnsafeRawPointer(right)
+        let out = UnsafeMutableRawPointer(output)
+        let stride = MemoryLayout<Float>.stride
+
+        var i = 0
+        while i + 4 <= frameCount {
+            let lv = l.loadUnaligned(fromByteOffset: i * stride, as: SIMD4<Float>.self)
+            let rv = r.loadUnaligned(fromByteOffset: i * stride, as: SIMD4<Float>.self)
+            let mixed = SIMD8<Float>(
+                lv[0], rv[0], lv[1], rv[1],
+                lv[2], rv[2], lv[3], rv[3]
+            )
+            out.storeBytes(of: mixed, toByteOffset: i * 2 * stride, as: SIMD8<Float>.self)
+            i += 4
+        }
+        while i < frameCount {
+            output[i * 2] = left[i]
+            output[i * 2 + 1] = right[i]
+            i += 1
+        }
+    }
+
+    /// Splits interleaved stereo `L0 R0 L1 R1 ...` into two planar channels.
+    /// - Parameters:
+    ///   - input: Interleaved samples (`frameCount * 2` floats)
+    ///   - left: Destination for left channel (`frameCount` floats)
+    ///   - right: Destination for right channel (`frameCount` floats)
+    nonisolated static func deinterleave(
+        _ input: UnsafeRawPointer,
+        left: UnsafeMutablePointer<Float>,
+        right: UnsafeMutablePointer<Float>,
+        frameCount: Int
+    ) {
+        let l = UnsafeMutableRawPointer(left)
+        let r = UnsafeMutableRawPointer(right)
+        let stride = MemoryLayout<Float>.stride
+
+        var i = 0
+        while i + 4 <= frameCount {
+            let v = input.loadUnaligned(fromByteOffset: i * 2 * stride, as: SIMD8<Float>.self)
+            l.storeBytes(of: v.evenHalf, toByteOffset: i * stride, as: SIMD4<Float>.self)
+            r.storeBytes(of: v.oddHalf, toByteOffset: i * stride, as: SIMD4<Float>.self)
+            i += 4
+        }
+        while i < frameCount {
+            left[i] = input.loadUnaligned(fromByteOffset: i * 2 * stride, as: Float.self)
+            right[i] = input.loadUnaligned(fromByteOffset: (i * 2 + 1) * stride, as: Float.self)
+            i += 1
+        }
+    }
+
+    // MARK: - Format Conversion
+
+    /// Converts Float32 samples in [-1, 1] to Int16 with TPDF dither.
+    /// Samples outside the range are clamped. Pass `dither: nil` for plain rounding.
+    nonisolated static func convertFloatToInt16(
+        _ input: UnsafePointer<Float>,
+        into output: UnsafeMutablePointer<Int16>,
+        count: Int,
+        dither: UnsafeMutablePointer<PCMDither>? = nil
+    ) {
+        let src = UnsafeRawPointer(input)
+        let dst = UnsafeMutableRawPointer(output)
+        let scale = SIMD4<Float>(repeating: 32767)
+        let lower = SIMD4<Float>(repeating: -32768)
+        let upper = SIMD4<Float>(repeating: 32767)
+
+        var i = 0
+        while i + 4 <= count {
+            var v = src.loadUnaligned(fromByteOffset: i * 4, as: SIMD4<Float>.self) * scale
+            if let dither {
+                v += dither.pointee.next4()
+            }
+            v = v.clamped(lowerBound: lower, upperBound: upper)
+            let ints = SIMD4<Int32>(v, rounding: .toNearestOrEven)
+            dst.storeBytes(of: SIMD4<Int16>(truncatingIfNeeded: ints), toByteOffset: i * 2, as: SIMD4<Int16>.self)
+            i += 4
+        }
+        while i < count {
+            var s = input[i] * 32767
+            if let dither {
+                s += dither.pointee.next()
+            }
+            s = min(max(s, -32768), 32767)
+            output[i] = Int16(s.rounded(.toNearestOrEven))
+            i += 1
+        }
+    }
+
+    /// Converts Int16 samples to Float32 in [-1, 1).
+    nonisolated static func convertInt16ToFloat(
+        _ input: UnsafePointer<Int16>,
+        into output: UnsafeMutablePointer<Float>,
+        count: Int
+    ) {
+        let src = UnsafeRawPointer(input)
+        let dst = UnsafeMutableRawPointer(output)
+        let scale = SIMD4<Float>(repeating: 1.0 / 32768.0)
+
+        var i = 0
+        while i + 4 <= count {
+            let ints = src.loadUnaligned(fromByteOffset: i * 2, as: SIMD4<Int16>.self)
+            let v = SIMD4<Float>(SIMD4<Int32>(truncatingIfNeeded: ints)) * scale
+            dst.storeBytes(of: v, toByteOffset: i * 4, as: SIMD4<Float>.self)
+            i += 4
+        }
+        while i < count {
+            output[i] = Float(input[i]) * (1.0 / 32768.0)
+            i += 1
+        }
+    }
+
+    // MARK: - Gain
+
+    /// Multiplies `count` samples by `gain` in place.
+    nonisolated static func applyGain(_ gain: Float, to samples: UnsafeMutablePointer<Float>, count: Int) {
+        guard gain != 1 else { return }
+        let raw = UnsafeMutableRawPointer(samples)
+        let g = SIMD8<Float>(repeating: gain)
+
+        var i = 0
+        while i + 8 <= count {
+            let v = raw.loadUnaligned(fromByteOffset: i * 4, as: SIMD8<Float>.self) * g
+            raw.storeBytes(of: v, toByteOffset: i * 4, as: SIMD8<Float>.self)
+            i += 8
+        }
+        while i < count {
+            samples[i] *= gain
+            i += 1
+        }
+    }
+}
+
+// MARK: - Dither
+
+/// Triangular (TPDF) dither source in units of one Int16 LSB.
+/// Uses xorshift32 so it is cheap and deterministic for a given seed.
+struct PCMDither {
+    private var state: UInt32
+
+    nonisolated init(seed: UInt32 = 0x9E37_79B9) {
+        state = seed == 0 ? 0x9E37_79B9 : seed
+    }
+
+    @inline(__always)
+    nonisolated private mutating func nextUniform() -> Float {
+        state ^= state << 13
+        state ^= state >> 17
+        state ^= state << 5
+        // 24 high-quality bits -> [0, 1)
+        return Float(state >> 8) * (1.0 / 16_777_216.0)
+    }
+
+    /// One TPDF sample in (-1, 1) LSB.
+    @inline(__always)
+    nonisolated mutating func next() -> Float {
+        nextUniform() - nextUniform()
+    }
+
+    @inline(__always)
+    nonisolated mutating func next4() -> SIMD4<Float> {
+        SIMD4(next(), next(), next(), next())
+    }
+}
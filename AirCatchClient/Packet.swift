@@ -0,0 +1,39 @@
+//
+//  Packet.swift
+//  AirCatchClient
+//
+//  Packet types and the packet value the transports exchange.
+//
+
+import Foundation
+
+nonisolated enum PacketType: UInt8 {
+    case videoFrame = 0x01
+    case touchEvent = 0x02
+    case handshake = 0x03
+    case handshakeAck = 0x04
+    case disconnect = 0x05
+    case scrollEvent = 0x06
+    case keyEvent = 0x07       // Keyboard input
+    case qualityReport = 0x08  // Client reports quality metrics
+    case ping = 0x09
+    case pong = 0x0A
+    case videoFrameChunk = 0x0C
+    case pairingFailed = 0x0D  // PIN mismatch
+    case videoFrameChunkNack = 0x0E // Client requests resend of missing chunks (lossless mode)
+    case audioPCM = 0x0F
+    case mediaKeyEvent = 0x10  // Media keys (volume, brightness, play/pause, etc.)
+    case inputBatch = 0x11     // Sequenced input events (UDP input lane, TCP for transitions)
+    case videoFrameChunkLayered = 0x12 // videoFrameChunk with a FrameLayerTag after the chunk header
+    case keyframeRequest = 0x13        // Client lost its reference chain and needs a keyframe
+    case sessionResume = 0x14          // Client rejoins a parked session with its resume ticket
+    case sessionResumeRejected = 0x15  // Ticket unknown or expired; client falls back to a full handshake
+    case streamStartupReport = 0x16    // Host's stream startup timing, sent once the first frame is encoded
+    case sessionKeys = 0x17           // Host's key share and wrapped session secret, answering a handshake's key share
+}
+
+/// One packet of the wire format; see `PacketFramer` for the TCP framing.
+nonisolated struct Packet {
+    let type: PacketType
+    let payload: Data
+}
@@ -0,0 +1,169 @@
+//
+//  RelayDatagramChannel.swift
+//  AirCatchClient
+//
+//  UDP leg of the remote relay (TURN-like), used when no direct path exists.
+//
+
+import Foundation
+import Network
+import os
+
+/// Sends and receives datagrams through a relayed UDP port allocated by the relay server.
+///
+/// The relay hands each peer a port and a token over the WebSocket (`allocation`
+/// message). The peer binds its address by sending `[0xAB][token]` to that port,
+/// repeated as a keepalive. The relay answers with `[0xAB][peerReady]`, and only
+/// forwards datagrams once both peers are bound. Datagrams use the same
+/// `[type][payload]` framing as the WebSocket relay.
+nonisolated final class RelayDatagramChannel {
+
+    struct Allocation: Codable {
+        /// Relay node that owns the ports; nil means the WebSocket's host
+        let host: String?
+        let port: UInt16
+        let token: String  // Hex
+    }
+
+    private static let bindMagic: UInt8 = 0xAB
+    private static let bindInterval: DispatchTimeInterval = .seconds(1)
+    /// Missing this many bind acks in a row marks the channel inactive
+    private static let maxMissedAcks = 3
+
+    private let queue = DispatchQueue(label: "com.aircatch.relaydatagram")
+    private let ready = OSAllocatedUnfairLock<NWConnection?>(initialState: nil)
+
+    // State below is only touched on `queue`
+    private var connection: NWConnection?
+    private var bindDatagram = Data()
+    private var timer: DispatchSourceTimer?
+    private var missedAcks = 0
+    private var onPacket: (@MainActor (Packet) -> Void)?
+
+    /// Whether both peers are bound and datagrams can flow.
+    var isActive: Bool {
+        ready.withLock { $0 != nil }
+    }
+
+    // MARK: - Lifecycle
+
+    /// Connects to the relayed port and starts binding.
+    func open(host: String, allocation: Allocation, onPacket: @MainActor @escaping (Packet) -> Void) {
+        guard let token = Self.decodeHex(allocation.token),
+              let port = NWEndpoint.Port(rawValue: allocation.port) else { return }
+
+        queue.async {
+            self.closeConnection()
+            self.onPacket = onPacket
+            self.bindDatagram = Data([Self.bindMagic]) + token
+
+            let connection = NWConnection(host: NWEndpoint.Host(host), port: port, using: .udp)
+            connection.start(queue: self.queue)
+            self.connection = connection
+            self.receive(on: connection)
+            self.startTimer()
+            AirCatchLog.info("Relay UDP: binding to \(host):\(allocation.port)", category: .network)
+        }
+    }
+
+    func close() {
+        queue.async {
+            self.closeConnection()
+        }
+    }
+
+    // MARK: - Sending
+
+    /// Sends a datagram through the relay.
+    /// - Returns: false when the channel isn't ready and the caller should use the WebSocket.
+    func send(type: PacketType, payload: Data) -> Bool {
+        guard let connection = ready.withLock({ $0 }) else { return false }
+        var datagram = Data()
+        datagram.reserveCapacity(1 + payload.count)
+        datagram.append(type.rawValue)
+        datagram.append(payload)
+        connection.send(content: datagram, completion: .idempotent)
+        return true
+    }
+
+    // MARK: - Receiving
+
+    private func receive(on connection: NWConnection) {
+        connection.receiveMessage { [weak self] data, _, _, error in
+            guard let self else { return }
+            if let data, !data.isEmpty, connection === self.connection {
+                self.handleDatagram(data, on: connection)
+            }
+            if error == nil, connection.state != .cancelled {
+                self.receive(on: connection)
+            }
+        }
+    }
+
+    private func handleDatagram(_ data: Data, on connection: NWConnection) {
+        let first = data[data.startIndex]
+        if first == Self.bindMagic {
+            guard data.count == 2 else { return }
+            missedAcks = 0
+            let peerReady = data[data.startIndex + 1] == 1
+            let wasReady = isActive
+            ready.withLock { $0 = peerReady ? connection : nil }
+            if peerReady != wasReady {
+                AirCatchLog.info("Relay UDP \(peerReady ? "ready" : "waiting for peer")", category: .network)
+            }
+            return
+        }
+
+        guard let type = PacketType(rawValue: first) else { return }
+        let packet = Packet(type: type, payload: Data(data.dropFirst()))
+        let onPacket = self.onPacket
+        Task { @MainActor in
+            onPacket?(packet)
+        }
+    }
+
+    // MARK: - Binding
+
+    private func startTimer() {
+        timer?.cancel()
+        missedAcks = 0
+        let source = DispatchSource.makeTimerSource(queue: queue)
+        source.schedule(deadline: .now(), repeating: Self.bindInterval)
+        source.setEventHandler { [weak self] in
+            self?.sendBind()
+        }
+        source.resume()
+        timer = source
+    }
+
+    private func sendBind() {
+        guard let connection else { return }
+        missedAcks += 1
+        if missedAcks > Self.maxMissedAcks, isActive {
+            ready.withLock { $0 = nil }
+            AirCatchLog.info("Relay UDP: no acks, falling back to WebSocket", category: .network)
+        }
+        connection.send(content: bindDatagram, completion: .idempotent)
+    }
+
+    private func closeConnection() {
+        timer?.cancel()
+        timer = nil
+        ready.withLock { $0 = nil }
+        connection?.cancel()
+        connection = nil
+    }
+
+    private static func decodeHex(_ hex: String) -> Data? {
+        guard hex.count % 2 == 0 else { return nil }
+        var data = Data(capacity: hex.count / 2)
+        var index = hex.startIndex
+        while index < hex.endIndex {
+            let next = hex.index(index, offsetBy: 2)
+            guard let byte = UInt8(hex[index..<next], radix: 16) else { return nil }
+            data.append(byte)
+            index = next
+        }
+        return data
+    }
+}
@@ -6,6 +6,7 @@
 //
 
 import Foundation
+import CryptoKit
 import Network
 
 final class RemoteTransport {
@@ -40,13 +41,23 @@ final class RemoteTransport {
     private var onTCPPacket: (@MainActor (Packet) -> Void)?
     private var onUDPPacket: (@MainActor (Packet) -> Void)?
     private var onStateChange: (@MainActor (State) -> Void)?
+    
+    // Direct UDP path to the host, when NAT traversal succeeds
+    private let directPath = DirectPath(isControlling: false)
+    // Relayed UDP port, used when the direct path fails
+    private let relayChannel = RelayDatagramChannel()
+    private var relayHost: String?
+    
+    /// Whether UDP-channel packets travel as datagrams (direct or relayed) instead of over the WebSocket.
+    var hasDatagramPath: Bool { directPath.isActive || relayChannel.isActive }
 
     func start(
         sessionId: String,
         relayURL: String = AirCatchConfig.remoteRelayURL,
         onTCPPacket: @MainActor @escaping (Packet) -> Void,
         onUDPPacket: @MainActor @escaping (Packet) -> Void,
-        onStateChange: @MainActor @escaping (State) -> Void
+        onStateChange: @MainActor @escaping (State) -> Void,
+        onDirectPathChange: (@MainActor (Bool) -> Void)? = nil
     ) {
         self.sessionId = sessionId
         self.onTCPPacket = onTCPPacket
@@ -71,13 +82,26 @@ final class RemoteTransport {
         config.timeoutIntervalForResource = 300
         config.waitsForConnectivity = true
         
+        relayHost = url.host
+
         let request = URLRequest(url: url)
         let task = URLSession(configuration: config).webSocketTask(with: request)
         webSocket = task
         task.resume()
 
         send(message: RemoteMessage(type: "register", sessionId: sessionId, role: .client, channel: nil, payload: nil))
-        sendLocalCandidate()
+        directPath.start(
+            sendSignal: { [weak self] payload in
+                guard let self else { return }
+                self.send(message: RemoteMessage(type: "candidate", sessionId: self.sessionId, role: nil, channel: nil, payload: payload))
+            },
+            onPacket: onUDPPacket,
+            onPathChange: onDirectPathChange
+        )
+        if AirCatchConfig.relayDatagramEnabled {
+            // Ask the relay for a UDP port pair; it pushes the host's leg to the host
+            send(message: RemoteMessage(type: "allocate", sessionId: sessionId, role: nil, channel: nil, payload: nil))
+        }
         receiveLoop()
 
         state = .ready
@@ -87,16 +111,26 @@ final class RemoteTransport {
     }
 
     func stop() {
+        directPath.stop()
+        relayChannel.close()
         webSocket?.cancel(with: .goingAway, reason: nil)
         webSocket = nil
         state = .idle
     }
 
+    /// Keys the direct path's checks to the negotiated session (nil when it ends).
+    func setDirectPathKey(_ key: SymmetricKey?) {
+        directPath.setKey(key)
+    }
+
     func sendTCP(type: PacketType, payload: Data) {
         sendPacket(channel: .tcp, type: type, payload: payload)
     }
 
     func sendUDP(type: PacketType, payload: Data) {
+        if directPath.send(type: type, payload: payload) || relayChannel.send(type: type, payload: payload) {
+            return
+        }
         sendPacket(channel: .udp, type: type, payload: payload)
     }
 
@@ -186,12 +220,15 @@ final class RemoteTransport {
         }
 
         if message.type == "candidate", let payload = message.payload {
-            AirCatchLog.info("Remote candidate received: \(payload)", category: .network)
+            directPath.handleSignal(payload)
+            return
         }
-    }
 
-    private func sendLocalCandidate() {
-         // Placeholder
+        if message.type == "allocation", let payload = message.payload,
+           let allocation = try? JSONDecoder().decode(RelayDatagramChannel.Allocation.self, from: Data(payload.utf8)),
+           let host = allocation.host ?? relayHost, let onUDPPacket {
+            relayChannel.open(host: host, allocation: allocation, onPacket: onUDPPacket)
+        }
     }
 
     private func buildDatagram(type: PacketType, payload: Data) -> Data {
@@ -0,0 +1,32 @@
+//
+//  SessionKeyShare.swift
+//  AirCatchClient
+//
+//  The host's answer to a client key share.
+//
+
+import Foundation
+
+/// Host's answer to `HandshakeRequest.keyShare`, sent as `.sessionKeys` before streaming starts.
+///
+/// `sealedSecret` is the session secret (shared by every viewer of the stream),
+/// sealed under a key derived from the X25519 agreement of both key shares, the
+/// PIN and `salt`. Traffic keys are derived from the secret and `salt`.
+/// `confirmation` proves the host holds the PIN and its half of the agreement;
+/// older hosts send none, and their answers are used without `peerId` and `hostEpoch`.
+nonisolated struct SessionKeyShare: Codable {
+    /// Host's ephemeral X25519 public key
+    let publicKey: Data
+    /// Random per session
+    let salt: Data
+    /// nonce + ciphertext + tag (AES-GCM)
+    let sealedSecret: Data
+    /// `AEADCipher` raw value for traffic; nil means AES-GCM
+    let cipher: String?
+    /// The viewer's client-to-host chain (`KeySchedule`); nil for older hosts
+    var peerId: UInt16? = nil
+    /// Host's sending epoch when the viewer joined, so a late joiner starts its receiving chain there
+    var hostEpoch: UInt32? = nil
+    /// HMAC over the fields above (`KeySchedule.confirmedFields`)
+    var confirmation: Data? = nil
+}
@@ -0,0 +1,22 @@
+//
+//  SessionResumeRequest.swift
+//  AirCatchClient
+//
+//  A client rejoining a parked session by ticket.
+//
+
+import Foundation
+
+/// Sent instead of a `HandshakeRequest` to rejoin a session the host parked after a drop.
+///
+/// The host keeps the stream (encoder, virtual display) running for
+/// `AirCatchConfig.sessionResumeGracePeriod`. A matching ticket gets the original
+/// `HandshakeAck` (with a fresh ticket) and an immediate keyframe; anything else
+/// gets `sessionResumeRejected`.
+nonisolated struct SessionResumeRequest: Codable {
+    let ticket: String
+    /// PIN in clear, from clients predating `pinProof`
+    var pin: String? = nil
+    /// `KeySchedule.pinProof` over the ticket
+    var pinProof: Data? = nil
+}
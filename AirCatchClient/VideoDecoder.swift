@@ -9,15 +9,19 @@ import Foundation
 import VideoToolbox
 import CoreMedia
 import CoreVideo
+import os
 
-/// Delegate protocol for decoded frame output.
+/// Delegate protocol for decoded frame output. Called on the main thread.
 protocol VideoDecoderDelegate: AnyObject {
     func decoder(_ decoder: VideoDecoder, didOutputPixelBuffer pixelBuffer: CVPixelBuffer, presentationTime: CMTime)
     func decoder(_ decoder: VideoDecoder, didEncounterError error: Error)
 }
 
 /// Hardware-accelerated HEVC (H.265) and H.264 decoder with Sidecar-level optimization.
-final class VideoDecoder {
+///
+/// Frames can be queued from any thread; decoding runs on the decoder's own queue
+/// and only presentation touches the main thread (see `handleDecodedFrame`).
+nonisolated final class VideoDecoder {
     weak var delegate: VideoDecoderDelegate?
     
     private var decompressionSession: VTDecompressionSession?
@@ -31,18 +35,45 @@ final class VideoDecoder {
     // HEVC parameter sets (VPS required for HEVC)
     private var vpsData: Data?
     
+    /// A parameter set changed after the format description was built (the host restarted
+    /// its encoder). Rebuilt at the next IDR; an unchanged stream, e.g. after a session
+    /// resume, keeps its cached parameter sets and decompression session.
+    private var parameterSetsChanged = false
+    
+    /// Frames before the next keyframe are skipped (queued frames were discarded)
+    private var awaitingKeyframe = false
+    /// Called on the decoder queue when the awaited keyframe arrives
+    private var onAwaitedKeyframe: (@Sendable () -> Void)?
+    
+    /// Newest decoded picture waiting for the main thread; a newer one replaces it
+    private let pendingPresentation = OSAllocatedUnfairLock<(pixelBuffer: CVPixelBuffer, presentationTime: CMTime)?>(initialState: nil)
+    /// Pictures replaced before the main thread got to them
+    private let supersededPictures = OSAllocatedUnfairLock(initialState: 0)
+    
     private let queue = DispatchQueue(label: "com.aircatch.universal_decoder", qos: .userInteractive)
     
     // MARK: - Public API
     
-    /// Decodes a compressed frame.
-    /// - Parameter frameData: Raw HEVC/H.264 data with 8-byte timestamp header
-    func decode(frameData: Data) {
+    /// Decodes a compressed frame. Any thread.
+    /// - Parameters:
+    ///   - frameData: Raw HEVC/H.264 data with 8-byte timestamp header
+    ///   - isCurrent: Checked on the decoder queue; false skips a frame that went stale while queued
+    func decode(frameData: Data, ifCurrent isCurrent: @escaping () -> Bool = { true }) {
         queue.async { [weak self] in
+            guard isCurrent() else { return }
             self?.processFrame(frameData)
         }
     }
     
+    /// Skips frames until the next keyframe; earlier frames of the stream were dropped.
+    /// - Parameter onKeyframe: Called from the decoder queue once that keyframe arrives.
+    func skipToKeyframe(onKeyframe: (@Sendable () -> Void)? = nil) {
+        queue.async { [weak self] in
+            self?.awaitingKeyframe = true
+            self?.onAwaitedKeyframe = onKeyframe
+        }
+    }
+    
     func reset() {
         queue.async { [weak self] in
             self?.invalidateSession()
@@ -50,13 +81,19 @@ final class VideoDecoder {
             self?.ppsData = nil
             self?.vpsData = nil
             self?.formatDescription = nil
+            self?.parameterSetsChanged = false
+            self?.awaitingKeyframe = false
+            self?.onAwaitedKeyframe = nil
             self?.detectedCodec = kCMVideoCodecType_H264
         }
+        pendingPresentation.withLock { $0 = nil }
     }
     
     // MARK: - Private Implementation
     
     private var frameCount = 0
+    /// Frames decoded but not presented because the host reported no changed tiles
+    private(set) var unchangedFrameCount = 0
     
     private func processFrame(_ frameData: Data) {
         frameCount += 1
@@ -69,7 +106,24 @@ final class VideoDecoder {
             #endif
             return
         }
-        let nalData = Data(frameData.dropFirst(8))
+        
+        // Optional dirty region: [Tag: 1][RegionLength: 2][Region]
+        var headerLength = 8
+        var present = true
+        if frameData[frameData.startIndex + 8] == FrameDirtyRegion.headerTag {
+            guard let region = parseDirtyRegion(frameData, headerLength: &headerLength) else {
+                #if DEBUG
+                AirCatchLog.debug(" Malformed dirty region header, dropping frame")
+                #endif
+                return
+            }
+            if region.isEmpty {
+                // Keepalive: still decode to keep reference state, but skip presenting
+                present = false
+                unchangedFrameCount += 1
+            }
+        }
+        let nalData = Data(frameData.dropFirst(headerLength))
         
         // Parse NAL units
         let nalUnits = parseNALUnits(from: nalData)
@@ -82,7 +136,22 @@ final class VideoDecoder {
         #endif
         
         for nalUnit in nalUnits {
-            processNALUnit(nalUnit)
+            processNALUnit(nalUnit, present: present)
+        }
+    }
+    
+    /// Reads the tagged dirty region following the timestamp and advances `headerLength` past it.
+    private func parseDirtyRegion(_ frameData: Data, headerLength: inout Int) -> FrameDirtyRegion? {
+        guard frameData.count >= headerLength + 3 else { return nil }
+        return frameData.withUnsafeBytes { raw -> FrameDirtyRegion? in
+            let length = Int(UInt16(bigEndian: raw.loadUnaligned(fromByteOffset: headerLength + 1, as: UInt16.self)))
+            let start = headerLength + 3
+            guard raw.count >= start + length else { return nil }
+            guard let region = FrameDirtyRegion(serialized: UnsafeRawBufferPointer(rebasing: raw[start..<(start + length)])) else {
+                return nil
+            }
+            headerLength = start + length
+            return region
         }
     }
     
@@ -123,7 +192,7 @@ final class VideoDecoder {
     }
     private var nalProcessCount = 0
     
-    private func processNALUnit(_ nalUnit: Data) {
+    private func processNALUnit(_ nalUnit: Data, present: Bool = true) {
         guard !nalUnit.isEmpty else { return }
         
         let firstByte = nalUnit[0]
@@ -153,28 +222,34 @@ final class VideoDecoder {
             
             switch nalType {
             case 32: // VPS
-                vpsData = nalUnit
                 detectedCodec = kCMVideoCodecType_HEVC
-                tryCreateFormatDescription()
+                if vpsData != nalUnit {
+                    vpsData = nalUnit
+                    parameterSetDidChange()
+                }
                 
             case 33: // SPS
-                spsData = nalUnit
                 detectedCodec = kCMVideoCodecType_HEVC
-                tryCreateFormatDescription()
+                if spsData != nalUnit {
+                    spsData = nalUnit
+                    parameterSetDidChange()
+                }
                 
             case 34: // PPS
-                ppsData = nalUnit
                 detectedCodec = kCMVideoCodecType_HEVC
-                tryCreateFormatDescription()
+                if ppsData != nalUnit {
+                    ppsData = nalUnit
+                    parameterSetDidChange()
+                }
                 
             case 19, 20: // IDR slices (IDR_W_RADL, IDR_N_LP)
-                decodeVideoFrame(nalUnit, isIDR: true)
+                decodeVideoFrame(nalUnit, isIDR: true, present: present)
                 
             case 0...9: // Non-IDR slices (TRAIL_N, TRAIL_R, etc.)
-                decodeVideoFrame(nalUnit, isIDR: false)
+                decodeVideoFrame(nalUnit, isIDR: false, present: present)
                 
             case 16...21: // Other keyframe types (BLA, CRA, etc.)
-                decodeVideoFrame(nalUnit, isIDR: true)
+                decodeVideoFrame(nalUnit, isIDR: true, present: present)
                 
             default:
                 #if DEBUG
@@ -190,20 +265,24 @@ final class VideoDecoder {
             
             switch nalType {
             case 7: // SPS
-                spsData = nalUnit
                 detectedCodec = kCMVideoCodecType_H264
-                tryCreateFormatDescription()
+                if spsData != nalUnit {
+                    spsData = nalUnit
+                    parameterSetDidChange()
+                }
                 
             case 8: // PPS
-                ppsData = nalUnit
                 detectedCodec = kCMVideoCodecType_H264
-                tryCreateFormatDescription()
+                if ppsData != nalUnit {
+                    ppsData = nalUnit
+                    parameterSetDidChange()
+                }
                 
             case 5: // IDR slice
-                decodeVideoFrame(nalUnit, isIDR: true)
+                decodeVideoFrame(nalUnit, isIDR: true, present: present)
                 
             case 1: // Non-IDR slice
-                decodeVideoFrame(nalUnit, isIDR: false)
+                decodeVideoFrame(nalUnit, isIDR: false, present: present)
                 
             default:
                 break
@@ -211,6 +290,14 @@ final class VideoDecoder {
         }
     }
     
+    private func parameterSetDidChange() {
+        if formatDescription != nil {
+            parameterSetsChanged = true
+        } else {
+            tryCreateFormatDescription()
+        }
+    }
+    
     private func tryCreateFormatDescription() {
         guard let sps = spsData, let pps = ppsData else { return }
         guard formatDescription == nil else { return }
@@ -313,7 +400,7 @@ final class VideoDecoder {
         ]
         
         var outputCallback = VTDecompressionOutputCallbackRecord(
-            decompressionOutputCallback: { decompressionOutputRefCon, _, status, infoFlags, imageBuffer, presentationTimeStamp, _ in
+            decompressionOutputCallback: { decompressionOutputRefCon, sourceFrameRefCon, status, infoFlags, imageBuffer, presentationTimeStamp, _ in
                 let decoder = Unmanaged<VideoDecoder>.fromOpaque(decompressionOutputRefCon!).takeUnretainedValue()
                 
                 if status != noErr {
@@ -336,7 +423,7 @@ final class VideoDecoder {
                     return
                 }
                 
-                decoder.handleDecodedFrame(imageBuffer, presentationTime: presentationTimeStamp)
+                decoder.handleDecodedFrame(imageBuffer, presentationTime: presentationTimeStamp, present: sourceFrameRefCon == nil)
             },
             decompressionOutputRefCon: Unmanaged.passUnretained(self).toOpaque()
         )
@@ -378,7 +465,20 @@ final class VideoDecoder {
         }
     }
     
-    private func decodeVideoFrame(_ nalUnit: Data, isIDR: Bool) {
+    private func decodeVideoFrame(_ nalUnit: Data, isIDR: Bool, present: Bool = true) {
+        if awaitingKeyframe {
+            guard isIDR else { return }
+            awaitingKeyframe = false
+            onAwaitedKeyframe?()
+            onAwaitedKeyframe = nil
+        }
+        if isIDR && parameterSetsChanged {
+            parameterSetsChanged = false
+            invalidateSession()
+            formatDescription = nil
+            tryCreateFormatDescription()
+        }
+        
         guard let session = decompressionSession,
               let formatDesc = formatDescription else {
             return
@@ -451,7 +551,7 @@ final class VideoDecoder {
             session,
             sampleBuffer: sample,
             flags: decodeFlags,
-            frameRefcon: nil,
+            frameRefcon: present ? nil : UnsafeMutableRawPointer(bitPattern: 1),  // Non-nil marks "don't present"
             infoFlagsOut: &flagsOut
         )
         
@@ -481,18 +581,42 @@ final class VideoDecoder {
     private var consecutiveErrors = 0
     private let maxConsecutiveErrors = 10
     
-    private func handleDecodedFrame(_ pixelBuffer: CVPixelBuffer, presentationTime: CMTime) {
+    private func handleDecodedFrame(_ pixelBuffer: CVPixelBuffer, presentationTime: CMTime, present: Bool = true) {
         decodedCount += 1
         consecutiveErrors = 0  // Reset error counter on successful decode
+        // Unchanged frame: the picture on screen is already current
+        guard present else { return }
         #if DEBUG
         // Only log first decoded frame
         if decodedCount == 1 {
             AirCatchLog.debug("First decoded frame: \(CVPixelBufferGetWidth(pixelBuffer))x\(CVPixelBufferGetHeight(pixelBuffer))", category: .video)
         }
         #endif
+        // Latest picture wins: one main-thread hop in flight, carrying whatever is newest when it runs
+        let hopPending = pendingPresentation.withLock { pending -> Bool in
+            defer { pending = (pixelBuffer, presentationTime) }
+            return pending != nil
+        }
+        if hopPending {
+            let superseded = supersededPictures.withLock { count -> Int in
+                count += 1
+                return count
+            }
+            #if DEBUG
+            if superseded % 60 == 1 {
+                AirCatchLog.debug("\(superseded) decoded pictures replaced before the main thread showed them", category: .video)
+            }
+            #endif
+            return
+        }
         DispatchQueue.main.async { [weak self] in
-            guard let self else { return }
-            self.delegate?.decoder(self, didOutputPixelBuffer: pixelBuffer, presentationTime: presentationTime)
+            guard let self, let picture = self.pendingPresentation.withLock({ pending in
+                defer { pending = nil }
+                return pending
+            }) else { return }
+            MainActor.assumeIsolated {
+                self.delegate?.decoder(self, didOutputPixelBuffer: picture.pixelBuffer, presentationTime: picture.presentationTime)
+            }
         }
     }
     
@@ -0,0 +1,198 @@
+//
+//  VideoFrameHandoff.swift
+//  AirCatchClient
+//
+//  Hands complete frames from the network/reassembly queues to the decoder without the main thread.
+//
+
+import Foundation
+import os
+
+/// Bounded queue between frame reassembly and the decoder.
+///
+/// Frames go straight onto the decoder's queue from whichever thread completed
+/// them. A burst (frames held up by a Wi-Fi stall, arriving at once) is kept
+/// whole: the decoder works through it in a few milliseconds, and every frame in
+/// it references the one before. Only when more than
+/// `AirCatchConfig.maxQueuedDecodeFrames` have been waiting for
+/// `AirCatchConfig.decoderBehindThreshold`, or the backlog reaches
+/// `AirCatchConfig.maxBurstDecodeFrames`, is the decoder really behind; then the
+/// waiting frames are discarded (each checks its generation before decoding),
+/// the decoder skips ahead to the next keyframe, and one is requested from the
+/// host, again every `AirCatchConfig.keyframeRetryInterval` until it arrives.
+nonisolated final class VideoFrameHandoff {
+
+    private struct State {
+        weak var decoder: VideoDecoder?
+        /// Frames on the decoder's queue that haven't started decoding
+        var queued = 0
+        /// Bumped when the backlog is discarded; older frames skip decoding
+        var generation = 0
+        var discardedFrames = 0
+        /// When the backlog first exceeded `maxQueuedDecodeFrames`; nil once it drains
+        var behindSince: TimeInterval?
+        /// Last keyframe request while the decoder waits for one; nil once it arrived
+        var keyframeRequestedAt: TimeInterval?
+    }
+
+    private let state = OSAllocatedUnfairLock(initialState: State())
+    private let stallMonitor = MainThreadStallMonitor()
+    private let onKeyframeNeeded: @Sendable () -> Void
+
+    /// - Parameter onKeyframeNeeded: Called from the delivering thread after a backlog was
+    ///   discarded, and again while the keyframe is overdue.
+    init(onKeyframeNeeded: @escaping @Sendable () -> Void) {
+        self.onKeyframeNeeded = onKeyframeNeeded
+    }
+
+    /// Routes frames to `decoder` (nil detaches; frames are dropped until one attaches).
+    func attach(_ decoder: VideoDecoder?) {
+        state.withLock { state in
+            state.decoder = decoder
+            state.queued = 0
+            state.generation += 1
+            state.behindSince = nil
+            state.keyframeRequestedAt = nil
+        }
+        if decoder != nil {
+            stallMonitor.start()
+        } else {
+            stallMonitor.stop()
+        }
+    }
+
+    /// Queues a complete frame (8-byte timestamp header + Annex B) for decoding. Any thread.
+    func deliver(_ frame: Data) {
+        let now = ProcessInfo.processInfo.systemUptime
+        let admission = state.withLock { state -> (decoder: VideoDecoder, generation: Int, discarded: Bool, requestKeyframe: Bool)? in
+            guard let decoder = state.decoder else { return nil }
+            var discarded = false
+            var requestKeyframe = false
+            if state.queued >= AirCatchConfig.maxQueuedDecodeFrames {
+                let behindSince = state.behindSince ?? now
+                state.behindSince = behindSince
+                if now - behindSince >= AirCatchConfig.decoderBehindThreshold
+                    || state.queued >= AirCatchConfig.maxBurstDecodeFrames {
+                    state.discardedFrames += state.queued
+                    state.generation += 1
+                    state.queued = 0
+                    state.behindSince = nil
+                    state.keyframeRequestedAt = now
+                    discarded = true
+                    requestKeyframe = true
+                }
+            }
+            // The request may be deferred or lost across a reconnect; ask until the keyframe shows up
+            if !discarded, let requestedAt = state.keyframeRequestedAt,
+               now - requestedAt >= AirCatchConfig.keyframeRetryInterval {
+                state.keyframeRequestedAt = now
+                requestKeyframe = true
+            }
+            state.queued += 1
+            return (decoder, state.generation, discarded, requestKeyframe)
+        }
+        guard let admission else { return }
+
+        let state = self.state
+        let generation = admission.generation
+        if admission.discarded {
+            admission.decoder.skipToKeyframe {
+                state.withLock { state in
+                    guard state.generation == generation else { return }
+                    state.keyframeRequestedAt = nil
+                }
+            }
+            #if DEBUG
+            let discarded = state.withLock { $0.discardedFrames }
+            AirCatchLog.debug("Decoder backlog discarded (\(discarded) frames so far)", category: .video)
+            #endif
+        }
+        if admission.requestKeyframe {
+            onKeyframeNeeded()
+        }
+
+        admission.decoder.decode(frameData: frame) {
+            state.withLock { state in
+                guard state.generation == generation else { return false }
+                state.queued -= 1
+                if state.queued < AirCatchConfig.maxQueuedDecodeFrames {
+                    state.behindSince = nil
+                }
+                return true
+            }
+        }
+    }
+}
+
+// MARK: - Main Thread Stall Monitor
+
+/// Measures how late the main thread picks up work while video is attached.
+///
+/// Frames no longer wait on the main thread, but presentation still does; a stall
+/// shows up as pictures replaced before they were shown. Stalls of
+/// `AirCatchConfig.mainThreadStallThreshold` or longer are counted and logged.
+nonisolated final class MainThreadStallMonitor {
+
+    private static let probeInterval: DispatchTimeInterval = .milliseconds(50)
+
+    private let queue = DispatchQueue(label: "com.aircatch.stallmonitor", qos: .utility)
+    private let stats = OSAllocatedUnfairLock(initialState: (probeInFlight: false, stalls: 0, longest: TimeInterval(0)))
+
+    // Only touched on `queue`
+    private var timer: DispatchSourceTimer?
+
+    func start() {
+        queue.async {
+            guard self.timer == nil else { return }
+            let source = DispatchSource.makeTimerSource(queue: self.queue)
+            source.schedule(deadline: .now() + Self.probeInterval, repeating: Self.probeInterval)
+            source.setEventHandler { [weak self] in
+                self?.probe()
+            }
+            source.resume()
+            self.timer = source
+        }
+    }
+
+    func stop() {
+        queue.async {
+            self.timer?.cancel()
+            self.timer = nil
+            let summary = self.stats.withLock { stats -> (Int, TimeInterval) in
+                defer { stats = (false, 0, 0) }
+                return (stats.stalls, stats.longest)
+            }
+            if summary.0 > 0 {
+                AirCatchLog.info("Main thread stalled \(summary.0)x while streaming, longest \(Int(summary.1 * 1000)) ms", category: .video)
+            }
+        }
+    }
+
+    private func probe() {
+        let alreadyWaiting = stats.withLock { stats -> Bool in
+            defer { stats.probeInFlight = true }
+            return stats.probeInFlight
+        }
+        // A probe still waiting is itself a stall in progress; it is measured when it lands
+        guard !alreadyWaiting else { return }
+
+        let sentAt = ProcessInfo.processInfo.systemUptime
+        let stats = self.stats
+        DispatchQueue.main.async {
+            let lag = ProcessInfo.processInfo.systemUptime - sentAt
+            let isStall = lag >= AirCatchConfig.mainThreadStallThreshold
+            stats.withLock { stats in
+                stats.probeInFlight = false
+                if isStall {
+                    stats.stalls += 1
+                    stats.longest = max(stats.longest, lag)
+                }
+            }
+            #if DEBUG
+            if isStall {
+                AirCatchLog.debug("Main thread stall: \(Int(lag * 1000)) ms", category: .video)
+            }
+            #endif
+        }
+    }
+}
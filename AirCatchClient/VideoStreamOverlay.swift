@@ -99,14 +99,27 @@ struct VideoStreamOverlay: View {
                     }
                     
                 } else {
-                    ProgressView()
-                        .progressViewStyle(CircularProgressViewStyle(tint: .white))
-                        .scaleEffect(1.5)
+                    VStack(spacing: 24) {
+                        ProgressView()
+                            .progressViewStyle(CircularProgressViewStyle(tint: .white))
+                            .scaleEffect(1.5)
+                        
+                        // Startup breakdown so far (path, resolve/connect/handshake times)
+                        if let timeline = clientManager.startupTimeline {
+                            Text(timeline.summary)
+                                .font(.caption.monospacedDigit())
+                                .foregroundStyle(.white.opacity(0.6))
+                        }
+                    }
                 }
             }
         }
-        .onReceive(clientManager.videoFrameSubject) { data in
-            viewModel.decode(frameData: data)
+        .onAppear {
+            // Frames go from reassembly straight to the decoder; this view only presents
+            clientManager.videoFrames.attach(viewModel.decoder)
+        }
+        .onDisappear {
+            clientManager.videoFrames.attach(nil)
         }
         .onChange(of: clientManager.state) { _, newState in
             if case .disconnected = newState {
@@ -157,17 +170,13 @@ struct VideoStreamOverlay: View {
 final class VideoStreamViewModel: NSObject, ObservableObject {
     @Published var pixelBuffer: CVPixelBuffer?
     var lastTouchLocation: CGPoint?
-    private let decoder = VideoDecoder()
+    let decoder = VideoDecoder()
     
     override init() {
         super.init()
         decoder.delegate = self
     }
     
-    func decode(frameData: Data) {
-        decoder.decode(frameData: frameData)
-    }
-    
     func reset() {
         decoder.reset()
         Task { @MainActor in
@@ -189,10 +198,8 @@ extension VideoStreamViewModel: VideoDecoderDelegate {
             AirCatchLog.info("Streaming started: \(width)x\(height)", category: .video)
         }
         
-        // Display frame immediately for lowest latency
-        DispatchQueue.main.async {
-            self.pixelBuffer = pixelBuffer
-        }
+        // Already on the main thread, and already the newest picture
+        self.pixelBuffer = pixelBuffer
     }
 
     
@@ -0,0 +1,73 @@
+//
+//  AEADBackend.swift
+//  AirCatchHost
+//
+//  Interchangeable AEAD ciphers for traffic sealing.
+//
+
+import Foundation
+#if canImport(CryptoKit)
+import CryptoKit
+#else
+import Crypto
+#endif
+
+/// AEAD ciphers traffic can be sealed with, negotiated per session.
+/// Each has a 12-byte nonce and a 16-byte tag, so the wire layout doesn't change.
+nonisolated enum AEADCipher: String, Codable, CaseIterable {
+    case aes256GCM
+    case chaCha20Poly1305
+}
+
+/// One AEAD construction. Every backend uses a 12-byte nonce and a 16-byte tag,
+/// so sealed boxes keep the nonce + ciphertext + tag layout whatever the cipher.
+nonisolated protocol AEADBackend {
+    static var cipher: AEADCipher { get }
+
+    static func seal<Plaintext: DataProtocol>(
+        _ plaintext: Plaintext,
+        using key: SymmetricKey,
+        nonce: AES.GCM.Nonce,
+        authenticating aad: Data
+    ) throws -> (ciphertext: Data, tag: Data)
+
+    /// Opens a combined box (nonce + ciphertext + tag).
+    static func open(_ combined: Data, using key: SymmetricKey, authenticating aad: Data) throws -> Data
+}
+
+nonisolated enum AESGCMBackend: AEADBackend {
+    static let cipher = AEADCipher.aes256GCM
+
+    static func seal<Plaintext: DataProtocol>(_ plaintext: Plaintext, using key: SymmetricKey, nonce: AES.GCM.Nonce, authenticating aad: Data) throws -> (ciphertext: Data, tag: Data) {
+        let box = try AES.GCM.seal(plaintext, using: key, nonce: nonce, authenticating: aad)
+        return (box.ciphertext, box.tag)
+    }
+
+    static func open(_ combined: Data, using key: SymmetricKey, authenticating aad: Data) throws -> Data {
+        try AES.GCM.open(AES.GCM.SealedBox(combined: combined), using: key, authenticating: aad)
+    }
+}
+
+nonisolated enum ChaChaPolyBackend: AEADBackend {
+    static let cipher = AEADCipher.chaCha20Poly1305
+
+    static func seal<Plaintext: DataProtocol>(_ plaintext: Plaintext, using key: SymmetricKey, nonce: AES.GCM.Nonce, authenticating aad: Data) throws -> (ciphertext: Data, tag: Data) {
+        // Nonce sequences produce 12 raw bytes; only the type differs
+        let chachaNonce = try nonce.withUnsafeBytes { try ChaChaPoly.Nonce(data: $0) }
+        let box = try ChaChaPoly.seal(plaintext, using: key, nonce: chachaNonce, authenticating: aad)
+        return (box.ciphertext, box.tag)
+    }
+
+    static func open(_ combined: Data, using key: SymmetricKey, authenticating aad: Data) throws -> Data {
+        try ChaChaPoly.open(ChaChaPoly.SealedBox(combined: combined), using: key, authenticating: aad)
+    }
+}
+
+extension AEADCipher {
+    nonisolated var backend: AEADBackend.Type {
+        switch self {
+        case .aes256GCM: return AESGCMBackend.self
+        case .chaCha20Poly1305: return ChaChaPolyBackend.self
+        }
+    }
+}
@@ -0,0 +1,79 @@
+//
+//  AirCatchConfig.swift
+//  AirCatchHost
+//
+//  Tunables shared across the host app.
+//
+
+import Foundation
+
+enum AirCatchConfig {
+    nonisolated static let udpPort: UInt16 = 5555
+    nonisolated static let tcpPort: UInt16 = 5556
+    nonisolated static let bonjourServiceType = "_aircatch._udp."
+    nonisolated static let bonjourTCPServiceType = "_aircatch._tcp."
+
+    // Remote (Internet) relay/signaling
+    nonisolated static let remoteRelayURL: String = "wss://aircatch.duckdns.org/ws"
+    
+    // Remote direct path (UDP hole punching, relay stays as fallback)
+    nonisolated static let directPathEnabled = true
+    nonisolated static let directPathCheckTimeout: TimeInterval = 5.0  // Stop punching after this
+    nonisolated static let directPathIdleTimeout: TimeInterval = 3.0   // Fall back to relay after this much silence
+    nonisolated static let relayDatagramEnabled = true                  // Relayed UDP port pair when direct fails
+    
+    // Port aliases for clarity
+    nonisolated static let defaultUDPPort: UInt16 = 5555
+    nonisolated static let defaultTCPPort: UInt16 = 5556
+    
+    // Network constants
+    static let maxUDPPayloadSize: Int = 1200  // Safe UDP payload size (below MTU)
+    nonisolated static let maxTCPPayloadSize: Int = 32 * 1024 * 1024  // Larger TCP length fields are treated as corrupt
+    nonisolated static let rekeyInterval: UInt64 = 1 << 20              // Packets sealed per key before the sender ratchets
+    
+    // Frame encryption (segments are sealed in parallel above the threshold)
+    nonisolated static let parallelSealThreshold: Int = 256 * 1024
+    nonisolated static let sealSegmentSize: Int = 128 * 1024
+    
+    // Streaming defaults (optimized for HEVC on Apple Silicon)
+    static let defaultBitrate: Int = 16_000_000  // 16 Mbps - HEVC sweet spot
+    static let defaultFrameRate: Int = 60        // General default
+    static let maxTouchEventsPerSecond: Int = 60
+    static let reconnectMaxAttempts = 5
+    static let reconnectBaseDelay: TimeInterval = 1.0
+    static let sessionResumeGracePeriod: TimeInterval = 10.0  // Host keeps a dropped session's stream this long
+    static let virtualDisplayReadyTimeout: TimeInterval = 2.0 // Stream starts anyway if the display never reports online
+
+    // Remote Mode Specifics
+    static let remoteFrameRate: Int = 30
+    static let remoteBitrate: Int = 6_000_000     // 6 Mbps (target range: 4-10)
+    static let remoteMinBitrate: Int = 4_000_000  // Floor for adaptive
+    static let remoteMaxBitrate: Int = 10_000_000 // Ceiling for adaptive
+    static let remoteMinFPS: Int = 20             // Floor when congested
+    static let remoteMaxFPS: Int = 30             // Target FPS
+    static let remoteGOPDuration: Double = 0.5    // Short GOP (0.5s) for faster recovery
+
+    
+    // Resolution limits
+    static let maxRenderPixels: Double = 8_000_000  // ~8MP cap for render resolution
+    
+    // Frame cache settings
+    nonisolated static let frameCacheTTL: TimeInterval = 1.0  // Seconds before cached frames expire
+    nonisolated static let frameCacheLimit: Int = 240         // Most frames cached for retransmits (2 s at 120 fps)
+    
+    // Per-viewer video fan-out (host, local UDP)
+    nonisolated static let fanoutMaxPacingRate: Int = 200_000_000  // bits/s, starting estimate for a new viewer
+    nonisolated static let fanoutMinPacingRate: Int = 2_000_000    // bits/s floor when congested
+    nonisolated static let fanoutMaxQueueDelay: TimeInterval = 0.1 // Backlog beyond this thins or drops frames
+    
+    // Static content detection
+    nonisolated static let staticFrameRefreshInterval: TimeInterval = 1.0  // Keepalive encode while screen is unchanged
+    
+    // Temporal layers: base layer at this fraction of the frame rate, the rest droppable (HEVC)
+    nonisolated static let temporalLayersEnabled = true
+    nonisolated static let baseLayerFrameRateFraction: Double = 0.5
+    nonisolated static let keyframeRequestMinInterval: TimeInterval = 0.25  // Spacing of forced keyframes
+    
+    // Input scheduling
+    static let inputPredictionHorizon: TimeInterval = 0  // Pointer extrapolation (seconds), 0 = off
+}
@@ -0,0 +1,53 @@
+//
+//  AirCatchLog.swift
+//  AirCatchHost
+//
+//  Unified logging categories for the host app.
+//
+
+import Foundation
+#if canImport(os)
+import os
+#endif
+
+/// Writes through os_log, or to standard error where os is unavailable (the Linux test package).
+enum AirCatchLog {
+    enum Category: String {
+        case network = "Network"
+        case video = "Video"
+        case input = "Input"
+        case general = "General"
+    }
+    
+    nonisolated private static let subsystem = "com.aircatch.host"
+    
+    nonisolated static func info(_ message: String, category: Category = .general) {
+        #if canImport(os)
+        os_log(.info, log: OSLog(subsystem: subsystem, category: category.rawValue), "%{public}@", message)
+        #else
+        write("info", message, category: category)
+        #endif
+    }
+    
+    nonisolated static func error(_ message: String, category: Category = .general) {
+        #if canImport(os)
+        os_log(.error, log: OSLog(subsystem: subsystem, category: category.rawValue), "%{public}@", message)
+        #else
+        write("error", message, category: category)
+        #endif
+    }
+    
+    nonisolated static func debug(_ message: String, category: Category = .general) {
+        #if canImport(os)
+        os_log(.debug, log: OSLog(subsystem: subsystem, category: category.rawValue), "%{public}@", message)
+        #else
+        write("debug", message, category: category)
+        #endif
+    }
+    
+    #if !canImport(os)
+    nonisolated private static func write(_ level: String, _ message: String, category: Category) {
+        FileHandle.standardError.write(Data("[\(subsystem)] \(level) \(category.rawValue): \(message)\n".utf8))
+    }
+    #endif
+}
@@ -2,24 +2,48 @@
 //  CryptoManager.swift
 //  AirCatchHost
 //
-//  End-to-end encryption using PIN-derived AES-256-GCM.
+//  End-to-end encryption with negotiated AEAD session keys (X25519 + PIN).
 //
 
 import Foundation
 import CryptoKit
+import os
 
-/// Provides end-to-end encryption using AES-256-GCM with PIN-derived key.
-/// This ensures neither network sniffers nor the relay server can read data.
-final class CryptoManager {
-    private var key: SymmetricKey?
+/// Provides end-to-end encryption using AES-256-GCM or ChaCha20-Poly1305.
+/// Network observers can't read traffic. The relay can't either while it only forwards,
+/// but it learns the PIN (the session ID), so it could intercept pairing.
+///
+/// Until a client sends a key share, traffic uses the PIN-derived key. The first
+/// key share starts a session: a random secret and salt, handed to every viewer
+/// sealed under its own X25519 agreement mixed with the PIN. Traffic keys then
+/// come from `KeySchedule` (one ratcheting chain per direction) until the
+/// session ends with the stream.
+///
+/// Video and audio seal on their own queues while input opens on the network
+/// queue, so the keys are behind a lock. Each seal takes its nonces under the
+/// lock and runs the cipher outside it.
+nonisolated final class CryptoManager {
+    /// Bytes sealing adds in front of and behind the ciphertext: nonce (12) + tag (16)
+    static let sealOverhead = FrameSealer.overhead
+
+    private struct State {
+        var schedule: KeySchedule?
+        /// Secret, salt and cipher of the running session; nil while on the PIN key
+        var session: (secret: SymmetricKey, salt: Data, cipher: AEADCipher)?
+        var pin = ""
+        /// Peer ID for the next viewer to join the session
+        var nextPeer: UInt16 = 1
+    }
+
+    private let state = OSAllocatedUnfairLock(initialState: State())
     private static let salt = "AirCatch-E2EE-v1".data(using: .utf8)!
     private static let info = "AirCatch-Session".data(using: .utf8)!
     
     /// Derives a 256-bit AES key from the PIN using HKDF.
-    /// Call this when PIN is generated (host) or entered (client).
+    /// Call this when PIN is generated (host) or entered (client). Ends any session.
     func deriveKey(from pin: String) {
         guard !pin.isEmpty else {
-            key = nil
+            state.withLock { $0 = State() }
             return
         }
         
@@ -28,12 +52,13 @@ final class CryptoManager {
         // Use HKDF to derive a strong key from the short PIN
         // Salt ensures different apps with same PIN get different keys
         // Info adds context to the derivation
-        key = HKDF<SHA256>.deriveKey(
+        let key = HKDF<SHA256>.deriveKey(
             inputKeyMaterial: SymmetricKey(data: pinData),
             salt: Self.salt,
             info: Self.info,
             outputByteCount: 32  // 256 bits for AES-256
         )
+        state.withLock { $0 = State(schedule: KeySchedule(staticKey: key, role: .host), pin: pin) }
         
         #if DEBUG
         AirCatchLog.info("E2EE: Key derived from PIN", category: .network)
@@ -42,27 +67,141 @@ final class CryptoManager {
     
     /// Clears the encryption key (call on disconnect).
     func clearKey() {
-        key = nil
+        state.withLock { state in
+            state.schedule = nil
+            state.session = nil
+        }
+    }
+    
+    // MARK: - Key Exchange
+    
+    /// Answers a client's X25519 key share, starting a session if none is running.
+    /// Later viewers join the running session, since they all receive the same stream,
+    /// each with its own peer ID and client-to-host chain.
+    /// A new session seals with the cipher fastest on this Mac among `supportedCiphers`
+    /// (AES-GCM for clients that list none).
+    /// - Returns: The `.sessionKeys` payload, or nil for an invalid share, no common cipher
+    ///   or no peer ID left.
+    func acceptKeyShare(_ clientShare: Data, supportedCiphers: [String]?) -> SessionKeyShare? {
+        let (pin, session) = state.withLock { ($0.pin, $0.session) }
+        guard !pin.isEmpty,
+              let clientKey = try? Curve25519.KeyAgreement.PublicKey(rawRepresentation: clientShare) else { return nil }
+        
+        let offered = supportedCiphers?.compactMap(AEADCipher.init(rawValue:)) ?? [.aes256GCM]
+        guard let cipher = session.map({ $0.cipher }) ?? CipherBenchmark.ranking.first(where: { offered.contains($0) }) else { return nil }
+        guard offered.contains(cipher) else {
+            AirCatchLog.error("E2EE: Client can't open the session's \(cipher.rawValue)", category: .network)
+            return nil
+        }
+        
+        let current = session ?? (secret: SymmetricKey(size: .bits256), salt: SymmetricKey(size: .bits256).withUnsafeBytes { Data($0) }, cipher: cipher)
+        let ephemeral = Curve25519.KeyAgreement.PrivateKey()
+        let hostShare = ephemeral.publicKey.rawRepresentation
+        
+        do {
+            let agreement = try ephemeral.sharedSecretFromKeyAgreement(with: clientKey)
+            let wrappingKey = KeySchedule.wrappingKey(agreement: agreement, pin: pin, salt: current.salt, clientShare: clientShare, hostShare: hostShare)
+            let secret = current.secret.withUnsafeBytes { Data($0) }
+            guard let sealedSecret = try AES.GCM.seal(secret, using: wrappingKey).combined else { return nil }
+            
+            let joined = state.withLock { state -> (peer: UInt16, hostEpoch: UInt32)? in
+                guard state.pin == pin, state.session.map({ $0.salt == current.salt }) ?? true,
+                      state.nextPeer <= KeySchedule.maxPeerId else { return nil }
+                if state.session == nil {
+                    state.session = current
+                    state.schedule = KeySchedule(secret: current.secret, salt: current.salt, role: .host, cipher: cipher,
+                                                 rekeyInterval: AirCatchConfig.rekeyInterval)
+                }
+                let peer = state.nextPeer
+                state.nextPeer += 1
+                state.schedule?.addPeer(peer)
+                return (peer, state.schedule?.sendEpoch ?? 0)
+            }
+            guard let joined else {
+                // Two viewers' first key shares can race; the session the first one started wins
+                let raced = session == nil && state.withLock { $0.pin == pin && $0.session != nil }
+                return raced ? acceptKeyShare(clientShare, supportedCiphers: supportedCiphers) : nil
+            }
+            if session == nil {
+                AirCatchLog.info("E2EE: Session keys established (\(cipher.rawValue))", category: .network)
+            }
+            
+            var answer = SessionKeyShare(publicKey: hostShare, salt: current.salt, sealedSecret: sealedSecret, cipher: cipher.rawValue)
+            answer.peerId = joined.peer
+            answer.hostEpoch = joined.hostEpoch
+            let confirmationKey = KeySchedule.confirmationKey(agreement: agreement, pin: pin, salt: current.salt, clientShare: clientShare, hostShare: hostShare)
+            answer.confirmation = Data(HMAC<SHA256>.authenticationCode(for: KeySchedule.confirmedFields(of: answer), using: confirmationKey))
+            return answer
+        } catch {
+            #if DEBUG
+            AirCatchLog.error("E2EE: Key exchange failed - \(error)", category: .network)
+            #endif
+            return nil
+        }
+    }
+    
+    /// Returns to the PIN key once nobody watches the session's stream anymore.
+    func endSession() {
+        guard let pin = state.withLock({ $0.session == nil ? nil : $0.pin }) else { return }
+        deriveKey(from: pin)
     }
     
     /// Returns true if encryption is ready.
     var isReady: Bool {
-        key != nil
+        state.withLock { $0.schedule != nil }
     }
     
-    /// Encrypts plaintext data using AES-256-GCM.
-    /// Returns: nonce (12) + ciphertext + tag (16), or nil on failure.
-    func encrypt(_ plaintext: Data) -> Data? {
-        guard let key = key else {
+    /// Key for direct-path checks, derived from the session secret; nil while on the PIN key.
+    var directPathKey: SymmetricKey? {
+        state.withLock { $0.schedule?.directPathKey }
+    }
+    
+    /// Encrypts plaintext data with the session cipher.
+    /// Returns: `prefix` + nonce (12) + ciphertext + tag (16) in one pooled buffer, or nil on failure.
+    /// The prefix reserves room for a transport header, so the packet isn't copied again to frame it.
+    /// With `segmented`, plaintexts of `parallelSealThreshold` bytes or more are sealed by `sealSegments` instead.
+    func encrypt(_ plaintext: Data, prefix: Data = Data(), segmented: Bool = false) -> Data? {
+        guard isReady else {
             #if DEBUG
             AirCatchLog.error("E2EE: Encrypt failed - no key", category: .network)
             #endif
             return nil
         }
         
+        let useSegments = segmented && plaintext.count >= AirCatchConfig.parallelSealThreshold
+        var sealed = false
+        let capacity = prefix.count + Self.sealedSize(of: plaintext.count, segmented: segmented)
+        let output = FrameBufferPool.shared.makeData(capacity: capacity) { buffer in
+            if !prefix.isEmpty {
+                prefix.withUnsafeBytes { buffer.baseAddress!.copyMemory(from: $0.baseAddress!, byteCount: prefix.count) }
+            }
+            let body = UnsafeMutableRawBufferPointer(rebasing: buffer[prefix.count...])
+            let count = useSegments ? sealSegments(plaintext, into: body) : seal(plaintext, into: body)
+            guard let count else { return 0 }
+            sealed = true
+            return prefix.count + count
+        }
+        return sealed ? output : nil
+    }
+
+    /// Size of `encrypt`'s output for `count` plaintext bytes, not counting the prefix.
+    static func sealedSize(of count: Int, segmented: Bool) -> Int {
+        guard segmented, count >= AirCatchConfig.parallelSealThreshold else { return count + sealOverhead }
+        return FrameSealer.segmentedSize(of: count, segmentSize: AirCatchConfig.sealSegmentSize)
+    }
+
+    /// Seals `plaintext` into caller-owned memory as nonce (12) + ciphertext + tag (16)
+    /// with the session's cipher, the same layout as `AES.GCM.SealedBox.combined`.
+    /// - Returns: Bytes written (`plaintext.count + sealOverhead`), or nil on failure.
+    func seal<Plaintext: DataProtocol>(_ plaintext: Plaintext, into output: UnsafeMutableRawBufferPointer) -> Int? {
+        guard output.count >= plaintext.count + Self.sealOverhead,
+              let sealing = state.withLock({ state -> (key: SymmetricKey, nonce: AES.GCM.Nonce, backend: AEADBackend.Type)? in
+                  guard let cipher = state.schedule?.cipher, let next = state.schedule?.nextSealing() else { return nil }
+                  return (next.key, next.nonce, cipher.backend)
+              }) else { return nil }
+        
         do {
-            let sealed = try AES.GCM.seal(plaintext, using: key)
-            return sealed.combined  // nonce + ciphertext + tag
+            return try FrameSealer.seal(plaintext, using: sealing.key, nonce: sealing.nonce, backend: sealing.backend, into: output)
         } catch {
             #if DEBUG
             AirCatchLog.error("E2EE: Encrypt failed - \(error)", category: .network)
@@ -71,10 +210,34 @@ final class CryptoManager {
         }
     }
     
-    /// Decrypts ciphertext (nonce + ciphertext + tag) using AES-256-GCM.
+    /// Seals a large frame as `FrameSealer` segments of `sealSegmentSize` bytes, sealed
+    /// concurrently. Keyframe sealing then takes roughly its single-core time divided by
+    /// the cores available.
+    /// - Returns: Bytes written (`sealedSize(of:segmented: true)`), or nil on failure.
+    func sealSegments(_ plaintext: Data, into output: UnsafeMutableRawBufferPointer) -> Int? {
+        let segmentSize = AirCatchConfig.sealSegmentSize
+        let segmentCount = (plaintext.count + segmentSize - 1) / segmentSize
+        guard segmentCount > 0, segmentCount <= Int(UInt16.max),
+              output.count >= FrameSealer.segmentedSize(of: plaintext.count, segmentSize: segmentSize),
+              let sealing = state.withLock({ state -> (key: SymmetricKey, nonces: [AES.GCM.Nonce], backend: AEADBackend.Type)? in
+                  guard let cipher = state.schedule?.cipher, let next = state.schedule?.nextSealing(count: segmentCount) else { return nil }
+                  return (next.key, next.nonces, cipher.backend)
+              }) else { return nil }
+
+        guard let written = FrameSealer.sealSegments(plaintext, segmentSize: segmentSize, using: sealing.key,
+                                                     nonces: sealing.nonces, backend: sealing.backend, into: output) else {
+            #if DEBUG
+            AirCatchLog.error("E2EE: Segmented encrypt failed", category: .network)
+            #endif
+            return nil
+        }
+        return written
+    }
+    
+    /// Decrypts ciphertext (nonce + ciphertext + tag) with the session cipher.
     /// Returns plaintext or nil if decryption fails (wrong key, tampered data).
     func decrypt(_ ciphertext: Data) -> Data? {
-        guard let key = key else {
+        guard isReady else {
             #if DEBUG
             AirCatchLog.error("E2EE: Decrypt failed - no key", category: .network)
             #endif
@@ -89,9 +252,20 @@ final class CryptoManager {
             return nil
         }
         
+        guard let opening = state.withLock({ state -> (position: KeySchedule.Opening, backend: AEADBackend.Type)? in
+            guard let schedule = state.schedule, let opening = schedule.openingKey(for: ciphertext.prefix(12)) else { return nil }
+            return (opening, schedule.cipher.backend)
+        }) else {
+            #if DEBUG
+            AirCatchLog.error("E2EE: Decrypt failed - unknown sender or key epoch", category: .network)
+            #endif
+            return nil
+        }
+        
         do {
-            let box = try AES.GCM.SealedBox(combined: ciphertext)
-            return try AES.GCM.open(box, using: key)
+            let plaintext = try opening.backend.open(ciphertext, using: opening.position.key, authenticating: Data())
+            state.withLock { $0.schedule?.didOpen(opening.position) }
+            return plaintext
         } catch {
             #if DEBUG
             AirCatchLog.error("E2EE: Decrypt failed - \(error)", category: .network)
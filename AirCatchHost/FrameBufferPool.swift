@@ -0,0 +1,108 @@
+//
+//  FrameBufferPool.swift
+//  AirCatchHost
+//
+//  Recycled byte buffers for the encode -> chunk -> send path.
+//
+
+import Foundation
+import Synchronization
+
+/// Size-classed pool of raw buffers handed out as `Data`.
+///
+/// Every encoded frame used to allocate at each stage (frame assembly, Annex B
+/// conversion, one `Data` per chunk). Those stages now write into one pooled
+/// buffer each, wrapped with `Data(bytesNoCopy:)`. Slices of that `Data` share
+/// its storage, so a frame's datagrams cost no allocation of their own. The
+/// buffer goes back to its class when the last copy or slice is released: after
+/// the final send completion, or for a viewer with lossless video, once the frame
+/// leaves its retransmit cache (`frameCacheTTL`).
+///
+/// Classes are powers of two from `minClassSize`; requests above `maxClassSize`
+/// are allocated and freed normally.
+nonisolated final class FrameBufferPool {
+
+    static let shared = FrameBufferPool()
+
+    private static let minClassSize = 4 * 1024
+    private static let maxClassSize = 8 * 1024 * 1024
+    /// Idle buffers kept per class; enough for a frame in every pipeline stage plus the retransmit cache
+    private static let maxIdlePerClass = 16
+
+    private struct State {
+        var idle: [Int: [UnsafeMutableRawPointer]] = [:]
+        var reused = 0
+        var allocated = 0
+    }
+
+    private let state = Mutex(State())
+
+    /// Returns `Data` of up to `capacity` bytes, filled by `fill`, backed by a pooled buffer.
+    /// - Parameter fill: Writes into the buffer and returns the byte count actually used.
+    func makeData(capacity: Int, _ fill: (UnsafeMutableRawBufferPointer) -> Int) -> Data {
+        guard capacity > 0 else { return Data() }
+        guard capacity <= Self.maxClassSize else {
+            var data = Data(count: capacity)
+            let used = data.withUnsafeMutableBytes { fill($0) }
+            data.count = used
+            return data
+        }
+
+        let classSize = Self.classSize(for: capacity)
+        let pointer = take(classSize: classSize)
+        let used = fill(UnsafeMutableRawBufferPointer(start: pointer, count: capacity))
+        precondition(used <= capacity, "FrameBufferPool: fill overran its buffer")
+
+        return Data(bytesNoCopy: pointer, count: used, deallocator: .custom { [weak self] pointer, _ in
+            if let self {
+                self.recycle(pointer, classSize: classSize)
+            } else {
+                pointer.deallocate()
+            }
+        })
+    }
+
+    /// Reuse ratio since the last call, for logging when a stream stops.
+    func drainStatistics() -> (reused: Int, allocated: Int) {
+        state.withLock { state in
+            defer {
+                state.reused = 0
+                state.allocated = 0
+            }
+            return (state.reused, state.allocated)
+        }
+    }
+
+    // MARK: - Buffers
+
+    private func take(classSize: Int) -> UnsafeMutableRawPointer {
+        let pooled = state.withLock { state -> UnsafeMutableRawPointer? in
+            if let pointer = state.idle[classSize]?.popLast() {
+                state.reused += 1
+                return pointer
+            }
+            state.allocated += 1
+            return nil
+        }
+        return pooled ?? UnsafeMutableRawPointer.allocate(byteCount: classSize, alignment: 16)
+    }
+
+    private func recycle(_ pointer: UnsafeMutableRawPointer, classSize: Int) {
+        let kept = state.withLock { state -> Bool in
+            guard state.idle[classSize, default: []].count < Self.maxIdlePerClass else { return false }
+            state.idle[classSize, default: []].append(pointer)
+            return true
+        }
+        if !kept {
+            pointer.deallocate()
+        }
+    }
+
+    private static func classSize(for capacity: Int) -> Int {
+        var size = minClassSize
+        while size < capacity {
+            size <<= 1
+        }
+        return size
+    }
+}
@@ -0,0 +1,213 @@
+//
+//  FrameChangeDetector.swift
+//  AirCatchHost
+//
+//  Tile-hash based static-content detection for captured BGRA frames.
+//
+
+import Foundation
+#if canImport(CoreVideo)
+import CoreVideo
+#endif
+
+/// Detects whether a captured frame differs from the previous one.
+///
+/// The frame is split into square tiles and each tile is hashed with a SIMD
+/// multiply/xor kernel. Only the tile hashes are kept between frames, so the
+/// memory cost is a few kilobytes regardless of resolution. The kernel is pure
+/// Swift standard library code and has no Apple framework dependency.
+nonisolated final class FrameChangeDetector {
+
+    /// Tile edge length in pixels.
+    static let tileSize = 64
+
+    private var tileHashes: [UInt64] = []
+    private var scratchHashes: [UInt64] = []
+    private var dirtyMask: [Bool] = []
+    private var tilesX = 0
+    private var tilesY = 0
+    private var width = 0
+    private var height = 0
+    private var bytesPerRow = 0
+
+    /// Number of tiles that changed in the last call to `detectChanges`.
+    private(set) var changedTileCount = 0
+
+    /// Total tiles in the current frame geometry.
+    var tileCount: Int { tileHashes.count }
+
+    /// False when the last frame could not be hashed (unsupported format or lock failure).
+    private(set) var hasTileState = false
+
+    /// Forgets the previous frame so the next one is reported as changed.
+    func reset() {
+        tileHashes.removeAll(keepingCapacity: true)
+        width = 0
+        height = 0
+        bytesPerRow = 0
+        changedTileCount = 0
+        hasTileState = false
+    }
+
+    #if canImport(CoreVideo)
+    /// Hashes the pixel buffer and compares it with the previous frame.
+    /// - Returns: `true` when any tile changed (or the geometry changed).
+    func detectChanges(in pixelBuffer: CVPixelBuffer) -> Bool {
+        guard CVPixelBufferGetPixelFormatType(pixelBuffer) == kCVPixelFormatType_32BGRA,
+              CVPixelBufferLockBaseAddress(pixelBuffer, .readOnly) == kCVReturnSuccess else {
+            hasTileState = false
+            return true
+        }
+        defer { CVPixelBufferUnlockBaseAddress(pixelBuffer, .readOnly) }
+
+        guard let base = CVPixelBufferGetBaseAddress(pixelBuffer) else {
+            hasTileState = false
+            return true
+        }
+        return detectChanges(
+            base: UnsafeRawPointer(base),
+            width: CVPixelBufferGetWidth(pixelBuffer),
+            height: CVPixelBufferGetHeight(pixelBuffer),
+            bytesPerRow: CVPixelBufferGetBytesPerRow(pixelBuffer)
+        )
+    }
+    #endif
+
+    /// Raw-pointer entry point for 4-byte-per-pixel frames.
+    func detectChanges(base: UnsafeRawPointer, width: Int, height: Int, bytesPerRow: Int) -> Bool {
+        let tileSize = Self.tileSize
+        let tilesX = (width + tileSize - 1) / tileSize
+        let tilesY = (height + tileSize - 1) / tileSize
+        let count = tilesX * tilesY
+
+        let geometryChanged = width != self.width || height != self.height
+            || bytesPerRow != self.bytesPerRow || tileHashes.count != count
+        if scratchHashes.count != count {
+            scratchHashes = [UInt64](repeating: 0, count: count)
+        }
+        if dirtyMask.count != count {
+            dirtyMask = [Bool](repeating: false, count: count)
+        }
+
+        scratchHashes.withUnsafeMutableBufferPointer { hashes in
+            for ty in 0..<tilesY {
+                let y0 = ty * tileSize
+                let rows = min(tileSize, height - y0)
+                for tx in 0..<tilesX {
+                    let x0 = tx * tileSize
+                    let cols = min(tileSize, width - x0)
+                    hashes[ty * tilesX + tx] = Self.hashTile(
+                        base.advanced(by: y0 * bytesPerRow + x0 * 4),
+                        rowBytes: cols * 4,
+                        rows: rows,
+                        bytesPerRow: bytesPerRow
+                    )
+                }
+            }
+        }
+
+        if geometryChanged {
+            self.width = width
+            self.height = height
+            self.bytesPerRow = bytesPerRow
+            self.tilesX = tilesX
+            self.tilesY = tilesY
+            for i in 0..<count { dirtyMask[i] = true }
+            changedTileCount = count
+        } else {
+            var changed = 0
+            for i in 0..<count {
+                let dirty = scratchHashes[i] != tileHashes[i]
+                dirtyMask[i] = dirty
+                if dirty { changed += 1 }
+            }
+            changedTileCount = changed
+        }
+
+        swap(&tileHashes, &scratchHashes)
+        hasTileState = true
+        return changedTileCount > 0
+    }
+
+    // MARK: - Dirty Region
+
+    /// Changed tiles of the last frame, merged into rectangles.
+    /// Horizontal runs of dirty tiles are extended downwards while the next
+    /// row has a run with the same span. Returns nil without valid tile state.
+    func dirtyRegion() -> FrameDirtyRegion? {
+        guard hasTileState else { return nil }
+        if changedTileCount == 0 {
+            return FrameDirtyRegion(tileSize: UInt16(Self.tileSize), rects: [])
+        }
+        if changedTileCount == tilesX * tilesY {
+            return .fullFrame(width: width, height: height, tileSize: Self.tileSize)
+        }
+
+        typealias TileRect = FrameDirtyRegion.TileRect
+        var rects: [TileRect] = []
+        // Run (start << 16 | length) -> index of the rect that ended on the previous row
+        var openRuns: [Int: Int] = [:]
+        var nextRuns: [Int: Int] = [:]
+
+        for ty in 0..<tilesY {
+            let row = ty * tilesX
+            var tx = 0
+            while tx < tilesX {
+                guard dirtyMask[row + tx] else {
+                    tx += 1
+                    continue
+                }
+                let start = tx
+                while tx < tilesX && dirtyMask[row + tx] { tx += 1 }
+                let key = start << 16 | (tx - start)
+
+                if let index = openRuns[key] {
+                    let r = rects[index]
+                    rects[index] = TileRect(x: r.x, y: r.y, width: r.width, height: r.height + 1)
+                    nextRuns[key] = index
+                } else {
+                    rects.append(TileRect(x: UInt16(start), y: UInt16(ty), width: UInt16(tx - start), height: 1))
+                    nextRuns[key] = rects.count - 1
+                }
+            }
+            swap(&openRuns, &nextRuns)
+            nextRuns.removeAll(keepingCapacity: true)
+        }
+
+        return FrameDirtyRegion(tileSize: UInt16(Self.tileSize), rects: rects)
+    }
+
+    // MARK: - Kernel
+
+    /// Hashes one tile. Rows are consumed 32 bytes at a time into four
+    /// independent 64-bit lanes, then folded into a single value.
+    @inline(__always)
+    private static func hashTile(_ tile: UnsafeRawPointer, rowBytes: Int, rows: Int, bytesPerRow: Int) -> UInt64 {
+        let prime = SIMD4<UInt64>(repeating: 0x100_0000_01B3)
+        var acc = SIMD4<UInt64>(0xCBF2_9CE4_8422_2325, 0x8422_2325_CBF2_9CE4, 0x9E37_79B9_7F4A_7C15, 0x7F4A_7C15_9E37_79B9)
+        var tail: UInt64 = 0xCBF2_9CE4_8422_2325
+
+        for row in 0..<rows {
+            let line = tile.advanced(by: row * bytesPerRow)
+            var offset = 0
+            while offset + 32 <= rowBytes {
+                let v = line.loadUnaligned(fromByteOffset: offset, as: SIMD4<UInt64>.self)
+                acc = (acc ^ v) &* prime
+                offset += 32
+            }
+            while offset + 4 <= rowBytes {
+                let px = line.loadUnaligned(fromByteOffset: offset, as: UInt32.self)
+                tail = (tail ^ UInt64(px)) &* 0x100_0000_01B3
+                offset += 4
+            }
+            // Mix the row index so identical rows in different positions differ
+            tail = (tail ^ UInt64(row)) &* 0x100_0000_01B3
+        }
+
+        var h = tail
+        for i in 0..<4 {
+            h = (h ^ acc[i]) &* 0x100_0000_01B3
+        }
+        return h
+    }
+}
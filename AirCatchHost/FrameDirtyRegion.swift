@@ -0,0 +1,96 @@
+//
+//  FrameDirtyRegion.swift
+//  AirCatchHost
+//
+//  Per-frame changed-area metadata carried in the video frame header.
+//
+
+import Foundation
+
+/// Changed screen area of a video frame, expressed as tile-aligned rectangles.
+///
+/// Frames carry it only while every viewer set `HandshakeRequest.supportsDirtyRegions`.
+/// The frame layout then becomes `[Timestamp: 8][Tag: 1][RegionLength: 2][Region][Annex B]`
+/// instead of `[Timestamp: 8][Annex B]`; the tag tells the two apart per frame.
+/// Region wire format (big endian): `[TileSize: 2][RectCount: 2]` followed by
+/// `RectCount` entries of `[X: 2][Y: 2][Width: 2][Height: 2]` in tile units.
+nonisolated struct FrameDirtyRegion: Equatable {
+    nonisolated struct TileRect: Equatable {
+        let x: UInt16
+        let y: UInt16
+        let width: UInt16
+        let height: UInt16
+    }
+
+    /// Tile edge length in pixels
+    let tileSize: UInt16
+    let rects: [TileRect]
+
+    /// Marks a region after the timestamp. Annex B always starts with 0x00, so this never collides.
+    static let headerTag: UInt8 = 0xD1
+
+    /// Beyond this many rectangles the region collapses to its bounding box.
+    static let maxRects = 64
+
+    /// True when nothing on screen changed (keepalive frame).
+    var isEmpty: Bool { rects.isEmpty }
+
+    init(tileSize: UInt16, rects: [TileRect]) {
+        self.tileSize = tileSize
+        if rects.count > Self.maxRects {
+            let minX = rects.map(\.x).min() ?? 0
+            let minY = rects.map(\.y).min() ?? 0
+            let maxX = rects.map { $0.x + $0.width }.max() ?? 0
+            let maxY = rects.map { $0.y + $0.height }.max() ?? 0
+            self.rects = [TileRect(x: minX, y: minY, width: maxX - minX, height: maxY - minY)]
+        } else {
+            self.rects = rects
+        }
+    }
+
+    /// Region covering a whole frame of the given pixel size.
+    static func fullFrame(width: Int, height: Int, tileSize: Int) -> FrameDirtyRegion {
+        let tilesX = UInt16(clamping: (width + tileSize - 1) / tileSize)
+        let tilesY = UInt16(clamping: (height + tileSize - 1) / tileSize)
+        return FrameDirtyRegion(
+            tileSize: UInt16(clamping: tileSize),
+            rects: [TileRect(x: 0, y: 0, width: tilesX, height: tilesY)]
+        )
+    }
+
+    var serializedSize: Int { 4 + rects.count * 8 }
+
+    func serialized() -> Data {
+        var data = Data(capacity: serializedSize)
+        func append(_ value: UInt16) {
+            withUnsafeBytes(of: value.bigEndian) { data.append(contentsOf: $0) }
+        }
+        append(tileSize)
+        append(UInt16(rects.count))
+        for rect in rects {
+            append(rect.x)
+            append(rect.y)
+            append(rect.width)
+            append(rect.height)
+        }
+        return data
+    }
+
+    /// Parses a region from its wire format. Returns nil when truncated.
+    init?(serialized bytes: UnsafeRawBufferPointer) {
+        guard bytes.count >= 4 else { return nil }
+        func read(_ offset: Int) -> UInt16 {
+            UInt16(bigEndian: bytes.loadUnaligned(fromByteOffset: offset, as: UInt16.self))
+        }
+        let count = Int(read(2))
+        guard bytes.count >= 4 + count * 8 else { return nil }
+        var rects: [TileRect] = []
+        rects.reserveCapacity(count)
+        for i in 0..<count {
+            let base = 4 + i * 8
+            rects.append(TileRect(x: read(base), y: read(base + 2), width: read(base + 4), height: read(base + 6)))
+        }
+        self.tileSize = read(0)
+        self.rects = rects
+    }
+}
@@ -0,0 +1,64 @@
+//
+//  FrameDropPolicy.swift
+//  AirCatchHost
+//
+//  Per-frame admission for congested send queues, aware of temporal layers.
+//
+
+import Foundation
+
+/// Decides which frames a congested queue may skip without breaking decode.
+///
+/// Above `thinFraction` of the queue budget, droppable frames (enhancement
+/// layers nothing references) are skipped. Over the full budget a reference
+/// frame has to go as well; every later frame depends on it, so the queue then
+/// skips everything until the next keyframe and asks the encoder for one.
+/// Keyframes are always admitted.
+nonisolated struct FrameDropPolicy {
+
+    enum Decision: Equatable {
+        case send
+        /// Skipped a droppable frame; decode is unaffected
+        case thin
+        /// Skipped a reference frame or a frame after it; the receiver needs a keyframe
+        case drop
+    }
+
+    /// Share of the budget above which droppable frames are skipped
+    var thinFraction = 0.5
+
+    private(set) var waitingForKeyframe: Bool
+    private(set) var thinnedFrames = 0
+    private(set) var droppedFrames = 0
+
+    /// - Parameter waitingForKeyframe: Start true for a receiver that joins mid-stream.
+    init(waitingForKeyframe: Bool = false) {
+        self.waitingForKeyframe = waitingForKeyframe
+    }
+
+    /// - Parameters:
+    ///   - queuedBytes: Bytes already waiting ahead of this frame.
+    ///   - budget: Bytes the queue may hold before reference frames are dropped.
+    mutating func admit(_ tag: FrameLayerTag, frameBytes: Int, queuedBytes: Int, budget: Double) -> Decision {
+        if tag.isKeyframe {
+            waitingForKeyframe = false
+            return .send
+        }
+        if waitingForKeyframe {
+            droppedFrames += 1
+            return .drop
+        }
+
+        let queued = Double(queuedBytes + frameBytes)
+        if tag.isDroppable && queued > budget * thinFraction {
+            thinnedFrames += 1
+            return .thin
+        }
+        if queued > budget {
+            droppedFrames += 1
+            waitingForKeyframe = true
+            return .drop
+        }
+        return .send
+    }
+}
@@ -0,0 +1,172 @@
+//
+//  FrameSealer.swift
+//  AirCatchHost
+//
+//  AEAD box layout of sealed traffic, single and segmented, written into caller-owned memory.
+//
+
+import Foundation
+#if canImport(CryptoKit)
+import CryptoKit
+#else
+import Crypto
+#endif
+
+/// Seals and opens the boxes `CryptoManager` puts on the wire, given keys and nonces
+/// it took from its `KeySchedule`. Holds no state, so it runs on any thread.
+///
+/// A box is nonce (12) + ciphertext + tag (16), the same layout as
+/// `AES.GCM.SealedBox.combined`. A segmented frame is `[Tag: 1][SegmentCount: 2][SegmentSize: 4]`
+/// followed by one box per `SegmentSize` bytes. Each segment authenticates the header,
+/// the first segment's nonce and its own index, so segments can't be dropped,
+/// reordered or spliced in from another frame.
+nonisolated enum FrameSealer {
+    /// Bytes a box adds around its plaintext: nonce (12) + tag (16)
+    static let overhead = 12 + 16
+    /// First byte of a segmented frame. Host nonces start with their direction bit set, so a
+    /// single box never begins with it.
+    static let segmentedTag: UInt8 = 0x53
+    /// `[Tag: 1][SegmentCount: 2][SegmentSize: 4]`
+    static let segmentHeaderSize = 7
+
+    /// Size of `count` plaintext bytes sealed as `segmentSize` segments.
+    static func segmentedSize(of count: Int, segmentSize: Int) -> Int {
+        let segments = (count + segmentSize - 1) / segmentSize
+        return segmentHeaderSize + count + segments * overhead
+    }
+
+    /// Seals `plaintext` into `output` as one box.
+    /// - Returns: Bytes written (`plaintext.count + overhead`).
+    static func seal<Plaintext: DataProtocol>(
+        _ plaintext: Plaintext,
+        using key: SymmetricKey,
+        nonce: AES.GCM.Nonce,
+        backend: AEADBackend.Type,
+        authenticating aad: Data = Data(),
+        into output: UnsafeMutableRawBufferPointer
+    ) throws -> Int {
+        let box = try backend.seal(plaintext, using: key, nonce: nonce, authenticating: aad)
+        var written = 0
+        func write(_ bytes: UnsafeRawBufferPointer) {
+            guard !bytes.isEmpty else { return }
+            output.baseAddress!.advanced(by: written).copyMemory(from: bytes.baseAddress!, byteCount: bytes.count)
+            written += bytes.count
+        }
+        nonce.withUnsafeBytes(write)
+        box.ciphertext.withUnsafeBytes(write)
+        box.tag.withUnsafeBytes(write)
+        return written
+    }
+
+    /// Seals `plaintext` as one box per `segmentSize` bytes, concurrently.
+    /// - Parameters:
+    ///   - nonces: One per segment, all under `key`.
+    ///   - workers: Threads to spread the segments over; nil gives every segment its own
+    ///     iteration and leaves the thread count to Dispatch.
+    /// - Returns: Bytes written (`segmentedSize(of:segmentSize:)`), or nil on failure.
+    static func sealSegments(
+        _ plaintext: Data,
+        segmentSize: Int,
+        using key: SymmetricKey,
+        nonces: [AES.GCM.Nonce],
+        backend: AEADBackend.Type,
+        workers: Int? = nil,
+        into output: UnsafeMutableRawBufferPointer
+    ) -> Int? {
+        let segmentCount = (plaintext.count + segmentSize - 1) / segmentSize
+        let total = segmentedSize(of: plaintext.count, segmentSize: segmentSize)
+        guard segmentCount > 0, segmentCount <= Int(UInt16.max), nonces.count == segmentCount,
+              output.count >= total else { return nil }
+
+        let base = output.baseAddress!
+        base.storeBytes(of: segmentedTag, as: UInt8.self)
+        base.storeBytes(of: UInt16(segmentCount).bigEndian, toByteOffset: 1, as: UInt16.self)
+        base.storeBytes(of: UInt32(segmentSize).bigEndian, toByteOffset: 3, as: UInt32.self)
+
+        var binding = Data(UnsafeRawBufferPointer(start: base, count: segmentHeaderSize))
+        nonces[0].withUnsafeBytes { binding.append(contentsOf: $0) }
+
+        let sealed = forEachSegment(segmentCount, workers: workers) { index in
+            let start = index * segmentSize
+            let end = min(start + segmentSize, plaintext.count)
+            let offset = segmentHeaderSize + start + index * overhead
+            let box = UnsafeMutableRawBufferPointer(start: base.advanced(by: offset), count: end - start + overhead)
+            let segment = plaintext[(plaintext.startIndex + start)..<(plaintext.startIndex + end)]
+            return (try? seal(segment, using: key, nonce: nonces[index], backend: backend,
+                              authenticating: segmentAAD(binding, index: index), into: box)) != nil
+        }
+        return sealed ? total : nil
+    }
+
+    /// Opens a frame sealed by `sealSegments`, its segments concurrently.
+    /// - Parameter opening: Key and cipher for the frame's first nonce; every segment shares its epoch.
+    /// - Returns: nil when the layout doesn't add up, `opening` has no key or any segment fails to open.
+    static func openSegments(
+        _ sealed: Data,
+        workers: Int? = nil,
+        opening: (_ firstNonce: Data) -> (key: SymmetricKey, backend: AEADBackend.Type)?
+    ) -> Data? {
+        guard sealed.count > segmentHeaderSize + overhead, sealed.first == segmentedTag else { return nil }
+        let start = sealed.startIndex
+        let segmentCount = Int(sealed[start + 1]) << 8 | Int(sealed[start + 2])
+        let segmentSize = Int(sealed[start + 3]) << 24 | Int(sealed[start + 4]) << 16
+            | Int(sealed[start + 5]) << 8 | Int(sealed[start + 6])
+        guard segmentCount > 0, segmentSize > 0 else { return nil }
+
+        // Every segment but the last is full; the last holds 1...segmentSize bytes
+        let plaintextCount = sealed.count - segmentHeaderSize - segmentCount * overhead
+        guard plaintextCount > (segmentCount - 1) * segmentSize,
+              plaintextCount <= segmentCount * segmentSize else { return nil }
+
+        let firstNonce = sealed[(start + segmentHeaderSize)..<(start + segmentHeaderSize + 12)]
+        guard let keyed = opening(Data(firstNonce)) else { return nil }
+        let key = keyed.key
+        let backend = keyed.backend
+        var binding = Data(sealed[start..<(start + segmentHeaderSize)])
+        binding.append(firstNonce)
+
+        var plaintext = Data(count: plaintextCount)
+        let opened = plaintext.withUnsafeMutableBytes { output in
+            let base = output.baseAddress!
+            return forEachSegment(segmentCount, workers: workers) { index in
+                let plainStart = index * segmentSize
+                let plainCount = min(segmentSize, plaintextCount - plainStart)
+                let boxStart = start + segmentHeaderSize + plainStart + index * overhead
+                let box = sealed[boxStart..<(boxStart + plainCount + overhead)]
+                guard let segment = try? backend.open(box, using: key, authenticating: segmentAAD(binding, index: index)) else {
+                    return false
+                }
+                segment.withUnsafeBytes { bytes in
+                    base.advanced(by: plainStart).copyMemory(from: bytes.baseAddress!, byteCount: plainCount)
+                }
+                return true
+            }
+        }
+        return opened ? plaintext : nil
+    }
+
+    // MARK: - Helpers
+
+    private static func segmentAAD(_ binding: Data, index: Int) -> Data {
+        var aad = binding
+        aad.append(UInt8(index >> 8))
+        aad.append(UInt8(index & 0xFF))
+        return aad
+    }
+
+    /// Runs `body` for every segment index across `workers` threads.
+    /// - Returns: true when every call returned true.
+    private static func forEachSegment(_ count: Int, workers: Int?, _ body: (Int) -> Bool) -> Bool {
+        let lanes = min(count, max(1, workers ?? count))
+        // One slot per lane, so lanes record failures without sharing memory
+        var succeeded = [Bool](repeating: true, count: lanes)
+        succeeded.withUnsafeMutableBufferPointer { results in
+            DispatchQueue.concurrentPerform(iterations: lanes) { lane in
+                for index in stride(from: lane, to: count, by: lanes) where !body(index) {
+                    results[lane] = false
+                }
+            }
+        }
+        return !succeeded.contains(false)
+    }
+}
@@ -49,6 +49,7 @@ final class HostManager: ObservableObject {
         AirCatchLog.info("New PIN generated")
         remoteTransport.updateSessionId(currentPIN)
         crypto.deriveKey(from: currentPIN)  // E2EE: Derive encryption key from PIN
+        remoteTransport.setDirectPathKey(nil)
     }
     
     // MARK: - Network Components
@@ -59,10 +60,17 @@ final class HostManager: ObservableObject {
     private let remoteTransport = RemoteTransportHost()
     private let crypto = CryptoManager()  // E2EE encryption
     private let virtualDisplayManager = VirtualDisplayManager.shared
+    private let inputScheduler = InputScheduler()
     
     // MARK: - Screen Capture
     
     private var screenStreamer: ScreenStreamer?
+    /// Startup of the current stream, until its first frame is reported
+    private struct StreamStartup {
+        let requestedAt: TimeInterval
+        var displayReadyAt: TimeInterval?
+    }
+    private var streamStartup: StreamStartup?
     private var currentClientDimensions: (width: Int, height: Int)?
     private var currentFrameId: UInt32 = 0
     private let maxUDPPayloadSize = AirCatchConfig.maxUDPPayloadSize // Safe UDP payload size (below MTU)
@@ -70,8 +78,43 @@ final class HostManager: ObservableObject {
     /// When false, prefer sending video over TCP (higher reliability).
     private var preferLowLatency: Bool = true
 
-    /// When true, keep a short retransmit window for UDP video chunks (wired mode).
-    private var losslessVideoEnabled: Bool = true
+    /// When true, video frames carry dirty-region metadata (every viewer opted in via handshake).
+    private var dirtyRegionsEnabled: Bool = false
+
+    /// A connected viewer of the shared stream
+    private enum ViewerKey: Hashable {
+        case connection(ObjectIdentifier)
+        case remote
+        case peer(MCPeerID)
+    }
+
+    /// Stream formats a viewer negotiated in its handshake
+    private struct ViewerCapabilities {
+        var dirtyRegions = false
+        var frameLayers = false
+        var segmentedSealing = false
+        /// Keep sent frames for NACK retransmits (wired mode)
+        var losslessVideo = false
+
+        init(_ request: HandshakeRequest?) {
+            dirtyRegions = request?.supportsDirtyRegions ?? false
+            frameLayers = request?.supportsFrameLayers ?? false
+            segmentedSealing = request?.supportsSegmentedSealing ?? false
+            losslessVideo = request?.losslessVideo ?? false
+        }
+    }
+
+    /// Capabilities of each connected viewer
+    private var viewerCapabilities: [ViewerKey: ViewerCapabilities] = [:]
+
+    /// Local connections that negotiated lossless video, with their fan-out viewer id
+    private var retransmitConnections: [ObjectIdentifier: String] = [:]
+
+    /// When true, video chunks carry a `FrameLayerTag` (every viewer opted in via handshake).
+    private var frameLayersEnabled: Bool = false
+
+    /// When true, large frames are sealed as parallel segments (every viewer opted in via handshake).
+    private var segmentedSealingEnabled: Bool = false
 
     /// Whether the active session is a Remote (Internet) session.
     private var remoteSessionActive: Bool = false
@@ -80,22 +123,20 @@ final class HostManager: ObservableObject {
     /// When true, stream at host's native resolution. When false, scale to client resolution.
     private var optimizeForHostDisplay: Bool = false
 
-    private struct CachedFrame {
-        let createdAt: TimeInterval
-        let totalChunks: Int
-        let chunksByIndex: [Int: Data]
-    }
-
-    // FrameID -> cached chunks for retransmit (lossless mode)
-    // SAFETY: Only accessed from cachedFramesQueue
-    nonisolated(unsafe) private var cachedFrames: [UInt32: CachedFrame] = [:]
-    private let cachedFramesQueue = DispatchQueue(label: "com.aircatch.framecache")
+    /// Per-viewer queues, pacing and retransmit caches for local UDP video
+    private let videoFanout: VideoFanout
 
     // Target display selection
     private var targetDisplayID: CGDirectDisplayID? = nil
     private var targetScreenFrame: CGRect? = nil
     
-    private init() {}
+    private init() {
+        videoFanout = VideoFanout(onKeyframeNeeded: {
+            Task { @MainActor in
+                HostManager.shared.screenStreamer?.requestKeyframe()
+            }
+        })
+    }
     
     // MARK: - Lifecycle
     
@@ -105,6 +146,11 @@ final class HostManager: ObservableObject {
         // Generate a new PIN for this session
         regeneratePIN()
         
+        // Rank the ciphers off the main thread before the first key exchange needs them
+        DispatchQueue.global(qos: .utility).async {
+            _ = CipherBenchmark.ranking
+        }
+        
         Task {
             do {
                 // Start UDP listener on fixed port
@@ -198,6 +244,8 @@ final class HostManager: ObservableObject {
         mpcHost.stop()
         remoteTransport.stop()
         remoteSessionActive = false
+        resumableSession = nil
+        cancelParkedSession()
         
         isRunning = false
         isStreaming = false
@@ -220,6 +268,13 @@ final class HostManager: ObservableObject {
                 NetworkManager.shared.registerUDPClient(endpoint: endpoint)
             }
         }
+        
+        // Input lane: touch/scroll/key events that bypass the TCP control stream
+        if packet.type == .inputBatch {
+            Task { @MainActor in
+                self.handleInputBatch(packet.payload)
+            }
+        }
     }
     
     private nonisolated func handleTCPPacket(_ packet: Packet, from connection: NWConnection) {
@@ -232,6 +287,14 @@ final class HostManager: ObservableObject {
             Task { @MainActor in
                 self.handleVideoChunkNack(packet.payload, from: connection)
             }
+        case .keyframeRequest:
+            Task { @MainActor in
+                self.screenStreamer?.requestKeyframe()
+            }
+        case .sessionResume:
+            Task { @MainActor in
+                self.handleSessionResume(packet.payload, from: connection)
+            }
         case .touchEvent:
             Task { @MainActor in
                 self.handleTouchEvent(packet.payload)
@@ -248,6 +311,11 @@ final class HostManager: ObservableObject {
             Task { @MainActor in
                 self.handleMediaKeyEvent(packet.payload)
             }
+        case .inputBatch:
+            // Reliable copies of input-lane transitions (deduplicated by sequence number)
+            Task { @MainActor in
+                self.handleInputBatch(packet.payload)
+            }
         case .ping:
             Task { @MainActor in
                 self.handlePingPacket(packet.payload, from: connection)
@@ -272,6 +340,13 @@ final class HostManager: ObservableObject {
             Task { @MainActor in
                 await handleRemoteHandshake(payload: packet.payload)
             }
+        case .sessionResume:
+            if let ack = resumeSession(packet.payload, isRemote: true, viewer: .remote),
+               let data = try? JSONEncoder().encode(ack) {
+                remoteTransport.sendTCP(type: .handshakeAck, payload: data)
+            } else {
+                remoteTransport.sendTCP(type: .sessionResumeRejected, payload: Data())
+            }
         case .touchEvent:
             handleTouchEvent(packet.payload)
         case .scrollEvent:
@@ -284,6 +359,8 @@ final class HostManager: ObservableObject {
             handleRemotePingPacket(packet.payload)
         case .qualityReport:
             handleRemoteQualityReport(packet.payload)
+        case .keyframeRequest:
+            screenStreamer?.requestKeyframe()
         case .disconnect:
             handleRemoteDisconnect()
         default:
@@ -309,8 +386,9 @@ final class HostManager: ObservableObject {
             guard let self else { return }
             self.handleMPCPacket(packet, from: peer)
         }
-        mpcHost.onPeerDisconnected = { [weak self] _ in
+        mpcHost.onPeerDisconnected = { [weak self] peer in
             guard let self else { return }
+            self.setViewerCapabilities(nil, for: .peer(peer))
             if self.connectedClients > 0 {
                 self.connectedClients -= 1
             }
@@ -326,6 +404,9 @@ final class HostManager: ObservableObject {
         stopStreaming()
         // Only restore if we are the last client disconnecting
         if connectedClients == 0 {
+            // Nobody is left on the session keys; the next client starts a new session
+            crypto.endSession()
+            remoteTransport.setDirectPathKey(nil)
             // Destroy virtual display if active
             virtualDisplayManager.destroyVirtualDisplay()
             // Also restore main display if it was changed
@@ -348,6 +429,7 @@ final class HostManager: ObservableObject {
         case .audioPCM:
             break
         case .disconnect:
+            setViewerCapabilities(nil, for: .peer(peer))
             if connectedClients > 0 {
                 connectedClients -= 1
             }
@@ -370,16 +452,19 @@ final class HostManager: ObservableObject {
             #endif
             handshakeRequest = nil
         }
-        let receivedPIN = handshakeRequest?.pin ?? ""
-
-        if receivedPIN != currentPIN {
+        if !verifiesPIN(handshakeRequest) {
             mpcHost.send(to: peer, type: .pairingFailed, payload: Data(), mode: .reliable)
             return
         }
+        if let keys = sessionKeys(answering: handshakeRequest) {
+            mpcHost.send(to: peer, type: .sessionKeys, payload: keys, mode: .reliable)
+        }
 
-        // Local session (non-remote)
+        // Local session (non-remote); MPC sessions aren't resumable
         remoteSessionActive = false
         remoteCodecPreference = nil
+        resumableSession = nil
+        cancelParkedSession()
 
         connectedClients += 1
 
@@ -389,7 +474,7 @@ final class HostManager: ObservableObject {
         }
 
         self.preferLowLatency = handshakeRequest?.preferLowLatency ?? true
-        self.losslessVideoEnabled = handshakeRequest?.losslessVideo ?? false
+        setViewerCapabilities(ViewerCapabilities(handshakeRequest), for: .peer(peer))
         
         // Resolution optimization: use client's preference or preset's default
         self.optimizeForHostDisplay = handshakeRequest?.optimizeForHostDisplay ?? currentQuality.defaultOptimizeForHostDisplay
@@ -465,10 +550,8 @@ final class HostManager: ObservableObject {
                 networkManager.sendTCP(to: connection, type: .pairingFailed, payload: Data())
                 return
             }
-            let receivedPIN = handshakeRequest?.pin ?? ""
-            
             // Verify PIN
-            if receivedPIN != currentPIN {
+            if !verifiesPIN(handshakeRequest) {
                 #if DEBUG
                 AirCatchLog.debug("PIN mismatch for: \(connection.endpoint)", category: .network)
                 #endif
@@ -476,10 +559,15 @@ final class HostManager: ObservableObject {
                 networkManager.sendTCP(to: connection, type: .pairingFailed, payload: Data())
                 return
             }
+            if let keys = sessionKeys(answering: handshakeRequest) {
+                networkManager.sendTCP(to: connection, type: .sessionKeys, payload: keys)
+            }
 
-            // Local session (non-remote)
+            // Local session (non-remote). A client may be moving its session off the relay.
+            let migratingFromRelay = self.remoteSessionActive
             self.remoteSessionActive = false
             self.remoteCodecPreference = nil
+            self.cancelParkedSession()
             
             #if DEBUG
             AirCatchLog.debug("PIN verified successfully for: \(connection.endpoint)", category: .network)
@@ -501,7 +589,11 @@ final class HostManager: ObservableObject {
 
             // Client transport preference
             self.preferLowLatency = handshakeRequest?.preferLowLatency ?? true
-            self.losslessVideoEnabled = handshakeRequest?.losslessVideo ?? false
+            self.setViewerCapabilities(ViewerCapabilities(handshakeRequest), for: .connection(ObjectIdentifier(connection)))
+            self.setRetransmits(handshakeRequest?.losslessVideo ?? false, for: connection)
+            
+            // New session: drop held motion (the client's input lane starts fresh)
+            self.inputScheduler.reset()
             
             // Resolution optimization: use client's preference or preset's default
             self.optimizeForHostDisplay = handshakeRequest?.optimizeForHostDisplay ?? currentQuality.defaultOptimizeForHostDisplay
@@ -526,8 +618,9 @@ final class HostManager: ObservableObject {
                         deviceModel: handshakeRequest?.deviceModel,
                         audioEnabled: wantsAudio
                     )
-                } else if previousQuality != currentQuality || self.audioStreamingEnabled != wantsAudio {
-                    // Apply quality/audio change for an already-running stream
+                } else if migratingFromRelay || previousQuality != currentQuality || self.audioStreamingEnabled != wantsAudio {
+                    // Apply quality/audio change for an already-running stream,
+                    // or drop the relay's codec and bitrate caps
                     stopStreaming()
                     await startStreaming(
                         clientMaxWidth: handshakeRequest?.screenWidth,
@@ -551,10 +644,12 @@ final class HostManager: ObservableObject {
                 bitrate: currentQuality.bitrate,
                 isVirtualDisplay: false,
                 displayMode: .mirror,
-                displayPosition: nil
+                displayPosition: nil,
+                inputLane: handshakeRequest?.supportsInputLane == true
             )
+            let ticketedAck = self.issueResumeTicket(for: ack, isRemote: false, capabilities: ViewerCapabilities(handshakeRequest))
             
-            if let data = try? JSONEncoder().encode(ack) {
+            if let data = try? JSONEncoder().encode(ticketedAck) {
                 networkManager.sendTCP(to: connection, type: .handshakeAck, payload: data)
             }
         }
@@ -571,22 +666,25 @@ final class HostManager: ObservableObject {
             return
         }
 
-        let receivedPIN = handshakeRequest?.pin ?? ""
-        guard receivedPIN == currentPIN else {
+        guard verifiesPIN(handshakeRequest) else {
             remoteTransport.sendTCP(type: .pairingFailed, payload: Data())
             return
         }
+        if let keys = sessionKeys(answering: handshakeRequest) {
+            remoteTransport.sendTCP(type: .sessionKeys, payload: keys)
+        }
 
         remoteSessionActive = true
+        cancelParkedSession()
         connectedClients += 1
         
         // --- REMOTE QUALITY POLICY ENFORCEMENT ---
         // Force HEVC Main (8-bit) for best compatibility/bandwidth ratio
         remoteCodecPreference = .hevc
         
-        // Remote mode: prioritize latency, disable retransmit
+        // Remote mode: prioritize latency (relayed video has no retransmits)
         self.preferLowLatency = true
-        self.losslessVideoEnabled = false
+        setViewerCapabilities(ViewerCapabilities(handshakeRequest), for: .remote)
         
         // Remote mode: always use client resolution to minimize bandwidth over internet
         self.optimizeForHostDisplay = false
@@ -658,22 +756,168 @@ final class HostManager: ObservableObject {
             displayMode: .mirror,
             displayPosition: nil
         )
+        let ticketedAck = issueResumeTicket(for: ack, isRemote: true, capabilities: ViewerCapabilities(handshakeRequest))
 
-        if let data = try? JSONEncoder().encode(ack) {
+        if let data = try? JSONEncoder().encode(ticketedAck) {
             remoteTransport.sendTCP(type: .handshakeAck, payload: data)
         }
     }
 
+    /// Clients prove the PIN with an HMAC over their key share (`KeySchedule.pinProof`),
+    /// so it never crosses the network; clients predating the proof still send it in clear.
+    private func verifiesPIN(_ request: HandshakeRequest?) -> Bool {
+        verifiesPIN(proof: request?.pinProof, over: request?.keyShare, legacyPIN: request?.pin)
+    }
+
+    private func verifiesPIN(proof: Data?, over context: Data?, legacyPIN: String?) -> Bool {
+        if let proof, let context {
+            return KeySchedule.isValidPINProof(proof, pin: currentPIN, context: context)
+        }
+        return legacyPIN == currentPIN
+    }
+
+    /// Answers the handshake's key share before the stream starts, so the first frames
+    /// are already sealed under the session keys. nil for clients without a key share.
+    private func sessionKeys(answering request: HandshakeRequest?) -> Data? {
+        guard let share = request?.keyShare,
+              let answer = crypto.acceptKeyShare(share, supportedCiphers: request?.supportedCiphers) else { return nil }
+        remoteTransport.setDirectPathKey(crypto.directPathKey)
+        return try? JSONEncoder().encode(answer)
+    }
+
     @MainActor
     private func handleRemoteDisconnect() {
         remoteSessionActive = false
+        setViewerCapabilities(nil, for: .remote)
         connectedClients = max(0, connectedClients - 1)
         postStatusChange()
         if connectedClients == 0 {
-            stopStreaming()
+            parkSession()
         }
     }
     
+    // MARK: - Session Resume
+    
+    /// The last acknowledged session, resumable by ticket while its stream is running.
+    private struct ResumableSession {
+        let ticket: String
+        let isRemote: Bool
+        let ack: HandshakeAck
+        /// The resuming client doesn't repeat its handshake capabilities
+        let capabilities: ViewerCapabilities
+    }
+    
+    private var resumableSession: ResumableSession?
+    /// Bumped whenever a client comes back, cancelling a pending stop of a parked session
+    private var parkGeneration = 0
+    
+    /// Attaches a fresh ticket to `ack` and remembers the session it resumes.
+    private func issueResumeTicket(for ack: HandshakeAck, isRemote: Bool, capabilities: ViewerCapabilities) -> HandshakeAck {
+        var ticketed = ack
+        var generator = SystemRandomNumberGenerator()
+        let ticket = (0..<16).map { _ in String(format: "%02x", UInt8.random(in: .min ... .max, using: &generator)) }.joined()
+        ticketed.resumeTicket = ticket
+        resumableSession = ResumableSession(ticket: ticket, isRemote: isRemote, ack: ticketed, capabilities: capabilities)
+        return ticketed
+    }
+    
+    /// The last client dropped. A resumable stream keeps running (encoder, virtual
+    /// display, crypto) for `sessionResumeGracePeriod` so a client coming back after
+    /// a Wi-Fi blip skips stream setup; anything else stops now.
+    private func parkSession() {
+        guard isStreaming, resumableSession != nil else {
+            resumableSession = nil
+            stopStreamingAndRestore()
+            return
+        }
+        
+        parkGeneration += 1
+        let generation = parkGeneration
+        AirCatchLog.info("Last client dropped; keeping the stream \(Int(AirCatchConfig.sessionResumeGracePeriod))s for resume", category: .network)
+        DispatchQueue.main.asyncAfter(deadline: .now() + AirCatchConfig.sessionResumeGracePeriod) { [weak self] in
+            MainActor.assumeIsolated {
+                guard let self, generation == self.parkGeneration, self.connectedClients == 0 else { return }
+                AirCatchLog.info("Resume window expired", category: .network)
+                self.resumableSession = nil
+                self.stopStreamingAndRestore()
+            }
+        }
+    }
+    
+    private func cancelParkedSession() {
+        parkGeneration += 1
+    }
+    
+    private func handleSessionResume(_ payload: Data, from connection: NWConnection) {
+        if let ack = resumeSession(payload, isRemote: false, viewer: .connection(ObjectIdentifier(connection))),
+           let data = try? JSONEncoder().encode(ack) {
+            setRetransmits(resumableSession?.capabilities.losslessVideo ?? false, for: connection)
+            networkManager.sendTCP(to: connection, type: .handshakeAck, payload: data)
+        } else {
+            networkManager.sendTCP(to: connection, type: .sessionResumeRejected, payload: Data())
+        }
+    }
+    
+    /// Rejoins the running session without restarting the stream, and forces a keyframe
+    /// so the client (which kept its decoder) recovers on the next frame.
+    /// The old connection may not have been noticed as dropped yet; its disconnect
+    /// later balances the client count.
+    /// - Returns: The ack to send (with a new ticket), or nil to reject.
+    private func resumeSession(_ payload: Data, isRemote: Bool, viewer: ViewerKey) -> HandshakeAck? {
+        guard let request = try? JSONDecoder().decode(SessionResumeRequest.self, from: payload),
+              let session = resumableSession,
+              request.ticket == session.ticket,
+              verifiesPIN(proof: request.pinProof, over: Data(request.ticket.utf8), legacyPIN: request.pin),
+              session.isRemote == isRemote,
+              isStreaming else {
+            AirCatchLog.info("Session resume rejected", category: .network)
+            return nil
+        }
+        
+        cancelParkedSession()
+        connectedClients += 1
+        remoteSessionActive = isRemote
+        setViewerCapabilities(session.capabilities, for: viewer)
+        inputScheduler.reset()
+        screenStreamer?.requestKeyframe()
+        postStatusChange()
+        
+        AirCatchLog.info("Session resumed (\(isRemote ? "remote" : "local"))", category: .network)
+        return issueResumeTicket(for: session.ack, isRemote: isRemote, capabilities: session.capabilities)
+    }
+    
+    // MARK: - Viewer Capabilities
+    
+    /// Records what `viewer` negotiated (nil when it left). Frames are encoded and
+    /// packetized once for everyone watching, so each format is used only while
+    /// every connected viewer negotiated it.
+    private func setViewerCapabilities(_ capabilities: ViewerCapabilities?, for viewer: ViewerKey) {
+        viewerCapabilities[viewer] = capabilities
+        let viewers = viewerCapabilities.values
+        dirtyRegionsEnabled = !viewers.isEmpty && viewers.allSatisfy(\.dirtyRegions)
+        frameLayersEnabled = !viewers.isEmpty && viewers.allSatisfy(\.frameLayers)
+        segmentedSealingEnabled = !viewers.isEmpty && viewers.allSatisfy(\.segmentedSealing)
+        screenStreamer?.includesDirtyRegions = dirtyRegionsEnabled
+    }
+
+    /// Lets a local viewer's UDP video keep sent frames for NACK retransmits. Viewers
+    /// without lossless video don't, so pooled frame buffers recycle as soon as they're sent.
+    /// A resumed client can connect again before its old connection is noticed as dropped,
+    /// so a viewer id keeps retransmits while any of its connections asked for them.
+    private func setRetransmits(_ enabled: Bool, for connection: NWConnection) {
+        let key = ObjectIdentifier(connection)
+        guard let viewerId = retransmitConnections[key] ?? Self.fanoutViewerId(for: connection) else { return }
+        retransmitConnections[key] = enabled ? viewerId : nil
+        videoFanout.setRetransmits(retransmitConnections.values.contains(viewerId), forViewer: viewerId)
+    }
+
+    /// Fan-out viewers are keyed by client IP, which the TCP control connection shares.
+    private nonisolated static func fanoutViewerId(for connection: NWConnection) -> String? {
+        let endpoint = connection.currentPath?.remoteEndpoint ?? connection.endpoint
+        guard case .hostPort(let host, _) = endpoint else { return nil }
+        return "\(host)"
+    }
+    
     // MARK: - Adaptive Bitrate Logic
     
     private var currentRemoteBitrate: Int = 6_000_000
@@ -791,53 +1035,56 @@ final class HostManager: ObservableObject {
             return
         }
         
+        applyTouchEvent(touch)
+    }
+    
+    private func applyTouchEvent(_ touch: TouchEvent) {
         #if DEBUG
         AirCatchLog.debug("Received touch: type=\(touch.eventType)", category: .input)
         #endif
         
-        Task { @MainActor in
-            // Get the target display frame (virtual display if active, otherwise main)
-            let screenFrame = self.targetDisplayFrame()
-
-            // With virtual display, touch mapping is direct (1:1 pixel-perfect)
-            // No letterboxing adjustment needed as the virtual display matches iPad exactly
-            var finalNormX = touch.normalizedX
-            var finalNormY = touch.normalizedY
-
-            // Only adjust for letterboxing if NOT using virtual display
-            // (i.e., when streaming main display with different aspect ratio)
-            if !virtualDisplayManager.isVirtualDisplayActive {
-                if let (clientW, clientH) = self.currentClientDimensions, clientW > 0, clientH > 0 {
-                    let hostW = screenFrame.width
-                    let hostH = screenFrame.height
-
-                    if hostW > 0 && hostH > 0 {
-                        let hostAspect = hostW / hostH
-                        let clientAspect = Double(clientW) / Double(clientH)
-
-                        if hostAspect > clientAspect {
-                            let coverageH = clientAspect / hostAspect
-                            let barH = (1.0 - coverageH) / 2.0
-                            finalNormY = (touch.normalizedY - barH) / coverageH
-                        } else {
-                            let coverageW = hostAspect / clientAspect
-                            let barW = (1.0 - coverageW) / 2.0
-                            finalNormX = (touch.normalizedX - barW) / coverageW
-                        }
+        // Get the target display frame (virtual display if active, otherwise main)
+        let screenFrame = self.targetDisplayFrame()
+
+        // With virtual display, touch mapping is direct (1:1 pixel-perfect)
+        // No letterboxing adjustment needed as the virtual display matches iPad exactly
+        var finalNormX = touch.normalizedX
+        var finalNormY = touch.normalizedY
+
+        // Only adjust for letterboxing if NOT using virtual display
+        // (i.e., when streaming main display with different aspect ratio)
+        if !virtualDisplayManager.isVirtualDisplayActive {
+            if let (clientW, clientH) = self.currentClientDimensions, clientW > 0, clientH > 0 {
+                let hostW = screenFrame.width
+                let hostH = screenFrame.height
+
+                if hostW > 0 && hostH > 0 {
+                    let hostAspect = hostW / hostH
+                    let clientAspect = Double(clientW) / Double(clientH)
+
+                    if hostAspect > clientAspect {
+                        let coverageH = clientAspect / hostAspect
+                        let barH = (1.0 - coverageH) / 2.0
+                        finalNormY = (touch.normalizedY - barH) / coverageH
+                    } else {
+                        let coverageW = hostAspect / clientAspect
+                        let barW = (1.0 - coverageW) / 2.0
+                        finalNormX = (touch.normalizedX - barW) / coverageW
                     }
                 }
             }
+        }
 
-            finalNormX = max(0, min(1, finalNormX))
-            finalNormY = max(0, min(1, finalNormY))
+        finalNormX = max(0, min(1, finalNormX))
+        finalNormY = max(0, min(1, finalNormY))
 
-            InputInjector.shared.injectClick(
-                xPercent: finalNormX,
-                yPercent: finalNormY,
-                eventType: touch.eventType,
-                in: screenFrame
-            )
-        }
+        inputScheduler.submitPointer(
+            x: finalNormX,
+            y: finalNormY,
+            eventType: touch.eventType,
+            in: screenFrame,
+            timestamp: touch.timestamp
+        )
     }
     
     /// Returns the frame of the target display (virtual or main)
@@ -866,24 +1113,16 @@ final class HostManager: ObservableObject {
             #endif
             return
         }
-        
+        applyScrollEvent(scroll)
+    }
+    
+    private func applyScrollEvent(_ scroll: ScrollEvent) {
         #if DEBUG
         AirCatchLog.debug("Received scroll event: deltaX=\(scroll.deltaX), deltaY=\(scroll.deltaY)", category: .input)
         #endif
         
-        Task { @MainActor in
-            // Get current mouse position for scroll location
-            let mouseLocation = NSEvent.mouseLocation
-            // Convert to screen coordinates (flip Y for CoreGraphics)
-            if let screen = NSScreen.main {
-                let cgPoint = CGPoint(x: mouseLocation.x, y: screen.frame.height - mouseLocation.y)
-                InputInjector.shared.injectScroll(
-                    deltaX: Int32(scroll.deltaX),
-                    deltaY: Int32(scroll.deltaY),
-                    at: cgPoint
-                )
-            }
-        }
+        // Deltas within one display refresh are summed and injected at the cursor
+        inputScheduler.submitScroll(deltaX: scroll.deltaX, deltaY: scroll.deltaY)
     }
     
     private func handleKeyEvent(_ payload: Data) {
@@ -893,7 +1132,10 @@ final class HostManager: ObservableObject {
             #endif
             return
         }
-        
+        applyKeyEvent(keyEvent)
+    }
+    
+    private func applyKeyEvent(_ keyEvent: KeyEvent) {
         #if DEBUG
         AirCatchLog.debug("Received key event: keyCode=\(keyEvent.keyCode) char=\(keyEvent.character ?? "") down=\(keyEvent.isKeyDown)", category: .input)
         #endif
@@ -901,17 +1143,19 @@ final class HostManager: ObservableObject {
         // Check if this is a text injection event (Voice Typing)
         if let character = keyEvent.character, !character.isEmpty, keyEvent.keyCode == 0 {
             // KeyCode 0 with a character string is our signal for "Injection"
-            Task { @MainActor in
+            inputScheduler.submitOrdered {
                 InputInjector.shared.injectText(character)
             }
             return
         }
         
-        InputInjector.shared.injectKeyEvent(
-            keyCode: keyEvent.keyCode,
-            modifiers: keyEvent.modifiers,
-            isKeyDown: keyEvent.isKeyDown
-        )
+        inputScheduler.submitOrdered {
+            InputInjector.shared.injectKeyEvent(
+                keyCode: keyEvent.keyCode,
+                modifiers: keyEvent.modifiers,
+                isKeyDown: keyEvent.isKeyDown
+            )
+        }
     }
     
     private func handleMediaKeyEvent(_ payload: Data) {
@@ -921,12 +1165,47 @@ final class HostManager: ObservableObject {
             #endif
             return
         }
-        
+        applyMediaKeyEvent(mediaEvent)
+    }
+    
+    private func applyMediaKeyEvent(_ mediaEvent: MediaKeyEvent) {
         #if DEBUG
         AirCatchLog.debug("Received media key event: mediaKey=\(mediaEvent.mediaKey)", category: .input)
         #endif
         
-        InputInjector.shared.injectMediaKeyEvent(mediaKey: mediaEvent.mediaKey)
+        inputScheduler.submitOrdered {
+            InputInjector.shared.injectMediaKeyEvent(mediaKey: mediaEvent.mediaKey)
+        }
+    }
+    
+    /// Handles an encrypted `.inputBatch` from the UDP input lane (or its TCP copy).
+    /// Batches that fail to decrypt are dropped, so the lane only accepts paired clients.
+    private func handleInputBatch(_ payload: Data) {
+        guard crypto.isReady,
+              let decrypted = crypto.decrypt(payload),
+              let batch = try? JSONDecoder().decode(InputBatch.self, from: decrypted) else {
+            #if DEBUG
+            AirCatchLog.error("Dropped undecodable input batch", category: .input)
+            #endif
+            return
+        }
+        
+        for event in batch.events {
+            let isPointerMotion = event.touch.map { $0.eventType == .moved || $0.eventType == .dragMoved } ?? false
+            guard inputScheduler.accept(sequenceNumber: event.sequenceNumber, isPointerMotion: isPointerMotion, lane: batch.laneId) else {
+                continue
+            }
+            
+            if let touch = event.touch {
+                applyTouchEvent(touch)
+            } else if let scroll = event.scroll {
+                applyScrollEvent(scroll)
+            } else if let key = event.key {
+                applyKeyEvent(key)
+            } else if let mediaKey = event.mediaKey {
+                applyMediaKeyEvent(mediaKey)
+            }
+        }
     }
 
     private nonisolated func handleClientDisconnect(_ connection: NWConnection) {
@@ -934,11 +1213,13 @@ final class HostManager: ObservableObject {
         
         Task { @MainActor in
             connectedClients = max(0, connectedClients - 1)
+            setViewerCapabilities(nil, for: .connection(ObjectIdentifier(connection)))
+            setRetransmits(false, for: connection)
             postStatusChange()
             
-            // Stop streaming if no clients
+            // Stop streaming if no clients (after the resume window)
             if connectedClients == 0 {
-                stopStreamingAndRestore()
+                parkSession()
             }
         }
     }
@@ -955,6 +1236,7 @@ final class HostManager: ObservableObject {
         audioEnabled: Bool = false
     ) async {
         guard screenStreamer == nil else { return }
+        streamStartup = StreamStartup(requestedAt: ProcessInfo.processInfo.systemUptime)
         
         if let w = clientMaxWidth, let h = clientMaxHeight {
             self.currentClientDimensions = (w, h)
@@ -974,6 +1256,7 @@ final class HostManager: ObservableObject {
         // - Apply preset resolution with 2x HiDPI scaling
         // - Match iPad's ~4:3 aspect ratio to avoid letterboxing
         var virtualDisplayID: CGDirectDisplayID? = nil
+        var displayReady: Task<Bool, Never>? = nil
         if !remoteSessionActive, !optimizeForHostDisplay,
            let w = clientMaxWidth, let h = clientMaxHeight, w > 0, h > 0 {
             // Pass device model for better iPad detection (Sidecar-like hardware handshake)
@@ -983,8 +1266,12 @@ final class HostManager: ObservableObject {
                 deviceModel: deviceModel
             )
             if virtualDisplayID != nil {
-                // Wait for virtual display to be ready
-                try? await Task.sleep(for: .milliseconds(500))
+                // Capture waits for the display to come online; the encoder doesn't
+                displayReady = Task { [weak self, virtualDisplayManager] in
+                    let ready = await virtualDisplayManager.waitUntilReady()
+                    self?.streamStartup?.displayReadyAt = ProcessInfo.processInfo.systemUptime
+                    return ready
+                }
                 AirCatchLog.info("✅ Using Sidecar-like virtual display: \(virtualDisplayManager.presetName)", category: .video)
             } else {
                 AirCatchLog.info("Virtual display unavailable, using main display", category: .video)
@@ -1004,17 +1291,29 @@ final class HostManager: ObservableObject {
             codecOverride: remoteSessionActive ? remoteCodecPreference : nil,
             audioEnabled: audioEnabled,
             optimizeForHostDisplay: optimizeForHostDisplay,
-            onFrame: { [weak self] compressedFrame in
-                self?.broadcastVideoFrame(compressedFrame)
+            includesDirtyRegions: dirtyRegionsEnabled,
+            onFrame: { [weak self] compressedFrame, tag in
+                self?.broadcastVideoFrame(compressedFrame, tag: tag)
             },
             onAudio: audioEnabled ? { [weak self] audioData in
                 self?.broadcastAudioFrame(audioData)
             } : nil
         )
-
+        let streamer = screenStreamer
+        streamer?.onFirstFrame = { [weak self, weak streamer] firstFrameAt in
+            Task { @MainActor in
+                guard let self, let streamer, streamer === self.screenStreamer else { return }
+                self.reportStreamStartup(of: streamer, firstFrameAt: firstFrameAt)
+            }
+        }
+        
+        // Network warm-up: local viewers get their send queues while the encoder and display start
+        if !remoteSessionActive {
+            videoFanout.prepare(networkManager.udpViewerConnections())
+        }
         
         do {
-            try await screenStreamer?.start()
+            try await streamer?.start(after: displayReady)
             isStreaming = true
             postStatusChange()
             
@@ -1022,6 +1321,7 @@ final class HostManager: ObservableObject {
         } catch {
             AirCatchLog.error("Failed to start streaming: \(error)", category: .video)
             screenStreamer = nil
+            streamStartup = nil
             
             // Check for Screen Capture permission error (SCStreamErrorDomain Code=-3801)
             let nsError = error as NSError
@@ -1045,56 +1345,92 @@ final class HostManager: ObservableObject {
         }
     }
     
+    /// Logs the startup breakdown of the stream that just produced its first frame
+    /// and sends it to the client (`streamStartupReport`).
+    private func reportStreamStartup(of streamer: ScreenStreamer, firstFrameAt: TimeInterval) {
+        guard let startup = streamStartup else { return }
+        streamStartup = nil
+        
+        func milliseconds(_ time: TimeInterval) -> Int {
+            Int(((time - startup.requestedAt) * 1000).rounded())
+        }
+        let report = StreamStartupReport(
+            displayReadyMs: startup.displayReadyAt.map(milliseconds),
+            encoderReadyMs: milliseconds(streamer.encoderReadyAt ?? firstFrameAt),
+            // The first frame can be encoded before startCapture() returns
+            captureStartedMs: milliseconds(min(streamer.captureStartedAt ?? firstFrameAt, firstFrameAt)),
+            firstFrameMs: milliseconds(firstFrameAt)
+        )
+        
+        let display = report.displayReadyMs.map { "display \($0) ms, " } ?? ""
+        AirCatchLog.info("Stream startup: \(display)encoder \(report.encoderReadyMs) ms, capture \(report.captureStartedMs) ms, time to first frame \(report.firstFrameMs) ms", category: .video)
+        
+        guard let data = try? JSONEncoder().encode(report) else { return }
+        if remoteSessionActive {
+            remoteTransport.sendTCP(type: .streamStartupReport, payload: data)
+        } else {
+            networkManager.broadcastTCP(type: .streamStartupReport, payload: data)
+        }
+    }
+    
     private func stopStreaming() {
+        streamStartup = nil
         screenStreamer?.stop()
         screenStreamer = nil
+        inputScheduler.reset()
+        inputScheduler.resetAllLanes()
+        videoFanout.removeAll()
         isStreaming = false
         
         postStatusChange()
         AirCatchLog.info("Screen streaming stopped", category: .video)
+        #if DEBUG
+        let pool = FrameBufferPool.shared.drainStatistics()
+        AirCatchLog.debug("Frame buffers: \(pool.reused) reused, \(pool.allocated) allocated", category: .video)
+        #endif
     }
     
 
     // Dedicated queue for video broadcasting to avoid blocking compression
     private let broadcastQueue = DispatchQueue(label: "com.aircatch.broadcast", qos: .userInteractive)
 
-    private nonisolated func pruneCachedFramesIfNeeded(now: TimeInterval = Date().timeIntervalSinceReferenceDate) {
-        // Must be called on cachedFramesQueue
-        guard !cachedFrames.isEmpty else { return }
+    // Changed per instructions:
+    private func broadcastVideoFrame(_ data: Data, tag: FrameLayerTag) {
+        // Remote: skip frames the WebSocket queue can't take, droppable layers first
+        if remoteSessionActive {
+            switch remoteTransport.admitVideoFrame(tag, frameBytes: data.count) {
+            case .send:
+                break
+            case .thin:
+                return
+            case .drop:
+                screenStreamer?.requestKeyframe()
+                return
+            }
+        }
 
-        let oldKeys = cachedFrames
-            .filter { now - $0.value.createdAt > AirCatchConfig.frameCacheTTL }
-            .map { $0.key }
-        for key in oldKeys { cachedFrames.removeValue(forKey: key) }
-    }
+        // Local TCP delivery: seal straight behind the packet header, so the frame is copied once
+        if !remoteSessionActive && !preferLowLatency && crypto.isReady {
+            let sealedSize = CryptoManager.sealedSize(of: data.count, segmented: segmentedSealingEnabled)
+            let header = NetworkManager.tcpHeader(type: .videoFrame, payloadLength: sealedSize)
+            if let packet = crypto.encrypt(data, prefix: header, segmented: segmentedSealingEnabled) {
+                NetworkManager.shared.broadcastTCP(packet: packet)
+                return
+            }
+        }
 
-    private nonisolated func cacheFrameForRetransmit(frameId: UInt32, totalChunks: Int, chunksByIndex: [Int: Data]) {
-        // Must be called on cachedFramesQueue
-        // Note: losslessVideoEnabled is checked before calling this from broadcastVideoFrame
-        // Prune only every 60 frames (once per second at 60fps) for performance
-        if frameId % UInt32(AirCatchConfig.cachePruneInterval) == 0 {
-            pruneCachedFramesIfNeeded()
-        }
-        cachedFrames[frameId] = CachedFrame(
-            createdAt: Date().timeIntervalSinceReferenceDate,
-            totalChunks: totalChunks,
-            chunksByIndex: chunksByIndex
-        )
-    }
-    
-    // Changed per instructions:
-    private func broadcastVideoFrame(_ data: Data) {
         // E2EE: Encrypt video data if crypto is ready
         let frameData: Data
-        if crypto.isReady, let encrypted = crypto.encrypt(data) {
+        if crypto.isReady, let encrypted = crypto.encrypt(data, segmented: segmentedSealingEnabled) {
             frameData = encrypted
         } else {
             frameData = data  // Fallback to unencrypted (shouldn't happen after handshake)
         }
         
-        // Remote mode: always send complete frames via TCP (WebSocket is already TCP-based)
-        // Chunking over WebSocket creates too many messages and overwhelms the connection
-        if remoteSessionActive {
+        // Remote mode over the WebSocket relay: send complete frames via TCP
+        // Chunking over WebSocket creates too many messages and overwhelms the connection.
+        // With a direct or relayed UDP path, remote frames are chunked like local ones.
+        if remoteSessionActive && !remoteTransport.hasDatagramPath {
             remoteTransport.sendTCP(type: .videoFrame, payload: frameData)
             return
         }
@@ -1111,8 +1447,9 @@ final class HostManager: ObservableObject {
 
         // Capture main-actor state needed for the background send.
         let maxPayloadSize = maxUDPPayloadSize
-        let shouldCacheForRetransmit = losslessVideoEnabled
         let isRemoteSession = remoteSessionActive
+        let chunkType: PacketType = frameLayersEnabled ? .videoFrameChunkLayered : .videoFrameChunk
+        let headerSize = frameLayersEnabled ? 9 : 8
         
         // Dispatch to avoid blocking the compression callback thread
         let dataToChunk = frameData  // Use encrypted data for chunking
@@ -1132,49 +1469,56 @@ final class HostManager: ObservableObject {
                 AirCatchLog.debug("Broadcasting Frame \(frameId): \(totalLen) bytes, \(totalChunks) chunks", category: .video)
             }
             
-            // Fragment and send
-            var chunksForCache: [Int: Data] = [:]
-            if shouldCacheForRetransmit {
-                chunksForCache.reserveCapacity(totalChunks)
+            // Lay every chunk out back to back in one pooled buffer; each datagram is a slice of it.
+            // Local viewers get complete datagrams; the remote transport adds its own type byte.
+            let prefixSize = isRemoteSession ? headerSize : 1 + headerSize
+            let slab = FrameBufferPool.shared.makeData(capacity: totalChunks * prefixSize + totalLen) { buffer in
+                dataToChunk.withUnsafeBytes { source in
+                    var written = 0
+                    for i in 0..<totalChunks {
+                        let start = i * maxPayloadSize
+                        let count = min(maxPayloadSize, totalLen - start)
+                        let packet = buffer.baseAddress!.advanced(by: written)
+                        var cursor = 0
+
+                        if !isRemoteSession {
+                            packet.storeBytes(of: chunkType.rawValue, as: UInt8.self)
+                            cursor += 1
+                        }
+                        // Header: [FrameId: 4][ChunkIdx: 2][TotalChunks: 2], plus [Tag: 1] when layered
+                        packet.storeBytes(of: frameId.bigEndian, toByteOffset: cursor, as: UInt32.self)
+                        packet.storeBytes(of: UInt16(i).bigEndian, toByteOffset: cursor + 4, as: UInt16.self)
+                        packet.storeBytes(of: UInt16(totalChunks).bigEndian, toByteOffset: cursor + 6, as: UInt16.self)
+                        if headerSize == 9 {
+                            packet.storeBytes(of: tag.byte, toByteOffset: cursor + 8, as: UInt8.self)
+                        }
+                        cursor += headerSize
+                        packet.advanced(by: cursor).copyMemory(from: source.baseAddress!.advanced(by: start), byteCount: count)
+                        written += cursor + count
+                    }
+                    return written
+                }
             }
+
+            var datagrams: [Data] = []
+            datagrams.reserveCapacity(totalChunks)
+            var offset = slab.startIndex
             for i in 0..<totalChunks {
-                let start = i * maxPayloadSize
-                let end = min(start + maxPayloadSize, totalLen)
-                let chunkData = dataToChunk.subdata(in: start..<end)
-                
-                var packet = Data()
-                packet.reserveCapacity(8 + chunkData.count)
-                
-                // Header: [FrameId: 4][ChunkIdx: 2][TotalChunks: 2]
-                var fId = frameId.bigEndian
-                var idx = UInt16(i).bigEndian
-                var total = UInt16(totalChunks).bigEndian
-
-                withUnsafeBytes(of: &fId) { packet.append(contentsOf: $0) }
-                withUnsafeBytes(of: &idx) { packet.append(contentsOf: $0) }
-                withUnsafeBytes(of: &total) { packet.append(contentsOf: $0) }
-                packet.append(chunkData)
-                
-                // Send chunk via UDP (remote relay or local broadcast)
+                let end = offset + prefixSize + min(maxPayloadSize, totalLen - i * maxPayloadSize)
+                // Remote chunks go straight out; local ones are paced per viewer
                 if isRemoteSession {
-                    self.remoteTransport.sendUDP(type: .videoFrameChunk, payload: packet)
+                    self.remoteTransport.sendUDP(type: chunkType, payload: slab[offset..<end])
                 } else {
-                    NetworkManager.shared.broadcastUDP(type: .videoFrameChunk, payload: packet)
-                }
-
-                if shouldCacheForRetransmit {
-                    chunksForCache[i] = packet
+                    datagrams.append(slab[offset..<end])
                 }
+                offset = end
             }
 
-            if shouldCacheForRetransmit {
-                let chunksSnapshot = chunksForCache
-                let frameIdCopy = frameId
-                let totalChunksCopy = totalChunks
-                self.cachedFramesQueue.async {
-                    self.cacheFrameForRetransmit(frameId: frameIdCopy, totalChunks: totalChunksCopy, chunksByIndex: chunksSnapshot)
-                }
-            }
+            guard !isRemoteSession else { return }
+            self.videoFanout.submit(
+                VideoFanout.Frame(frameId: frameId, tag: tag, datagrams: datagrams),
+                to: NetworkManager.shared.udpViewerConnections()
+            )
         }
     }
     
@@ -1207,33 +1551,14 @@ final class HostManager: ObservableObject {
             #endif
             return
         }
-        guard let request else { return }
-
-        guard losslessVideoEnabled else { return }
-
-        let endpoint = connection.currentPath?.remoteEndpoint ?? connection.endpoint
-        guard case .hostPort(let host, _) = endpoint else { return }
-        let hostString = "\(host)"
-
-        guard let udpEndpoint = NetworkManager.shared.udpEndpoint(forHostString: hostString) else {
-            return
-        }
+        guard let request, let viewerId = Self.fanoutViewerId(for: connection) else { return }
 
-        // Thread-safe access to cached frames
-        cachedFramesQueue.async { [weak self] in
-            guard let self else { return }
-            guard let cached = self.cachedFrames[request.frameId] else { return }
-
-            let payloadsToResend: [Data] = request.missingChunkIndices.compactMap { idx in
-                cached.chunksByIndex[Int(idx)]
-            }
-
-            self.broadcastQueue.async {
-                for payload in payloadsToResend {
-                    NetworkManager.shared.sendUDP(to: udpEndpoint, type: .videoFrameChunk, payload: payload)
-                }
-            }
-        }
+        // Resent on the viewer's own flow, behind its pacer (if it keeps sent frames)
+        videoFanout.handleNack(
+            viewerId: viewerId,
+            frameId: request.frameId,
+            missingChunkIndices: request.missingChunkIndices
+        )
     }
     
     // MARK: - Notifications
@@ -0,0 +1,123 @@
+//
+//  InputCoalescer.swift
+//  AirCatchHost
+//
+//  Refresh-aligned coalescing decisions for pointer motion and scroll.
+//
+
+import Foundation
+
+/// Decides when pointer motion and scroll are injected relative to display refreshes.
+///
+/// The first event of a refresh is injected at once, so an isolated move or
+/// scroll costs no added latency. Whatever follows it within the same refresh is
+/// held: pointer motion keeps only the newest position, scroll deltas are summed,
+/// and the result is due at the next refresh boundary. A burst that arrives after
+/// a Wi-Fi stall therefore lands in one step per refresh instead of replaying in
+/// slow motion. Pointer and scroll are gated independently.
+///
+/// Holds no timer and touches no platform API; `InputScheduler` drives it from a
+/// display link, and traces can be replayed against it off-device.
+nonisolated struct InputCoalescer<Pointer> {
+
+    struct HeldPointer {
+        let value: Pointer
+        /// Motion of different kinds (hover, drag) never merges
+        let kind: Int
+        /// Receipt time of the oldest event folded into this one
+        let receivedAt: TimeInterval
+    }
+
+    struct Scroll: Equatable {
+        var deltaX: Double
+        var deltaY: Double
+    }
+
+    /// Input to inject now, pointer first.
+    struct Due {
+        var pointer: HeldPointer?
+        var scroll: Scroll?
+    }
+
+    private(set) var heldPointer: HeldPointer?
+    private(set) var heldScroll: Scroll?
+    private var pointerInjectedThisRefresh = false
+    private var scrollInjectedThisRefresh = false
+
+    /// Events folded into a newer one before injection
+    private(set) var coalescedCount = 0
+
+    /// True while refresh ticks matter: input is held, or the current refresh already injected some.
+    /// When false the display link can pause; the next event is injected immediately.
+    var needsRefresh: Bool {
+        heldPointer != nil || heldScroll != nil || pointerInjectedThisRefresh || scrollInjectedThisRefresh
+    }
+
+    /// - Returns: Motion to inject now: this event, or an older one of another kind. Nil when held.
+    mutating func submitPointer(_ value: Pointer, kind: Int, receivedAt: TimeInterval) -> HeldPointer? {
+        if let held = heldPointer {
+            if held.kind == kind {
+                coalescedCount += 1
+                heldPointer = HeldPointer(value: value, kind: kind, receivedAt: held.receivedAt)
+                return nil
+            }
+            // Hover and drag don't merge; the older kind goes first and this one waits its turn
+            heldPointer = HeldPointer(value: value, kind: kind, receivedAt: receivedAt)
+            return held
+        }
+
+        let pointer = HeldPointer(value: value, kind: kind, receivedAt: receivedAt)
+        guard !pointerInjectedThisRefresh else {
+            heldPointer = pointer
+            return nil
+        }
+        pointerInjectedThisRefresh = true
+        return pointer
+    }
+
+    /// - Returns: The delta to inject now, or nil when it was added to the held sum.
+    mutating func submitScroll(deltaX: Double, deltaY: Double) -> Scroll? {
+        if var held = heldScroll {
+            held.deltaX += deltaX
+            held.deltaY += deltaY
+            heldScroll = held
+            coalescedCount += 1
+            return nil
+        }
+        guard !scrollInjectedThisRefresh else {
+            heldScroll = Scroll(deltaX: deltaX, deltaY: deltaY)
+            return nil
+        }
+        scrollInjectedThisRefresh = true
+        return Scroll(deltaX: deltaX, deltaY: deltaY)
+    }
+
+    /// Everything held, for injection ahead of an order-sensitive event.
+    mutating func flush() -> Due {
+        let due = Due(pointer: heldPointer, scroll: heldScroll)
+        if heldPointer != nil { pointerInjectedThisRefresh = true }
+        if heldScroll != nil { scrollInjectedThisRefresh = true }
+        heldPointer = nil
+        heldScroll = nil
+        return due
+    }
+
+    /// A display refresh started: held input is due, and a stream that held
+    /// nothing may inject its next event immediately again.
+    mutating func refresh() -> Due {
+        let due = Due(pointer: heldPointer, scroll: heldScroll)
+        pointerInjectedThisRefresh = heldPointer != nil
+        scrollInjectedThisRefresh = heldScroll != nil
+        heldPointer = nil
+        heldScroll = nil
+        return due
+    }
+
+    /// Drops held input (disconnect, new handshake).
+    mutating func reset() {
+        heldPointer = nil
+        heldScroll = nil
+        pointerInjectedThisRefresh = false
+        scrollInjectedThisRefresh = false
+    }
+}
@@ -0,0 +1,321 @@
+//
+//  InputScheduler.swift
+//  AirCatchHost
+//
+//  Coalesces pointer motion and scroll per display refresh before injection.
+//
+
+import Foundation
+import CoreGraphics
+import AppKit
+import QuartzCore
+
+/// Sits between the network handlers and `InputInjector`.
+///
+/// Move/drag and scroll events go through an `InputCoalescer` clocked by the
+/// display link: the first event of a refresh is injected right away, and the
+/// ones after it in the same refresh collapse into one injection at the next
+/// refresh. The link only runs while motion is in flight. Button, click and key
+/// transitions are never coalesced; held motion is flushed first so their order
+/// relative to motion is kept.
+@MainActor
+final class InputScheduler {
+
+    // MARK: - Configuration
+
+    /// How far ahead to extrapolate pointer motion (seconds). 0 disables prediction.
+    var predictionHorizon: TimeInterval = AirCatchConfig.inputPredictionHorizon
+
+    // MARK: - Coalescing
+
+    private struct PointerEvent {
+        let x: Double
+        let y: Double
+        let eventType: TouchEventType
+        let screenFrame: CGRect
+    }
+
+    private var coalescer = InputCoalescer<PointerEvent>()
+    private lazy var refreshTicker = RefreshTicker { [weak self] in
+        self?.refreshDidStart()
+    }
+
+    /// Last two client-side pointer samples for velocity estimation
+    private var lastSample: (x: Double, y: Double, timestamp: TimeInterval)?
+    private var velocity: (x: Double, y: Double) = (0, 0)
+
+    // MARK: - Sequencing
+
+    /// Recently applied input-lane sequence numbers of one client, bounded by `capacity`
+    private struct SequenceWindow {
+        private var seen = Set<UInt32>()
+        private var order: [UInt32] = []
+        private var head = 0
+        private var highestMotion: UInt32 = 0
+        private let capacity = 512
+
+        mutating func accept(_ sequenceNumber: UInt32, isPointerMotion: Bool) -> Bool {
+            guard !seen.contains(sequenceNumber) else { return false }
+            if isPointerMotion {
+                guard sequenceNumber > highestMotion else { return false }
+                highestMotion = sequenceNumber
+            }
+
+            seen.insert(sequenceNumber)
+            if order.count < capacity {
+                order.append(sequenceNumber)
+            } else {
+                seen.remove(order[head])
+                order[head] = sequenceNumber
+                head = (head + 1) % capacity
+            }
+            return true
+        }
+    }
+
+    /// Sequence windows by `InputBatch.laneId`, so clients never filter each other's input.
+    /// Clients pick a fresh lane ID per session; `legacyLane` serves those that send none.
+    private var sequenceWindows: [UInt32: SequenceWindow] = [:]
+    /// Lane IDs, least recently used first
+    private var laneOrder: [UInt32] = []
+    private let maxLanes = 16
+    private let legacyLane: UInt32 = 0
+
+    // MARK: - Statistics
+
+    /// Motion events replaced by a newer one before injection
+    var coalescedEventCount: Int { coalescer.coalescedCount }
+    /// Events handed to `InputInjector`
+    private(set) var injectedEventCount = 0
+    /// Time from receipt to injection for the most recent motion event (seconds)
+    private(set) var lastInjectionLag: TimeInterval = 0
+    /// Largest receipt-to-injection delay seen so far (seconds)
+    private(set) var maxInjectionLag: TimeInterval = 0
+
+    // MARK: - Submission
+
+    /// Submits a pointer event in normalized (0-1) coordinates of `screenFrame`.
+    /// - Parameter timestamp: Client-side event time, used for velocity estimation.
+    func submitPointer(x: Double, y: Double, eventType: TouchEventType, in screenFrame: CGRect, timestamp: TimeInterval) {
+        let now = ProcessInfo.processInfo.systemUptime
+
+        switch eventType {
+        case .moved, .dragMoved:
+            updateVelocity(x: x, y: y, timestamp: timestamp)
+            let event = PointerEvent(x: x, y: y, eventType: eventType, screenFrame: screenFrame)
+            if let due = coalescer.submitPointer(event, kind: eventType == .dragMoved ? 1 : 0, receivedAt: now) {
+                inject(due, at: now)
+            }
+            refreshTicker.resume()
+
+        default:
+            // Transitions use the exact reported position, never a prediction
+            flushPending()
+            lastSample = nil
+            velocity = (0, 0)
+            InputInjector.shared.injectClick(xPercent: x, yPercent: y, eventType: eventType, in: screenFrame)
+            injectedEventCount += 1
+        }
+    }
+
+    /// Submits a scroll delta. Deltas arriving after the first one of a refresh are summed.
+    func submitScroll(deltaX: Double, deltaY: Double) {
+        if let due = coalescer.submitScroll(deltaX: deltaX, deltaY: deltaY) {
+            inject(due)
+        }
+        refreshTicker.resume()
+    }
+
+    /// Runs an order-sensitive injection (keys, text, media keys) after pending motion.
+    func submitOrdered(_ inject: () -> Void) {
+        flushPending()
+        inject()
+        injectedEventCount += 1
+    }
+
+    /// Drops anything not yet injected (e.g. on disconnect or a new handshake).
+    /// Of the sequence windows only the legacy lane restarts; other clients' windows
+    /// are untouched, and a client that handshakes again arrives on a new lane.
+    func reset() {
+        coalescer.reset()
+        refreshTicker.pause()
+        lastSample = nil
+        velocity = (0, 0)
+        forgetLane(legacyLane)
+    }
+
+    /// Forgets every client's sequence window (streaming stopped).
+    func resetAllLanes() {
+        sequenceWindows.removeAll()
+        laneOrder.removeAll()
+    }
+
+    /// Filters sequenced input-lane events before they are submitted.
+    /// - Parameter lane: The batch's lane ID; nil for clients that predate lanes.
+    /// - Returns: false for duplicates (redundant datagrams, TCP copies) and for
+    ///   pointer motion older than motion already applied on the same lane.
+    func accept(sequenceNumber: UInt32, isPointerMotion: Bool, lane: UInt32?) -> Bool {
+        let lane = lane ?? legacyLane
+        if let index = laneOrder.firstIndex(of: lane) {
+            laneOrder.remove(at: index)
+        } else if laneOrder.count >= maxLanes {
+            sequenceWindows[laneOrder.removeFirst()] = nil
+        }
+        laneOrder.append(lane)
+
+        return sequenceWindows[lane, default: SequenceWindow()].accept(sequenceNumber, isPointerMotion: isPointerMotion)
+    }
+
+    private func forgetLane(_ lane: UInt32) {
+        sequenceWindows[lane] = nil
+        laneOrder.removeAll { $0 == lane }
+    }
+
+    // MARK: - Flushing
+
+    /// Injects held motion immediately.
+    func flushPending() {
+        let due = coalescer.flush()
+        let now = ProcessInfo.processInfo.systemUptime
+        if let pointer = due.pointer {
+            inject(pointer, at: now)
+        }
+        if let scroll = due.scroll {
+            inject(scroll)
+        }
+    }
+
+    /// Display link tick: held motion is due; the link pauses once a refresh passes without input.
+    private func refreshDidStart() {
+        let due = coalescer.refresh()
+        let now = ProcessInfo.processInfo.systemUptime
+        if let pointer = due.pointer {
+            inject(pointer, at: now)
+        }
+        if let scroll = due.scroll {
+            inject(scroll)
+        }
+        if !coalescer.needsRefresh {
+            refreshTicker.pause()
+        }
+    }
+
+    private func inject(_ held: InputCoalescer<PointerEvent>.HeldPointer, at now: TimeInterval) {
+        let event = held.value
+        var x = event.x
+        var y = event.y
+        if predictionHorizon > 0 {
+            x = max(0, min(1, x + velocity.x * predictionHorizon))
+            y = max(0, min(1, y + velocity.y * predictionHorizon))
+        }
+
+        InputInjector.shared.injectClick(
+            xPercent: x,
+            yPercent: y,
+            eventType: event.eventType,
+            in: event.screenFrame
+        )
+        injectedEventCount += 1
+
+        lastInjectionLag = now - held.receivedAt
+        maxInjectionLag = max(maxInjectionLag, lastInjectionLag)
+
+        #if DEBUG
+        if injectedEventCount % 600 == 0 {
+            AirCatchLog.debug("Input: \(injectedEventCount) injected, \(coalescedEventCount) coalesced, lag \(Int(lastInjectionLag * 1000))ms (max \(Int(maxInjectionLag * 1000))ms)", category: .input)
+        }
+        #endif
+    }
+
+    private func inject(_ scroll: InputCoalescer<PointerEvent>.Scroll) {
+        // Scroll at the current cursor location (flip Y for CoreGraphics)
+        guard let screen = NSScreen.main else { return }
+        let mouseLocation = NSEvent.mouseLocation
+        let cgPoint = CGPoint(x: mouseLocation.x, y: screen.frame.height - mouseLocation.y)
+        InputInjector.shared.injectScroll(
+            deltaX: Int32(clamping: Int(scroll.deltaX.rounded())),
+            deltaY: Int32(clamping: Int(scroll.deltaY.rounded())),
+            at: cgPoint
+        )
+        injectedEventCount += 1
+    }
+
+    // MARK: - Prediction
+
+    /// Exponentially smoothed velocity in normalized units per second.
+    private func updateVelocity(x: Double, y: Double, timestamp: TimeInterval) {
+        defer { lastSample = (x, y, timestamp) }
+        guard let last = lastSample else { return }
+        let dt = timestamp - last.timestamp
+        // Ignore duplicate or out-of-order timestamps and long pauses
+        guard dt > 0.001, dt < 0.1 else {
+            velocity = (0, 0)
+            return
+        }
+        let alpha = 0.5
+        velocity.x = alpha * ((x - last.x) / dt) + (1 - alpha) * velocity.x
+        velocity.y = alpha * ((y - last.y) / dt) + (1 - alpha) * velocity.y
+    }
+}
+
+// MARK: - Refresh Ticker
+
+/// Calls `onTick` at the start of every display refresh while resumed.
+///
+/// Backed by the main screen's `CADisplayLink`, so ticks land on real vsync
+/// boundaries rather than an estimate from the nominal refresh rate. Without a
+/// screen (headless host) it falls back to 60 Hz main-queue ticks.
+@MainActor
+private final class RefreshTicker: NSObject {
+
+    private let onTick: () -> Void
+    private var link: CADisplayLink?
+    private var isRunning = false
+    private var fallbackTickScheduled = false
+
+    init(onTick: @escaping () -> Void) {
+        self.onTick = onTick
+    }
+
+    func resume() {
+        guard !isRunning else { return }
+        isRunning = true
+
+        if link == nil, let screen = NSScreen.main {
+            let link = screen.displayLink(target: self, selector: #selector(displayLinkFired(_:)))
+            link.add(to: .main, forMode: .common)
+            self.link = link
+        }
+        if let link {
+            link.isPaused = false
+        } else {
+            scheduleFallbackTick()
+        }
+    }
+
+    func pause() {
+        isRunning = false
+        link?.isPaused = true
+    }
+
+    @objc private func displayLinkFired(_ link: CADisplayLink) {
+        guard isRunning else { return }
+        onTick()
+    }
+
+    private func scheduleFallbackTick() {
+        guard !fallbackTickScheduled else { return }
+        fallbackTickScheduled = true
+        DispatchQueue.main.asyncAfter(deadline: .now() + 1.0 / 60) { [weak self] in
+            MainActor.assumeIsolated {
+                guard let self else { return }
+                self.fallbackTickScheduled = false
+                guard self.isRunning else { return }
+                self.onTick()
+                if self.isRunning {
+                    self.scheduleFallbackTick()
+                }
+            }
+        }
+    }
+}
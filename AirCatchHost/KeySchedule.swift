@@ -0,0 +1,301 @@
+//
+//  KeySchedule.swift
+//  AirCatchHost
+//
+//  Per-direction traffic keys with an HKDF ratchet, and the nonces sealed under them.
+//
+
+import Foundation
+#if canImport(CryptoKit)
+import CryptoKit
+#else
+import Crypto
+#endif
+
+/// Traffic keys of one peer: a sending chain and its receiving chains.
+///
+/// A session derives one chain per direction from its secret and salt. The
+/// sender ratchets its chain (`k[n+1] = HKDF(k[n])`) every `rekeyInterval`
+/// packets (`AirCatchConfig.rekeyInterval` in the apps) and forgets the old key;
+/// the epoch travels in the nonce, so the receiver follows without a message. The receiver
+/// keeps the previous epoch's key for packets still in flight and moves forward
+/// once a packet of the new epoch authenticates. A ratchet step is one HKDF per
+/// million packets; the per-packet cost is a counter compare.
+///
+/// Viewers of one stream share the host-to-client chain, but each sends on its
+/// own client-to-host chain, named by the peer ID the host hands out with the
+/// session keys. Client nonces carry that ID above a 16-bit epoch, and the host
+/// keeps one receiving chain per ID, so one viewer's epoch never moves another's.
+/// Peer 0 is the shared chain of clients that predate peer IDs. A viewer that
+/// joins late starts its receiving chain at the host's current epoch.
+///
+/// Before a key exchange completes, both chains are the PIN key and never ratchet,
+/// and traffic uses AES-GCM. A session uses the cipher negotiated with it.
+nonisolated struct KeySchedule {
+
+    enum Role {
+        case host
+        case client
+    }
+
+    /// Key and position of a box's receiving chain, to confirm with `didOpen` once it authenticates
+    struct Opening {
+        let key: SymmetricKey
+        let epoch: UInt32
+        let peer: UInt16
+    }
+
+    private struct ReceiveChain {
+        var key: SymmetricKey
+        var epoch: UInt32
+        var previousKey: SymmetricKey?
+    }
+
+    /// A receiver ratchets at most this many epochs ahead for one packet
+    private static let maxEpochSkip: UInt32 = 16
+    /// Client nonces: `[0][Peer: 15 bits][Epoch: 16 bits]`
+    static let maxPeerId: UInt16 = 0x7FFF
+    private static let maxClientEpoch: UInt32 = 0xFFFF
+    private static let ratchetInfo = Data("AirCatch-Ratchet".utf8)
+    private static let peerInfo = Data("AirCatch-Peer".utf8)
+
+    let cipher: AEADCipher
+    /// Authenticates direct-path connectivity checks; nil before the key exchange,
+    /// since the PIN alone must not be enough to open a path
+    let directPathKey: SymmetricKey?
+    private let role: Role
+    private let ratchets: Bool
+    /// Packets sealed under one sending key before the chain ratchets
+    private let rekeyInterval: UInt64
+    /// Client-to-host chain this client seals on; 0 on the host
+    private let peer: UInt16
+
+    // Sending
+    private var sendKey: SymmetricKey
+    private(set) var sendEpoch: UInt32 = 0
+    private var sentInEpoch: UInt64 = 0
+    private var nonces: NonceSequence
+
+    // Receiving: by peer ID on the host, only chain 0 on a client
+    private var receiveChains: [UInt16: ReceiveChain]
+    /// Client-to-host base key the host derives each viewer's chain from
+    private let peerBaseKey: SymmetricKey?
+
+    /// One key for both directions, no ratchet (PIN-derived, before the key exchange).
+    init(staticKey: SymmetricKey, role: Role) {
+        self.role = role
+        cipher = .aes256GCM
+        directPathKey = nil
+        ratchets = false
+        rekeyInterval = .max
+        peer = 0
+        sendKey = staticKey
+        receiveChains = [0: ReceiveChain(key: staticKey, epoch: 0)]
+        peerBaseKey = nil
+        nonces = NonceSequence(isHost: role == .host)
+    }
+
+    /// Ratcheting chains, one per direction, derived from a session secret.
+    /// - Parameters:
+    ///   - peer: Client only: the chain to seal on, from `SessionKeyShare.peerId`.
+    ///   - receiveEpoch: Client only: the host's sending epoch at join time.
+    init(secret: SymmetricKey, salt: Data, role: Role, cipher: AEADCipher, rekeyInterval: UInt64,
+         peer: UInt16 = 0, receiveEpoch: UInt32 = 0) {
+        let hostToClient = HKDF<SHA256>.deriveKey(inputKeyMaterial: secret, salt: salt, info: Data("AirCatch-Host-To-Client".utf8), outputByteCount: 32)
+        let clientToHost = HKDF<SHA256>.deriveKey(inputKeyMaterial: secret, salt: salt, info: Data("AirCatch-Client-To-Host".utf8), outputByteCount: 32)
+        self.role = role
+        self.cipher = cipher
+        directPathKey = HKDF<SHA256>.deriveKey(inputKeyMaterial: secret, salt: salt, info: Data("AirCatch-DirectPath".utf8), outputByteCount: 32)
+        ratchets = true
+        self.rekeyInterval = rekeyInterval
+        let sealingPeer = role == .client ? min(peer, Self.maxPeerId) : 0
+        self.peer = sealingPeer
+        switch role {
+        case .host:
+            sendKey = hostToClient
+            receiveChains = [0: ReceiveChain(key: clientToHost, epoch: 0)]
+            peerBaseKey = clientToHost
+        case .client:
+            sendKey = Self.peerKey(clientToHost, peer: sealingPeer)
+            var key = hostToClient
+            for _ in 0..<receiveEpoch {
+                key = Self.ratchet(key)
+            }
+            receiveChains = [0: ReceiveChain(key: key, epoch: receiveEpoch)]
+            peerBaseKey = nil
+        }
+        nonces = NonceSequence(isHost: role == .host, epoch: Self.nonceEpoch(0, peer: sealingPeer, role: role))
+    }
+
+    /// Host: starts the receiving chain of a viewer that was handed `peer`.
+    mutating func addPeer(_ peer: UInt16) {
+        guard let peerBaseKey, receiveChains[peer] == nil else { return }
+        receiveChains[peer] = ReceiveChain(key: Self.peerKey(peerBaseKey, peer: peer), epoch: 0)
+    }
+
+    // MARK: - Sending
+
+    mutating func nextSealing() -> (key: SymmetricKey, nonce: AES.GCM.Nonce) {
+        ratchetSendChainIfDue(sealing: 1)
+        return (sendKey, nonces.next())
+    }
+
+    /// Key and nonces for `count` boxes that must share an epoch (segments of one frame).
+    mutating func nextSealing(count: Int) -> (key: SymmetricKey, nonces: [AES.GCM.Nonce]) {
+        ratchetSendChainIfDue(sealing: UInt64(count))
+        return (sendKey, (0..<count).map { _ in nonces.next() })
+    }
+
+    private mutating func ratchetSendChainIfDue(sealing count: UInt64) {
+        // A client's epoch field is 16 bits; past it the key stays, and the counter keeps nonces unique
+        if ratchets, sentInEpoch + count > rekeyInterval, role == .host || sendEpoch < Self.maxClientEpoch {
+            sendKey = Self.ratchet(sendKey)
+            sendEpoch += 1
+            sentInEpoch = 0
+            nonces = NonceSequence(isHost: role == .host, epoch: Self.nonceEpoch(sendEpoch, peer: peer, role: role))
+        }
+        sentInEpoch += count
+    }
+
+    /// The 31 bits after the direction bit: the host's epoch, or a client's peer ID and epoch.
+    private static func nonceEpoch(_ epoch: UInt32, peer: UInt16, role: Role) -> UInt32 {
+        role == .host ? epoch : UInt32(peer) << 16 | epoch
+    }
+
+    // MARK: - Receiving
+
+    /// Key for a box sealed with `nonce` (its first 12 bytes), to confirm with `didOpen`
+    /// once it authenticates. nil when the sender is unknown or its epoch out of reach.
+    func openingKey<Nonce: DataProtocol>(for nonce: Nonce) -> Opening? {
+        guard ratchets else { return receiveChains[0].map { Opening(key: $0.key, epoch: 0, peer: 0) } }
+        guard nonce.count >= 4 else { return nil }
+        let field = nonce.prefix(4).reduce(UInt32(0)) { $0 << 8 | UInt32($1) } & 0x7FFF_FFFF
+        // Client nonces name their chain; clients predating peer IDs fill all 31 bits with a small epoch
+        let peer = role == .host ? UInt16(field >> 16) : 0
+        let epoch = role == .host ? field & Self.maxClientEpoch : field
+        guard let chain = receiveChains[peer] else { return nil }
+
+        if epoch == chain.epoch {
+            return Opening(key: chain.key, epoch: epoch, peer: peer)
+        }
+        if epoch &+ 1 == chain.epoch, let previousKey = chain.previousKey {
+            return Opening(key: previousKey, epoch: epoch, peer: peer)
+        }
+        guard epoch > chain.epoch, epoch - chain.epoch <= Self.maxEpochSkip else { return nil }
+        var key = chain.key
+        for _ in chain.epoch..<epoch {
+            key = Self.ratchet(key)
+        }
+        return Opening(key: key, epoch: epoch, peer: peer)
+    }
+
+    /// Moves a receiving chain forward after a box of a newer epoch authenticated.
+    mutating func didOpen(_ opening: Opening) {
+        guard ratchets, var chain = receiveChains[opening.peer], opening.epoch > chain.epoch else { return }
+        chain.previousKey = opening.epoch == chain.epoch + 1 ? chain.key : nil
+        chain.key = opening.key
+        chain.epoch = opening.epoch
+        receiveChains[opening.peer] = chain
+    }
+
+    // MARK: - Derivation
+
+    private static func ratchet(_ key: SymmetricKey) -> SymmetricKey {
+        HKDF<SHA256>.deriveKey(inputKeyMaterial: key, info: ratchetInfo, outputByteCount: 32)
+    }
+
+    /// Peer 0 keeps the base key, for clients that predate peer IDs.
+    private static func peerKey(_ base: SymmetricKey, peer: UInt16) -> SymmetricKey {
+        guard peer != 0 else { return base }
+        var info = peerInfo
+        info.append(UInt8(peer >> 8))
+        info.append(UInt8(peer & 0xFF))
+        return HKDF<SHA256>.deriveKey(inputKeyMaterial: base, info: info, outputByteCount: 32)
+    }
+
+    /// Key that seals the session secret in `SessionKeyShare`: the X25519 agreement,
+    /// bound to the PIN, the session salt and both key shares.
+    static func wrappingKey(agreement: SharedSecret, pin: String, salt: Data, clientShare: Data, hostShare: Data) -> SymmetricKey {
+        var info = Data("AirCatch-KeyWrap-v2".utf8)
+        info.append(Data(pin.utf8))
+        info.append(clientShare)
+        info.append(hostShare)
+        return agreement.hkdfDerivedSymmetricKey(using: SHA256.self, salt: salt, sharedInfo: info, outputByteCount: 32)
+    }
+
+    // MARK: - PIN Binding
+
+    /// Proves the PIN without sending it: an HMAC over `context` (the handshake's key
+    /// share, or a resume ticket) under a key derived from the PIN.
+    static func pinProof(pin: String, context: Data) -> Data {
+        Data(HMAC<SHA256>.authenticationCode(for: context, using: pinProofKey(pin)))
+    }
+
+    static func isValidPINProof(_ proof: Data, pin: String, context: Data) -> Bool {
+        HMAC<SHA256>.isValidAuthenticationCode(proof, authenticating: context, using: pinProofKey(pin))
+    }
+
+    private static func pinProofKey(_ pin: String) -> SymmetricKey {
+        HKDF<SHA256>.deriveKey(inputKeyMaterial: SymmetricKey(data: Data(pin.utf8)), salt: Data("AirCatch-PIN-Proof-v1".utf8),
+                               info: Data("AirCatch-PIN-Proof".utf8), outputByteCount: 32)
+    }
+
+    /// Key for `SessionKeyShare.confirmation`: the X25519 agreement, with the HKDF salt
+    /// keyed by the PIN. Only a host holding both the PIN and its half of the agreement
+    /// can produce it, so a client detects a host-side impostor before using the answer.
+    static func confirmationKey(agreement: SharedSecret, pin: String, salt: Data, clientShare: Data, hostShare: Data) -> SymmetricKey {
+        let pinSalt = Data(HMAC<SHA256>.authenticationCode(for: salt, using: SymmetricKey(data: Data(pin.utf8))))
+        var info = Data("AirCatch-KeyConfirm-v1".utf8)
+        info.append(clientShare)
+        info.append(hostShare)
+        return agreement.hkdfDerivedSymmetricKey(using: SHA256.self, salt: pinSalt, sharedInfo: info, outputByteCount: 32)
+    }
+
+    /// The fields of `answer` its confirmation covers (the key shares are in the key).
+    /// `cipher` is the only variable-length field, so the concatenation is unambiguous.
+    static func confirmedFields(of answer: SessionKeyShare) -> Data {
+        var fields = answer.salt
+        fields.append(answer.sealedSecret)
+        withUnsafeBytes(of: (answer.peerId ?? 0).bigEndian) { fields.append(contentsOf: $0) }
+        withUnsafeBytes(of: (answer.hostEpoch ?? 0).bigEndian) { fields.append(contentsOf: $0) }
+        fields.append(Data((answer.cipher ?? "").utf8))
+        return fields
+    }
+}
+
+// MARK: - Nonces
+
+/// Deterministic AES-GCM nonces: `[direction bit + 31 bits][64-bit counter]`.
+///
+/// The counter makes nonces unique under one key without a random draw per
+/// packet, and the direction bit keeps host and client sequences apart. Under a
+/// ratcheting schedule the 31 bits carry the sender's epoch. Under the shared
+/// PIN key they are random, and with the random counter start they keep sessions
+/// that re-derive the same key from reusing each other's nonces.
+nonisolated struct NonceSequence {
+    private let prefix: UInt32
+    private var counter: UInt64
+
+    /// Random prefix, for a key that outlives the session.
+    init(isHost: Bool) {
+        self.init(isHost: isHost, epoch: UInt32.random(in: 0...UInt32.max))
+    }
+
+    init(isHost: Bool, epoch: UInt32) {
+        let direction: UInt32 = isHost ? 0x8000_0000 : 0
+        prefix = direction | (epoch & 0x7FFF_FFFF)
+        // Clients predating peer IDs share the client-to-host key; random starts keep their counters apart
+        counter = UInt64.random(in: 0...UInt64.max)
+    }
+
+    mutating func next() -> AES.GCM.Nonce {
+        counter &+= 1
+        let prefix = self.prefix.bigEndian
+        let counter = self.counter.bigEndian
+        return withUnsafeTemporaryAllocation(byteCount: 12, alignment: 1) { bytes in
+            bytes.storeBytes(of: prefix, as: UInt32.self)
+            bytes.storeBytes(of: counter, toByteOffset: 4, as: UInt64.self)
+            return try! AES.GCM.Nonce(data: UnsafeRawBufferPointer(bytes))
+        }
+    }
+}
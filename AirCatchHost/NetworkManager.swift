@@ -7,6 +7,7 @@
 
 import Foundation
 import Network
+import Synchronization
 
 final class NetworkManager {
     static let shared = NetworkManager()
@@ -23,6 +24,11 @@ final class NetworkManager {
 
     // Best-effort mapping from client IP -> last seen UDP endpoint (for retransmits)
     private var udpEndpointByHost: [String: NWEndpoint] = [:]
+    // Reply senders for endpoints without a flow of their own, reused across sends
+    private var udpSenders: [NWEndpoint: NWConnection] = [:]
+
+    // Ready flows for the per-chunk send paths, rebuilt by publishUDPTargets()
+    private let udpTargets = Mutex(UDPSendTargets<NWConnection>.empty)
     
     // MARK: - TCP Components
     private var tcpListener: NWListener?
@@ -173,41 +179,47 @@ final class NetworkManager {
     }
 
     /// Sends a UDP packet back to a specific endpoint (host reply path).
+    /// Goes out on the client's own flow when there is one, otherwise on a sender
+    /// kept per endpoint, so a burst of replies doesn't set up a socket per packet.
     func sendUDP(to endpoint: NWEndpoint, type: PacketType, payload: Data) {
+        let datagram = buildDatagram(type: type, payload: payload)
+        queue.async { [weak self] in
+            guard let self else { return }
+            self.udpSender(for: endpoint).send(content: datagram, completion: NWConnection.SendCompletion.contentProcessed({ error in
+                if let error {
+                    AirCatchLog.info("UDP send error: \(error)")
+                }
+            }))
+        }
+    }
+
+    /// Must run on `queue`.
+    private func udpSender(for endpoint: NWEndpoint) -> NWConnection {
+        let isUsable: (NWConnection) -> Bool = { connection in
+            switch connection.state {
+            case .failed, .cancelled: return false
+            default: return true
+            }
+        }
+        if let flow = (udpConnections + registeredUDPClients).first(where: { $0.endpoint == endpoint && isUsable($0) }) {
+            return flow
+        }
+        if let sender = udpSenders[endpoint], isUsable(sender) {
+            return sender
+        }
+
         let connection = NWConnection(to: endpoint, using: .udp)
         prepareUDPConnection(connection)
         connection.start(queue: queue)
-        let datagram = buildDatagram(type: type, payload: payload)
-        connection.send(content: datagram, completion: NWConnection.SendCompletion.contentProcessed({ error in
-            if let error {
-                AirCatchLog.info("UDP send error: \(error)")
-            }
-            connection.cancel()
-        }))
+        udpSenders[endpoint] = connection
+        return connection
     }
     
     /// Broadcasts a UDP packet to all connected clients.
     func broadcastUDP(type: PacketType, payload: Data) {
         let datagram = buildDatagram(type: type, payload: payload)
-        
-        // Thread-safe copy of connections to avoid race conditions
-        let connections = queue.sync { Array(udpConnections) }
-        let registeredClients = queue.sync { Array(registeredUDPClients) }
-        
-        // Log occasionally to debug connection tracking
-        if type == .videoFrameChunk && Int.random(in: 0...1000) == 0 {
-             let states = connections.map { "\($0.endpoint) \($0.state)" }
-             AirCatchLog.info(" Broadcasting chunk to \(connections.count) clients: \(states)")
-        }
-        
-        // Send to UDP listener connections
-        for connection in connections where connection.state == .ready {
-            connection.send(content: datagram, completion: NWConnection.SendCompletion.contentProcessed({ _ in }))
-        }
-        
-        // Also send to manually registered clients (from incoming UDP packets)
-        for connection in registeredClients where connection.state == .ready {
-            connection.send(content: datagram, completion: NWConnection.SendCompletion.contentProcessed({ _ in }))
+        for connection in udpTargets.withLock({ $0.connections }) {
+            connection.send(content: datagram, completion: .idempotent)
         }
     }
     
@@ -226,12 +238,16 @@ final class NetworkManager {
             
             // Create a connection to send data back to this client
             let connection = NWConnection(to: endpoint, using: .udp)
-            connection.stateUpdateHandler = { state in
+            connection.stateUpdateHandler = { [weak self] state in
                 switch state {
                 case .ready:
                     AirCatchLog.info("UDP client connection ready: \(endpoint)")
+                    self?.publishUDPTargets()
                 case .failed(let error):
                     AirCatchLog.info("UDP client connection failed: \(error)")
+                    self?.publishUDPTargets()
+                case .cancelled:
+                    self?.publishUDPTargets()
                 default:
                     break
                 }
@@ -245,14 +261,34 @@ final class NetworkManager {
         }
     }
 
+    /// Ready UDP connections for video, one per client host.
+    /// Listener flows win over registered ones: they reply from the port the client connected to.
+    func udpViewerConnections() -> [(id: String, connection: NWConnection)] {
+        udpTargets.withLock { $0.viewers }
+    }
+
+    /// Rebuilds the send-target snapshot from the current flows. Must run on `queue`.
+    private func publishUDPTargets() {
+        // Listener flows last, so they win for their host
+        let ready = (registeredUDPClients + udpConnections).filter { $0.state == .ready }
+        let targets = UDPSendTargets(ready: ready) { connection in
+            guard case .hostPort(let host, _) = connection.endpoint else { return nil }
+            return "\(host)"
+        }
+        udpTargets.withLock { $0 = targets }
+    }
+
     func udpEndpoint(forHostString hostString: String) -> NWEndpoint? {
-        udpEndpointByHost[hostString]
+        queue.sync { udpEndpointByHost[hostString] }
     }
     
     /// Broadcasts a TCP packet to all connected clients.
     func broadcastTCP(type: PacketType, payload: Data) {
-        let datagram = buildTCPPacket(type: type, payload: payload)
-        
+        broadcastTCP(packet: buildTCPPacket(type: type, payload: payload))
+    }
+
+    /// Broadcasts an already framed TCP packet (`tcpHeader` + payload) to all connected clients.
+    func broadcastTCP(packet datagram: Data) {
         // Thread-safe copy then send
         let connections = queue.sync { Array(tcpConnections) }
         for connection in connections where connection.state == .ready {
@@ -323,6 +359,10 @@ final class NetworkManager {
         
         registeredUDPClients.forEach { $0.cancel() }
         registeredUDPClients.removeAll()
+        udpTargets.withLock { $0 = .empty }
+        
+        udpSenders.values.forEach { $0.cancel() }
+        udpSenders.removeAll()
         
         udpReceiveHandler = nil
     }
@@ -347,12 +387,15 @@ final class NetworkManager {
     }
 
     private func prepareUDPConnection(_ connection: NWConnection) {
-        connection.stateUpdateHandler = { (state: NWConnection.State) in
+        connection.stateUpdateHandler = { [weak self] (state: NWConnection.State) in
             switch state {
+            case .ready:
+                self?.publishUDPTargets()
             case .failed(let error):
                 AirCatchLog.info("UDP connection failed: \(error)")
+                self?.publishUDPTargets()
             case .cancelled:
-                break
+                self?.publishUDPTargets()
             default:
                 break
             }
@@ -404,11 +447,24 @@ final class NetworkManager {
         connection.start(queue: queue)
     }
     
-    private func tcpReceiveLoop(on connection: NWConnection) {
-        // First read the header (1 byte type + 4 bytes length)
-        connection.receive(minimumIncompleteLength: 5, maximumLength: 5) { [weak self] data, _, isComplete, error in
+    private func tcpReceiveLoop(on connection: NWConnection, framer: PacketFramer = PacketFramer(maxPayloadSize: AirCatchConfig.maxTCPPayloadSize)) {
+        // Read whatever has arrived; the framer emits every packet it completes
+        connection.receive(minimumIncompleteLength: 1, maximumLength: PacketFramer.readSize) { [weak self] data, _, isComplete, error in
             guard let self else { return }
             
+            if let data, !data.isEmpty {
+                do {
+                    for packet in try framer.append(data) {
+                        self.tcpReceiveHandler?(packet, connection)
+                    }
+                } catch {
+                    AirCatchLog.error("TCP framing error, closing connection: \(error)")
+                    connection.cancel()
+                    self.tcpReceiveHandler?(Packet(type: .disconnect, payload: Data()), connection)
+                    return
+                }
+            }
+            
             if let error {
                 AirCatchLog.info("TCP receive error: \(error)")
                 return
@@ -420,43 +476,7 @@ final class NetworkManager {
                 return
             }
             
-            guard let data, data.count == 5 else {
-                if connection.state == .ready {
-                    self.tcpReceiveLoop(on: connection)
-                }
-                return
-            }
-            
-            guard let type = PacketType(rawValue: data[0]) else {
-                self.tcpReceiveLoop(on: connection)
-                return
-            }
-            
-            // Parse payload length (big endian)
-            let length = Int(data[1]) << 24 | Int(data[2]) << 16 | Int(data[3]) << 8 | Int(data[4])
-            
-            if length == 0 {
-                self.tcpReceiveHandler?(Packet(type: type, payload: Data()), connection)
-                self.tcpReceiveLoop(on: connection)
-                return
-            }
-            
-            // Read the payload
-            connection.receive(minimumIncompleteLength: length, maximumLength: length) { [weak self] payloadData, _, _, error in
-                guard let self else { return }
-                
-                if let error {
-                    AirCatchLog.info("TCP payload receive error: \(error)")
-                }
-                
-                if let payloadData {
-                    self.tcpReceiveHandler?(Packet(type: type, payload: payloadData), connection)
-                }
-                
-                if connection.state == .ready {
-                    self.tcpReceiveLoop(on: connection)
-                }
-            }
+            self.tcpReceiveLoop(on: connection, framer: framer)
         }
     }
 
@@ -478,18 +498,22 @@ final class NetworkManager {
     private func buildTCPPacket(type: PacketType, payload: Data) -> Data {
         var packet = Data()
         packet.reserveCapacity(5 + payload.count)
-        packet.append(type.rawValue)
-        
-        // Length as 4 bytes big endian
-        let length = UInt32(payload.count)
-        packet.append(UInt8((length >> 24) & 0xFF))
-        packet.append(UInt8((length >> 16) & 0xFF))
-        packet.append(UInt8((length >> 8) & 0xFF))
-        packet.append(UInt8(length & 0xFF))
-        
+        packet.append(Self.tcpHeader(type: type, payloadLength: payload.count))
         packet.append(payload)
         return packet
     }
+
+    /// TCP packet header: [type:1][length:4, big endian]
+    nonisolated static func tcpHeader(type: PacketType, payloadLength: Int) -> Data {
+        let length = UInt32(payloadLength)
+        return Data([
+            type.rawValue,
+            UInt8((length >> 24) & 0xFF),
+            UInt8((length >> 16) & 0xFF),
+            UInt8((length >> 8) & 0xFF),
+            UInt8(length & 0xFF)
+        ])
+    }
 }
 
 // MARK: - Connection Helpers
@@ -506,3 +530,11 @@ private extension NetworkManager {
     }
 }
 
+
+// MARK: - Video Fan-out
+
+nonisolated extension NWConnection: VideoDatagramSink {
+    func send(datagram: Data, completion: @escaping @Sendable () -> Void) {
+        send(content: datagram, completion: .contentProcessed { _ in completion() })
+    }
+}
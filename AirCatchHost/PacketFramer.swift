@@ -0,0 +1,83 @@
+//
+//  PacketFramer.swift
+//  AirCatchHost
+//
+//  Splits the TCP control/video stream into packets, many per read.
+//
+
+import Foundation
+
+/// Incremental parser for the TCP wire format `[Type: 1][Length: 4, big endian][Payload]`.
+///
+/// The receive loop reads whatever is available (up to `readSize`) and appends
+/// it; every packet the bytes complete comes out of that one call, so a burst of
+/// small input packets costs one receive callback instead of two per packet.
+/// Consumed bytes are compacted away only once they make up half the buffer,
+/// which keeps its storage for the next reads.
+///
+/// A length over `maxPayloadSize` means the stream is corrupt or hostile; it
+/// throws before anything is allocated for it.
+nonisolated final class PacketFramer {
+
+    enum FramingError: Error {
+        case payloadTooLarge(Int)
+    }
+
+    static let headerSize = 5
+    /// Upper bound of one receive
+    static let readSize = 256 * 1024
+
+    let maxPayloadSize: Int
+    private var buffer: [UInt8] = []
+    /// Start of the first unparsed byte in `buffer`
+    private var readIndex = 0
+
+    init(maxPayloadSize: Int) {
+        self.maxPayloadSize = maxPayloadSize
+        buffer.reserveCapacity(Self.readSize)
+    }
+
+    /// Bytes received but not yet part of a complete packet.
+    var bufferedByteCount: Int {
+        buffer.count - readIndex
+    }
+
+    /// Adds received bytes and returns every packet they complete, in order.
+    /// Packets of unknown type are skipped.
+    func append(_ bytes: Data) throws -> [Packet] {
+        buffer.append(contentsOf: bytes)
+
+        var packets: [Packet] = []
+        while buffer.count - readIndex >= Self.headerSize {
+            let typeByte = buffer[readIndex]
+            let length = Int(buffer[readIndex + 1]) << 24 | Int(buffer[readIndex + 2]) << 16
+                | Int(buffer[readIndex + 3]) << 8 | Int(buffer[readIndex + 4])
+            guard length <= maxPayloadSize else {
+                throw FramingError.payloadTooLarge(length)
+            }
+
+            let payloadStart = readIndex + Self.headerSize
+            let payloadEnd = payloadStart + length
+            guard payloadEnd <= buffer.count else { break }
+
+            if let type = PacketType(rawValue: typeByte) {
+                let payload = length == 0 ? Data() : Data(buffer[payloadStart..<payloadEnd])
+                packets.append(Packet(type: type, payload: payload))
+            }
+            readIndex = payloadEnd
+        }
+
+        compactIfNeeded()
+        return packets
+    }
+
+    private func compactIfNeeded() {
+        if readIndex == buffer.count {
+            buffer.removeAll(keepingCapacity: true)
+            readIndex = 0
+        } else if readIndex > buffer.count / 2 {
+            buffer.removeSubrange(0..<readIndex)
+            readIndex = 0
+        }
+    }
+}
@@ -6,6 +6,7 @@
 //
 
 import Foundation
+import CryptoKit
 
 final class RemoteTransportHost {
     enum Channel: String, Codable {
@@ -46,6 +47,17 @@ final class RemoteTransportHost {
     
     // Thread safety for pendingBytes
     private let queue = DispatchQueue(label: "com.aircatch.remotehost.queue")
+    // Per-frame admission against pendingBytes (only touched on `queue`)
+    private var dropPolicy = FrameDropPolicy()
+    
+    // Direct UDP path to the client, when NAT traversal succeeds
+    private let directPath = DirectPath(isControlling: true)
+    // Relayed UDP port, used when the direct path fails
+    private let relayChannel = RelayDatagramChannel()
+    private var relayHost: String?
+    
+    /// Whether UDP-channel packets travel as datagrams (direct or relayed) instead of over the WebSocket.
+    var hasDatagramPath: Bool { directPath.isActive || relayChannel.isActive }
 
     func start(
         sessionId: String,
@@ -66,13 +78,15 @@ final class RemoteTransportHost {
             return
         }
 
+        relayHost = url.host
+
         let request = URLRequest(url: url)
         let task = URLSession(configuration: .default).webSocketTask(with: request)
         webSocket = task
         task.resume()
 
         send(message: RemoteMessage(type: "register", sessionId: sessionId, role: .host, channel: nil, payload: nil))
-        sendLocalCandidate()
+        startDirectPath(onUDPPacket: onUDPPacket)
         receiveLoop()
 
         Task { @MainActor in
@@ -81,15 +95,28 @@ final class RemoteTransportHost {
     }
 
     func stop() {
+        directPath.stop()
+        relayChannel.close()
         webSocket?.cancel(with: .goingAway, reason: nil)
         webSocket = nil
-        queue.sync { pendingBytes = 0 }
+        queue.sync {
+            pendingBytes = 0
+            dropPolicy = FrameDropPolicy()
+        }
     }
 
     func updateSessionId(_ newSessionId: String) {
         guard newSessionId != sessionId else { return }
         sessionId = newSessionId
         send(message: RemoteMessage(type: "register", sessionId: newSessionId, role: .host, channel: nil, payload: nil))
+        if let onUDPPacket {
+            startDirectPath(onUDPPacket: onUDPPacket)
+        }
+    }
+
+    /// Keys the direct path's checks to the negotiated session (nil when it ends).
+    func setDirectPathKey(_ key: SymmetricKey?) {
+        directPath.setKey(key)
     }
 
     func sendTCP(type: PacketType, payload: Data) {
@@ -97,18 +124,34 @@ final class RemoteTransportHost {
     }
 
     func sendUDP(type: PacketType, payload: Data) {
-        // UDP path handles video frames. Check flow control.
-        if type == .videoFrame || type == .videoFrameChunk {
-             let currentPending = queue.sync { pendingBytes }
-             if currentPending > maxPendingBytes {
-                 // Drop frame if backpressure is high
-                 AirCatchLog.info("Dropping remote frame (backpressure: \(currentPending) bytes)", category: .network)
-                 return
-             }
+        // Datagram paths have no WebSocket queue to protect
+        if directPath.send(type: type, payload: payload) || relayChannel.send(type: type, payload: payload) {
+            return
         }
         sendPacket(channel: .udp, type: type, payload: payload)
     }
 
+    /// Decides whether a whole video frame may be queued on the WebSocket.
+    /// Backpressure thins droppable frames before it costs a reference frame,
+    /// and after losing one, nothing is sent until the next keyframe.
+    func admitVideoFrame(_ tag: FrameLayerTag, frameBytes: Int) -> FrameDropPolicy.Decision {
+        let wantsWebSocket = !hasDatagramPath
+        let (decision, wasWaiting) = queue.sync {
+            let wasWaiting = dropPolicy.waitingForKeyframe
+            let decision = dropPolicy.admit(
+                tag,
+                frameBytes: frameBytes,
+                queuedBytes: wantsWebSocket ? pendingBytes : 0,
+                budget: Double(maxPendingBytes)
+            )
+            return (decision, wasWaiting)
+        }
+        if decision == .drop && !wasWaiting {
+            AirCatchLog.info("Dropping remote frames until next keyframe (backpressure)", category: .network)
+        }
+        return decision
+    }
+
     private func sendPacket(channel: Channel, type: PacketType, payload: Data) {
         guard let webSocket else { return }
         
@@ -123,7 +166,7 @@ final class RemoteTransportHost {
         // We add a 1-byte header for PacketType so the receiver knows what it is.
         // Format: [1 byte Type] [Payload...]
         
-        if (type == .videoFrame || type == .videoFrameChunk) && channel == .udp {
+        if (type == .videoFrame || type == .videoFrameChunk || type == .videoFrameChunkLayered) && channel == .udp {
              var binaryMsg = Data()
              binaryMsg.reserveCapacity(1 + payload.count)
              binaryMsg.append(type.rawValue)
@@ -238,13 +281,31 @@ final class RemoteTransportHost {
         }
 
         if message.type == "candidate", let payload = message.payload {
-            AirCatchLog.info("Remote candidate received: \(payload)", category: .network)
+            directPath.handleSignal(payload)
+            return
+        }
+
+        // The relay pushes our UDP leg when the client allocates one
+        if message.type == "allocation", let payload = message.payload,
+           let allocation = try? JSONDecoder().decode(RelayDatagramChannel.Allocation.self, from: Data(payload.utf8)),
+           let host = allocation.host ?? relayHost, let onUDPPacket {
+            relayChannel.open(host: host, allocation: allocation, onPacket: onUDPPacket)
+            return
+        }
+
+        if message.type == "release" {
+            relayChannel.close()
         }
     }
 
-    private func sendLocalCandidate() {
-        // STUN/Candidate logic - keeping as placeholder if you switch to webrtc later
-        // Currently redundant for relay-only but harmless.
+    private func startDirectPath(onUDPPacket: @MainActor @escaping (Packet) -> Void) {
+        directPath.start(
+            sendSignal: { [weak self] payload in
+                guard let self else { return }
+                self.send(message: RemoteMessage(type: "candidate", sessionId: self.sessionId, role: nil, channel: nil, payload: payload))
+            },
+            onPacket: onUDPPacket
+        )
     }
 
     private func buildDatagram(type: PacketType, payload: Data) -> Data {
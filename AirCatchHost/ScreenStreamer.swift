@@ -11,6 +11,7 @@ import VideoToolbox
 import CoreMedia
 import AppKit
 import IOSurface
+import os
 
 /// Captures the screen using ScreenCaptureKit and compresses frames to HEVC.
 final class ScreenStreamer: NSObject {
@@ -37,12 +38,24 @@ final class ScreenStreamer: NSObject {
     // MARK: - Compression
     
     private var compressionSession: VTCompressionSession?
-    private var frameCallback: ((Data) -> Void)?
+    private var frameCallback: ((Data, FrameLayerTag) -> Void)?
     private var audioCallback: ((Data) -> Void)?
     private var cachedVPS: Data?  // HEVC only
     private var cachedSPS: Data?
     private var cachedPPS: Data?
     private var codecOverride: CodecPreference?
+    /// Set by `requestKeyframe()`, consumed by the next encode once due
+    private nonisolated struct KeyframeRequest {
+        var pending = false
+        /// Arrived within `keyframeRequestMinInterval` of the last forced keyframe; due when it passes
+        var deferred = false
+        var lastForcedAt: TimeInterval = 0
+
+        func isDue(at now: TimeInterval) -> Bool {
+            pending || (deferred && now - lastForcedAt >= AirCatchConfig.keyframeRequestMinInterval)
+        }
+    }
+    private let keyframeRequest = OSAllocatedUnfairLock(initialState: KeyframeRequest())
     
     // MARK: - Audio
     
@@ -52,12 +65,31 @@ final class ScreenStreamer: NSObject {
     
     private var isRunning = false
     
+    // MARK: - Startup Timing
+    
+    /// When `start()` built the encoder and when capture began (system uptime)
+    private(set) var encoderReadyAt: TimeInterval?
+    private(set) var captureStartedAt: TimeInterval?
+    /// Called once, on the encoder's thread, with the time the first frame was handed off
+    var onFirstFrame: ((TimeInterval) -> Void)?
+    private var firstFrameDelivered = false
+    
     // MARK: - Encoder Throughput Tracking
     
     /// Total frames encoded since last reset (used for FPS measurement)
     private(set) var encodedFrameCount: Int = 0
     private var lastFrameCountReset: Date = Date()
     
+    // MARK: - Static Content Detection
+    
+    private let changeDetector = FrameChangeDetector()
+    /// Presentation time of the last frame handed to the encoder
+    private var lastEncodedPresentationTime: CMTime = .invalid
+    /// Frames dropped before encoding because nothing on screen changed
+    private(set) var suppressedFrameCount: Int = 0
+    /// When true, each frame carries a `FrameDirtyRegion` after the timestamp
+    var includesDirtyRegions: Bool
+    
     init(preset: QualityPreset = .balanced,
          maxClientWidth: Int? = nil,
          maxClientHeight: Int? = nil,
@@ -65,7 +97,8 @@ final class ScreenStreamer: NSObject {
          codecOverride: CodecPreference? = nil,
          audioEnabled: Bool = false,
          optimizeForHostDisplay: Bool = false,
-         onFrame: @escaping (Data) -> Void,
+         includesDirtyRegions: Bool = false,
+         onFrame: @escaping (Data, FrameLayerTag) -> Void,
          onAudio: ((Data) -> Void)? = nil) {
         self.currentPreset = preset
         self.clientWidth = maxClientWidth
@@ -74,6 +107,7 @@ final class ScreenStreamer: NSObject {
         self.codecOverride = codecOverride
         self.audioEnabled = audioEnabled
         self.optimizeForHostDisplay = optimizeForHostDisplay
+        self.includesDirtyRegions = includesDirtyRegions
         self.frameCallback = onFrame
         self.audioCallback = onAudio
         super.init()
@@ -82,14 +116,42 @@ final class ScreenStreamer: NSObject {
     
     // MARK: - Public API
     
-    func start() async throws {
+    /// Starts capture.
+    ///
+    /// Content enumeration waits for `displayReady` (a virtual display that isn't
+    /// online yet has no `SCDisplay`). The encoder doesn't depend on it when the
+    /// output size comes from the client or the display's current bounds, so it is
+    /// built while enumeration runs, and rebuilt only if the enumerated display
+    /// turns out to need a different size.
+    func start(after displayReady: Task<Bool, Never>? = nil) async throws {
         guard !isRunning else { return }
-        
-        // 1. Get available content
-        let availableContent = try await SCShareableContent.excludingDesktopWindows(
-            false,
-            onScreenWindowsOnly: false
+        firstFrameDelivered = false
+        encoderReadyAt = nil
+        captureStartedAt = nil
+        
+        // 1. Get available content (in parallel with the encoder)
+        async let shareableContent = Self.loadShareableContent(after: displayReady)
+        
+        // 2. Setup compression session at the predicted size
+        let expectedBounds = CGDisplayBounds(targetDisplayID ?? CGMainDisplayID())
+        var (width, height) = calculateOptimalOutputResolution(
+            sourceWidth: Int(expectedBounds.width),
+            sourceHeight: Int(expectedBounds.height),
+            clientWidth: clientWidth,
+            clientHeight: clientHeight
         )
+        if width > 0, height > 0 {
+            try setupCompressionSession(width: width, height: height)
+            encoderReadyAt = ProcessInfo.processInfo.systemUptime
+        }
+        
+        let availableContent: SCShareableContent
+        do {
+            availableContent = try await shareableContent
+        } catch {
+            invalidateCompressionSession()
+            throw error
+        }
         
         // Get the target display
         let display: SCDisplay?
@@ -101,17 +163,28 @@ final class ScreenStreamer: NSObject {
         }
 
         guard let display else {
+            invalidateCompressionSession()
             throw StreamerError.noDisplayFound
         }
         
         // Calculate output resolution based on client's iPad screen
         // Goal: Match iPad's aspect ratio for pixel-perfect display
-        let (width, height) = calculateOptimalOutputResolution(
-            sourceWidth: display.width,
-            sourceHeight: display.height,
-            clientWidth: clientWidth,
-            clientHeight: clientHeight
-        )
+        // Only the display's size can change the prediction, and only without client dimensions
+        let needsEncoder = encoderReadyAt == nil
+        if needsEncoder || display.width != Int(expectedBounds.width) || display.height != Int(expectedBounds.height) {
+            let size = calculateOptimalOutputResolution(
+                sourceWidth: display.width,
+                sourceHeight: display.height,
+                clientWidth: clientWidth,
+                clientHeight: clientHeight
+            )
+            if needsEncoder || size != (width, height) {
+                (width, height) = size
+                invalidateCompressionSession()
+                try setupCompressionSession(width: width, height: height)
+                encoderReadyAt = ProcessInfo.processInfo.systemUptime
+            }
+        }
         
         // Create content filter (capture entire display)
         let filter = SCContentFilter(display: display, excludingWindows: [])
@@ -141,10 +214,7 @@ final class ScreenStreamer: NSObject {
 
 
         
-        // 5. Setup compression session
-        try setupCompressionSession(width: width, height: height)
-        
-        // 6. Create and start the stream
+        // 4. Create and start the stream
         let stream = SCStream(filter: filter, configuration: config, delegate: self)
         
         let queue = DispatchQueue(label: "com.aircatch.videocapture", qos: .userInteractive)
@@ -174,10 +244,19 @@ final class ScreenStreamer: NSObject {
         
         self.stream = stream
         isRunning = true
+        captureStartedAt = ProcessInfo.processInfo.systemUptime
         
         AirCatchLog.info(" Started capturing at \(currentPreset.frameRate)fps (\(width)x\(height)) - Preset: \(currentPreset.displayName)")
     }
     
+    private nonisolated static func loadShareableContent(after displayReady: Task<Bool, Never>?) async throws -> SCShareableContent {
+        _ = await displayReady?.value
+        return try await SCShareableContent.excludingDesktopWindows(
+            false,
+            onScreenWindowsOnly: false
+        )
+    }
+    
     func stop() {
         guard isRunning else { return }
         
@@ -187,14 +266,17 @@ final class ScreenStreamer: NSObject {
         
         stream = nil
         streamOutput = nil
+        invalidateCompressionSession()
         
+        isRunning = false
+        AirCatchLog.info(" Stopped")
+    }
+    
+    private func invalidateCompressionSession() {
         if let session = compressionSession {
             VTCompressionSessionInvalidate(session)
             compressionSession = nil
         }
-        
-        isRunning = false
-        AirCatchLog.info(" Stopped")
     }
 
 
@@ -298,6 +380,16 @@ final class ScreenStreamer: NSObject {
         // Frame rate configuration
         VTSessionSetProperty(session, key: kVTCompressionPropertyKey_ExpectedFrameRate, value: currentPreset.frameRate as CFNumber)
         
+        // Temporal layers: only the base layer is referenced, so congested queues can skip the rest
+        if useHEVC && AirCatchConfig.temporalLayersEnabled {
+            let layerStatus = VTSessionSetProperty(session,
+                                                   key: kVTCompressionPropertyKey_BaseLayerFrameRateFraction,
+                                                   value: AirCatchConfig.baseLayerFrameRateFraction as CFNumber)
+            if layerStatus != noErr {
+                AirCatchLog.info(" ⚠️ Temporal layers unavailable (Error: \(layerStatus)); all frames are references")
+            }
+        }
+        
         // DYNAMIC BITRATE: Respect the selected high-bandwidth QualityPreset
         // Performance (10Mbps) | Balanced (20Mbps) | Pro (30Mbps)
         let targetBitrate = currentPreset.bitrate
@@ -407,6 +499,21 @@ final class ScreenStreamer: NSObject {
         AirCatchLog.info(" Encoder FPS updated to \(fps)")
     }
     
+    /// Forces the next encoded frame to be a keyframe (a viewer lost its reference chain).
+    /// Requests within `keyframeRequestMinInterval` of the last forced keyframe are deferred
+    /// to the end of that window and merged, so several congested receivers don't turn the
+    /// stream into all keyframes, yet a viewer that lost the forced keyframe still gets one.
+    func requestKeyframe() {
+        let now = ProcessInfo.processInfo.systemUptime
+        keyframeRequest.withLock { state in
+            if now - state.lastForcedAt >= AirCatchConfig.keyframeRequestMinInterval {
+                state.pending = true
+            } else {
+                state.deferred = true
+            }
+        }
+    }
+
     private var compressCount = 0
     private(set) var skippedFrameCount: Int = 0  // Exposed for diagnostics
     
@@ -449,14 +556,43 @@ final class ScreenStreamer: NSObject {
         let presentationTime = CMSampleBufferGetPresentationTimeStamp(sampleBuffer)
         let duration = CMSampleBufferGetDuration(sampleBuffer)
         
+        // Skip unchanged frames, but still encode one per refresh interval as a keepalive.
+        // A due keyframe request is never held back.
+        let requestCheckedAt = ProcessInfo.processInfo.systemUptime
+        let forceKeyframe = keyframeRequest.withLock { $0.isDue(at: requestCheckedAt) }
+        if !changeDetector.detectChanges(in: imageBuffer), lastEncodedPresentationTime.isValid, !forceKeyframe {
+            let sinceLast = CMTimeGetSeconds(CMTimeSubtract(presentationTime, lastEncodedPresentationTime))
+            if sinceLast < AirCatchConfig.staticFrameRefreshInterval {
+                suppressedFrameCount += 1
+                #if DEBUG
+                if suppressedFrameCount == 1 || suppressedFrameCount % 600 == 0 {
+                    AirCatchLog.debug("Static frame suppressed (total: \(suppressedFrameCount))", category: .video)
+                }
+                #endif
+                return
+            }
+        }
+        lastEncodedPresentationTime = presentationTime
+        
+        // Tile hashes are exact; ScreenCaptureKit's dirty rects cover buffers that could not be hashed
+        let dirtyRegion: FrameDirtyRegion? = includesDirtyRegions
+            ? (changeDetector.dirtyRegion() ?? captureDirtyRegion(from: sampleBuffer, imageBuffer: imageBuffer))
+            : nil
+        
         var flags = VTEncodeInfoFlags()
+        var frameProperties: CFDictionary?
+        if forceKeyframe {
+            let now = ProcessInfo.processInfo.systemUptime
+            keyframeRequest.withLock { $0 = KeyframeRequest(lastForcedAt: now) }
+            frameProperties = [kVTEncodeFrameOptionKey_ForceKeyFrame: kCFBooleanTrue] as CFDictionary
+        }
         
         let status = VTCompressionSessionEncodeFrame(
             session,
             imageBuffer: imageBuffer,
             presentationTimeStamp: presentationTime,
             duration: duration,
-            frameProperties: nil,
+            frameProperties: frameProperties,
             infoFlagsOut: &flags
         ) { [weak self] status, _, sampleBuffer in
             guard let strongSelf = self else { return }
@@ -479,7 +615,7 @@ final class ScreenStreamer: NSObject {
                 #endif
                 return
             }
-            strongSelf.handleCompressedFrame(sampleBuffer)
+            strongSelf.handleCompressedFrame(sampleBuffer, dirtyRegion: dirtyRegion)
         }
         
         if status != noErr {
@@ -498,6 +634,8 @@ final class ScreenStreamer: NSObject {
         cachedSPS = nil
         cachedPPS = nil
         cachedVPS = nil
+        changeDetector.reset()
+        lastEncodedPresentationTime = .invalid
         // Session will be recreated on next start
         #if DEBUG
         AirCatchLog.info(" Compression session reset due to error")
@@ -506,7 +644,7 @@ final class ScreenStreamer: NSObject {
     
     private var handleCount = 0
     
-    private func handleCompressedFrame(_ sampleBuffer: CMSampleBuffer) {
+    private func handleCompressedFrame(_ sampleBuffer: CMSampleBuffer, dirtyRegion: FrameDirtyRegion?) {
         handleCount += 1
         
         guard let dataBuffer = CMSampleBufferGetDataBuffer(sampleBuffer) else {
@@ -524,17 +662,22 @@ final class ScreenStreamer: NSObject {
         // Determine if this frame is a keyframe
         let isKeyframe = isKeyframeSample(sampleBuffer)
 
-        // Convert AVCC (length-prefixed) to Annex B (start-code prefixed)
-        guard let elementaryStream = makeAnnexBStream(from: dataBuffer, includeParameterSets: isKeyframe) else {
-            return
+        // Keyframes always report the full frame so the client repaints after recovery
+        var region = dirtyRegion
+        if region != nil, isKeyframe {
+            region = .fullFrame(width: captureWidth, height: captureHeight, tileSize: FrameChangeDetector.tileSize)
         }
 
-        // Create frame data with timestamp header (first 8 bytes) followed by Annex B stream
-        var frameData = Data()
+        // Timestamp header, optional dirty region and the Annex B stream, in one pooled buffer
         let timestamp = CMSampleBufferGetPresentationTimeStamp(sampleBuffer)
-        var timestampValue = timestamp.value
-        frameData.append(Data(bytes: &timestampValue, count: 8))
-        frameData.append(elementaryStream)
+        guard let frameData = makeFrameData(
+            timestamp: timestamp.value,
+            dirtyRegion: region,
+            from: dataBuffer,
+            includeParameterSets: isKeyframe
+        ) else {
+            return
+        }
         
         #if DEBUG
         if Int.random(in: 0...60) == 0 {
@@ -542,8 +685,49 @@ final class ScreenStreamer: NSObject {
         }
         #endif
         
-        frameCallback?(frameData)
+        // With a base-layer frame rate set, the frames between base frames are the droppable layer
+        let isDroppable = !isKeyframe && !isReferenceSample(sampleBuffer)
+        let tag = FrameLayerTag(temporalLayer: isDroppable ? 1 : 0, isKeyframe: isKeyframe, isDroppable: isDroppable)
+        frameCallback?(frameData, tag)
         encodedFrameCount += 1  // Track encoded frames
+        
+        if !firstFrameDelivered {
+            firstFrameDelivered = true
+            onFirstFrame?(ProcessInfo.processInfo.systemUptime)
+        }
+    }
+
+    /// Maps ScreenCaptureKit's per-frame dirty rects (points) onto the tile grid of the pixel buffer.
+    private func captureDirtyRegion(from sampleBuffer: CMSampleBuffer, imageBuffer: CVImageBuffer) -> FrameDirtyRegion {
+        let tileSize = FrameChangeDetector.tileSize
+        let width = CVPixelBufferGetWidth(imageBuffer)
+        let height = CVPixelBufferGetHeight(imageBuffer)
+
+        guard let attachments = CMSampleBufferGetSampleAttachmentsArray(sampleBuffer, createIfNecessary: false) as? [[SCStreamFrameInfo: Any]],
+              let info = attachments.first,
+              let rawRects = info[.dirtyRects] as? [NSDictionary] else {
+            return .fullFrame(width: width, height: height, tileSize: tileSize)
+        }
+
+        let scale = info[.scaleFactor] as? CGFloat ?? 1
+        let bounds = CGRect(x: 0, y: 0, width: width, height: height)
+        var rects: [FrameDirtyRegion.TileRect] = []
+        for raw in rawRects {
+            guard let rect = CGRect(dictionaryRepresentation: raw as CFDictionary) else { continue }
+            let pixels = CGRect(x: rect.minX * scale, y: rect.minY * scale,
+                                width: rect.width * scale, height: rect.height * scale).intersection(bounds)
+            guard !pixels.isNull, !pixels.isEmpty else { continue }
+
+            let x0 = Int(pixels.minX) / tileSize
+            let y0 = Int(pixels.minY) / tileSize
+            let x1 = (Int(pixels.maxX.rounded(.up)) + tileSize - 1) / tileSize
+            let y1 = (Int(pixels.maxY.rounded(.up)) + tileSize - 1) / tileSize
+            rects.append(FrameDirtyRegion.TileRect(
+                x: UInt16(clamping: x0), y: UInt16(clamping: y0),
+                width: UInt16(clamping: x1 - x0), height: UInt16(clamping: y1 - y0)
+            ))
+        }
+        return FrameDirtyRegion(tileSize: UInt16(tileSize), rects: rects)
     }
 
     /// Returns true when the sample buffer represents a keyframe (sync frame).
@@ -558,6 +742,17 @@ final class ScreenStreamer: NSObject {
         return !notSync
     }
 
+    /// Returns false when the encoder marked the sample as not referenced by later frames.
+    private func isReferenceSample(_ sampleBuffer: CMSampleBuffer) -> Bool {
+        guard let attachments = CMSampleBufferGetSampleAttachmentsArray(sampleBuffer, createIfNecessary: false),
+              CFArrayGetCount(attachments) > 0,
+              let rawAttachment = CFArrayGetValueAtIndex(attachments, 0) else {
+            return true
+        }
+        let attachment = unsafeBitCast(rawAttachment, to: CFDictionary.self) as NSDictionary
+        return attachment[kCMSampleAttachmentKey_IsDependedOnByOthers] as? Bool ?? true
+    }
+
     /// Caches SPS/PPS (H.264) or VPS/SPS/PPS (HEVC) from the format description.
     private func cacheParameterSetsIfNeeded(from sampleBuffer: CMSampleBuffer) {
         guard let formatDescription = CMSampleBufferGetFormatDescription(sampleBuffer) else {
@@ -660,9 +855,11 @@ final class ScreenStreamer: NSObject {
         }
     }
 
-    /// Converts the compressed block buffer into an Annex B elementary stream, optionally
-    /// prefixing with parameter sets for keyframes (SPS/PPS for H.264, VPS/SPS/PPS for HEVC).
-    private func makeAnnexBStream(from dataBuffer: CMBlockBuffer, includeParameterSets: Bool) -> Data? {
+    /// Builds `[Timestamp: 8][Tag: 1][RegionLength: 2][Region]?[Annex B stream]` for one frame.
+    /// The block buffer's AVCC (length-prefixed) NAL units are rewritten with start codes,
+    /// prefixed with the parameter sets for keyframes (SPS/PPS for H.264, VPS/SPS/PPS for HEVC).
+    /// Everything is written once, straight into a `FrameBufferPool` buffer.
+    private func makeFrameData(timestamp: Int64, dirtyRegion: FrameDirtyRegion?, from dataBuffer: CMBlockBuffer, includeParameterSets: Bool) -> Data? {
         var length: Int = 0
         var dataPointer: UnsafeMutablePointer<Int8>?
 
@@ -676,46 +873,60 @@ final class ScreenStreamer: NSObject {
 
         guard status == kCMBlockBufferNoErr, let pointer = dataPointer else { return nil }
 
-        let startCode: [UInt8] = [0, 0, 0, 1]
-        var stream = Data()
-
+        var parameterSets: [Data] = []
         if includeParameterSets {
             if let vps = cachedVPS {
                 // HEVC: Include VPS, SPS, PPS
                 guard let sps = cachedSPS, let pps = cachedPPS else { return nil }
-                stream.append(contentsOf: startCode)
-                stream.append(vps)
-                stream.append(contentsOf: startCode)
-                stream.append(sps)
-                stream.append(contentsOf: startCode)
-                stream.append(pps)
+                parameterSets = [vps, sps, pps]
             } else if let sps = cachedSPS, let pps = cachedPPS {
                 // H.264: Include SPS, PPS
-                stream.append(contentsOf: startCode)
-                stream.append(sps)
-                stream.append(contentsOf: startCode)
-                stream.append(pps)
+                parameterSets = [sps, pps]
             }
         }
 
-        var offset = 0
-        while offset + 4 <= length {
-            // Read the NAL length (big endian) safely to avoid alignment crashes
-            var lengthVal: UInt32 = 0
-            withUnsafeMutableBytes(of: &lengthVal) { buffer in
-                buffer.copyBytes(from: UnsafeRawBufferPointer(start: UnsafeRawPointer(pointer).advanced(by: offset), count: 4))
+        let region = dirtyRegion?.serialized()
+        // Start codes replace the 4-byte NAL lengths, so the stream never outgrows the block buffer
+        let capacity = 8 + (region.map { 3 + $0.count } ?? 0)
+            + parameterSets.reduce(0) { $0 + 4 + $1.count } + length
+        let startCode: UInt32 = UInt32(1).bigEndian
+
+        return FrameBufferPool.shared.makeData(capacity: capacity) { buffer in
+            var written = 0
+            func write(_ bytes: UnsafeRawBufferPointer) {
+                buffer.baseAddress!.advanced(by: written).copyMemory(from: bytes.baseAddress!, byteCount: bytes.count)
+                written += bytes.count
+            }
+            func write<T>(value: T) {
+                withUnsafeBytes(of: value) { write($0) }
             }
-            let nalLength = UInt32(bigEndian: lengthVal)
-            offset += 4
-            guard nalLength > 0, offset + Int(nalLength) <= length else { break }
 
-            stream.append(contentsOf: startCode)
-            stream.append(Data(bytes: pointer.advanced(by: offset), count: Int(nalLength)))
+            write(value: timestamp)
+            if let region {
+                write(value: FrameDirtyRegion.headerTag)
+                write(value: UInt16(region.count).bigEndian)
+                region.withUnsafeBytes { write($0) }
+            }
+            for parameterSet in parameterSets {
+                write(value: startCode)
+                parameterSet.withUnsafeBytes { write($0) }
+            }
 
-            offset += Int(nalLength)
-        }
+            let source = UnsafeRawPointer(pointer)
+            var offset = 0
+            while offset + 4 <= length {
+                // Read the NAL length (big endian) safely to avoid alignment crashes
+                let nalLength = Int(UInt32(bigEndian: source.loadUnaligned(fromByteOffset: offset, as: UInt32.self)))
+                offset += 4
+                guard nalLength > 0, offset + nalLength <= length else { break }
+
+                write(value: startCode)
+                write(UnsafeRawBufferPointer(start: source.advanced(by: offset), count: nalLength))
 
-        return stream
+                offset += nalLength
+            }
+            return written
+        }
     }
     
     // MARK: - Audio Processing
@@ -761,42 +972,34 @@ final class ScreenStreamer: NSObject {
         let list = UnsafeMutableAudioBufferListPointer(audioBufferListPtr)
         guard list.count > 0, let buf0 = list[0].mData else { return }
         let size0 = Int(list[0].mDataByteSize)
-        
-        // Prepare Audio Packet
-        var audioData = Data()
-        
-        // 1. Append Timestamp (8 bytes)
-        let timestamp = CMSampleBufferGetPresentationTimeStamp(sampleBuffer)
-        var timestampValue = timestamp.value
-        audioData.append(Data(bytes: &timestampValue, count: 8))
-        
-        // 2. Append PCM Data (Interleaved)
-        // Check for Planar Stereo (2 buffers) and Interleave if necessary
-        if list.count == 2, let buf1 = list[1].mData {
-            // Planar Stereo: Interleave L and R (L0 R0 L1 R1...)
-            // Both buffers should be same size and format (Float32)
-            let sampleCount = size0 / 4
-            let interleavedData = Data(count: size0 * 2)
-            
-            // "Unsafe" copy is clean here as we own the data
-            // Copy into new Data buffer
-            var interleaved = interleavedData // Mutable copy
-            interleaved.withUnsafeMutableBytes { dst in
-                guard let dstPtr = dst.bindMemory(to: Float.self).baseAddress else { return }
-                let src0 = buf0.assumingMemoryBound(to: Float.self)
-                let src1 = buf1.assumingMemoryBound(to: Float.self)
-                
-                for i in 0..<sampleCount {
-                    dstPtr[i*2] = src0[i]
-                    dstPtr[i*2+1] = src1[i]
-                }
+        let isPlanarStereo = list.count == 2 && list[1].mData != nil
+        let pcmSize = isPlanarStereo ? size0 * 2 : size0
+
+        // Prepare Audio Packet: [Timestamp: 8][PCM (interleaved)]
+        // Sized once up front so the PCM is written in place (single allocation per packet).
+        var audioData = Data(count: 8 + pcmSize)
+        let timestampValue = CMSampleBufferGetPresentationTimeStamp(sampleBuffer).value
+
+        audioData.withUnsafeMutableBytes { dst in
+            guard let base = dst.baseAddress else { return }
+            base.storeBytes(of: timestampValue, as: Int64.self)
+            let pcm = base.advanced(by: 8)
+
+            if isPlanarStereo, let buf1 = list[1].mData {
+                // Planar Stereo: Interleave L and R (L0 R0 L1 R1...)
+                // Both buffers should be same size and format (Float32)
+                PCMKernels.interleave(
+                    left: buf0.assumingMemoryBound(to: Float.self),
+                    right: buf1.assumingMemoryBound(to: Float.self),
+                    into: pcm.assumingMemoryBound(to: Float.self),
+                    frameCount: size0 / MemoryLayout<Float>.size
+                )
+            } else {
+                // Already Interleaved or Mono: Copy directly
+                pcm.copyMemory(from: buf0, byteCount: size0)
             }
-            audioData.append(interleaved)
-        } else {
-            // Already Interleaved or Mono: Copy directly
-            audioData.append(Data(bytes: buf0, count: size0))
         }
-        
+
         audioCallback(audioData)
     }
 }
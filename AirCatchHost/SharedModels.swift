@@ -9,80 +9,12 @@ import Foundation
 import Network
 import os
 
-// MARK: - Logging
+// MARK: - Configuration
 
-
-
-enum AirCatchLog {
-    enum Category: String {
-        case network = "Network"
-        case video = "Video"
-        case input = "Input"
-        case general = "General"
-    }
-    
-    nonisolated private static let subsystem = "com.aircatch.host"
-    
-    nonisolated static func info(_ message: String, category: Category = .general) {
-        os_log(.info, log: OSLog(subsystem: subsystem, category: category.rawValue), "%{public}@", message)
-    }
-    
-    nonisolated static func error(_ message: String, category: Category = .general) {
-        os_log(.error, log: OSLog(subsystem: subsystem, category: category.rawValue), "%{public}@", message)
-    }
-    
-    nonisolated static func debug(_ message: String, category: Category = .general) {
-        os_log(.debug, log: OSLog(subsystem: subsystem, category: category.rawValue), "%{public}@", message)
-    }
-}
-
-// MARK: - Configuration Constants
-
-enum AirCatchConfig {
-    nonisolated static let udpPort: UInt16 = 5555
-    nonisolated static let tcpPort: UInt16 = 5556
-    nonisolated static let bonjourServiceType = "_aircatch._udp."
-    nonisolated static let bonjourTCPServiceType = "_aircatch._tcp."
-
-    // Remote (Internet) relay/signaling
-    nonisolated static let remoteRelayURL: String = "wss://aircatch.duckdns.org/ws"
-    
-    // Port aliases for clarity
-    nonisolated static let defaultUDPPort: UInt16 = 5555
-    nonisolated static let defaultTCPPort: UInt16 = 5556
-    
-    // Network constants
-    static let maxUDPPayloadSize: Int = 1200  // Safe UDP payload size (below MTU)
-    
-    // Streaming defaults (optimized for HEVC on Apple Silicon)
-    static let defaultBitrate: Int = 16_000_000  // 16 Mbps - HEVC sweet spot
-    static let defaultFrameRate: Int = 60        // General default
-    static let maxTouchEventsPerSecond: Int = 60
-    static let reconnectMaxAttempts = 5
-    static let reconnectBaseDelay: TimeInterval = 1.0
-
-    // Remote Mode Specifics
-    static let remoteFrameRate: Int = 30
-    static let remoteBitrate: Int = 6_000_000     // 6 Mbps (target range: 4-10)
-    static let remoteMinBitrate: Int = 4_000_000  // Floor for adaptive
-    static let remoteMaxBitrate: Int = 10_000_000 // Ceiling for adaptive
-    static let remoteMinFPS: Int = 20             // Floor when congested
-    static let remoteMaxFPS: Int = 30             // Target FPS
-    static let remoteGOPDuration: Double = 0.5    // Short GOP (0.5s) for faster recovery
-
-    
-    // Resolution limits
-    static let maxRenderPixels: Double = 8_000_000  // ~8MP cap for render resolution
-    
-    // Frame cache settings
-    nonisolated static let frameCacheTTL: TimeInterval = 1.0  // Seconds before cached frames expire
-    nonisolated static let cachePruneInterval: Int = 60       // Prune every N frames
-    
-    // Quality presets defaults
+extension AirCatchConfig {
     static let defaultPreset: QualityPreset = .balanced
 }
 
-
 // MARK: - Quality Presets
 // Optimized for HEVC on Apple Silicon (M2/M3)
 // 3 presets: one for each use case
@@ -146,26 +78,6 @@ enum QualityPreset: String, Codable, CaseIterable {
     }
 }
 
-// MARK: - Packet Types
-
-enum PacketType: UInt8 {
-    case videoFrame = 0x01
-    case touchEvent = 0x02
-    case handshake = 0x03
-    case handshakeAck = 0x04
-    case disconnect = 0x05
-    case scrollEvent = 0x06
-    case keyEvent = 0x07       // Keyboard input
-    case qualityReport = 0x08  // Client reports quality metrics
-    case ping = 0x09
-    case pong = 0x0A
-    case videoFrameChunk = 0x0C
-    case pairingFailed = 0x0D  // PIN mismatch
-    case videoFrameChunkNack = 0x0E // Client requests resend of missing chunks (lossless mode)
-    case audioPCM = 0x0F
-    case mediaKeyEvent = 0x10  // Media keys (volume, brightness, play/pause, etc.)
-}
-
 // MARK: - Connection/Codec Preferences
 
 enum ConnectionMode: String, Codable {
@@ -180,11 +92,6 @@ enum CodecPreference: String, Codable {
     case h264
 }
 
-struct Packet {
-    let type: PacketType
-    let payload: Data
-}
-
 // MARK: - Lossless Video (UDP Retransmit)
 
 /// Sent by client over TCP when some UDP chunks for a frame are missing.
@@ -219,10 +126,24 @@ struct HandshakeRequest: Codable {
     /// When true, client requests lossless-ish video delivery (UDP + retransmit over TCP).
     let losslessVideo: Bool?
     let deviceId: String?           // Unique device identifier for trusted devices
-    let pin: String?                // PIN for pairing verification
+    let pin: String?                // PIN in clear, from clients predating `pinProof`
     /// When true, stream at host's native resolution instead of scaling to client resolution.
     /// This provides higher quality but may require letterboxing on the client.
     let optimizeForHostDisplay: Bool?
+    /// When true, client can parse dirty-region metadata in the video frame header.
+    let supportsDirtyRegions: Bool?
+    /// When true, client can send input as `.inputBatch` datagrams on the UDP input lane.
+    let supportsInputLane: Bool?
+    /// When true, client can parse `.videoFrameChunkLayered` chunks.
+    let supportsFrameLayers: Bool?
+    /// When true, client can open large frames sealed as parallel segments.
+    let supportsSegmentedSealing: Bool?
+    /// Client's ephemeral X25519 public key; the host answers with `.sessionKeys`.
+    let keyShare: Data?
+    /// `AEADCipher` raw values the client can open, fastest on the client first.
+    let supportedCiphers: [String]?
+    /// `KeySchedule.pinProof` over `keyShare`, sent instead of `pin`.
+    let pinProof: Data?
     
     init(clientName: String,
          clientVersion: String,
@@ -242,7 +163,14 @@ struct HandshakeRequest: Codable {
          losslessVideo: Bool? = nil,
          deviceId: String? = nil,
          pin: String? = nil,
-         optimizeForHostDisplay: Bool? = nil) {
+         optimizeForHostDisplay: Bool? = nil,
+         supportsDirtyRegions: Bool? = nil,
+         supportsInputLane: Bool? = nil,
+         supportsFrameLayers: Bool? = nil,
+         supportsSegmentedSealing: Bool? = nil,
+         keyShare: Data? = nil,
+         supportedCiphers: [String]? = nil,
+         pinProof: Data? = nil) {
         self.clientName = clientName
         self.clientVersion = clientVersion
         self.deviceModel = deviceModel
@@ -262,6 +190,13 @@ struct HandshakeRequest: Codable {
         self.deviceId = deviceId
         self.pin = pin
         self.optimizeForHostDisplay = optimizeForHostDisplay
+        self.supportsDirtyRegions = supportsDirtyRegions
+        self.supportsInputLane = supportsInputLane
+        self.supportsFrameLayers = supportsFrameLayers
+        self.supportsSegmentedSealing = supportsSegmentedSealing
+        self.keyShare = keyShare
+        self.supportedCiphers = supportedCiphers
+        self.pinProof = pinProof
     }
 }
 
@@ -279,11 +214,16 @@ struct HandshakeAck: Codable {
     let displayMode: StreamDisplayMode?
     /// Position of extended display (if virtual display is active)
     let displayPosition: ExtendedDisplayPosition?
+    /// Whether the host accepts input on the UDP input lane
+    let inputLane: Bool?
+    /// Opaque ticket for `SessionResumeRequest` after a drop (set by the host when it acknowledges)
+    var resumeTicket: String?
     
     init(width: Int, height: Int, frameRate: Int, hostName: String,
          qualityPreset: QualityPreset? = nil, bitrate: Int? = nil,
          isVirtualDisplay: Bool? = nil, displayMode: StreamDisplayMode? = nil,
-         displayPosition: ExtendedDisplayPosition? = nil) {
+         displayPosition: ExtendedDisplayPosition? = nil,
+         inputLane: Bool? = nil, resumeTicket: String? = nil) {
         self.width = width
         self.height = height
         self.frameRate = frameRate
@@ -293,6 +233,8 @@ struct HandshakeAck: Codable {
         self.isVirtualDisplay = isVirtualDisplay
         self.displayMode = displayMode
         self.displayPosition = displayPosition
+        self.inputLane = inputLane
+        self.resumeTicket = resumeTicket
     }
 }
 
@@ -390,6 +332,28 @@ struct MediaKeyEvent: Codable {
     }
 }
 
+// MARK: - Input Lane
+
+/// One sequenced input event. Exactly one of the event fields is set.
+/// Sequence numbers are shared by all event kinds and let the host drop
+/// duplicates (redundant datagrams, TCP copies) and stale pointer motion.
+struct InputLaneEvent: Codable {
+    let sequenceNumber: UInt32
+    var touch: TouchEvent? = nil
+    var scroll: ScrollEvent? = nil
+    var key: KeyEvent? = nil
+    var mediaKey: MediaKeyEvent? = nil
+}
+
+/// Encrypted payload of `.inputBatch`. Events are oldest first; on UDP the most
+/// recent events are repeated in every datagram so a lost datagram loses nothing.
+struct InputBatch: Codable {
+    let events: [InputLaneEvent]
+    /// Random per client session (never 0); keys the host's sequence window so
+    /// several clients don't filter each other's input. Nil from older clients.
+    var laneId: UInt32? = nil
+}
+
 // MARK: - Quality Report
 
 struct QualityReport: Codable {
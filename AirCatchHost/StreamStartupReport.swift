@@ -0,0 +1,21 @@
+//
+//  StreamStartupReport.swift
+//  AirCatchHost
+//
+//  Host-side timing of a stream startup, sent to the client.
+//
+
+import Foundation
+
+/// Host-side breakdown of a stream startup, in milliseconds from the start request.
+///
+/// Steps overlap, so they don't add up: the encoder is built while the virtual
+/// display comes online and screen content is enumerated.
+nonisolated struct StreamStartupReport: Codable, Equatable {
+    /// Virtual display online with its HiDPI mode applied (nil when mirroring an existing display)
+    let displayReadyMs: Int?
+    let encoderReadyMs: Int
+    let captureStartedMs: Int
+    /// First frame handed to the transport
+    let firstFrameMs: Int
+}
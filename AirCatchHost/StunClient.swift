@@ -8,15 +8,18 @@
 import Foundation
 import Network
 
-enum StunClient {
+nonisolated enum StunClient {
     struct MappedAddress {
         let ip: String
         let port: UInt16
     }
 
+    /// - Parameter localPort: Binds the request to this local port (with address reuse) so the
+    ///   mapping matches other sockets on the same port, e.g. for hole punching.
     static func discoverMappedAddress(
         host: String = "stun.l.google.com",
         port: UInt16 = 19302,
+        localPort: UInt16? = nil,
         timeout: TimeInterval = 2.0,
         completion: @escaping (MappedAddress?) -> Void
     ) {
@@ -25,7 +28,13 @@ enum StunClient {
             return
         }
 
-        let connection = NWConnection(host: NWEndpoint.Host(host), port: nwPort, using: .udp)
+        let parameters = NWParameters.udp
+        if let localPort, let boundPort = NWEndpoint.Port(rawValue: localPort) {
+            parameters.allowLocalEndpointReuse = true
+            parameters.requiredLocalEndpoint = .hostPort(host: .ipv4(.any), port: boundPort)
+        }
+
+        let connection = NWConnection(host: NWEndpoint.Host(host), port: nwPort, using: parameters)
         connection.stateUpdateHandler = { state in
             switch state {
             case .ready:
@@ -0,0 +1,38 @@
+//
+//  UDPSendTargets.swift
+//  AirCatchHost
+//
+//  Snapshot of the ready UDP flows that the per-chunk send paths read.
+//
+
+import Foundation
+
+/// Ready UDP flows, as an immutable snapshot for the per-chunk send paths.
+/// `NetworkManager` rebuilds it on its queue only when a flow becomes ready, fails
+/// or goes away, so senders take one short lock instead of waiting behind the
+/// receive loops.
+nonisolated struct UDPSendTargets<Connection> {
+    static var empty: UDPSendTargets { UDPSendTargets(connections: [], viewers: []) }
+
+    /// Every ready flow, listener and registered
+    let connections: [Connection]
+    /// One flow per client host (see `NetworkManager.udpViewerConnections()`)
+    let viewers: [(id: String, connection: Connection)]
+
+    init(connections: [Connection], viewers: [(id: String, connection: Connection)]) {
+        self.connections = connections
+        self.viewers = viewers
+    }
+
+    /// - Parameters:
+    ///   - ready: Ready flows; a later flow for the same host replaces an earlier one.
+    ///   - host: The client host a flow reaches, or nil to leave it out of `viewers`.
+    init(ready: [Connection], host: (Connection) -> String?) {
+        var byHost: [String: Connection] = [:]
+        for connection in ready {
+            guard let id = host(connection) else { continue }
+            byHost[id] = connection
+        }
+        self.init(connections: ready, viewers: byHost.map { (id: $0.key, connection: $0.value) })
+    }
+}
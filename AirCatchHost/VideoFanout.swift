@@ -0,0 +1,461 @@
+//
+//  VideoFanout.swift
+//  AirCatchHost
+//
+//  Per-viewer send queues, pacing and rate adaptation for local UDP video.
+//
+
+import Foundation
+import Synchronization
+
+/// Where a viewer's datagrams go. `NWConnection` in the app (see NetworkManager).
+nonisolated protocol VideoDatagramSink: AnyObject {
+    /// Hands every datagram `block` sends to the transport as one batch.
+    func batch(_ block: () -> Void)
+    /// - Parameter completion: Called once the datagram left the process (or failed).
+    func send(datagram: Data, completion: @escaping @Sendable () -> Void)
+}
+
+/// Fans encoded video frames out to each local UDP viewer independently.
+///
+/// Every viewer has its own serial queue, frame backlog, token-bucket pacer,
+/// retransmit cache and rate estimate, so a viewer on a weak link only thins
+/// its own stream. The rate estimate is AIMD: NACKed chunks and a backlog that
+/// overruns the pacer cut it, clean intervals grow it back.
+///
+/// Only viewers that negotiated lossless video keep sent frames for retransmits.
+/// For the rest, a frame's pooled slab goes back to `FrameBufferPool` as soon as
+/// its last datagram is sent.
+///
+/// Admission follows `FrameDropPolicy` with a budget of
+/// `AirCatchConfig.fanoutMaxQueueDelay` at the viewer's current rate: droppable
+/// frames are skipped first. If a reference frame has to go, that viewer skips
+/// everything until the next keyframe and asks the encoder for one.
+nonisolated final class VideoFanout {
+
+    /// One encoded frame, already split into complete datagrams (`[type][chunk header][chunk]`).
+    struct Frame {
+        let frameId: UInt32
+        let tag: FrameLayerTag
+        let datagrams: [Data]
+        let byteCount: Int
+
+        init(frameId: UInt32, tag: FrameLayerTag, datagrams: [Data]) {
+            self.frameId = frameId
+            self.tag = tag
+            self.datagrams = datagrams
+            self.byteCount = datagrams.reduce(0) { $0 + $1.count }
+        }
+    }
+
+    private let viewers = Mutex<[String: Viewer]>([:])
+    /// Viewer ids that negotiated lossless video, kept across viewer re-creation
+    private let retransmitViewers = Mutex<Set<String>>([])
+    private let onKeyframeNeeded: @Sendable () -> Void
+
+    /// - Parameter onKeyframeNeeded: Called from a viewer queue when a viewer
+    ///   can't decode again until the next keyframe.
+    init(onKeyframeNeeded: @escaping @Sendable () -> Void) {
+        self.onKeyframeNeeded = onKeyframeNeeded
+    }
+
+    // MARK: - Viewers
+
+    /// Queues a frame for every viewer in `connections`.
+    /// The viewer table follows the list: new ids get a fresh viewer, missing ids are dropped.
+    func submit<Sink: VideoDatagramSink>(_ frame: Frame, to connections: [(id: String, connection: Sink)]) {
+        syncViewers(with: connections).forEach { $0.enqueue(frame) }
+    }
+
+    /// Sets up viewers ahead of the first frame (stream startup), so the first
+    /// keyframe doesn't wait on queue and pacer creation.
+    func prepare<Sink: VideoDatagramSink>(_ connections: [(id: String, connection: Sink)]) {
+        _ = syncViewers(with: connections)
+    }
+
+    /// - Returns: The viewers for `connections`.
+    private func syncViewers<Sink: VideoDatagramSink>(with connections: [(id: String, connection: Sink)]) -> [Viewer] {
+        var removed: [Viewer] = []
+        let retransmitting = retransmitViewers.withLock { $0 }
+        let active = viewers.withLock { table -> [Viewer] in
+            var next: [String: Viewer] = [:]
+            next.reserveCapacity(connections.count)
+            for (id, connection) in connections {
+                if let viewer = table[id], viewer.connection === connection {
+                    next[id] = viewer
+                } else {
+                    next[id] = Viewer(id: id, connection: connection, cachesSentFrames: retransmitting.contains(id),
+                                      onKeyframeNeeded: onKeyframeNeeded)
+                }
+            }
+            for (id, viewer) in table where next[id] !== viewer {
+                removed.append(viewer)
+            }
+            table = next
+            return Array(next.values)
+        }
+
+        removed.forEach { $0.close() }
+        return active
+    }
+
+    /// Keeps sent frames for `id`'s retransmits while `enabled` (the viewer negotiated lossless video).
+    func setRetransmits(_ enabled: Bool, forViewer id: String) {
+        retransmitViewers.withLock { ids in
+            if enabled {
+                ids.insert(id)
+            } else {
+                ids.remove(id)
+            }
+        }
+        viewers.withLock { $0[id] }?.setCachesSentFrames(enabled)
+    }
+
+    /// Frames `id` holds for retransmits (diagnostics and tests).
+    func cachedFrameCount(forViewer id: String) -> Int {
+        viewers.withLock { $0[id] }?.cachedFrameCount() ?? 0
+    }
+
+    /// Resends chunks a viewer reported missing, from that viewer's own cache and queue.
+    func handleNack(viewerId: String, frameId: UInt32, missingChunkIndices: [UInt16]) {
+        guard let viewer = viewers.withLock({ $0[viewerId] }) else { return }
+        viewer.retransmit(frameId: frameId, chunkIndices: missingChunkIndices)
+    }
+
+    /// Drops every viewer and its queued data (streaming stopped).
+    func removeAll() {
+        let removed = viewers.withLock { table -> [Viewer] in
+            defer { table.removeAll() }
+            return Array(table.values)
+        }
+        removed.forEach { $0.close() }
+    }
+}
+
+// MARK: - Viewer
+
+/// Thread-safe by confinement: everything mutable lives on `queue`, apart from the locked `inFlightBytes`.
+private nonisolated final class Viewer: @unchecked Sendable {
+
+    /// How often the rate estimate is re-evaluated
+    private static let adaptInterval: TimeInterval = 0.5
+    /// Loss above this cuts the rate; below `increaseLossRatio` lets it grow
+    private static let decreaseLossRatio = 0.05
+    private static let increaseLossRatio = 0.01
+    private static let decreaseFactor = 0.7
+    /// Minimum spacing of keyframe requests from one viewer
+    private static let keyframeRequestInterval: TimeInterval = 0.5
+    /// Pacer burst: enough for a handful of datagrams per wakeup
+    private static let minBurstBytes = 16.0 * Double(AirCatchConfig.maxUDPPayloadSize + 9)
+
+    let id: String
+    let connection: VideoDatagramSink
+    private let queue: DispatchQueue
+    private let onKeyframeNeeded: @Sendable () -> Void
+
+    /// Bytes handed to the sink but not yet written to the socket
+    private let inFlightBytes = InFlightBytes()
+
+    // State below is only touched on `queue`
+
+    // Send queue
+    private var backlog: [VideoFanout.Frame] = []
+    private var backlogHead = 0
+    /// Next datagram of `backlog[backlogHead]`
+    private var nextDatagram = 0
+    private var backlogBytes = 0
+    private var retransmitQueue: [(datagram: Data, requestedAt: TimeInterval)] = []
+    private var retransmitHead = 0
+    /// A viewer joining mid-stream can't decode until the next keyframe
+    private var dropPolicy = FrameDropPolicy(waitingForKeyframe: true)
+    private var lastKeyframeRequest: TimeInterval = 0
+
+    // Pacing (bytes per second)
+    private var rate = Double(AirCatchConfig.fanoutMaxPacingRate) / 8
+    private var tokens = 0.0
+    private var lastRefill: TimeInterval
+    private var drainScheduled = false
+    private var closed = false
+
+    // Retransmit cache (lossless viewers only): frames whose first chunk went out, keyed by frame id.
+    // sentOrder lists them oldest first (consumed from sentOrderHead) so expiry is O(1) per insert.
+    private var sentFrames: [UInt32: (sentAt: TimeInterval, frame: VideoFanout.Frame)] = [:]
+    private var sentOrder: [(frameId: UInt32, sentAt: TimeInterval)] = []
+    private var sentOrderHead = 0
+    private var cachesSentFrames: Bool
+
+    // Congestion estimate for the current interval
+    private var intervalStart: TimeInterval
+    private var intervalSentChunks = 0
+    private var intervalLostChunks = 0
+    private var intervalOverran = false
+    /// Retransmits sent, and their total time from NACK to the socket
+    private var intervalRetransmits = 0
+    private var intervalRetransmitDelay: TimeInterval = 0
+
+    init(id: String, connection: VideoDatagramSink, cachesSentFrames: Bool, onKeyframeNeeded: @escaping @Sendable () -> Void) {
+        self.id = id
+        self.connection = connection
+        self.cachesSentFrames = cachesSentFrames
+        self.queue = DispatchQueue(label: "com.aircatch.fanout.\(id)", qos: .userInteractive)
+        self.onKeyframeNeeded = onKeyframeNeeded
+        let now = ProcessInfo.processInfo.systemUptime
+        self.lastRefill = now
+        self.intervalStart = now
+        AirCatchLog.info("Video viewer added: \(id)", category: .video)
+    }
+
+    // MARK: - Entry Points
+
+    func enqueue(_ frame: VideoFanout.Frame) {
+        queue.async {
+            guard !self.closed else { return }
+            self.accept(frame)
+        }
+    }
+
+    func retransmit(frameId: UInt32, chunkIndices: [UInt16]) {
+        queue.async {
+            guard !self.closed else { return }
+            self.intervalLostChunks += chunkIndices.count
+            // Chunks of frames before a skipped reference frame can't help the decoder
+            guard !self.dropPolicy.waitingForKeyframe, let entry = self.sentFrames[frameId] else { return }
+            let datagrams = entry.frame.datagrams
+            let now = ProcessInfo.processInfo.systemUptime
+            for index in chunkIndices where Int(index) < datagrams.count {
+                self.retransmitQueue.append((datagrams[Int(index)], now))
+            }
+            self.drain()
+        }
+    }
+
+    func setCachesSentFrames(_ enabled: Bool) {
+        queue.async {
+            self.cachesSentFrames = enabled
+            if !enabled {
+                self.clearSentFrames()
+            }
+        }
+    }
+
+    func cachedFrameCount() -> Int {
+        queue.sync { sentFrames.count }
+    }
+
+    func close() {
+        queue.async {
+            self.closed = true
+            self.backlog.removeAll()
+            self.retransmitQueue.removeAll()
+            self.clearSentFrames()
+            AirCatchLog.info("Video viewer removed: \(self.id) (dropped \(self.dropPolicy.droppedFrames), thinned \(self.dropPolicy.thinnedFrames))", category: .video)
+        }
+    }
+
+    // MARK: - Admission
+
+    private func accept(_ frame: VideoFanout.Frame) {
+        let now = ProcessInfo.processInfo.systemUptime
+        adaptIfNeeded(now: now)
+
+        if frame.tag.isKeyframe {
+            // Everything not yet started is superseded by the keyframe
+            discardQueuedFrames()
+        }
+
+        let decision = dropPolicy.admit(
+            frame.tag,
+            frameBytes: frame.byteCount,
+            queuedBytes: backlogBytes + inFlightBytes.value,
+            budget: rate * AirCatchConfig.fanoutMaxQueueDelay
+        )
+        switch decision {
+        case .send:
+            break
+        case .thin:
+            intervalOverran = true
+            return
+        case .drop:
+            intervalOverran = true
+            requestKeyframe(now: now)
+            return
+        }
+
+        backlog.append(frame)
+        backlogBytes += frame.byteCount
+        drain()
+    }
+
+    /// Drops queued frames that haven't started sending. A partly sent frame is finished.
+    private func discardQueuedFrames() {
+        let firstUnstarted = nextDatagram > 0 ? backlogHead + 1 : backlogHead
+        guard firstUnstarted < backlog.count else { return }
+        for frame in backlog[firstUnstarted...] {
+            backlogBytes -= frame.byteCount
+        }
+        backlog.removeSubrange(firstUnstarted...)
+    }
+
+    private func requestKeyframe(now: TimeInterval) {
+        guard now - lastKeyframeRequest >= Self.keyframeRequestInterval else { return }
+        lastKeyframeRequest = now
+        onKeyframeNeeded()
+    }
+
+    // MARK: - Pacing
+
+    private func drain() {
+        guard !drainScheduled, !closed else { return }
+        let now = ProcessInfo.processInfo.systemUptime
+        let burst = max(rate * 0.002, Self.minBurstBytes)
+        tokens = min(burst, tokens + (now - lastRefill) * rate)
+        lastRefill = now
+
+        // Everything the pacer allows now goes to Network.framework as one batch
+        connection.batch {
+            while let datagram = nextToSend() {
+                let size = Double(datagram.count)
+                if tokens < size {
+                    drainScheduled = true
+                    let wait = (size - tokens) / rate
+                    queue.asyncAfter(deadline: .now() + max(wait, 0.0005)) { [weak self] in
+                        guard let self else { return }
+                        self.drainScheduled = false
+                        self.drain()
+                    }
+                    return
+                }
+                tokens -= size
+                advance(now: now)
+                send(datagram)
+            }
+        }
+    }
+
+    /// Retransmits go ahead of new frames.
+    private func nextToSend() -> Data? {
+        if retransmitHead < retransmitQueue.count {
+            return retransmitQueue[retransmitHead].datagram
+        }
+        if backlogHead < backlog.count {
+            return backlog[backlogHead].datagrams[nextDatagram]
+        }
+        return nil
+    }
+
+    private func advance(now: TimeInterval) {
+        if retransmitHead < retransmitQueue.count {
+            intervalRetransmits += 1
+            intervalRetransmitDelay += now - retransmitQueue[retransmitHead].requestedAt
+            retransmitHead += 1
+            if retransmitHead == retransmitQueue.count {
+                retransmitQueue.removeAll(keepingCapacity: true)
+                retransmitHead = 0
+            }
+            return
+        }
+
+        let frame = backlog[backlogHead]
+        if nextDatagram == 0 && cachesSentFrames {
+            cacheSentFrame(frame, now: now)
+        }
+        backlogBytes -= frame.datagrams[nextDatagram].count
+        nextDatagram += 1
+        if nextDatagram == frame.datagrams.count {
+            nextDatagram = 0
+            backlogHead += 1
+            if backlogHead == backlog.count {
+                backlog.removeAll(keepingCapacity: true)
+                backlogHead = 0
+            }
+        }
+    }
+
+    private func send(_ datagram: Data) {
+        let size = datagram.count
+        intervalSentChunks += 1
+        let inFlight = inFlightBytes
+        inFlight.add(size)
+        connection.send(datagram: datagram) {
+            inFlight.add(-size)
+        }
+    }
+
+    private func clearSentFrames() {
+        sentFrames.removeAll()
+        sentOrder.removeAll()
+        sentOrderHead = 0
+    }
+
+    /// Caches a frame for retransmits, expiring frames past `frameCacheTTL` or beyond
+    /// `frameCacheLimit` from the old end on every insert.
+    private func cacheSentFrame(_ frame: VideoFanout.Frame, now: TimeInterval) {
+        sentFrames[frame.frameId] = (now, frame)
+        sentOrder.append((frame.frameId, now))
+
+        while sentOrderHead < sentOrder.count {
+            let oldest = sentOrder[sentOrderHead]
+            guard now - oldest.sentAt > AirCatchConfig.frameCacheTTL
+                    || sentOrder.count - sentOrderHead > AirCatchConfig.frameCacheLimit else { break }
+            // A wrapped frame id may have been cached again since
+            if sentFrames[oldest.frameId]?.sentAt == oldest.sentAt {
+                sentFrames[oldest.frameId] = nil
+            }
+            sentOrderHead += 1
+        }
+        if sentOrderHead >= AirCatchConfig.frameCacheLimit {
+            sentOrder.removeFirst(sentOrderHead)
+            sentOrderHead = 0
+        }
+    }
+
+    // MARK: - Rate Adaptation
+
+    private func adaptIfNeeded(now: TimeInterval) {
+        guard now - intervalStart >= Self.adaptInterval else { return }
+
+        let lossRatio = intervalSentChunks > 0
+            ? Double(intervalLostChunks) / Double(intervalSentChunks)
+            : 0
+        let minRate = Double(AirCatchConfig.fanoutMinPacingRate) / 8
+        let maxRate = Double(AirCatchConfig.fanoutMaxPacingRate) / 8
+
+        if lossRatio > Self.decreaseLossRatio {
+            rate = max(minRate, rate * Self.decreaseFactor)
+        } else if lossRatio < Self.increaseLossRatio {
+            // Additive increase: 1 Mbps per interval, faster while the backlog keeps overrunning
+            let step = intervalOverran ? rate * 0.1 : 125_000
+            rate = min(maxRate, rate + step)
+        }
+
+        #if DEBUG
+        if lossRatio > Self.decreaseLossRatio || intervalOverran {
+            AirCatchLog.debug("Viewer \(id): \(Int(rate * 8 / 1_000_000)) Mbps, loss \(Int(lossRatio * 100))%, dropped \(dropPolicy.droppedFrames), thinned \(dropPolicy.thinnedFrames)", category: .video)
+        }
+        if intervalRetransmits > 0 {
+            let averageDelay = intervalRetransmitDelay / Double(intervalRetransmits) * 1000
+            AirCatchLog.debug("Viewer \(id): \(intervalRetransmits) retransmits, \(String(format: "%.1f", averageDelay)) ms NACK-to-send", category: .video)
+        }
+        #endif
+
+        intervalStart = now
+        intervalSentChunks = 0
+        intervalLostChunks = 0
+        intervalOverran = false
+        intervalRetransmits = 0
+        intervalRetransmitDelay = 0
+    }
+}
+
+/// Bytes a viewer handed to its sink and not yet seen complete, shared with send completions.
+private nonisolated final class InFlightBytes: Sendable {
+    private let bytes = Mutex(0)
+
+    var value: Int {
+        bytes.withLock { $0 }
+    }
+
+    func add(_ count: Int) {
+        bytes.withLock { $0 += count }
+    }
+}
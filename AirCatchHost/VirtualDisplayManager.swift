@@ -181,13 +181,8 @@ final class VirtualDisplayManager {
             displayHeight = logicalHeight
             isVirtualDisplayActive = true
             
-            // Wait for display to appear, then set the HiDPI mode
-            DispatchQueue.main.asyncAfter(deadline: .now() + 0.5) { [weak self] in
-                guard let self = self else { return }
-                self.updateDisplayFrame()
-                // Select the HiDPI mode at logical resolution
-                self.setHiDPIMode(displayID: displayID, logicalWidth: logicalWidth, logicalHeight: logicalHeight)
-            }
+            // Set the HiDPI mode once the display comes online (see waitUntilReady())
+            beginReadinessTracking(displayID: displayID, logicalWidth: logicalWidth, logicalHeight: logicalHeight)
             
             AirCatchLog.info("✅ Virtual display created: ID=\(displayID)")
             AirCatchLog.info("   Physical: \(physicalWidth)×\(physicalHeight), HiDPI: \(logicalWidth)×\(logicalHeight)")
@@ -262,10 +257,97 @@ final class VirtualDisplayManager {
         displayHeight = 0
         displayFrame = .zero
         isVirtualDisplayActive = false
+        finishReadinessTracking(ready: false)
         
         AirCatchLog.info("Virtual display destroyed")
     }
     
+    // MARK: - Display Readiness
+    
+    /// The virtual display is online with its HiDPI mode applied
+    private(set) var isDisplayReady = false
+    private var readinessWaiters: [CheckedContinuation<Bool, Never>] = []
+    /// Mode to apply when the display comes online
+    private var pendingLogicalSize: (width: Int, height: Int)?
+    private var readinessGeneration = 0
+    private var isObservingReconfiguration = false
+    
+    /// Delivered on the main run loop, where it is registered
+    private static let reconfigurationCallback: CGDisplayReconfigurationCallBack = { displayID, flags, userInfo in
+        guard let userInfo, !flags.contains(.beginConfigurationFlag) else { return }
+        let manager = Unmanaged<VirtualDisplayManager>.fromOpaque(userInfo).takeUnretainedValue()
+        MainActor.assumeIsolated {
+            manager.displayReconfigured(displayID)
+        }
+    }
+    
+    /// Suspends until the virtual display can be captured.
+    ///
+    /// A new display shows up asynchronously; capturing it earlier finds no
+    /// `SCDisplay` or the pre-HiDPI mode. Ready means the system reported it online
+    /// and the HiDPI mode was applied, or `virtualDisplayReadyTimeout` passed.
+    /// - Returns: false if there is no virtual display, or it was destroyed while waiting.
+    func waitUntilReady() async -> Bool {
+        guard isVirtualDisplayActive else { return false }
+        if isDisplayReady { return true }
+        return await withCheckedContinuation { continuation in
+            readinessWaiters.append(continuation)
+        }
+    }
+    
+    private func beginReadinessTracking(displayID: CGDirectDisplayID, logicalWidth: Int, logicalHeight: Int) {
+        isDisplayReady = false
+        pendingLogicalSize = (logicalWidth, logicalHeight)
+        readinessGeneration += 1
+        let generation = readinessGeneration
+        
+        if !isObservingReconfiguration {
+            isObservingReconfiguration = true
+            CGDisplayRegisterReconfigurationCallback(Self.reconfigurationCallback, Unmanaged.passUnretained(self).toOpaque())
+        }
+        
+        // It may already be online by the time the callback is in place
+        if CGDisplayIsOnline(displayID) != 0 {
+            displayReconfigured(displayID)
+            return
+        }
+        
+        DispatchQueue.main.asyncAfter(deadline: .now() + AirCatchConfig.virtualDisplayReadyTimeout) { [weak self] in
+            MainActor.assumeIsolated {
+                guard let self, generation == self.readinessGeneration, !self.isDisplayReady,
+                      let displayID = self.virtualDisplayID else { return }
+                AirCatchLog.info("Virtual display not reported online after \(AirCatchConfig.virtualDisplayReadyTimeout)s, continuing")
+                self.displayCameOnline(displayID)
+            }
+        }
+    }
+    
+    private func displayReconfigured(_ displayID: CGDirectDisplayID) {
+        guard displayID == virtualDisplayID, !isDisplayReady, CGDisplayIsOnline(displayID) != 0 else { return }
+        displayCameOnline(displayID)
+    }
+    
+    private func displayCameOnline(_ displayID: CGDirectDisplayID) {
+        guard let size = pendingLogicalSize else { return }
+        pendingLogicalSize = nil
+        updateDisplayFrame()
+        // Select the HiDPI mode at logical resolution (synchronous)
+        setHiDPIMode(displayID: displayID, logicalWidth: size.width, logicalHeight: size.height)
+        finishReadinessTracking(ready: true)
+    }
+    
+    private func finishReadinessTracking(ready: Bool) {
+        isDisplayReady = ready
+        pendingLogicalSize = nil
+        if isObservingReconfiguration {
+            isObservingReconfiguration = false
+            CGDisplayRemoveReconfigurationCallback(Self.reconfigurationCallback, Unmanaged.passUnretained(self).toOpaque())
+        }
+        let waiters = readinessWaiters
+        readinessWaiters.removeAll()
+        waiters.forEach { $0.resume(returning: ready) }
+    }
+    
     /// Returns the bounds of the virtual display for screen capture.
     func getDisplayBounds() -> CGRect {
         guard let displayID = virtualDisplayID else {
@@ -0,0 +1,38 @@
+// swift-tools-version: 6.1
+//
+//  Package.swift
+//  PortableTests
+//
+//  Linux-runnable tests and benchmarks for the platform-independent parts of the apps.
+//
+
+import PackageDescription
+
+// Sources/AirCatchPortable links to the apps' own files rather than copies, so
+// what is tested and measured here is the code that ships. `swift test` runs the
+// tests; `swift run -c release AirCatchPortable` runs the benchmarks.
+// swift-crypto stands in for CryptoKit off Apple platforms, with the same API.
+let package = Package(
+    name: "AirCatchPortable",
+    // Synchronization.Mutex, as the host app uses
+    platforms: [.macOS(.v15)],
+    dependencies: [
+        .package(url: "https://github.com/apple/swift-crypto.git", "3.0.0"..<"5.0.0"),
+    ],
+    targets: [
+        .executableTarget(
+            name: "AirCatchPortable",
+            dependencies: [
+                .product(name: "Crypto", package: "swift-crypto", condition: .when(platforms: [.linux])),
+            ]
+        ),
+        .testTarget(
+            name: "AirCatchPortableTests",
+            dependencies: [
+                "AirCatchPortable",
+                .product(name: "Crypto", package: "swift-crypto", condition: .when(platforms: [.linux])),
+            ]
+        ),
+    ],
+    swiftLanguageModes: [.v5]
+)
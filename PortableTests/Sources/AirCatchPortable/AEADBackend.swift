@@ -0,0 +1 @@
+../../../AirCatchHost/AEADBackend.swift
\ No newline at end of file
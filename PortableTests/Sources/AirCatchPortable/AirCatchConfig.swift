@@ -0,0 +1 @@
+../../../AirCatchHost/AirCatchConfig.swift
\ No newline at end of file
@@ -0,0 +1 @@
+../../../AirCatchHost/AirCatchLog.swift
\ No newline at end of file
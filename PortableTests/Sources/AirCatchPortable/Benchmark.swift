@@ -0,0 +1,36 @@
+//
+//  Benchmark.swift
+//  PortableTests
+//
+//  Minimal timing loop for the benchmark executable.
+//
+
+import Foundation
+
+/// Runs `body` until `minimumDuration` has passed and reports throughput.
+/// - Parameter bytesPerIteration: Input bytes one call processes, for MB/s.
+func benchmark(_ name: String, bytesPerIteration: Int, minimumDuration: Duration = .milliseconds(500), _ body: () -> Void) {
+    // Warm caches and branch predictors before timing
+    for _ in 0..<16 { body() }
+
+    let clock = ContinuousClock()
+    var iterations = 0
+    let elapsed = clock.measure {
+        let deadline = clock.now.advanced(by: minimumDuration)
+        repeat {
+            body()
+            iterations += 1
+        } while clock.now < deadline
+    }
+
+    let seconds = Double(elapsed.components.seconds) + Double(elapsed.components.attoseconds) / 1e18
+    let perCall = seconds / Double(iterations) * 1e6
+    let megabytesPerSecond = Double(bytesPerIteration * iterations) / seconds / 1e6
+    print("\(name.padding(toLength: 44, withPad: " ", startingAt: 0)) \(String(format: "%9.2f", perCall)) us/call \(String(format: "%9.0f", megabytesPerSecond)) MB/s")
+}
+
+/// Keeps the optimizer from deleting work whose result is otherwise unused.
+@inline(never)
+func blackHole<T>(_ value: T) {
+    withExtendedLifetime(value) {}
+}
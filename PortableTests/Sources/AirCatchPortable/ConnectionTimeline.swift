@@ -0,0 +1 @@
+../../../AirCatchClient/ConnectionTimeline.swift
\ No newline at end of file
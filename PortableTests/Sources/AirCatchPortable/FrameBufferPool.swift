@@ -0,0 +1 @@
+../../../AirCatchHost/FrameBufferPool.swift
\ No newline at end of file
@@ -0,0 +1,76 @@
+//
+//  FrameBufferPoolBenchmarks.swift
+//  PortableTests
+//
+//  Allocations per frame through FrameBufferPool, by how long viewers keep sent frames.
+//
+
+import Foundation
+
+/// Each frame takes the pooled buffers the host uses: Annex B output (ScreenStreamer),
+/// the sealed frame (CryptoManager) and the datagram slab (HostManager). The first two
+/// are released as the next stage takes over; the slab is released when the fan-out is
+/// done with it.
+///
+/// `release at send`: no viewer keeps sent frames (lossless video off).
+/// `1 s cache`: a lossless viewer holds each slab for `frameCacheTTL`, so the last
+/// frame rate's worth of slabs is live at once.
+enum FrameBufferPoolBenchmarks {
+
+    static let bitsPerSecond = 20_000_000.0
+    /// `AirCatchConfig.maxUDPPayloadSize`, and a layered chunk prefix
+    static let payloadSize = 1200
+    static let prefixSize = 10
+    static let overhead = 28
+
+    static let scenarios: [(name: String, frameRate: Double, heldFrames: Int)] = [
+        ("release at send, 60 fps", 60, 0),
+        ("1 s cache, 60 fps", 60, 60),
+        ("1 s cache, 120 fps", 120, 120),
+    ]
+
+    static func run() {
+        print("Frame buffer pool, 20 Mbps stream, jittered P-frames")
+        for scenario in scenarios {
+            let pool = FrameBufferPool()
+            let averageBytes = bitsPerSecond / 8 / scenario.frameRate
+            var held: [Data] = []
+            var heldHead = 0
+            var random: UInt32 = 0x9E37_79B9
+            var frames = 0
+
+            func sendFrame() {
+                random ^= random << 13
+                random ^= random >> 17
+                random ^= random << 5
+                let size = Int(averageBytes * (0.5 + Double(random) / Double(UInt32.max)))
+                let annexB = pool.makeData(capacity: size) { _ in size }
+                let sealed = pool.makeData(capacity: annexB.count + overhead) { _ in size + overhead }
+                let chunks = (sealed.count + payloadSize - 1) / payloadSize
+                let slab = pool.makeData(capacity: sealed.count + chunks * prefixSize) { _ in sealed.count + chunks * prefixSize }
+                frames += 1
+
+                held.append(slab)
+                if held.count - heldHead > scenario.heldFrames {
+                    held[heldHead] = Data()
+                    heldHead += 1
+                }
+                if heldHead >= 256 {
+                    held.removeFirst(heldHead)
+                    heldHead = 0
+                }
+            }
+
+            // Past the warm-up, so the numbers show the steady state
+            for _ in 0..<(scenario.heldFrames * 4 + 64) { sendFrame() }
+            _ = pool.drainStatistics()
+            frames = 0
+
+            benchmark(scenario.name, bytesPerIteration: Int(averageBytes)) { sendFrame() }
+            let statistics = pool.drainStatistics()
+            let takes = max(1, statistics.reused + statistics.allocated)
+            let liveBytes = held[heldHead...].reduce(0) { $0 + $1.count }
+            print("  \(String(format: "%.4f", Double(statistics.allocated) / Double(frames))) allocations/frame, \(String(format: "%.1f", Double(statistics.reused) / Double(takes) * 100))% reused, \(liveBytes / 1024) KB held by the cache")
+        }
+    }
+}
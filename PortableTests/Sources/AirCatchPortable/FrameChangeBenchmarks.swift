@@ -0,0 +1,57 @@
+//
+//  FrameChangeBenchmarks.swift
+//  PortableTests
+//
+//  Cost of FrameChangeDetector per captured frame, against the frame budget it runs in.
+//
+
+import Foundation
+
+enum FrameChangeBenchmarks {
+
+    /// Capture sizes the host actually streams; rows are padded the way IOSurfaces are
+    static let sizes: [(name: String, width: Int, height: Int)] = [
+        ("1080p", 1920, 1080),
+        ("iPad Pro 11\"", 2388, 1668),
+        ("4K", 3840, 2160),
+    ]
+
+    static func run() {
+        print("Frame change detection (BGRA)")
+        for size in sizes {
+            let bytesPerRow = (size.width * 4 + 63) / 64 * 64
+            var frame = [UInt8](repeating: 0, count: bytesPerRow * size.height)
+            for i in stride(from: 0, to: frame.count, by: 7) {
+                frame[i] = UInt8(truncatingIfNeeded: i &* 31)
+            }
+            let detector = FrameChangeDetector()
+            let frameBytes = size.width * size.height * 4
+            let unchangedFrames = 60
+
+            // Static screen: every frame hashes identical content (the skip case)
+            let elapsed = ContinuousClock().measure {
+                frame.withUnsafeBytes { raw in
+                    for _ in 0..<unchangedFrames {
+                        blackHole(detector.detectChanges(base: raw.baseAddress!, width: size.width, height: size.height, bytesPerRow: bytesPerRow))
+                    }
+                }
+            }
+            let perFrame = elapsed / unchangedFrames
+
+            // Typing: one tile changes per frame, and the region is built for the header
+            benchmark("detect + region, \(size.name)", bytesPerIteration: frameBytes) {
+                frame[bytesPerRow * 100 + 400] &+= 1
+                frame.withUnsafeBytes { raw in
+                    blackHole(detector.detectChanges(base: raw.baseAddress!, width: size.width, height: size.height, bytesPerRow: bytesPerRow))
+                }
+                blackHole(detector.dirtyRegion())
+            }
+
+            let milliseconds = Double(perFrame.components.attoseconds) / 1e15 + Double(perFrame.components.seconds) * 1e3
+            print("  \(size.name): \(String(format: "%.2f", milliseconds)) ms per unchanged frame, "
+                + "\(String(format: "%.1f", milliseconds / (1000.0 / 60) * 100))% of a 60 fps frame, "
+                + "\(String(format: "%.1f", milliseconds / (1000.0 / 120) * 100))% at 120 fps")
+        }
+        print("  A skipped frame saves its encode, seal and send; the hash pays for itself when it is cheaper than those.")
+    }
+}
@@ -0,0 +1 @@
+../../../AirCatchHost/FrameChangeDetector.swift
\ No newline at end of file
@@ -0,0 +1 @@
+../../../AirCatchHost/FrameDirtyRegion.swift
\ No newline at end of file
@@ -0,0 +1 @@
+../../../AirCatchHost/FrameDropPolicy.swift
\ No newline at end of file
@@ -0,0 +1,124 @@
+//
+//  FrameDropSimulation.swift
+//  PortableTests
+//
+//  Synthetic layered video stream through a rate-limited queue governed by FrameDropPolicy.
+//
+
+import Foundation
+
+/// Pushes a 60 fps stream with every other frame droppable (HEVC with a base
+/// layer at half the frame rate) through a queue that drains at `linkBitsPerSecond`,
+/// the way `VideoFanout` admits frames for one viewer, and counts how many frames
+/// the receiver can decode.
+///
+/// The baseline sends the same stream with the layer information stripped, so
+/// any drop breaks the reference chain until the next keyframe. Both sides ask
+/// for a keyframe on a chain break, spaced by `keyframeRequestMinInterval`.
+enum FrameDropSimulation {
+
+    struct Parameters {
+        var frameRate = 60.0
+        var encoderBitsPerSecond = 20_000_000.0
+        var linkBitsPerSecond = 15_000_000.0
+        var duration: TimeInterval = 20
+        /// Periodic keyframe spacing (seconds)
+        var gopDuration: TimeInterval = 2
+        /// Keyframe size relative to an average frame
+        var keyframeScale = 6.0
+        /// Queue budget in seconds at link rate, like `AirCatchConfig.fanoutMaxQueueDelay`
+        var maxQueueDelay: TimeInterval = 0.1
+        var keyframeRequestMinInterval: TimeInterval = 0.25
+        var seed: UInt32 = 0x9E37_79B9
+    }
+
+    struct Report {
+        let frames: Int
+        /// Frames sent that the receiver can decode
+        let decodable: Int
+        let thinned: Int
+        let dropped: Int
+        let keyframes: Int
+
+        var decodableFraction: Double { Double(decodable) / Double(frames) }
+    }
+
+    /// - Parameter layerAware: false strips the droppable flag, modelling a sender that drops blindly.
+    static func run(_ parameters: Parameters, layerAware: Bool) -> Report {
+        let p = parameters
+        let frameCount = Int(p.duration * p.frameRate)
+        let interval = 1 / p.frameRate
+        let gopFrames = max(1, Int(p.gopDuration * p.frameRate))
+        let averageBytes = p.encoderBitsPerSecond / 8 / p.frameRate
+        let linkBytesPerSecond = p.linkBitsPerSecond / 8
+        let budget = linkBytesPerSecond * p.maxQueueDelay
+
+        var policy = FrameDropPolicy()
+        var random = p.seed
+        var queuedBytes = 0.0
+        var sinceKeyframe = 0
+        var keyframeRequested = false
+        var lastForcedAt = -Double.infinity
+        var decodable = 0
+        var keyframes = 0
+
+        for index in 0..<frameCount {
+            let now = Double(index) * interval
+            queuedBytes = max(0, queuedBytes - linkBytesPerSecond * interval)
+
+            let forced = keyframeRequested && now - lastForcedAt >= p.keyframeRequestMinInterval
+            let isKeyframe = index == 0 || sinceKeyframe + 1 >= gopFrames || forced
+            if forced {
+                keyframeRequested = false
+                lastForcedAt = now
+            }
+            sinceKeyframe = isKeyframe ? 0 : sinceKeyframe + 1
+
+            // Half the bits go to each layer; droppable frames are a little smaller
+            let isDroppable = !isKeyframe && sinceKeyframe % 2 == 1
+            random ^= random << 13
+            random ^= random >> 17
+            random ^= random << 5
+            let jitter = 0.7 + 0.6 * Double(random) / Double(UInt32.max)
+            let scale = isKeyframe ? p.keyframeScale : (isDroppable ? 0.8 : 1.2)
+            let frameBytes = Int(averageBytes * scale * jitter)
+
+            let tag = FrameLayerTag(
+                temporalLayer: isDroppable ? 1 : 0,
+                isKeyframe: isKeyframe,
+                isDroppable: layerAware && isDroppable
+            )
+            if isKeyframe { keyframes += 1 }
+
+            switch policy.admit(tag, frameBytes: frameBytes, queuedBytes: Int(queuedBytes), budget: budget) {
+            case .send:
+                queuedBytes += Double(frameBytes)
+                decodable += 1
+            case .thin:
+                break
+            case .drop:
+                keyframeRequested = true
+            }
+        }
+
+        return Report(
+            frames: frameCount,
+            decodable: decodable,
+            thinned: policy.thinnedFrames,
+            dropped: policy.droppedFrames,
+            keyframes: keyframes
+        )
+    }
+
+    static func printReport() {
+        print("Frame drop policy, 20 Mbps encoder, decodable share of frames")
+        for megabits in [25.0, 20.0, 15.0] {
+            var parameters = Parameters()
+            parameters.linkBitsPerSecond = megabits * 1_000_000
+            let layered = run(parameters, layerAware: true)
+            let blind = run(parameters, layerAware: false)
+            let label = "  \(Int(megabits)) Mbps link".padding(toLength: 20, withPad: " ", startingAt: 0)
+            print("\(label) layered \(String(format: "%.2f", layered.decodableFraction)) (thinned \(layered.thinned), dropped \(layered.dropped))   blind \(String(format: "%.2f", blind.decodableFraction)) (dropped \(blind.dropped))")
+        }
+    }
+}
@@ -0,0 +1 @@
+../../../AirCatchHost/FrameLayerTag.swift
\ No newline at end of file
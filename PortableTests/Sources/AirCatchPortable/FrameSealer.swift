@@ -0,0 +1 @@
+../../../AirCatchHost/FrameSealer.swift
\ No newline at end of file
@@ -0,0 +1 @@
+../../../AirCatchHost/InputCoalescer.swift
\ No newline at end of file
@@ -0,0 +1,229 @@
+//
+//  InputTraceReplay.swift
+//  PortableTests
+//
+//  Replays input arrival traces through InputCoalescer against a simulated display.
+//
+
+import Foundation
+
+/// Feeds timestamped input arrivals and display refresh ticks to `InputCoalescer`
+/// in time order, the way `InputScheduler` does on the host, and measures what
+/// the coalescing costs and saves.
+///
+/// Display latency compares coalesced delivery with injecting every event on
+/// arrival: an injection shows on the first refresh at or after it, so coalescing
+/// only costs latency where it moves an event past a refresh.
+///
+/// Traces are CSV lines of `seconds,kind,a,b`: `move`/`drag` with normalized x,y,
+/// `scroll` with deltaX,deltaY, or `click` (a,b ignored). Lines starting with `#`
+/// are comments. Arrival times are when the host received each event.
+enum InputTraceReplay {
+
+    enum Kind: Equatable {
+        case move(x: Double, y: Double)
+        case drag(x: Double, y: Double)
+        case scroll(deltaX: Double, deltaY: Double)
+        /// Any order-sensitive event: click, key, media key
+        case click
+    }
+
+    struct Event {
+        let time: TimeInterval
+        let kind: Kind
+    }
+
+    struct Report {
+        let events: Int
+        let injections: Int
+        let coalesced: Int
+        /// Per motion event: time until an injection reflected it (seconds)
+        let addedLatency: [TimeInterval]
+        /// The same, had every event waited for the next refresh boundary
+        let holdUntilRefreshLatency: [TimeInterval]
+        /// Per motion event: arrival to the first refresh showing it, coalesced
+        let displayLatency: [TimeInterval]
+        /// The same with every event injected on arrival
+        let immediateDisplayLatency: [TimeInterval]
+        /// Most pointer injections that landed between two refresh ticks
+        let maxPointerInjectionsPerRefresh: Int
+        /// Last injected pointer kind and position
+        let finalPointer: Kind?
+        let scrollTotal: (deltaX: Double, deltaY: Double)
+        /// Pointer kinds in injection order, hover/drag transitions only
+        let pointerKindSequence: [Int]
+    }
+
+    /// - Parameter refreshRate: Display refreshes per second; ticks start at time 0.
+    static func replay(_ trace: [Event], refreshRate: Double) -> Report {
+        let interval = 1 / refreshRate
+        var coalescer = InputCoalescer<Kind>()
+        var injections = 0
+        var latencies: [TimeInterval] = []
+        var holdLatencies: [TimeInterval] = []
+        var displayLatencies: [TimeInterval] = []
+        var immediateLatencies: [TimeInterval] = []
+        var waitingPointer: [TimeInterval] = []
+        var waitingScroll: [TimeInterval] = []
+        var pointerThisRefresh = 0
+        var maxPointerPerRefresh = 0
+        var finalPointer: Kind?
+        var scrollTotal = (deltaX: 0.0, deltaY: 0.0)
+        var kinds: [Int] = []
+
+        /// First refresh tick at or after `time`
+        func shownAt(_ time: TimeInterval) -> TimeInterval {
+            (time / interval - 1e-9).rounded(.up) * interval
+        }
+        func injectPointer(_ held: InputCoalescer<Kind>.HeldPointer, at now: TimeInterval) {
+            injections += 1
+            pointerThisRefresh += 1
+            maxPointerPerRefresh = max(maxPointerPerRefresh, pointerThisRefresh)
+            finalPointer = held.value
+            if kinds.last != held.kind { kinds.append(held.kind) }
+            latencies += waitingPointer.map { now - $0 }
+            displayLatencies += waitingPointer.map { shownAt(now) - $0 }
+            waitingPointer.removeAll()
+        }
+        func injectScroll(_ scroll: InputCoalescer<Kind>.Scroll, at now: TimeInterval) {
+            injections += 1
+            scrollTotal.deltaX += scroll.deltaX
+            scrollTotal.deltaY += scroll.deltaY
+            latencies += waitingScroll.map { now - $0 }
+            displayLatencies += waitingScroll.map { shownAt(now) - $0 }
+            waitingScroll.removeAll()
+        }
+        func inject(_ due: InputCoalescer<Kind>.Due, at now: TimeInterval) {
+            if let pointer = due.pointer { injectPointer(pointer, at: now) }
+            if let scroll = due.scroll { injectScroll(scroll, at: now) }
+        }
+
+        var nextTick = 0.0
+        // Stable: events sharing an arrival time (a stall backlog) keep their order
+        let sorted = trace.enumerated().sorted { ($0.element.time, $0.offset) < ($1.element.time, $1.offset) }.map(\.element)
+        let end = (sorted.last?.time ?? 0) + 2 * interval
+        var index = 0
+        while index < sorted.count || nextTick <= end {
+            // A tick and an arrival at the same instant: the tick is first, as on a run loop
+            if index >= sorted.count || nextTick <= sorted[index].time {
+                pointerThisRefresh = 0
+                inject(coalescer.refresh(), at: nextTick)
+                nextTick += interval
+                continue
+            }
+
+            let event = sorted[index]
+            index += 1
+            let now = event.time
+            switch event.kind {
+            case .move, .drag:
+                holdLatencies.append(nextTick - now)
+                immediateLatencies.append(shownAt(now) - now)
+                let kind = pointerKind(event.kind)
+                // A kind switch injects the older held motion; this event is not part of it
+                let displacesHeld = coalescer.heldPointer.map { $0.kind != kind } ?? false
+                if !displacesHeld { waitingPointer.append(now) }
+                if let due = coalescer.submitPointer(event.kind, kind: kind, receivedAt: now) {
+                    injectPointer(due, at: now)
+                }
+                if displacesHeld { waitingPointer.append(now) }
+            case .scroll(let deltaX, let deltaY):
+                waitingScroll.append(now)
+                holdLatencies.append(nextTick - now)
+                immediateLatencies.append(shownAt(now) - now)
+                if let due = coalescer.submitScroll(deltaX: deltaX, deltaY: deltaY) {
+                    injectScroll(due, at: now)
+                }
+            case .click:
+                inject(coalescer.flush(), at: now)
+                injections += 1
+            }
+        }
+
+        return Report(
+            events: sorted.count,
+            injections: injections,
+            coalesced: coalescer.coalescedCount,
+            addedLatency: latencies,
+            holdUntilRefreshLatency: holdLatencies,
+            displayLatency: displayLatencies,
+            immediateDisplayLatency: immediateLatencies,
+            maxPointerInjectionsPerRefresh: maxPointerPerRefresh,
+            finalPointer: finalPointer,
+            scrollTotal: scrollTotal,
+            pointerKindSequence: kinds
+        )
+    }
+
+    private static func pointerKind(_ kind: Kind) -> Int {
+        if case .drag = kind { return 1 }
+        return 0
+    }
+
+    // MARK: - Traces
+
+    /// Parses a CSV trace; malformed lines are skipped.
+    static func parse(_ text: String) -> [Event] {
+        text.split(whereSeparator: \.isNewline).compactMap { line in
+            guard !line.hasPrefix("#") else { return nil }
+            let fields = line.split(separator: ",").map { $0.trimmingCharacters(in: .whitespaces) }
+            guard fields.count >= 2, let time = Double(fields[0]) else { return nil }
+            let a = fields.count > 2 ? Double(fields[2]) ?? 0 : 0
+            let b = fields.count > 3 ? Double(fields[3]) ?? 0 : 0
+            switch fields[1] {
+            case "move": return Event(time: time, kind: .move(x: a, y: b))
+            case "drag": return Event(time: time, kind: .drag(x: a, y: b))
+            case "scroll": return Event(time: time, kind: .scroll(deltaX: a, deltaY: b))
+            case "click": return Event(time: time, kind: .click)
+            default: return nil
+            }
+        }
+    }
+
+    /// Built-in traces shaped after what the host sees from an iPad over Wi-Fi.
+    static let builtIn: [(name: String, trace: [Event])] = [
+        ("isolated moves", (0..<20).map { Event(time: 0.0137 + Double($0) * 0.25, kind: .move(x: Double($0) / 20, y: 0.5)) }),
+        ("120 Hz pencil drag", (0..<240).map { Event(time: 0.003 + Double($0) / 120, kind: .drag(x: Double($0) / 240, y: 0.5)) }),
+        ("Wi-Fi stall bursts", stallBursts()),
+        ("trackpad scroll", (0..<120).map { Event(time: 0.001 + Double($0) / 90, kind: .scroll(deltaX: 0, deltaY: -3)) }),
+    ]
+
+    /// 120 Hz motion where every 100 ms a 40 ms stall delivers the backlog at once.
+    private static func stallBursts() -> [Event] {
+        (0..<240).map { i in
+            let sent = 0.002 + Double(i) / 120
+            let cycle = sent.truncatingRemainder(dividingBy: 0.1)
+            let arrival = cycle < 0.04 ? sent - cycle + 0.04 : sent
+            return Event(time: arrival, kind: .move(x: Double(i) / 240, y: 0.25))
+        }
+    }
+
+    // MARK: - Output
+
+    static func printReport(_ name: String, _ trace: [Event]) {
+        print("Input trace: \(name) (\(trace.count) events)")
+        for rate in [60.0, 120.0] {
+            let report = replay(trace, refreshRate: rate)
+            print("  \(Int(rate)) Hz: \(report.injections) injected, \(report.coalesced) coalesced, "
+                + "added latency p50 \(milliseconds(percentile(report.addedLatency, 0.5))) "
+                + "p99 \(milliseconds(percentile(report.addedLatency, 0.99))) "
+                + "max \(milliseconds(report.addedLatency.max() ?? 0)); "
+                + "hold-until-refresh p50 \(milliseconds(percentile(report.holdUntilRefreshLatency, 0.5))) "
+                + "p99 \(milliseconds(percentile(report.holdUntilRefreshLatency, 0.99)))")
+            print("        display latency coalesced p50 \(milliseconds(percentile(report.displayLatency, 0.5))) "
+                + "p99 \(milliseconds(percentile(report.displayLatency, 0.99))) (\(report.injections) injections); "
+                + "immediate p50 \(milliseconds(percentile(report.immediateDisplayLatency, 0.5))) "
+                + "p99 \(milliseconds(percentile(report.immediateDisplayLatency, 0.99))) (\(report.events) injections)")
+        }
+    }
+
+    static func percentile(_ values: [TimeInterval], _ p: Double) -> TimeInterval {
+        guard !values.isEmpty else { return 0 }
+        let sorted = values.sorted()
+        return sorted[min(sorted.count - 1, Int(Double(sorted.count - 1) * p + 0.5))]
+    }
+
+    private static func milliseconds(_ seconds: TimeInterval) -> String {
+        String(format: "%.1f ms", seconds * 1000)
+    }
+}
@@ -0,0 +1 @@
+../../../AirCatchHost/KeySchedule.swift
\ No newline at end of file
@@ -0,0 +1,85 @@
+//
+//  KeyScheduleBenchmarks.swift
+//  PortableTests
+//
+//  Per-packet cost of KeySchedule against the fixed key and nonce sequence it replaced.
+//
+
+import Foundation
+#if canImport(CryptoKit)
+import CryptoKit
+#else
+import Crypto
+#endif
+
+/// What the ratcheting schedule adds to every packet the host seals and opens.
+///
+/// `fixed key`: one key and a `NonceSequence`, as before sessions had a schedule.
+/// `schedule`: `KeySchedule.nextSealing()` at the apps' rekey interval, and at an
+/// interval short enough that a ratchet (one HKDF) lands in every batch. Opening
+/// looks up the key with `openingKey(for:)` and confirms it with `didOpen`,
+/// across several viewers' chains on the host.
+enum KeyScheduleBenchmarks {
+
+    /// `AirCatchConfig.rekeyInterval`
+    static let rekeyInterval: UInt64 = 1 << 20
+    /// One UDP video chunk
+    static let packetSize = 1200
+    static let batch = 1000
+
+    static func run() {
+        print("Key schedule, \(batch) packets of \(packetSize) bytes per call")
+        let secret = SymmetricKey(size: .bits256)
+        let salt = Data(repeating: 7, count: 32)
+        let packet = Data(count: packetSize)
+        var output = [UInt8](repeating: 0, count: packetSize + FrameSealer.overhead)
+
+        // Key and nonce only: the bookkeeping the schedule adds
+        let fixedKey = SymmetricKey(size: .bits256)
+        var fixedNonces = NonceSequence(isHost: true, epoch: 0)
+        benchmark("nonce, fixed key", bytesPerIteration: batch * packetSize) {
+            for _ in 0..<batch { blackHole((fixedKey, fixedNonces.next())) }
+        }
+        for (name, interval) in [("app interval", rekeyInterval), ("ratchet every 256", UInt64(256))] {
+            var schedule = KeySchedule(secret: secret, salt: salt, role: .host, cipher: .aes256GCM, rekeyInterval: interval)
+            benchmark("nextSealing, \(name)", bytesPerIteration: batch * packetSize) {
+                for _ in 0..<batch { blackHole(schedule.nextSealing()) }
+            }
+        }
+
+        // Sealing whole packets, so the bookkeeping shows against the cipher
+        benchmark("seal, fixed key", bytesPerIteration: batch * packetSize) {
+            output.withUnsafeMutableBytes { buffer in
+                for _ in 0..<batch {
+                    blackHole(try! FrameSealer.seal(packet, using: fixedKey, nonce: fixedNonces.next(), backend: AESGCMBackend.self, into: buffer))
+                }
+            }
+        }
+        var hostSchedule = KeySchedule(secret: secret, salt: salt, role: .host, cipher: .aes256GCM, rekeyInterval: rekeyInterval)
+        benchmark("seal, schedule", bytesPerIteration: batch * packetSize) {
+            output.withUnsafeMutableBytes { buffer in
+                for _ in 0..<batch {
+                    let sealing = hostSchedule.nextSealing()
+                    blackHole(try! FrameSealer.seal(packet, using: sealing.key, nonce: sealing.nonce, backend: AESGCMBackend.self, into: buffer))
+                }
+            }
+        }
+
+        // Input from 8 viewers interleaved, each on its own chain
+        let peers = UInt16(1)...UInt16(8)
+        for peer in peers { hostSchedule.addPeer(peer) }
+        var clients = peers.map {
+            KeySchedule(secret: secret, salt: salt, role: .client, cipher: .aes256GCM, rekeyInterval: rekeyInterval, peer: $0)
+        }
+        let nonces = (0..<batch).map { index in
+            clients[index % clients.count].nextSealing().nonce.withUnsafeBytes { Data($0) }
+        }
+        benchmark("openingKey + didOpen, 8 viewers", bytesPerIteration: batch * packetSize) {
+            for nonce in nonces {
+                guard let opening = hostSchedule.openingKey(for: nonce) else { fatalError("no key for a client nonce") }
+                hostSchedule.didOpen(opening)
+                blackHole(opening.key)
+            }
+        }
+    }
+}
@@ -0,0 +1,108 @@
+//
+//  PCMBenchmarks.swift
+//  PortableTests
+//
+//  PCMKernels against the scalar loops they replaced.
+//
+
+import Foundation
+
+enum PCMBenchmarks {
+
+    /// One 10 ms stereo capture buffer at 48 kHz, the size the host sends per packet
+    static let frameCount = 480
+
+    static func run() {
+        print("PCM (\(frameCount) stereo frames)")
+        let left = (0..<frameCount).map { Float($0) / Float(frameCount) }
+        let right = left.map { -$0 }
+        var interleaved = [Float](repeating: 0, count: frameCount * 2)
+        var outLeft = [Float](repeating: 0, count: frameCount)
+        var outRight = [Float](repeating: 0, count: frameCount)
+        let bytes = frameCount * 2 * MemoryLayout<Float>.size
+
+        benchmark("interleave (scalar)", bytesPerIteration: bytes) {
+            for i in 0..<frameCount {
+                interleaved[i * 2] = left[i]
+                interleaved[i * 2 + 1] = right[i]
+            }
+            blackHole(interleaved)
+        }
+        benchmark("interleave (PCMKernels)", bytesPerIteration: bytes) {
+            interleaved.withUnsafeMutableBufferPointer { out in
+                PCMKernels.interleave(left: left, right: right, into: out.baseAddress!, frameCount: frameCount)
+            }
+            blackHole(interleaved)
+        }
+        benchmark("deinterleave (scalar)", bytesPerIteration: bytes) {
+            for i in 0..<frameCount {
+                outLeft[i] = interleaved[i * 2]
+                outRight[i] = interleaved[i * 2 + 1]
+            }
+            blackHole(outLeft)
+        }
+        benchmark("deinterleave (PCMKernels)", bytesPerIteration: bytes) {
+            interleaved.withUnsafeBytes { input in
+                outLeft.withUnsafeMutableBufferPointer { l in
+                    outRight.withUnsafeMutableBufferPointer { r in
+                        PCMKernels.deinterleave(input.baseAddress!, left: l.baseAddress!, right: r.baseAddress!, frameCount: frameCount)
+                    }
+                }
+            }
+            blackHole(outLeft)
+        }
+
+        let sampleCount = frameCount * 2
+        let floatBytes = sampleCount * MemoryLayout<Float>.size
+        var int16s = [Int16](repeating: 0, count: sampleCount)
+        var dither = PCMDither()
+        benchmark("float -> int16 (scalar)", bytesPerIteration: floatBytes) {
+            for i in 0..<sampleCount {
+                int16s[i] = Int16(min(max(interleaved[i] * 32767, -32768), 32767).rounded(.toNearestOrEven))
+            }
+            blackHole(int16s)
+        }
+        benchmark("float -> int16 (PCMKernels)", bytesPerIteration: floatBytes) {
+            interleaved.withUnsafeBufferPointer { src in
+                int16s.withUnsafeMutableBufferPointer { dst in
+                    PCMKernels.convertFloatToInt16(src.baseAddress!, into: dst.baseAddress!, count: sampleCount)
+                }
+            }
+            blackHole(int16s)
+        }
+        benchmark("float -> int16 + TPDF dither (PCMKernels)", bytesPerIteration: floatBytes) {
+            interleaved.withUnsafeBufferPointer { src in
+                int16s.withUnsafeMutableBufferPointer { dst in
+                    PCMKernels.convertFloatToInt16(src.baseAddress!, into: dst.baseAddress!, count: sampleCount, dither: &dither)
+                }
+            }
+            blackHole(int16s)
+        }
+        benchmark("int16 -> float (scalar)", bytesPerIteration: floatBytes) {
+            for i in 0..<sampleCount {
+                interleaved[i] = Float(int16s[i]) * (1.0 / 32768.0)
+            }
+            blackHole(interleaved)
+        }
+        benchmark("int16 -> float (PCMKernels)", bytesPerIteration: floatBytes) {
+            int16s.withUnsafeBufferPointer { src in
+                interleaved.withUnsafeMutableBufferPointer { dst in
+                    PCMKernels.convertInt16ToFloat(src.baseAddress!, into: dst.baseAddress!, count: sampleCount)
+                }
+            }
+            blackHole(interleaved)
+        }
+        benchmark("gain (scalar)", bytesPerIteration: floatBytes) {
+            for i in 0..<sampleCount {
+                interleaved[i] *= 0.999
+            }
+            blackHole(interleaved)
+        }
+        benchmark("gain (PCMKernels)", bytesPerIteration: floatBytes) {
+            interleaved.withUnsafeMutableBufferPointer { samples in
+                PCMKernels.applyGain(0.999, to: samples.baseAddress!, count: sampleCount)
+            }
+            blackHole(interleaved)
+        }
+    }
+}
@@ -0,0 +1 @@
+../../../AirCatchHost/PCMKernels.swift
\ No newline at end of file
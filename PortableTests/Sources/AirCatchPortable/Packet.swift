@@ -0,0 +1 @@
+../../../AirCatchHost/Packet.swift
\ No newline at end of file
@@ -0,0 +1 @@
+../../../AirCatchHost/PacketFramer.swift
\ No newline at end of file
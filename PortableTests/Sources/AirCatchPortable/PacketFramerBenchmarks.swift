@@ -0,0 +1,55 @@
+//
+//  PacketFramerBenchmarks.swift
+//  PortableTests
+//
+//  Throughput of PacketFramer on the two traffic shapes the TCP lane carries.
+//
+
+import Foundation
+
+enum PacketFramerBenchmarks {
+
+    /// Wire bytes for `count` packets of `payloadSize` bytes each.
+    static func stream(type: PacketType, payloadSize: Int, count: Int) -> [UInt8] {
+        var bytes: [UInt8] = []
+        bytes.reserveCapacity((PacketFramer.headerSize + payloadSize) * count)
+        for index in 0..<count {
+            bytes.append(type.rawValue)
+            bytes.append(contentsOf: [
+                UInt8(truncatingIfNeeded: payloadSize >> 24), UInt8(truncatingIfNeeded: payloadSize >> 16),
+                UInt8(truncatingIfNeeded: payloadSize >> 8), UInt8(truncatingIfNeeded: payloadSize),
+            ])
+            bytes.append(contentsOf: repeatElement(UInt8(truncatingIfNeeded: index), count: payloadSize))
+        }
+        return bytes
+    }
+
+    /// Splits `bytes` into receives of at most `readSize`, the way the receive loop gets them.
+    static func reads(of bytes: [UInt8], readSize: Int) -> [Data] {
+        stride(from: 0, to: bytes.count, by: readSize).map {
+            Data(bytes[$0..<min($0 + readSize, bytes.count)])
+        }
+    }
+
+    static func run() {
+        print("TCP packet framing")
+        let shapes: [(name: String, type: PacketType, payloadSize: Int, count: Int)] = [
+            // Input bursts after a stall: many small batches arrive in one read
+            ("input batches, 48 B", .inputBatch, 48, 4096),
+            // Lossless/remote video: a frame per packet, several reads per frame
+            ("video frames, 120 KB", .videoFrame, 120 * 1024, 32),
+        ]
+        for shape in shapes {
+            let bytes = stream(type: shape.type, payloadSize: shape.payloadSize, count: shape.count)
+            for readSize in [1500, PacketFramer.readSize] {
+                let received = reads(of: bytes, readSize: readSize)
+                let framer = PacketFramer(maxPayloadSize: 32 * 1024 * 1024)
+                benchmark("\(shape.name), \(readSize) B reads", bytesPerIteration: bytes.count) {
+                    for data in received {
+                        blackHole(try! framer.append(data))
+                    }
+                }
+            }
+        }
+    }
+}
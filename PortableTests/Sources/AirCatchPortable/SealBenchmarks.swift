@@ -0,0 +1,105 @@
+//
+//  SealBenchmarks.swift
+//  PortableTests
+//
+//  Frame sealing through SealedBox.combined against FrameSealer's sealing in place.
+//
+
+import Foundation
+#if canImport(CryptoKit)
+import CryptoKit
+#else
+import Crypto
+#endif
+
+/// The two ways the host has sealed a video frame, at the sizes a 4K stream produces.
+///
+/// `combined`: random nonce, `SealedBox.combined` as a new `Data`, then a copy
+/// behind the transport header, the way frames were sealed before `FrameSealer`.
+/// `in place`: `FrameSealer.seal` writing nonce + ciphertext + tag straight after
+/// header room in one buffer, with `NonceSequence` nonces, as `CryptoManager.seal(_:into:)`
+/// does. `segmented` is `FrameSealer.sealSegments` at `AirCatchConfig.sealSegmentSize`.
+enum SealBenchmarks {
+
+    static let headerRoom = 16
+    /// `AirCatchConfig.sealSegmentSize`
+    static let segmentSize = 128 * 1024
+
+    static let sizes: [(name: String, bytes: Int)] = [
+        ("4K P-frame, 160 KB", 160 * 1024),
+        ("4K keyframe, 1.5 MB", 1536 * 1024),
+    ]
+
+    static func makeFrame(_ bytes: Int) -> Data {
+        Data((0..<bytes).map { UInt8(truncatingIfNeeded: $0 &* 31) })
+    }
+
+    static func run() {
+        let key = SymmetricKey(size: .bits256)
+        let header = Data(count: headerRoom)
+        var nonces = NonceSequence(isHost: true, epoch: 0)
+        for cipher in AEADCipher.allCases {
+            print("Frame sealing (\(cipher.rawValue))")
+            let backend = cipher.backend
+            for size in sizes {
+                let frame = makeFrame(size.bytes)
+                var output = [UInt8](repeating: 0, count: headerRoom + FrameSealer.segmentedSize(of: size.bytes, segmentSize: segmentSize))
+                let segmentCount = (size.bytes + segmentSize - 1) / segmentSize
+
+                if cipher == .aes256GCM {
+                    benchmark("combined + copy, \(size.name)", bytesPerIteration: size.bytes) {
+                        var packet = header
+                        packet.append(try! AES.GCM.seal(frame, using: key).combined!)
+                        blackHole(packet)
+                    }
+                }
+                benchmark("in place, \(size.name)", bytesPerIteration: size.bytes) {
+                    let nonce = nonces.next()
+                    output.withUnsafeMutableBytes { buffer in
+                        blackHole(try! FrameSealer.seal(frame, using: key, nonce: nonce, backend: backend,
+                                                        into: UnsafeMutableRawBufferPointer(rebasing: buffer[headerRoom...])))
+                    }
+                }
+                benchmark("in place, segmented, \(size.name)", bytesPerIteration: size.bytes) {
+                    let segmentNonces = (0..<segmentCount).map { _ in nonces.next() }
+                    output.withUnsafeMutableBytes { buffer in
+                        blackHole(FrameSealer.sealSegments(frame, segmentSize: segmentSize, using: key, nonces: segmentNonces,
+                                                           backend: backend, into: UnsafeMutableRawBufferPointer(rebasing: buffer[headerRoom...])))
+                    }
+                }
+            }
+        }
+    }
+
+    /// Segmented sealing and opening of a 4K keyframe spread over 1 to 8 threads. On a
+    /// machine with fewer cores, the rows past the core count show the oversubscription cost.
+    static func runScaling() {
+        let key = SymmetricKey(size: .bits256)
+        let size = sizes[sizes.count - 1]
+        let frame = makeFrame(size.bytes)
+        let segmentCount = (size.bytes + segmentSize - 1) / segmentSize
+        var nonces = NonceSequence(isHost: true, epoch: 0)
+        var sealed = Data(count: FrameSealer.segmentedSize(of: size.bytes, segmentSize: segmentSize))
+        let segmentNonces = (0..<segmentCount).map { _ in nonces.next() }
+        _ = sealed.withUnsafeMutableBytes {
+            FrameSealer.sealSegments(frame, segmentSize: segmentSize, using: key, nonces: segmentNonces, backend: AESGCMBackend.self, into: $0)
+        }
+        var output = [UInt8](repeating: 0, count: sealed.count)
+
+        print("Segmented sealing by thread count (aes256GCM, \(size.name), \(segmentCount) segments, \(ProcessInfo.processInfo.activeProcessorCount) cores)")
+        for workers in 1...8 {
+            benchmark("seal, \(workers) thread\(workers == 1 ? "" : "s")", bytesPerIteration: size.bytes) {
+                let segmentNonces = (0..<segmentCount).map { _ in nonces.next() }
+                output.withUnsafeMutableBytes { buffer in
+                    blackHole(FrameSealer.sealSegments(frame, segmentSize: segmentSize, using: key, nonces: segmentNonces,
+                                                       backend: AESGCMBackend.self, workers: workers, into: buffer))
+                }
+            }
+        }
+        for workers in 1...8 {
+            benchmark("open, \(workers) thread\(workers == 1 ? "" : "s")", bytesPerIteration: size.bytes) {
+                blackHole(FrameSealer.openSegments(sealed, workers: workers) { _ in (key, AESGCMBackend.self) })
+            }
+        }
+    }
+}
@@ -0,0 +1,99 @@
+//
+//  SendTargetBenchmarks.swift
+//  PortableTests
+//
+//  Per-chunk lookup of UDP send targets by N concurrent senders, while the network queue is busy.
+//
+
+import Foundation
+import Synchronization
+
+/// How long senders wait to learn where a chunk goes, with 1 to 8 clients.
+///
+/// A serial queue stands in for `NetworkManager`'s, kept busy by a receive loop:
+/// 20 us of work per packet back to back, republishing the targets every 1000
+/// packets. Each client has its own sender thread sending 250 chunks, and looks up
+/// the targets for every chunk.
+/// `queue.sync`: copy the flow list on the network queue, as the send paths did
+/// before `UDPSendTargets`.
+/// `snapshot`: read `UDPSendTargets` behind its lock, as they do now.
+enum SendTargetBenchmarks {
+
+    static let chunksPerClient = 250
+    static let chunkSize = 1200
+    static let receiveWork: Duration = .microseconds(20)
+
+    /// A flow; the host's is an NWConnection.
+    final class Flow: Sendable {
+        let host: String
+        init(host: String) { self.host = host }
+    }
+
+    /// The network queue, the flow list it owns and the snapshot it publishes.
+    final class Network: @unchecked Sendable {
+        let queue = DispatchQueue(label: "bench.network", qos: .userInitiated)
+        let targets: Mutex<UDPSendTargets<Flow>>
+        /// Only touched on `queue`
+        var flows: [Flow]
+        private var received = 0
+        private let receiving = Mutex(true)
+        private let stopped = DispatchSemaphore(value: 0)
+
+        init(flows: [Flow]) {
+            self.flows = flows
+            targets = Mutex(UDPSendTargets(ready: flows) { $0.host })
+        }
+
+        func startReceiving() {
+            queue.async { self.receive() }
+        }
+
+        func stopReceiving() {
+            receiving.withLock { $0 = false }
+            stopped.wait()
+        }
+
+        /// One packet's worth of work, then the next packet
+        private func receive() {
+            guard receiving.withLock({ $0 }) else {
+                stopped.signal()
+                return
+            }
+            let clock = ContinuousClock()
+            let deadline = clock.now.advanced(by: SendTargetBenchmarks.receiveWork)
+            while clock.now < deadline {}
+            received += 1
+            if received % 1000 == 0 {
+                let published = UDPSendTargets(ready: flows) { $0.host }
+                targets.withLock { $0 = published }
+            }
+            queue.async { self.receive() }
+        }
+    }
+
+    static func run() {
+        print("UDP send targets, \(chunksPerClient) chunks per client, network queue busy receiving")
+        for clients in [1, 2, 4, 8] {
+            let network = Network(flows: (0..<clients).map { Flow(host: "10.0.0.\($0 + 2)") })
+            network.startReceiving()
+
+            let bytes = clients * chunksPerClient * chunkSize
+            let label = "\(clients) client\(clients == 1 ? "" : "s")"
+            benchmark("queue.sync, \(label)", bytesPerIteration: bytes) {
+                DispatchQueue.concurrentPerform(iterations: clients) { _ in
+                    for _ in 0..<chunksPerClient {
+                        blackHole(network.queue.sync { network.flows })
+                    }
+                }
+            }
+            benchmark("snapshot, \(label)", bytesPerIteration: bytes) {
+                DispatchQueue.concurrentPerform(iterations: clients) { _ in
+                    for _ in 0..<chunksPerClient {
+                        blackHole(network.targets.withLock { $0.viewers })
+                    }
+                }
+            }
+            network.stopReceiving()
+        }
+    }
+}
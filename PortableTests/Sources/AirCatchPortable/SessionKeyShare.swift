@@ -0,0 +1 @@
+../../../AirCatchHost/SessionKeyShare.swift
\ No newline at end of file
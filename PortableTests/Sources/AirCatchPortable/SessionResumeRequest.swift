@@ -0,0 +1 @@
+../../../AirCatchHost/SessionResumeRequest.swift
\ No newline at end of file
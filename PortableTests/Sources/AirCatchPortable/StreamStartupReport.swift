@@ -0,0 +1 @@
+../../../AirCatchHost/StreamStartupReport.swift
\ No newline at end of file
@@ -0,0 +1 @@
+../../../AirCatchHost/UDPSendTargets.swift
\ No newline at end of file
@@ -0,0 +1 @@
+../../../AirCatchHost/VideoFanout.swift
\ No newline at end of file
@@ -0,0 +1,33 @@
+//
+//  main.swift
+//  PortableTests
+//
+//  Benchmark entry point. Build with -c release; debug numbers are meaningless.
+//  Pass input trace files (see InputTraceReplay) to replay those instead.
+//
+
+import Foundation
+
+let traceFiles = CommandLine.arguments.dropFirst()
+if traceFiles.isEmpty {
+    PCMBenchmarks.run()
+    FrameChangeBenchmarks.run()
+    PacketFramerBenchmarks.run()
+    SealBenchmarks.run()
+    SealBenchmarks.runScaling()
+    KeyScheduleBenchmarks.run()
+    FrameBufferPoolBenchmarks.run()
+    SendTargetBenchmarks.run()
+    FrameDropSimulation.printReport()
+    for (name, trace) in InputTraceReplay.builtIn {
+        InputTraceReplay.printReport(name, trace)
+    }
+} else {
+    for path in traceFiles {
+        guard let text = try? String(contentsOfFile: path, encoding: .utf8) else {
+            print("Cannot read \(path)")
+            continue
+        }
+        InputTraceReplay.printReport(path, InputTraceReplay.parse(text))
+    }
+}
@@ -0,0 +1,51 @@
+//
+//  FrameBufferPoolTests.swift
+//  PortableTests
+//
+
+import XCTest
+@testable import AirCatchPortable
+
+final class FrameBufferPoolTests: XCTestCase {
+
+    private func fill(_ pool: FrameBufferPool, _ bytes: [UInt8], capacity: Int? = nil) -> Data {
+        pool.makeData(capacity: capacity ?? bytes.count) { buffer in
+            buffer.copyBytes(from: bytes)
+            return bytes.count
+        }
+    }
+
+    func testBufferReturnsWhenLastSliceIsReleased() {
+        let pool = FrameBufferPool()
+        var data: Data? = fill(pool, Array(0..<200), capacity: 5000)
+        var slice: Data? = data?[100..<150]
+        XCTAssertEqual(data?.count, 200)
+        data = nil
+        XCTAssertEqual(slice?.first, 100)
+        slice = nil
+
+        // Same size class: the released buffer comes back
+        _ = fill(pool, [1, 2, 3], capacity: 8000)
+        let statistics = pool.drainStatistics()
+        XCTAssertEqual(statistics.allocated, 1)
+        XCTAssertEqual(statistics.reused, 1)
+    }
+
+    /// A frame held for retransmits keeps its buffer out of the pool until it's released.
+    func testHeldBufferIsNotReused() {
+        let pool = FrameBufferPool()
+        let held = fill(pool, [7, 7, 7])
+        let other = fill(pool, [9, 9, 9])
+        XCTAssertEqual(Array(held), [7, 7, 7])
+        XCTAssertEqual(Array(other), [9, 9, 9])
+        XCTAssertEqual(pool.drainStatistics().allocated, 2)
+    }
+
+    func testOversizeRequestsBypassThePool() {
+        let pool = FrameBufferPool()
+        let data = pool.makeData(capacity: 16 * 1024 * 1024) { _ in 10 }
+        XCTAssertEqual(data.count, 10)
+        let statistics = pool.drainStatistics()
+        XCTAssertEqual(statistics.allocated + statistics.reused, 0)
+    }
+}
@@ -0,0 +1,155 @@
+//
+//  FrameChangeDetectorTests.swift
+//  PortableTests
+//
+
+import XCTest
+@testable import AirCatchPortable
+
+final class FrameChangeDetectorTests: XCTestCase {
+
+    /// A BGRA frame with optional row padding, like an IOSurface-backed pixel buffer.
+    private struct Frame {
+        let width: Int
+        let height: Int
+        let bytesPerRow: Int
+        var bytes: [UInt8]
+
+        init(width: Int, height: Int, padding: Int = 0) {
+            self.width = width
+            self.height = height
+            bytesPerRow = width * 4 + padding
+            bytes = (0..<(bytesPerRow * height)).map { UInt8(truncatingIfNeeded: ($0 &* 2_654_435_761) >> 13) }
+        }
+
+        mutating func touchPixel(x: Int, y: Int) {
+            bytes[y * bytesPerRow + x * 4] &+= 1
+        }
+
+        func detect(with detector: FrameChangeDetector) -> Bool {
+            bytes.withUnsafeBytes { raw in
+                detector.detectChanges(base: raw.baseAddress!, width: width, height: height, bytesPerRow: bytesPerRow)
+            }
+        }
+    }
+
+    private let tile = FrameChangeDetector.tileSize
+
+    func testFirstFrameIsChangedAndRepeatIsNot() {
+        let detector = FrameChangeDetector()
+        let frame = Frame(width: 256, height: 128)
+
+        XCTAssertTrue(frame.detect(with: detector))
+        XCTAssertEqual(detector.changedTileCount, detector.tileCount)
+        XCTAssertFalse(frame.detect(with: detector))
+        XCTAssertEqual(detector.changedTileCount, 0)
+        XCTAssertEqual(detector.dirtyRegion(), FrameDirtyRegion(tileSize: UInt16(tile), rects: []))
+    }
+
+    func testSinglePixelChangeMarksItsTile() {
+        let detector = FrameChangeDetector()
+        var frame = Frame(width: 256, height: 192)
+        _ = frame.detect(with: detector)
+
+        frame.touchPixel(x: tile + 5, y: 2 * tile + 63)
+        XCTAssertTrue(frame.detect(with: detector))
+        XCTAssertEqual(detector.changedTileCount, 1)
+        XCTAssertEqual(detector.dirtyRegion()?.rects, [.init(x: 1, y: 2, width: 1, height: 1)])
+    }
+
+    /// Every byte of a tile feeds the hash: SIMD lanes, the 4-byte tail, and each row.
+    func testEveryPixelOfATileIsCovered() {
+        let detector = FrameChangeDetector()
+        var frame = Frame(width: 100, height: 70)
+        _ = frame.detect(with: detector)
+
+        for y in 0..<frame.height {
+            for x in 0..<frame.width {
+                frame.touchPixel(x: x, y: y)
+                XCTAssertTrue(frame.detect(with: detector), "pixel \(x),\(y)")
+            }
+        }
+    }
+
+    func testSwappedRowsAreAChange() {
+        let detector = FrameChangeDetector()
+        var frame = Frame(width: 64, height: 64)
+        _ = frame.detect(with: detector)
+
+        let row = frame.bytesPerRow
+        let first = Array(frame.bytes[0..<row])
+        frame.bytes.replaceSubrange(0..<row, with: frame.bytes[row..<(2 * row)])
+        frame.bytes.replaceSubrange(row..<(2 * row), with: first)
+        XCTAssertTrue(frame.detect(with: detector))
+    }
+
+    func testRowPaddingIsIgnored() {
+        let detector = FrameChangeDetector()
+        var frame = Frame(width: 128, height: 64, padding: 48)
+        _ = frame.detect(with: detector)
+
+        frame.bytes[frame.width * 4 + 10] &+= 1
+        XCTAssertFalse(frame.detect(with: detector))
+    }
+
+    func testPartialEdgeTilesAreDetected() {
+        let detector = FrameChangeDetector()
+        var frame = Frame(width: 130, height: 70)
+        _ = frame.detect(with: detector)
+        XCTAssertEqual(detector.tileCount, 3 * 2)
+
+        frame.touchPixel(x: 129, y: 69)
+        XCTAssertTrue(frame.detect(with: detector))
+        XCTAssertEqual(detector.dirtyRegion()?.rects, [.init(x: 2, y: 1, width: 1, height: 1)])
+    }
+
+    func testGeometryChangeReportsFullFrame() {
+        let detector = FrameChangeDetector()
+        _ = Frame(width: 128, height: 128).detect(with: detector)
+
+        XCTAssertTrue(Frame(width: 192, height: 128).detect(with: detector))
+        XCTAssertEqual(detector.dirtyRegion(), .fullFrame(width: 192, height: 128, tileSize: tile))
+    }
+
+    func testResetForgetsThePreviousFrame() {
+        let detector = FrameChangeDetector()
+        let frame = Frame(width: 64, height: 64)
+        _ = frame.detect(with: detector)
+
+        detector.reset()
+        XCTAssertNil(detector.dirtyRegion())
+        XCTAssertTrue(frame.detect(with: detector))
+    }
+
+    func testDirtyTilesMergeIntoRectangles() {
+        let detector = FrameChangeDetector()
+        var frame = Frame(width: 8 * tile, height: 4 * tile)
+        _ = frame.detect(with: detector)
+
+        // A 2x2 block at tile (1, 1), and a row of three tiles at (5, 3)
+        for (tx, ty) in [(1, 1), (2, 1), (1, 2), (2, 2), (5, 3), (6, 3), (7, 3)] {
+            frame.touchPixel(x: tx * tile, y: ty * tile)
+        }
+        XCTAssertTrue(frame.detect(with: detector))
+        XCTAssertEqual(detector.dirtyRegion()?.rects, [
+            .init(x: 1, y: 1, width: 2, height: 2),
+            .init(x: 5, y: 3, width: 3, height: 1),
+        ])
+    }
+
+    func testDifferentSpansDoNotMerge() {
+        let detector = FrameChangeDetector()
+        var frame = Frame(width: 4 * tile, height: 2 * tile)
+        _ = frame.detect(with: detector)
+
+        // An L shape: two tiles wide on row 0, one tile on row 1
+        for (tx, ty) in [(0, 0), (1, 0), (0, 1)] {
+            frame.touchPixel(x: tx * tile, y: ty * tile)
+        }
+        XCTAssertTrue(frame.detect(with: detector))
+        XCTAssertEqual(detector.dirtyRegion()?.rects, [
+            .init(x: 0, y: 0, width: 2, height: 1),
+            .init(x: 0, y: 1, width: 1, height: 1),
+        ])
+    }
+}
@@ -0,0 +1,61 @@
+//
+//  FrameDirtyRegionTests.swift
+//  PortableTests
+//
+
+import XCTest
+@testable import AirCatchPortable
+
+final class FrameDirtyRegionTests: XCTestCase {
+
+    private func parse(_ data: Data) -> FrameDirtyRegion? {
+        data.withUnsafeBytes { FrameDirtyRegion(serialized: $0) }
+    }
+
+    func testRoundTrip() {
+        let region = FrameDirtyRegion(tileSize: 64, rects: [
+            .init(x: 0, y: 0, width: 2, height: 1),
+            .init(x: 300, y: 7, width: 1, height: 40),
+        ])
+        let data = region.serialized()
+        XCTAssertEqual(data.count, region.serializedSize)
+        XCTAssertEqual(parse(data), region)
+    }
+
+    func testWireFormatIsBigEndian() {
+        let region = FrameDirtyRegion(tileSize: 64, rects: [.init(x: 1, y: 2, width: 3, height: 0x0104)])
+        XCTAssertEqual([UInt8](region.serialized()), [0, 64, 0, 1, 0, 1, 0, 2, 0, 3, 1, 4])
+    }
+
+    /// An empty region is a keepalive: nothing on screen changed.
+    func testEmptyRegion() {
+        let region = FrameDirtyRegion(tileSize: 64, rects: [])
+        XCTAssertTrue(region.isEmpty)
+        XCTAssertEqual(parse(region.serialized()), region)
+    }
+
+    func testTruncatedInputIsRejected() {
+        let data = FrameDirtyRegion(tileSize: 64, rects: [.init(x: 1, y: 1, width: 1, height: 1)]).serialized()
+        for length in 0..<data.count {
+            XCTAssertNil(parse(data.prefix(length)), "length \(length)")
+        }
+    }
+
+    func testManyRectsCollapseToBoundingBox() {
+        let rects = (0..<(FrameDirtyRegion.maxRects + 1)).map {
+            FrameDirtyRegion.TileRect(x: UInt16($0 * 2), y: UInt16(5 + $0 % 3), width: 1, height: 1)
+        }
+        let region = FrameDirtyRegion(tileSize: 64, rects: rects)
+        XCTAssertEqual(region.rects, [.init(x: 0, y: 5, width: UInt16(FrameDirtyRegion.maxRects * 2 + 1), height: 3)])
+    }
+
+    func testFullFrameRoundsPartialTilesUp() {
+        let region = FrameDirtyRegion.fullFrame(width: 1920, height: 1080, tileSize: 64)
+        XCTAssertEqual(region.rects, [.init(x: 0, y: 0, width: 30, height: 17)])
+    }
+
+    /// The tag must never be mistaken for the start of an Annex B stream.
+    func testHeaderTagCannotStartAnnexB() {
+        XCTAssertNotEqual(FrameDirtyRegion.headerTag, 0x00)
+    }
+}
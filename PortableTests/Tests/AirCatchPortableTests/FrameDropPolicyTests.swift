@@ -0,0 +1,72 @@
+//
+//  FrameDropPolicyTests.swift
+//  PortableTests
+//
+
+import XCTest
+@testable import AirCatchPortable
+
+final class FrameDropPolicyTests: XCTestCase {
+
+    private let keyframe = FrameLayerTag(temporalLayer: 0, isKeyframe: true, isDroppable: false)
+    private let reference = FrameLayerTag(temporalLayer: 0, isKeyframe: false, isDroppable: false)
+    private let droppable = FrameLayerTag(temporalLayer: 1, isKeyframe: false, isDroppable: true)
+
+    func testTagByteRoundTrip() {
+        for byte: UInt8 in [0x00, 0x01, 0x41, 0x80, 0xC3] {
+            XCTAssertEqual(FrameLayerTag(byte: byte).byte, byte)
+        }
+        // Reserved bits are not carried
+        XCTAssertEqual(FrameLayerTag(byte: 0x3F).byte, 0x0F)
+    }
+
+    func testThinsDroppableFramesBeforeReferenceFrames() {
+        var policy = FrameDropPolicy()
+        XCTAssertEqual(policy.admit(droppable, frameBytes: 100, queuedBytes: 500, budget: 1000), .thin)
+        XCTAssertEqual(policy.admit(reference, frameBytes: 100, queuedBytes: 500, budget: 1000), .send)
+        XCTAssertEqual(policy.thinnedFrames, 1)
+        XCTAssertFalse(policy.waitingForKeyframe)
+    }
+
+    /// Past a lost reference frame nothing decodes until the next keyframe, which always goes out.
+    func testDroppedReferenceWaitsForKeyframe() {
+        var policy = FrameDropPolicy()
+        XCTAssertEqual(policy.admit(reference, frameBytes: 100, queuedBytes: 1000, budget: 1000), .drop)
+        XCTAssertTrue(policy.waitingForKeyframe)
+        XCTAssertEqual(policy.admit(reference, frameBytes: 100, queuedBytes: 0, budget: 1000), .drop)
+        XCTAssertEqual(policy.admit(droppable, frameBytes: 100, queuedBytes: 0, budget: 1000), .drop)
+        XCTAssertEqual(policy.admit(keyframe, frameBytes: 5000, queuedBytes: 5000, budget: 1000), .send)
+        XCTAssertEqual(policy.admit(reference, frameBytes: 100, queuedBytes: 0, budget: 1000), .send)
+        XCTAssertEqual(policy.droppedFrames, 3)
+    }
+
+    func testJoiningMidStreamWaitsForKeyframe() {
+        var policy = FrameDropPolicy(waitingForKeyframe: true)
+        XCTAssertEqual(policy.admit(reference, frameBytes: 1, queuedBytes: 0, budget: 1000), .drop)
+        XCTAssertEqual(policy.admit(keyframe, frameBytes: 1, queuedBytes: 0, budget: 1000), .send)
+    }
+
+    // MARK: - Simulated stream
+
+    func testAmpleLinkDropsNothing() {
+        var parameters = FrameDropSimulation.Parameters()
+        parameters.linkBitsPerSecond = 40_000_000
+        let report = FrameDropSimulation.run(parameters, layerAware: true)
+        XCTAssertEqual(report.dropped, 0)
+        XCTAssertGreaterThan(report.decodableFraction, 0.99)
+    }
+
+    /// Thinning the enhancement layer keeps the reference chain intact where blind drops break it.
+    func testLayerAwareDroppingKeepsMoreFramesDecodable() {
+        for megabits in [20.0, 15.0] {
+            var parameters = FrameDropSimulation.Parameters()
+            parameters.linkBitsPerSecond = megabits * 1_000_000
+            let layered = FrameDropSimulation.run(parameters, layerAware: true)
+            let blind = FrameDropSimulation.run(parameters, layerAware: false)
+            XCTAssertGreaterThan(layered.thinned, 0)
+            XCTAssertEqual(blind.thinned, 0)
+            XCTAssertGreaterThan(layered.decodableFraction, blind.decodableFraction + 0.2, "\(megabits) Mbps")
+            XCTAssertLessThan(layered.keyframes, blind.keyframes)
+        }
+    }
+}
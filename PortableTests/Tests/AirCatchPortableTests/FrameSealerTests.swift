@@ -0,0 +1,125 @@
+//
+//  FrameSealerTests.swift
+//  PortableTests
+//
+
+import XCTest
+#if canImport(CryptoKit)
+import CryptoKit
+#else
+import Crypto
+#endif
+@testable import AirCatchPortable
+
+final class FrameSealerTests: XCTestCase {
+
+    private let key = SymmetricKey(size: .bits256)
+    private let segmentSize = 1024
+
+    private func frame(_ count: Int) -> Data {
+        Data((0..<count).map { UInt8(truncatingIfNeeded: $0 &* 7) })
+    }
+
+    private func sealSegments(_ plaintext: Data, backend: AEADBackend.Type = AESGCMBackend.self, workers: Int? = nil) -> Data? {
+        var nonces = NonceSequence(isHost: true, epoch: 0)
+        let segmentCount = (plaintext.count + segmentSize - 1) / segmentSize
+        let segmentNonces = (0..<segmentCount).map { _ in nonces.next() }
+        var output = Data(count: FrameSealer.segmentedSize(of: plaintext.count, segmentSize: segmentSize))
+        let written = output.withUnsafeMutableBytes {
+            FrameSealer.sealSegments(plaintext, segmentSize: segmentSize, using: key, nonces: segmentNonces, backend: backend, workers: workers, into: $0)
+        }
+        return written == output.count ? output : nil
+    }
+
+    private func openSegments(_ sealed: Data, backend: AEADBackend.Type = AESGCMBackend.self, workers: Int? = nil) -> Data? {
+        FrameSealer.openSegments(sealed, workers: workers) { _ in (key, backend) }
+    }
+
+    /// Receivers open single boxes as `SealedBox(combined:)`.
+    func testSealMatchesCombinedLayout() throws {
+        let plaintext = frame(5000)
+        var nonces = NonceSequence(isHost: true, epoch: 0)
+        var output = Data(count: plaintext.count + FrameSealer.overhead)
+        let written = try output.withUnsafeMutableBytes {
+            try FrameSealer.seal(plaintext, using: key, nonce: nonces.next(), backend: AESGCMBackend.self, into: $0)
+        }
+        XCTAssertEqual(written, output.count)
+        XCTAssertEqual(try AES.GCM.open(AES.GCM.SealedBox(combined: output), using: key), plaintext)
+        XCTAssertEqual(try AESGCMBackend.open(output, using: key, authenticating: Data()), plaintext)
+    }
+
+    func testSegmentsRoundTripForEachCipher() {
+        for cipher in AEADCipher.allCases {
+            // A short last segment, and a frame that fills its last segment exactly
+            for count in [segmentSize * 3 + 100, segmentSize * 4] {
+                let plaintext = frame(count)
+                let sealed = sealSegments(plaintext, backend: cipher.backend)
+                XCTAssertEqual(sealed?.first, FrameSealer.segmentedTag)
+                XCTAssertEqual(sealed.flatMap { openSegments($0, backend: cipher.backend) }, plaintext, "\(cipher) \(count)")
+            }
+        }
+    }
+
+    /// The thread count changes who seals which segment, never the bytes.
+    func testWorkerCountDoesNotChangeOutput() {
+        let plaintext = frame(segmentSize * 9 + 1)
+        var nonces = NonceSequence(isHost: true, epoch: 0)
+        let segmentNonces = (0..<10).map { _ in nonces.next() }
+        let outputs = [1, 3, 8, nil].map { workers -> Data in
+            var output = Data(count: FrameSealer.segmentedSize(of: plaintext.count, segmentSize: segmentSize))
+            _ = output.withUnsafeMutableBytes {
+                FrameSealer.sealSegments(plaintext, segmentSize: segmentSize, using: key, nonces: segmentNonces,
+                                         backend: AESGCMBackend.self, workers: workers, into: $0)
+            }
+            return output
+        }
+        XCTAssertEqual(Set(outputs).count, 1)
+        for workers in [1, 3, 8] {
+            XCTAssertEqual(openSegments(outputs[0], workers: workers), plaintext)
+        }
+    }
+
+    func testTamperedOrReorderedSegmentsFail() throws {
+        let plaintext = frame(segmentSize * 3)
+        let sealed = try XCTUnwrap(sealSegments(plaintext))
+        let box = segmentSize + FrameSealer.overhead
+        let first = FrameSealer.segmentHeaderSize
+
+        var flipped = sealed
+        flipped[first + box + 40] ^= 1
+        XCTAssertNil(openSegments(flipped))
+
+        // Second and third segment swapped: each authenticates its own index
+        var swapped = sealed
+        swapped.replaceSubrange((first + box)..<(first + 2 * box), with: sealed[(first + 2 * box)..<(first + 3 * box)])
+        swapped.replaceSubrange((first + 2 * box)..<(first + 3 * box), with: sealed[(first + box)..<(first + 2 * box)])
+        XCTAssertNil(openSegments(swapped))
+
+        // Last segment dropped and the count rewritten to match
+        var truncated = Data(sealed.prefix(first + 2 * box))
+        truncated[2] = 2
+        XCTAssertNil(openSegments(truncated))
+    }
+
+    func testRejectsInconsistentLayout() throws {
+        let sealed = try XCTUnwrap(sealSegments(frame(segmentSize * 2)))
+        var wrongSize = sealed
+        wrongSize[6] = 0xFF
+        XCTAssertNil(openSegments(wrongSize))
+        XCTAssertNil(openSegments(Data(sealed.prefix(FrameSealer.segmentHeaderSize + FrameSealer.overhead))))
+
+        var notSegmented = sealed
+        notSegmented[0] = 0x80
+        XCTAssertNil(openSegments(notSegmented))
+    }
+
+    func testRejectsMismatchedNonceCount() {
+        var nonces = NonceSequence(isHost: true, epoch: 0)
+        var output = Data(count: FrameSealer.segmentedSize(of: segmentSize * 2, segmentSize: segmentSize))
+        let written = output.withUnsafeMutableBytes {
+            FrameSealer.sealSegments(frame(segmentSize * 2), segmentSize: segmentSize, using: key, nonces: [nonces.next()],
+                                     backend: AESGCMBackend.self, into: $0)
+        }
+        XCTAssertNil(written)
+    }
+}
@@ -0,0 +1,135 @@
+//
+//  InputCoalescerTests.swift
+//  PortableTests
+//
+
+import XCTest
+@testable import AirCatchPortable
+
+final class InputCoalescerTests: XCTestCase {
+
+    private typealias Coalescer = InputCoalescer<Int>
+
+    func testIsolatedEventsAreInjectedImmediately() {
+        var coalescer = Coalescer()
+        XCTAssertEqual(coalescer.submitPointer(1, kind: 0, receivedAt: 0)?.value, 1)
+        XCTAssertEqual(coalescer.submitScroll(deltaX: 0, deltaY: 2), Coalescer.Scroll(deltaX: 0, deltaY: 2))
+        XCTAssertTrue(coalescer.needsRefresh)
+
+        // A refresh with nothing held re-arms immediate injection, then the link may pause
+        XCTAssertNil(coalescer.refresh().pointer)
+        XCTAssertFalse(coalescer.needsRefresh)
+        XCTAssertEqual(coalescer.submitPointer(2, kind: 0, receivedAt: 1)?.value, 2)
+    }
+
+    func testBurstWithinRefreshKeepsNewestPosition() {
+        var coalescer = Coalescer()
+        XCTAssertNotNil(coalescer.submitPointer(1, kind: 0, receivedAt: 0))
+        for value in 2...5 {
+            XCTAssertNil(coalescer.submitPointer(value, kind: 0, receivedAt: Double(value)))
+        }
+        let due = coalescer.refresh().pointer
+        XCTAssertEqual(due?.value, 5)
+        XCTAssertEqual(due?.receivedAt, 2, "latency is measured from the oldest folded event")
+        XCTAssertEqual(coalescer.coalescedCount, 3)
+
+        // The refresh that injected held motion holds the next event again
+        XCTAssertNil(coalescer.submitPointer(6, kind: 0, receivedAt: 6))
+        XCTAssertTrue(coalescer.needsRefresh)
+    }
+
+    func testScrollDeltasAreSummed() {
+        var coalescer = Coalescer()
+        XCTAssertNotNil(coalescer.submitScroll(deltaX: 1, deltaY: 1))
+        XCTAssertNil(coalescer.submitScroll(deltaX: 2, deltaY: -3))
+        XCTAssertNil(coalescer.submitScroll(deltaX: 0.5, deltaY: -1))
+        XCTAssertEqual(coalescer.refresh().scroll, Coalescer.Scroll(deltaX: 2.5, deltaY: -4))
+    }
+
+    func testHoverAndDragKeepTheirOrder() {
+        var coalescer = Coalescer()
+        XCTAssertNotNil(coalescer.submitPointer(1, kind: 0, receivedAt: 0))
+        XCTAssertNil(coalescer.submitPointer(2, kind: 0, receivedAt: 1))
+        let older = coalescer.submitPointer(3, kind: 1, receivedAt: 2)
+        XCTAssertEqual(older?.value, 2)
+        XCTAssertEqual(older?.kind, 0)
+        XCTAssertEqual(coalescer.refresh().pointer?.value, 3)
+    }
+
+    func testFlushEmptiesHeldInputAheadOfClick() {
+        var coalescer = Coalescer()
+        _ = coalescer.submitPointer(1, kind: 0, receivedAt: 0)
+        _ = coalescer.submitPointer(2, kind: 0, receivedAt: 1)
+        _ = coalescer.submitScroll(deltaX: 0, deltaY: 1)
+        _ = coalescer.submitScroll(deltaX: 0, deltaY: 1)
+        let due = coalescer.flush()
+        XCTAssertEqual(due.pointer?.value, 2)
+        XCTAssertEqual(due.scroll, Coalescer.Scroll(deltaX: 0, deltaY: 1))
+        XCTAssertNil(coalescer.refresh().pointer)
+    }
+
+    func testResetDropsHeldInput() {
+        var coalescer = Coalescer()
+        _ = coalescer.submitPointer(1, kind: 0, receivedAt: 0)
+        _ = coalescer.submitPointer(2, kind: 0, receivedAt: 1)
+        coalescer.reset()
+        XCTAssertFalse(coalescer.needsRefresh)
+        XCTAssertEqual(coalescer.submitPointer(3, kind: 0, receivedAt: 2)?.value, 3)
+    }
+
+    // MARK: - Trace Replay
+
+    func testIsolatedMovesAddNoLatency() {
+        let trace = InputTraceReplay.builtIn.first { $0.name == "isolated moves" }!.trace
+        for rate in [60.0, 120.0] {
+            let report = InputTraceReplay.replay(trace, refreshRate: rate)
+            XCTAssertEqual(report.addedLatency.max(), 0)
+            XCTAssertEqual(report.injections, trace.count)
+        }
+    }
+
+    func testStallBurstsLandOnePerRefreshWithinOneInterval() {
+        let trace = InputTraceReplay.builtIn.first { $0.name == "Wi-Fi stall bursts" }!.trace
+        for rate in [60.0, 120.0] {
+            let report = InputTraceReplay.replay(trace, refreshRate: rate)
+            XCTAssertEqual(report.maxPointerInjectionsPerRefresh, 1)
+            XCTAssertLessThanOrEqual(report.addedLatency.max()!, 1 / rate + 1e-9)
+            XCTAssertGreaterThan(report.coalesced, 0)
+            XCTAssertEqual(report.finalPointer, trace.last!.kind)
+        }
+    }
+
+    /// Held motion goes out on the next refresh, which is where an immediate injection would show anyway.
+    func testCoalescingAddsNoDisplayLatency() {
+        for (name, trace) in InputTraceReplay.builtIn {
+            for rate in [60.0, 120.0] {
+                let report = InputTraceReplay.replay(trace, refreshRate: rate)
+                XCTAssertEqual(report.displayLatency.count, report.immediateDisplayLatency.count, name)
+                XCTAssertLessThanOrEqual(InputTraceReplay.percentile(report.displayLatency, 0.99),
+                                         InputTraceReplay.percentile(report.immediateDisplayLatency, 0.99) + 1e-9, "\(name) \(rate)")
+                XCTAssertLessThanOrEqual(report.immediateDisplayLatency.max()!, 1 / rate + 1e-9, name)
+            }
+        }
+    }
+
+    func testReplayPreservesScrollTotalAndKindOrder() {
+        let trace = InputTraceReplay.parse("""
+            # seconds,kind,a,b
+            0.001,move,0.1,0.1
+            0.002,move,0.2,0.2
+            0.003,drag,0.3,0.3
+            0.004,drag,0.4,0.4
+            0.005,scroll,0,-2
+            0.006,scroll,0,-2
+            0.007,scroll,1,-2
+            0.020,click,0,0
+            0.021,move,0.5,0.5
+            """)
+        XCTAssertEqual(trace.count, 9)
+        let report = InputTraceReplay.replay(trace, refreshRate: 60)
+        XCTAssertEqual(report.scrollTotal.deltaX, 1)
+        XCTAssertEqual(report.scrollTotal.deltaY, -6)
+        XCTAssertEqual(report.pointerKindSequence, [0, 1, 0])
+        XCTAssertEqual(report.finalPointer, .move(x: 0.5, y: 0.5))
+    }
+}
@@ -0,0 +1,78 @@
+//
+//  KeyScheduleTests.swift
+//  PortableTests
+//
+
+import XCTest
+#if canImport(CryptoKit)
+import CryptoKit
+#else
+import Crypto
+#endif
+@testable import AirCatchPortable
+
+final class KeyScheduleTests: XCTestCase {
+
+    private let secret = SymmetricKey(size: .bits256)
+    private let salt = Data(repeating: 3, count: 32)
+
+    private func schedule(_ role: KeySchedule.Role, rekeyInterval: UInt64 = 4, peer: UInt16 = 0, receiveEpoch: UInt32 = 0) -> KeySchedule {
+        KeySchedule(secret: secret, salt: salt, role: role, cipher: .aes256GCM, rekeyInterval: rekeyInterval, peer: peer, receiveEpoch: receiveEpoch)
+    }
+
+    /// Seals one packet on `sender` and opens it on `receiver` the way CryptoManager does.
+    private func deliver(from sender: inout KeySchedule, to receiver: inout KeySchedule) -> Bool {
+        let sealing = sender.nextSealing()
+        var box = Data(count: 10 + FrameSealer.overhead)
+        _ = try? box.withUnsafeMutableBytes {
+            try FrameSealer.seal(Data(count: 10), using: sealing.key, nonce: sealing.nonce, backend: AESGCMBackend.self, into: $0)
+        }
+        guard let opening = receiver.openingKey(for: box.prefix(12)),
+              (try? AESGCMBackend.open(box, using: opening.key, authenticating: Data())) != nil else { return false }
+        receiver.didOpen(opening)
+        return true
+    }
+
+    func testReceiverFollowsRatchets() {
+        var host = schedule(.host)
+        var client = schedule(.client)
+        for _ in 0..<20 {
+            XCTAssertTrue(deliver(from: &host, to: &client))
+        }
+        XCTAssertEqual(host.sendEpoch, 4)
+    }
+
+    func testSharedIntervalFromTheAppsDoesNotRatchetEarly() {
+        var host = schedule(.host, rekeyInterval: 1 << 20)
+        for _ in 0..<10_000 { _ = host.nextSealing() }
+        XCTAssertEqual(host.sendEpoch, 0)
+    }
+
+    /// One viewer's ratchets don't move another's chain on the host.
+    func testPeersRatchetIndependently() {
+        var host = schedule(.host)
+        host.addPeer(1)
+        host.addPeer(2)
+        var first = schedule(.client, peer: 1)
+        var second = schedule(.client, peer: 2)
+        for _ in 0..<12 {
+            XCTAssertTrue(deliver(from: &first, to: &host))
+        }
+        XCTAssertTrue(deliver(from: &second, to: &host))
+        XCTAssertEqual(first.sendEpoch, 2)
+        XCTAssertEqual(second.sendEpoch, 0)
+    }
+
+    func testUnknownPeerHasNoKey() {
+        var host = schedule(.host)
+        var stranger = schedule(.client, peer: 9)
+        XCTAssertFalse(deliver(from: &stranger, to: &host))
+    }
+
+    func testLateJoinerStartsAtHostEpoch() {
+        var host = schedule(.host)
+        for _ in 0..<10 { _ = host.nextSealing() }
+        var client = schedule(.client, receiveEpoch: host.sendEpoch)
+        XCTAssertTrue(deliver(from: &host, to: &client))
+    }
+}
@@ -0,0 +1,172 @@
+//
+//  LoopbackUDP.swift
+//  PortableTests
+//
+//  Plain UDP sockets on 127.0.0.1 standing in for the host's NWConnections.
+//
+
+import Foundation
+import Synchronization
+#if canImport(Glibc)
+import Glibc
+private let datagramSocket = Int32(SOCK_DGRAM.rawValue)
+#else
+import Darwin
+private let datagramSocket = SOCK_DGRAM
+#endif
+@testable import AirCatchPortable
+
+/// Test datagrams: `[FrameId: 4][ChunkIdx: 2]` then padding, like a chunk header.
+enum LoopbackDatagram {
+    static func make(frameId: UInt32, chunk: UInt16, size: Int) -> Data {
+        var datagram = Data(count: max(size, 6))
+        datagram.withUnsafeMutableBytes { bytes in
+            bytes.storeBytes(of: frameId.bigEndian, toByteOffset: 0, as: UInt32.self)
+            bytes.storeBytes(of: chunk.bigEndian, toByteOffset: 4, as: UInt16.self)
+        }
+        return datagram
+    }
+
+    static func parse(_ bytes: UnsafeRawBufferPointer) -> (frameId: UInt32, chunk: UInt16)? {
+        guard bytes.count >= 6 else { return nil }
+        return (UInt32(bigEndian: bytes.loadUnaligned(as: UInt32.self)),
+                UInt16(bigEndian: bytes.loadUnaligned(fromByteOffset: 4, as: UInt16.self)))
+    }
+}
+
+/// A viewer's end: a socket bound to an ephemeral loopback port, read on its own thread.
+final class LoopbackReceiver: @unchecked Sendable {
+    let port: UInt16
+    private let fd: Int32
+    private let running = Mutex(true)
+    private let received = Mutex<[UInt32: Set<UInt16>]>([:])
+    private let finished = DispatchSemaphore(value: 0)
+
+    init() {
+        let fd = Self.makeSocket()
+        var size: Int32 = 4 << 20
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &size, socklen_t(MemoryLayout<Int32>.size))
+        // Short timeout, so the reader notices `stop()`
+        var timeout = timeval(tv_sec: 0, tv_usec: 50_000)
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, socklen_t(MemoryLayout<timeval>.size))
+
+        var address = Self.loopback(port: 0)
+        var length = socklen_t(MemoryLayout<sockaddr_in>.size)
+        withUnsafeMutablePointer(to: &address) {
+            $0.withMemoryRebound(to: sockaddr.self, capacity: 1) { pointer in
+                _ = bind(fd, pointer, length)
+                _ = getsockname(fd, pointer, &length)
+            }
+        }
+        self.fd = fd
+        port = UInt16(bigEndian: address.sin_port)
+
+        Thread.detachNewThread { [self] in
+            var buffer = [UInt8](repeating: 0, count: 65_536)
+            while running.withLock({ $0 }) {
+                let count = buffer.withUnsafeMutableBytes { recv(fd, $0.baseAddress, $0.count, 0) }
+                guard count > 0 else { continue }
+                let header = buffer.withUnsafeBytes { LoopbackDatagram.parse(UnsafeRawBufferPointer(rebasing: $0[..<count])) }
+                if let header {
+                    _ = received.withLock { $0[header.frameId, default: []].insert(header.chunk) }
+                }
+            }
+            finished.signal()
+        }
+    }
+
+    /// Chunks received so far, by frame id (repeats counted once).
+    var chunks: [UInt32: Set<UInt16>] {
+        received.withLock { $0 }
+    }
+
+    var chunkCount: Int {
+        received.withLock { $0.values.reduce(0) { $0 + $1.count } }
+    }
+
+    func stop() {
+        running.withLock { $0 = false }
+        finished.wait()
+        close(fd)
+    }
+
+    static func makeSocket() -> Int32 {
+        socket(AF_INET, datagramSocket, 0)
+    }
+
+    static func loopback(port: UInt16) -> sockaddr_in {
+        var address = sockaddr_in()
+        #if canImport(Darwin)
+        address.sin_len = UInt8(MemoryLayout<sockaddr_in>.size)
+        #endif
+        address.sin_family = sa_family_t(AF_INET)
+        address.sin_port = port.bigEndian
+        address.sin_addr.s_addr = inet_addr("127.0.0.1")
+        return address
+    }
+}
+
+/// The host's end of one viewer: a socket connected to a `LoopbackReceiver`, optionally
+/// dropping datagrams before they reach it.
+final class LoopbackSink: VideoDatagramSink, @unchecked Sendable {
+    private let fd: Int32
+    /// Return true to drop a datagram (loss injection); called on the viewer's queue.
+    var drops: ((Data) -> Bool)?
+
+    init(to receiver: LoopbackReceiver) {
+        let fd = LoopbackReceiver.makeSocket()
+        var address = LoopbackReceiver.loopback(port: receiver.port)
+        withUnsafePointer(to: &address) {
+            $0.withMemoryRebound(to: sockaddr.self, capacity: 1) { pointer in
+                _ = connect(fd, pointer, socklen_t(MemoryLayout<sockaddr_in>.size))
+            }
+        }
+        self.fd = fd
+    }
+
+    deinit {
+        close(fd)
+    }
+
+    func batch(_ block: () -> Void) {
+        block()
+    }
+
+    func send(datagram: Data, completion: @escaping @Sendable () -> Void) {
+        if drops?(datagram) != true {
+            datagram.withUnsafeBytes { bytes in
+                #if canImport(Glibc)
+                _ = Glibc.send(fd, bytes.baseAddress, bytes.count, 0)
+                #else
+                _ = Darwin.send(fd, bytes.baseAddress, bytes.count, 0)
+                #endif
+            }
+        }
+        completion()
+    }
+}
+
+/// Loss for a `LoopbackSink`: chosen chunks lost on their first send, plus random loss on every send.
+final class InjectedLoss: @unchecked Sendable {
+    private let rate: Double
+    private let state: Mutex<(random: UInt32, once: Set<UInt64>)>
+
+    init(rate: Double = 0, once chunks: [(frameId: UInt32, chunk: UInt16)] = [], seed: UInt32 = 0x9E37_79B9) {
+        self.rate = rate
+        state = Mutex((seed, Set(chunks.map { UInt64($0.frameId) << 16 | UInt64($0.chunk) })))
+    }
+
+    func drops(_ datagram: Data) -> Bool {
+        guard let header = datagram.withUnsafeBytes(LoopbackDatagram.parse) else { return false }
+        let key = UInt64(header.frameId) << 16 | UInt64(header.chunk)
+        return state.withLock { state in
+            if state.once.remove(key) != nil {
+                return true
+            }
+            state.random ^= state.random << 13
+            state.random ^= state.random >> 17
+            state.random ^= state.random << 5
+            return Double(state.random) / Double(UInt32.max) < rate
+        }
+    }
+}
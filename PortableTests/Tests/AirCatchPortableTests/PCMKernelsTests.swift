@@ -0,0 +1,165 @@
+//
+//  PCMKernelsTests.swift
+//  PortableTests
+//
+
+import XCTest
+@testable import AirCatchPortable
+
+final class PCMKernelsTests: XCTestCase {
+
+    /// Counts around the 4-frame SIMD width, plus a real packet size
+    private let frameCounts = [0, 1, 3, 4, 5, 7, 8, 17, 480]
+
+    func testInterleaveMatchesScalar() {
+        for frameCount in frameCounts {
+            let left = (0..<frameCount).map { Float($0) + 0.25 }
+            let right = (0..<frameCount).map { -Float($0) - 0.5 }
+            var output = [Float](repeating: .nan, count: frameCount * 2)
+            output.withUnsafeMutableBufferPointer { out in
+                guard let base = out.baseAddress else { return }
+                PCMKernels.interleave(left: left, right: right, into: base, frameCount: frameCount)
+            }
+
+            var expected: [Float] = []
+            for i in 0..<frameCount {
+                expected += [left[i], right[i]]
+            }
+            XCTAssertEqual(output, expected, "frameCount \(frameCount)")
+        }
+    }
+
+    /// Packets put PCM after an 8-byte header, and `Data` gives no alignment guarantee;
+    /// read from every offset within a SIMD8 lane.
+    func testDeinterleaveReadsUnalignedInput() {
+        for frameCount in frameCounts {
+            for offset in 0..<8 {
+                let samples = (0..<(frameCount * 2)).map { Float($0) * 0.5 }
+                var bytes = [UInt8](repeating: 0xFF, count: offset)
+                samples.withUnsafeBytes { bytes += $0 }
+
+                var left = [Float](repeating: .nan, count: frameCount)
+                var right = [Float](repeating: .nan, count: frameCount)
+                bytes.withUnsafeBytes { raw in
+                    left.withUnsafeMutableBufferPointer { l in
+                        right.withUnsafeMutableBufferPointer { r in
+                            guard let base = raw.baseAddress, let lBase = l.baseAddress, let rBase = r.baseAddress else { return }
+                            PCMKernels.deinterleave(base + offset, left: lBase, right: rBase, frameCount: frameCount)
+                        }
+                    }
+                }
+
+                XCTAssertEqual(left, stride(from: 0, to: frameCount * 2, by: 2).map { samples[$0] }, "frameCount \(frameCount), offset \(offset)")
+                XCTAssertEqual(right, stride(from: 1, to: frameCount * 2, by: 2).map { samples[$0] }, "frameCount \(frameCount), offset \(offset)")
+            }
+        }
+    }
+
+    func testRoundTrip() {
+        let frameCount = 481
+        let left = (0..<frameCount).map { sinf(Float($0) * 0.01) }
+        let right = (0..<frameCount).map { cosf(Float($0) * 0.01) }
+        var interleaved = [Float](repeating: 0, count: frameCount * 2)
+        var outLeft = [Float](repeating: 0, count: frameCount)
+        var outRight = [Float](repeating: 0, count: frameCount)
+
+        interleaved.withUnsafeMutableBufferPointer { out in
+            PCMKernels.interleave(left: left, right: right, into: out.baseAddress!, frameCount: frameCount)
+        }
+        interleaved.withUnsafeBytes { input in
+            outLeft.withUnsafeMutableBufferPointer { l in
+                outRight.withUnsafeMutableBufferPointer { r in
+                    PCMKernels.deinterleave(input.baseAddress!, left: l.baseAddress!, right: r.baseAddress!, frameCount: frameCount)
+                }
+            }
+        }
+
+        XCTAssertEqual(outLeft, left)
+        XCTAssertEqual(outRight, right)
+    }
+
+    // MARK: - Format Conversion
+
+    private func toInt16(_ input: [Float], dither: PCMDither? = nil) -> [Int16] {
+        var output = [Int16](repeating: 0x5A5A, count: input.count)
+        var state = dither ?? PCMDither()
+        input.withUnsafeBufferPointer { src in
+            output.withUnsafeMutableBufferPointer { dst in
+                guard let srcBase = src.baseAddress, let dstBase = dst.baseAddress else { return }
+                if dither != nil {
+                    PCMKernels.convertFloatToInt16(srcBase, into: dstBase, count: input.count, dither: &state)
+                } else {
+                    PCMKernels.convertFloatToInt16(srcBase, into: dstBase, count: input.count)
+                }
+            }
+        }
+        return output
+    }
+
+    func testFloatToInt16MatchesScalar() {
+        for count in frameCounts {
+            let input = (0..<count).map { sinf(Float($0) * 0.37) * 1.2 }
+            let expected = input.map { Int16(min(max($0 * 32767, -32768), 32767).rounded(.toNearestOrEven)) }
+            XCTAssertEqual(toInt16(input), expected, "count \(count)")
+        }
+    }
+
+    func testFloatToInt16ClampsAndRoundsEndpoints() {
+        XCTAssertEqual(toInt16([-2, -1, 0, 1, 2, .ulpOfOne, -0.4 / 32767, 0.4 / 32767]),
+                       [-32768, -32767, 0, 32767, 32767, 0, 0, 0])
+    }
+
+    func testDitherStaysWithinOneStep() {
+        let input = (0..<4801).map { sinf(Float($0) * 0.01) * 0.5 }
+        let plain = toInt16(input)
+        let dithered = toInt16(input, dither: PCMDither(seed: 42))
+        var total = 0
+        for (a, b) in zip(plain, dithered) {
+            XCTAssertLessThanOrEqual(abs(Int(a) - Int(b)), 1)
+            total += Int(b) - Int(a)
+        }
+        // TPDF dither is zero-mean; a biased source would drift the signal
+        XCTAssertLessThan(abs(total), input.count / 20)
+        XCTAssertNotEqual(plain, dithered)
+        XCTAssertEqual(dithered, toInt16(input, dither: PCMDither(seed: 42)), "deterministic for a seed")
+    }
+
+    func testInt16ToFloatIsExactAndRoundTrips() {
+        for count in frameCounts {
+            let input = (0..<count).map { Int16(truncatingIfNeeded: $0 &* 2741 &- 30000) }
+            var floats = [Float](repeating: .nan, count: count)
+            input.withUnsafeBufferPointer { src in
+                floats.withUnsafeMutableBufferPointer { dst in
+                    guard let srcBase = src.baseAddress, let dstBase = dst.baseAddress else { return }
+                    PCMKernels.convertInt16ToFloat(srcBase, into: dstBase, count: count)
+                }
+            }
+            XCTAssertEqual(floats, input.map { Float($0) / 32768 }, "count \(count)")
+            // Scales differ (1/32768 in, 32767 out), so a round trip may move by one step
+            for (a, b) in zip(input, toInt16(floats)) {
+                XCTAssertLessThanOrEqual(abs(Int(a) - Int(b)), 1)
+            }
+        }
+    }
+
+    // MARK: - Gain
+
+    func testGainMatchesScalar() {
+        for count in frameCounts + [9, 15, 16] {
+            let input = (0..<count).map { Float($0) - 3.5 }
+            var samples = input
+            samples.withUnsafeMutableBufferPointer { buffer in
+                guard let base = buffer.baseAddress else { return }
+                PCMKernels.applyGain(0.25, to: base, count: count)
+            }
+            XCTAssertEqual(samples, input.map { $0 * 0.25 }, "count \(count)")
+        }
+    }
+
+    func testUnityGainLeavesSamplesUntouched() {
+        var samples: [Float] = [.nan, 1, -1]
+        samples.withUnsafeMutableBufferPointer { PCMKernels.applyGain(1, to: $0.baseAddress!, count: 3) }
+        XCTAssertTrue(samples[0].isNaN)
+        XCTAssertEqual(Array(samples[1...]), [1, -1])
+    }
+}
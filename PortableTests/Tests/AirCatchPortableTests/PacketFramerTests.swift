@@ -0,0 +1,88 @@
+//
+//  PacketFramerTests.swift
+//  PortableTests
+//
+
+import XCTest
+@testable import AirCatchPortable
+
+final class PacketFramerTests: XCTestCase {
+
+    private func wire(_ typeByte: UInt8, _ payload: [UInt8]) -> [UInt8] {
+        let length = payload.count
+        return [typeByte, UInt8(length >> 24 & 0xFF), UInt8(length >> 16 & 0xFF), UInt8(length >> 8 & 0xFF), UInt8(length & 0xFF)] + payload
+    }
+
+    func testManyPacketsInOneRead() throws {
+        let framer = PacketFramer(maxPayloadSize: 1024)
+        let bytes = wire(PacketType.ping.rawValue, [1, 2]) + wire(PacketType.inputBatch.rawValue, [3])
+            + wire(PacketType.pong.rawValue, [])
+        let packets = try framer.append(Data(bytes))
+        XCTAssertEqual(packets.map(\.type), [.ping, .inputBatch, .pong])
+        XCTAssertEqual(packets.map { [UInt8]($0.payload) }, [[1, 2], [3], []])
+        XCTAssertEqual(framer.bufferedByteCount, 0)
+    }
+
+    func testPacketSplitAcrossReadsAtEveryOffset() throws {
+        let bytes = wire(PacketType.videoFrame.rawValue, Array(0..<40)) + wire(PacketType.ping.rawValue, [9])
+        for split in 1..<bytes.count {
+            let framer = PacketFramer(maxPayloadSize: 1024)
+            let first = try framer.append(Data(bytes[..<split]))
+            let second = try framer.append(Data(bytes[split...]))
+            let packets = first + second
+            XCTAssertEqual(packets.map(\.type), [.videoFrame, .ping], "split at \(split)")
+            XCTAssertEqual([UInt8](packets[0].payload), Array(0..<40), "split at \(split)")
+            XCTAssertEqual(framer.bufferedByteCount, 0)
+        }
+    }
+
+    func testByteAtATime() throws {
+        let framer = PacketFramer(maxPayloadSize: 1024)
+        var packets: [Packet] = []
+        for byte in wire(PacketType.keyEvent.rawValue, [7, 8, 9]) + wire(PacketType.pong.rawValue, []) {
+            packets += try framer.append(Data([byte]))
+        }
+        XCTAssertEqual(packets.map(\.type), [.keyEvent, .pong])
+        XCTAssertEqual([UInt8](packets[0].payload), [7, 8, 9])
+    }
+
+    func testUnknownTypeIsSkipped() throws {
+        let framer = PacketFramer(maxPayloadSize: 1024)
+        XCTAssertNil(PacketType(rawValue: 0xEE))
+        let bytes = wire(0xEE, [1, 2, 3]) + wire(PacketType.ping.rawValue, [4])
+        let packets = try framer.append(Data(bytes))
+        XCTAssertEqual(packets.map(\.type), [.ping])
+        XCTAssertEqual([UInt8](packets[0].payload), [4])
+    }
+
+    func testOversizeLengthThrowsFromHeaderAlone() {
+        let framer = PacketFramer(maxPayloadSize: 16)
+        // Only the header arrives; the framer must refuse before waiting for the payload
+        let header = Data([PacketType.videoFrame.rawValue, 0, 0, 0, 17])
+        XCTAssertThrowsError(try framer.append(header)) { error in
+            guard case PacketFramer.FramingError.payloadTooLarge(let length) = error else {
+                return XCTFail("unexpected error \(error)")
+            }
+            XCTAssertEqual(length, 17)
+        }
+    }
+
+    func testPartialPacketStaysBuffered() throws {
+        let framer = PacketFramer(maxPayloadSize: 1024)
+        let bytes = wire(PacketType.ping.rawValue, [1]) + wire(PacketType.videoFrame.rawValue, Array(repeating: 5, count: 10))
+        let packets = try framer.append(Data(bytes.dropLast(4)))
+        XCTAssertEqual(packets.map(\.type), [.ping])
+        XCTAssertEqual(framer.bufferedByteCount, PacketFramer.headerSize + 6)
+        XCTAssertEqual(try framer.append(Data(bytes.suffix(4))).map(\.type), [.videoFrame])
+    }
+
+    func testBenchmarkStreamParsesBack() throws {
+        let bytes = PacketFramerBenchmarks.stream(type: .inputBatch, payloadSize: 48, count: 100)
+        let framer = PacketFramer(maxPayloadSize: 1024)
+        var count = 0
+        for data in PacketFramerBenchmarks.reads(of: bytes, readSize: 1500) {
+            count += try framer.append(data).count
+        }
+        XCTAssertEqual(count, 100)
+    }
+}
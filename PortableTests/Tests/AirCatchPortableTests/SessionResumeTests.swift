@@ -0,0 +1,119 @@
+//
+//  SessionResumeTests.swift
+//  PortableTests
+//
+
+import XCTest
+#if canImport(CryptoKit)
+import CryptoKit
+#else
+import Crypto
+#endif
+@testable import AirCatchPortable
+
+/// A dropped session coming back by resume ticket, timed against a full handshake.
+///
+/// Both ends do the work `ClientManager` and `HostManager` do between sending the
+/// request and the client acting on the ack: the PIN proof, and for a handshake the
+/// key exchange the way the CryptoManagers run it. The link adds `roundTrip`, and
+/// `ConnectionTimeline` turns the marks into the recovery time the client logs.
+/// Not included: the client's retry delay, and the host's stream startup, which only
+/// a full handshake waits for (ScreenCaptureKit and VideoToolbox; the app reports it
+/// as `StreamStartupReport`).
+final class SessionResumeTests: XCTestCase {
+
+    private let pin = "482913"
+    /// Wi-Fi round trip
+    private let roundTrip: TimeInterval = 0.02
+    private let runs = 50
+
+    /// Resume: the client proves the PIN over its ticket, the host checks it and resends the ack.
+    private func resume(ticket: String) -> Bool {
+        let request = SessionResumeRequest(ticket: ticket, pinProof: KeySchedule.pinProof(pin: pin, context: Data(ticket.utf8)))
+        guard let payload = try? JSONEncoder().encode(request),
+              let received = try? JSONDecoder().decode(SessionResumeRequest.self, from: payload),
+              let proof = received.pinProof else { return false }
+        return KeySchedule.isValidPINProof(proof, pin: pin, context: Data(received.ticket.utf8))
+    }
+
+    /// Handshake: a fresh key share and PIN proof, the host's `acceptKeyShare`, then the
+    /// client's `completeKeyExchange`.
+    private func handshake() throws -> Bool {
+        let exchangeKey = Curve25519.KeyAgreement.PrivateKey()
+        let clientShare = exchangeKey.publicKey.rawRepresentation
+        let proof = KeySchedule.pinProof(pin: pin, context: clientShare)
+
+        // Host
+        guard KeySchedule.isValidPINProof(proof, pin: pin, context: clientShare) else { return false }
+        let clientKey = try Curve25519.KeyAgreement.PublicKey(rawRepresentation: clientShare)
+        let secret = SymmetricKey(size: .bits256)
+        let salt = SymmetricKey(size: .bits256).withUnsafeBytes { Data($0) }
+        let ephemeral = Curve25519.KeyAgreement.PrivateKey()
+        let hostShare = ephemeral.publicKey.rawRepresentation
+        let hostAgreement = try ephemeral.sharedSecretFromKeyAgreement(with: clientKey)
+        let hostWrappingKey = KeySchedule.wrappingKey(agreement: hostAgreement, pin: pin, salt: salt, clientShare: clientShare, hostShare: hostShare)
+        guard let sealedSecret = try AES.GCM.seal(secret.withUnsafeBytes { Data($0) }, using: hostWrappingKey).combined else { return false }
+        var answer = SessionKeyShare(publicKey: hostShare, salt: salt, sealedSecret: sealedSecret, cipher: AEADCipher.aes256GCM.rawValue)
+        answer.peerId = 1
+        answer.hostEpoch = 0
+        let hostConfirmationKey = KeySchedule.confirmationKey(agreement: hostAgreement, pin: pin, salt: salt, clientShare: clientShare, hostShare: hostShare)
+        answer.confirmation = Data(HMAC<SHA256>.authenticationCode(for: KeySchedule.confirmedFields(of: answer), using: hostConfirmationKey))
+        let payload = try JSONEncoder().encode(answer)
+
+        // Client
+        let received = try JSONDecoder().decode(SessionKeyShare.self, from: payload)
+        let hostKey = try Curve25519.KeyAgreement.PublicKey(rawRepresentation: received.publicKey)
+        let agreement = try exchangeKey.sharedSecretFromKeyAgreement(with: hostKey)
+        let wrappingKey = KeySchedule.wrappingKey(agreement: agreement, pin: pin, salt: received.salt, clientShare: clientShare, hostShare: received.publicKey)
+        let confirmationKey = KeySchedule.confirmationKey(agreement: agreement, pin: pin, salt: received.salt, clientShare: clientShare, hostShare: received.publicKey)
+        guard let confirmation = received.confirmation,
+              HMAC<SHA256>.isValidAuthenticationCode(confirmation, authenticating: KeySchedule.confirmedFields(of: received), using: confirmationKey) else { return false }
+        let opened = try AES.GCM.open(AES.GCM.SealedBox(combined: received.sealedSecret), using: wrappingKey)
+        _ = KeySchedule(secret: SymmetricKey(data: opened), salt: received.salt, role: .client, cipher: .aes256GCM,
+                        rekeyInterval: AirCatchConfig.rekeyInterval, peer: received.peerId ?? 0, receiveEpoch: received.hostEpoch ?? 0)
+        return opened == secret.withUnsafeBytes { Data($0) }
+    }
+
+    /// Median seconds of `work`, which must succeed.
+    private func median(_ work: () throws -> Bool) rethrows -> TimeInterval {
+        let clock = ContinuousClock()
+        var samples: [TimeInterval] = []
+        for _ in 0..<runs {
+            var succeeded = false
+            let elapsed = try clock.measure { succeeded = try work() }
+            XCTAssertTrue(succeeded)
+            samples.append(Double(elapsed.components.attoseconds) / 1e18 + Double(elapsed.components.seconds))
+        }
+        return samples.sorted()[runs / 2]
+    }
+
+    /// The drop-to-ack (and, for a resume, first frame) timeline of one reconnect.
+    /// The host's forced keyframe follows the ack on the same link.
+    private func timeline(work: TimeInterval, firstFrame: Bool) -> ConnectionTimeline {
+        var timeline = ConnectionTimeline(startedAt: 0)
+        timeline.droppedAt = 0
+        timeline.mark(.transportReady, on: .localNetwork, at: 0)
+        timeline.mark(.handshakeAcked, on: .localNetwork, at: roundTrip + work)
+        timeline.activate(.localNetwork)
+        if firstFrame {
+            timeline.mark(.firstFrame, on: .localNetwork, at: roundTrip + work)
+        }
+        return timeline
+    }
+
+    func testResumeRecoversInAboutOneRoundTrip() throws {
+        let ticket = (0..<16).map { _ in String(format: "%02x", UInt8.random(in: .min ... .max)) }.joined()
+        let resumeWork = median { resume(ticket: ticket) }
+        let handshakeWork = try median { try handshake() }
+
+        let resumed = timeline(work: resumeWork, firstFrame: true)
+        let handshaken = timeline(work: handshakeWork, firstFrame: false)
+        print(String(format: "Resume: %.1f us of work, first frame %.2f ms after the drop; full handshake: %.1f us of work, acked %.2f ms after the drop, then the host's stream startup",
+                     resumeWork * 1e6, (resumed.recoveryTime ?? 0) * 1000,
+                     handshakeWork * 1e6, (handshaken.marks[.localNetwork]?[.handshakeAcked] ?? 0) * 1000))
+
+        XCTAssertLessThan(resumeWork, handshakeWork)
+        let recovery = try XCTUnwrap(resumed.recoveryTime)
+        XCTAssertLessThan(recovery, roundTrip * 1.1, "resume should cost about one round trip")
+    }
+}
@@ -0,0 +1,35 @@
+//
+//  UDPSendTargetsTests.swift
+//  PortableTests
+//
+
+import XCTest
+@testable import AirCatchPortable
+
+final class UDPSendTargetsTests: XCTestCase {
+
+    private typealias Flow = (name: String, host: String?)
+
+    private func targets(_ flows: [Flow]) -> UDPSendTargets<Flow> {
+        UDPSendTargets(ready: flows) { $0.host }
+    }
+
+    /// NetworkManager lists listener flows last, so they win over registered ones for a host.
+    func testOneViewerPerHostLaterFlowWins() {
+        let snapshot = targets([
+            ("registered", "10.0.0.2"),
+            ("other", "10.0.0.3"),
+            ("listener", "10.0.0.2"),
+        ])
+        let viewers = Dictionary(uniqueKeysWithValues: snapshot.viewers.map { ($0.id, $0.connection.name) })
+        XCTAssertEqual(viewers, ["10.0.0.2": "listener", "10.0.0.3": "other"])
+        XCTAssertEqual(snapshot.connections.map(\.name), ["registered", "other", "listener"])
+    }
+
+    func testFlowsWithoutHostOnlyBroadcast() {
+        let snapshot = targets([("unresolved", nil)])
+        XCTAssertTrue(snapshot.viewers.isEmpty)
+        XCTAssertEqual(snapshot.connections.count, 1)
+        XCTAssertTrue(UDPSendTargets<Flow>.empty.connections.isEmpty)
+    }
+}
@@ -0,0 +1,94 @@
+//
+//  VideoFanoutLoadTests.swift
+//  PortableTests
+//
+
+import XCTest
+@testable import AirCatchPortable
+
+/// The host's fan-out driving several viewers at once over real loopback sockets.
+final class VideoFanoutLoadTests: XCTestCase {
+
+    private let datagramSize = 1200
+    private let keyframe = FrameLayerTag(temporalLayer: 0, isKeyframe: true, isDroppable: false)
+    private let reference = FrameLayerTag(temporalLayer: 0, isKeyframe: false, isDroppable: false)
+
+    private func frame(_ frameId: UInt32, tag: FrameLayerTag, chunks: Int) -> VideoFanout.Frame {
+        let datagrams = (0..<chunks).map { LoopbackDatagram.make(frameId: frameId, chunk: UInt16($0), size: datagramSize) }
+        return VideoFanout.Frame(frameId: frameId, tag: tag, datagrams: datagrams)
+    }
+
+    /// Polls until `done` or the deadline.
+    private func wait(seconds: TimeInterval, until done: () -> Bool) {
+        let deadline = Date().addingTimeInterval(seconds)
+        while !done() && Date() < deadline {
+            Thread.sleep(forTimeInterval: 0.02)
+        }
+    }
+
+    /// 8 viewers, 2 s of 60 fps video (a 150 KB keyframe, then 20 KB frames), half of
+    /// them lossless. Every viewer gets the stream, and only lossless viewers keep sent
+    /// frames for retransmits.
+    func testEightViewersOverLoopback() {
+        let viewerCount = 8
+        let frameCount = 120
+        let frameChunks = 17
+        let keyframeChunks = 128
+
+        let receivers = (0..<viewerCount).map { _ in LoopbackReceiver() }
+        defer { receivers.forEach { $0.stop() } }
+        let connections = receivers.enumerated().map { (id: "viewer-\($0.offset)", connection: LoopbackSink(to: $0.element)) }
+        let lossless = Set(connections.indices.filter { $0 % 2 == 0 }.map { connections[$0].id })
+
+        let fanout = VideoFanout(onKeyframeNeeded: {})
+        for connection in connections {
+            fanout.setRetransmits(lossless.contains(connection.id), forViewer: connection.id)
+        }
+        fanout.prepare(connections)
+
+        let start = Date()
+        for index in 0..<frameCount {
+            let isKeyframe = index == 0
+            fanout.submit(frame(UInt32(index), tag: isKeyframe ? keyframe : reference,
+                                chunks: isKeyframe ? keyframeChunks : frameChunks), to: connections)
+            // Paced like the encoder, so the test measures delivery rather than the drop policy
+            let next = start.addingTimeInterval(Double(index + 1) / 60)
+            Thread.sleep(forTimeInterval: max(0, next.timeIntervalSinceNow))
+        }
+
+        let expected = keyframeChunks + (frameCount - 1) * frameChunks
+        wait(seconds: 5) { receivers.allSatisfy { $0.chunkCount >= expected } }
+
+        for (index, receiver) in receivers.enumerated() {
+            let chunks = receiver.chunks
+            XCTAssertEqual(chunks[0]?.count, keyframeChunks, "viewer \(index) keyframe")
+            XCTAssertGreaterThanOrEqual(Double(receiver.chunkCount) / Double(expected), 0.95, "viewer \(index) delivery")
+        }
+        for connection in connections {
+            if lossless.contains(connection.id) {
+                XCTAssertGreaterThan(fanout.cachedFrameCount(forViewer: connection.id), 0, connection.id)
+            } else {
+                XCTAssertEqual(fanout.cachedFrameCount(forViewer: connection.id), 0, connection.id)
+            }
+        }
+        fanout.removeAll()
+    }
+
+    /// Turning lossless off mid-stream releases the frames a viewer kept.
+    func testDisablingRetransmitsReleasesCachedFrames() {
+        let receiver = LoopbackReceiver()
+        defer { receiver.stop() }
+        let connections = [(id: "viewer", connection: LoopbackSink(to: receiver))]
+        let fanout = VideoFanout(onKeyframeNeeded: {})
+        fanout.setRetransmits(true, forViewer: "viewer")
+
+        fanout.submit(frame(0, tag: keyframe, chunks: 4), to: connections)
+        fanout.submit(frame(1, tag: reference, chunks: 4), to: connections)
+        wait(seconds: 2) { receiver.chunkCount >= 8 }
+        XCTAssertEqual(fanout.cachedFrameCount(forViewer: "viewer"), 2)
+
+        fanout.setRetransmits(false, forViewer: "viewer")
+        XCTAssertEqual(fanout.cachedFrameCount(forViewer: "viewer"), 0)
+        fanout.removeAll()
+    }
+}
@@ -0,0 +1,115 @@
+//
+//  VideoFanoutRetransmitTests.swift
+//  PortableTests
+//
+
+import XCTest
+@testable import AirCatchPortable
+
+/// NACKs through `VideoFanout.handleNack`, with loss injected between the fan-out and a loopback viewer.
+final class VideoFanoutRetransmitTests: XCTestCase {
+
+    private let chunks = 17
+    private let keyframe = FrameLayerTag(temporalLayer: 0, isKeyframe: true, isDroppable: false)
+    private let reference = FrameLayerTag(temporalLayer: 0, isKeyframe: false, isDroppable: false)
+
+    private var receiver: LoopbackReceiver!
+    private var connections: [(id: String, connection: LoopbackSink)] = []
+    private var fanout: VideoFanout!
+
+    override func setUp() {
+        receiver = LoopbackReceiver()
+        connections = [(id: "viewer", connection: LoopbackSink(to: receiver))]
+        fanout = VideoFanout(onKeyframeNeeded: {})
+    }
+
+    override func tearDown() {
+        fanout.removeAll()
+        receiver.stop()
+    }
+
+    private func submit(_ frameId: UInt32) {
+        let datagrams = (0..<chunks).map { LoopbackDatagram.make(frameId: frameId, chunk: UInt16($0), size: 1200) }
+        fanout.submit(VideoFanout.Frame(frameId: frameId, tag: frameId == 0 ? keyframe : reference, datagrams: datagrams),
+                      to: connections)
+    }
+
+    /// Waits for `count` distinct chunks; returns how long it took, or nil on timeout.
+    @discardableResult
+    private func waitForChunks(_ count: Int, seconds: TimeInterval = 2) -> TimeInterval? {
+        let start = Date()
+        while receiver.chunkCount < count {
+            guard Date().timeIntervalSince(start) < seconds else { return nil }
+            Thread.sleep(forTimeInterval: 0.001)
+        }
+        return Date().timeIntervalSince(start)
+    }
+
+    /// Chunk indices missing per frame, as the client's reassembler would NACK them.
+    private func missing(frames: Int) -> [UInt32: [UInt16]] {
+        let received = receiver.chunks
+        var missing: [UInt32: [UInt16]] = [:]
+        for frameId in 0..<UInt32(frames) {
+            let gaps = (0..<UInt16(chunks)).filter { !(received[frameId]?.contains($0) ?? false) }
+            if !gaps.isEmpty {
+                missing[frameId] = gaps
+            }
+        }
+        return missing
+    }
+
+    func testNackedChunksAreResentToLosslessViewer() throws {
+        fanout.setRetransmits(true, forViewer: "viewer")
+        let loss = InjectedLoss(once: [(1, 2), (1, 5)])
+        connections[0].connection.drops = loss.drops
+
+        submit(0)
+        submit(1)
+        waitForChunks(2 * chunks - 2)
+        XCTAssertEqual(missing(frames: 2), [1: [2, 5]])
+
+        fanout.handleNack(viewerId: "viewer", frameId: 1, missingChunkIndices: [2, 5])
+        let latency = try XCTUnwrap(waitForChunks(2 * chunks), "retransmits never arrived")
+        print("NACK to retransmit received: \(String(format: "%.2f", latency * 1000)) ms")
+        XCTAssertTrue(missing(frames: 2).isEmpty)
+    }
+
+    /// A viewer without lossless video keeps nothing to resend.
+    func testNackIsIgnoredWithoutLossless() {
+        let loss = InjectedLoss(once: [(1, 3)])
+        connections[0].connection.drops = loss.drops
+
+        submit(0)
+        submit(1)
+        waitForChunks(2 * chunks - 1)
+        fanout.handleNack(viewerId: "viewer", frameId: 1, missingChunkIndices: [3])
+        XCTAssertNil(waitForChunks(2 * chunks, seconds: 0.3))
+    }
+
+    /// 10% random loss on every send, retransmits included. NACK rounds like the client's
+    /// (every 30 ms) recover the whole stream well inside the 1 s cache.
+    func testRandomLossRecoversThroughNackRounds() {
+        fanout.setRetransmits(true, forViewer: "viewer")
+        let loss = InjectedLoss(rate: 0.1)
+        connections[0].connection.drops = loss.drops
+
+        let frames = 30
+        for frameId in 0..<UInt32(frames) {
+            submit(frameId)
+        }
+        waitForChunks(frames * chunks, seconds: 0.2)
+        let lost = frames * chunks - receiver.chunkCount
+        XCTAssertGreaterThan(lost, 0, "no loss injected")
+
+        var rounds = 0
+        while !missing(frames: frames).isEmpty && rounds < 10 {
+            for (frameId, gaps) in missing(frames: frames) {
+                fanout.handleNack(viewerId: "viewer", frameId: frameId, missingChunkIndices: gaps)
+            }
+            rounds += 1
+            Thread.sleep(forTimeInterval: 0.03)
+        }
+        print("\(lost) of \(frames * chunks) chunks lost, recovered in \(rounds) NACK rounds")
+        XCTAssertTrue(missing(frames: frames).isEmpty)
+    }
+}
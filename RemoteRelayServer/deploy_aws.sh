@@ -56,6 +56,8 @@ ssh -i "$PEM_KEY" -o StrictHostKeyChecking=no ubuntu@$EC2_IP "\
     echo 'Starting App container...'; \
     sudo docker run -d --restart always \
         --network aircatch-net \
+        -p 40000-40999:40000-40999/udp \
+        -e TRUSTED_PROXIES=caddy \
         --name current-relay \
         aircatch-relay; \
     echo 'Starting Caddy (SSL)...'; \
@@ -52,6 +52,8 @@ gcloud compute ssh teja@$INSTANCE_NAME --zone=$ZONE --command "\
     echo 'Starting App container...'; \
     sudo docker run -d --restart always \
         --network aircatch-net \
+        -p 40000-40999:40000-40999/udp \
+        -e TRUSTED_PROXIES=caddy \
         --name current-relay \
         aircatch-relay; \
     echo 'Starting Caddy (SSL)...'; \
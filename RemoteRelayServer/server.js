@@ -1,86 +1,618 @@
 import http from 'http';
-import { WebSocketServer } from 'ws';
+import dgram from 'dgram';
+import crypto from 'crypto';
+import dns from 'dns/promises';
+import net from 'net';
+import { monitorEventLoopDelay, performance } from 'perf_hooks';
+import { WebSocketServer, WebSocket } from 'ws';
 
 const port = process.env.PORT || 8080;
 
+// UDP relay (TURN-like): each session gets one relayed port per peer
+const UDP_PORT_MIN = Number(process.env.UDP_RELAY_PORT_MIN) || 40000;
+const UDP_PORT_MAX = Number(process.env.UDP_RELAY_PORT_MAX) || 40999;
+const UDP_BIND_MAGIC = 0xAB; // [0xAB][token 16] binds a peer address; never a valid packet type
+const UDP_TOKEN_BYTES = 16;
+
+// Cluster: CLUSTER_NODES lists every node's WebSocket URL (ws://host:port/ws) and NODE_URL is
+// this node's entry. Empty CLUSTER_NODES means a single standalone node.
+const CLUSTER_NODES = (process.env.CLUSTER_NODES || '').split(',').map((url) => url.trim()).filter(Boolean);
+const NODE_URL = process.env.NODE_URL || '';
+const PUBLIC_HOST = process.env.PUBLIC_HOST || ''; // Address apps use for this node's UDP relay ports
+const MAX_PENDING_UPSTREAM = 256;                  // Messages buffered while connecting to the owner node
+
+// Layered video chunks: [0x12][frameId 4][chunkIdx 2][total 2][tag 1]. Tag bit 0x40 marks a
+// droppable frame (nothing references it), shed first when the receiver's queue backs up.
+const LAYERED_CHUNK_TYPE = 0x12;
+const LAYER_TAG_OFFSET = 9;
+const LAYER_TAG_DROPPABLE = 0x40;
+const DROPPABLE_QUEUE_BYTES = Number(process.env.DROPPABLE_QUEUE_BYTES) || 256 * 1024;
+
+// Largest WebSocket message accepted: a 32 MB app packet, base64'd into a JSON relay message, fits
+const MAX_MESSAGE_BYTES = Number(process.env.MAX_MESSAGE_BYTES) || 64 * 1024 * 1024;
+// Media is already compressed and encrypted, so deflate only costs CPU. Synchronous events let a
+// read that holds several frames dispatch them all without a trip through the event loop each.
+const SOCKET_OPTIONS = { perMessageDeflate: false, maxPayload: MAX_MESSAGE_BYTES, allowSynchronousEvents: true };
+// Shared send options; forwarding allocates nothing per message
+const BINARY_FRAME = { binary: true };
+const TEXT_FRAME = { binary: false };
+
+if (CLUSTER_NODES.length > 0 && !CLUSTER_NODES.includes(NODE_URL)) {
+  console.error(`NODE_URL (${NODE_URL || 'unset'}) must be one of CLUSTER_NODES`);
+  process.exit(1);
+}
+// Behind a load balancer the relay URL's host is the balancer, not the node holding the ports
+if (CLUSTER_NODES.length > 0 && !PUBLIC_HOST) {
+  console.error('PUBLIC_HOST must be set on every cluster node (the address apps use for its UDP relay ports)');
+  process.exit(1);
+}
+
+// Observability: /metrics (Prometheus text format) and optional periodic per-session logs
+const METRICS_TOKEN = process.env.METRICS_TOKEN || ''; // If set, /metrics requires "Authorization: Bearer <token>"
+const STATS_INTERVAL_S = Number(process.env.STATS_INTERVAL) || 0; // Seconds between stats logs, 0 = off
+const METRICS_ENABLED = process.env.METRICS !== 'off'; // 'off' drops /metrics, send-latency sampling and its event-loop monitor
+
 const server = http.createServer((req, res) => {
+  if (req.url === '/metrics') {
+    if (!METRICS_ENABLED) {
+      res.writeHead(404);
+      res.end();
+      return;
+    }
+    if (METRICS_TOKEN && req.headers.authorization !== `Bearer ${METRICS_TOKEN}`) {
+      res.writeHead(401);
+      res.end();
+      return;
+    }
+    res.writeHead(200, { 'Content-Type': 'text/plain; version=0.0.4' });
+    res.end(renderMetrics());
+    return;
+  }
   res.writeHead(200, { 'Content-Type': 'text/plain' });
   res.end('AirCatch Relay is Running');
 });
-const wss = new WebSocketServer({ server, path: '/ws' });
+const wss = new WebSocketServer({ server, path: '/ws', ...SOCKET_OPTIONS });
 
 const sessions = new Map();
 
-// Rate limiting: track failed attempts per IP
-const rateLimitMap = new Map(); // IP -> { attempts: number, blockedUntil: timestamp }
-const MAX_ATTEMPTS = 5;
-const BLOCK_DURATION_MS = 60 * 1000; // 1 minute block
+// MARK: - Metrics
+// Hot paths only bump plain counters; gauges and percentiles are computed at scrape time.
 
-function isRateLimited(ip) {
-  const record = rateLimitMap.get(ip);
-  if (!record) return false;
-  
-  if (Date.now() < record.blockedUntil) {
-    return true; // Still blocked
+const SEND_LATENCY_SAMPLE_EVERY = 256; // Time one in N forwarded sends (the callback has a cost)
+const SEND_LATENCY_BUCKETS = [0.001, 0.005, 0.01, 0.05, 0.1, 0.5, 1];
+
+const metrics = {
+  connections: 0,
+  messagesIn: { binary: 0, register: 0, relay: 0, candidate: 0, allocate: 0, other: 0 },
+  bytesIn: 0,
+  messagesOut: 0,
+  bytesOut: 0,
+  droppedNoPeer: 0,
+  droppedDroppable: 0,
+  clusterProxied: 0,
+  rateLimitBlocks: 0,
+  rateLimitRejects: 0,
+  sessionsEvicted: 0,
+  sessionsExpired: 0,
+  udpDatagrams: 0,
+  udpBytes: 0,
+  sendLatency: { buckets: SEND_LATENCY_BUCKETS.map(() => 0), sum: 0, count: 0 },
+};
+let sendCounter = 0;
+
+// Each reader gets its own histogram, reset when read, so percentiles describe the
+// last scrape (or stats log) interval rather than everything since start
+const EVENT_LOOP_RESOLUTION_MS = 20;
+const scrapeEventLoopDelay = monitorEventLoopDelay({ resolution: EVENT_LOOP_RESOLUTION_MS });
+if (METRICS_ENABLED) scrapeEventLoopDelay.enable();
+
+// Histogram values include the sampling timer period; report only the excess
+function eventLoopLagSeconds(nanoseconds) {
+  return Math.max(0, nanoseconds / 1e9 - EVENT_LOOP_RESOLUTION_MS / 1000);
+}
+
+// Session IDs are PINs; logs show a keyed hash instead, stable for this process only
+const LOG_LABEL_KEY = crypto.randomBytes(16);
+function sessionLabel(sessionId) {
+  return crypto.createHmac('sha256', LOG_LABEL_KEY).update(String(sessionId)).digest('hex').slice(0, 10);
+}
+
+function newSessionStats() {
+  return { bytesIn: 0, bytesOut: 0, messages: 0, since: Date.now() };
+}
+
+function observeSendLatency(seconds) {
+  const latency = metrics.sendLatency;
+  latency.sum += seconds;
+  latency.count++;
+  for (let i = 0; i < SEND_LATENCY_BUCKETS.length; i++) {
+    if (seconds <= SEND_LATENCY_BUCKETS[i]) latency.buckets[i]++;
   }
-  
-  // Block expired, reset
-  if (record.blockedUntil > 0) {
+}
+
+// Sends to the peer socket, counting bytes and sampling time-to-flush
+function forward(target, data, options, session) {
+  if (!target || target.readyState !== target.OPEN) {
+    metrics.droppedNoPeer++;
+    return;
+  }
+  const size = typeof data === 'string' ? Buffer.byteLength(data) : data.length;
+  metrics.messagesOut++;
+  metrics.bytesOut += size;
+  if (session) session.stats.bytesOut += size;
+
+  if (METRICS_ENABLED && ++sendCounter % SEND_LATENCY_SAMPLE_EVERY === 0) {
+    const start = performance.now();
+    target.send(data, options, () => observeSendLatency((performance.now() - start) / 1000));
+  } else {
+    target.send(data, options);
+  }
+}
+
+function isDroppableChunk(data) {
+  return data.length > LAYER_TAG_OFFSET && data[0] === LAYERED_CHUNK_TYPE
+    && (data[LAYER_TAG_OFFSET] & LAYER_TAG_DROPPABLE) !== 0;
+}
+
+function renderMetrics() {
+  let hosts = 0;
+  let clients = 0;
+  let udpRelays = 0;
+  let queuedBytes = 0;
+  for (const session of sessions.values()) {
+    if (session.host) { hosts++; queuedBytes += session.host.bufferedAmount; }
+    if (session.client) { clients++; queuedBytes += session.client.bufferedAmount; }
+    if (session.udp) udpRelays++;
+  }
+
+  const lines = [];
+  const metric = (name, type, help, samples) => {
+    lines.push(`# HELP ${name} ${help}`, `# TYPE ${name} ${type}`);
+    for (const [labels, value] of samples) lines.push(`${name}${labels} ${value}`);
+  };
+
+  metric('aircatch_sessions', 'gauge', 'Sessions in the session table.', [['', sessions.size]]);
+  metric('aircatch_sessions_evicted_total', 'counter', 'Sessions evicted because the table was full.', [['', metrics.sessionsEvicted]]);
+  metric('aircatch_sessions_expired_total', 'counter', 'Client-only sessions expired without a host.', [['', metrics.sessionsExpired]]);
+  metric('aircatch_peers', 'gauge', 'Registered WebSocket peers.', [['{role="host"}', hosts], ['{role="client"}', clients]]);
+  metric('aircatch_connections_total', 'counter', 'WebSocket connections accepted.', [['', metrics.connections]]);
+  metric('aircatch_messages_received_total', 'counter', 'WebSocket messages received by kind.',
+    Object.entries(metrics.messagesIn).map(([kind, value]) => [`{kind="${kind}"}`, value]));
+  metric('aircatch_received_bytes_total', 'counter', 'WebSocket bytes received.', [['', metrics.bytesIn]]);
+  metric('aircatch_messages_sent_total', 'counter', 'WebSocket messages forwarded.', [['', metrics.messagesOut]]);
+  metric('aircatch_sent_bytes_total', 'counter', 'WebSocket bytes forwarded.', [['', metrics.bytesOut]]);
+  metric('aircatch_dropped_no_peer_total', 'counter', 'Messages dropped because the peer was not connected.', [['', metrics.droppedNoPeer]]);
+  metric('aircatch_dropped_droppable_total', 'counter', 'Droppable video chunks shed because the peer queue was backed up.', [['', metrics.droppedDroppable]]);
+  metric('aircatch_cluster_proxied_total', 'counter', 'Registrations proxied to the owner node.', [['', metrics.clusterProxied]]);
+  metric('aircatch_send_queue_bytes', 'gauge', 'Bytes buffered in WebSocket send queues.', [['', queuedBytes]]);
+
+  const latency = metrics.sendLatency;
+  metric('aircatch_send_latency_seconds', 'histogram', `Time to flush a forwarded message (1 in ${SEND_LATENCY_SAMPLE_EVERY} sampled).`, [
+    ...SEND_LATENCY_BUCKETS.map((bound, i) => [`_bucket{le="${bound}"}`, latency.buckets[i]]),
+    ['_bucket{le="+Inf"}', latency.count],
+    ['_sum', latency.sum],
+    ['_count', latency.count],
+  ]);
+
+  metric('aircatch_event_loop_lag_seconds', 'gauge', 'Event loop delay percentiles since the previous scrape.', [
+    ['{quantile="0.5"}', eventLoopLagSeconds(scrapeEventLoopDelay.percentile(50))],
+    ['{quantile="0.99"}', eventLoopLagSeconds(scrapeEventLoopDelay.percentile(99))],
+    ['{quantile="1"}', eventLoopLagSeconds(scrapeEventLoopDelay.max)],
+  ]);
+  scrapeEventLoopDelay.reset();
+  metric('aircatch_rate_limit_blocks_total', 'counter', 'Registrations refused because the IP ran out of tokens.', [['', metrics.rateLimitBlocks]]);
+  metric('aircatch_rate_limit_rejections_total', 'counter', 'Connections refused because the IP ran out of tokens.', [['', metrics.rateLimitRejects]]);
+  metric('aircatch_rate_limit_entries', 'gauge', 'Token buckets currently tracked.', [['', rateLimitMap.size]]);
+  metric('aircatch_udp_relays', 'gauge', 'Sessions with an allocated UDP relay.', [['', udpRelays]]);
+  metric('aircatch_udp_datagrams_total', 'counter', 'Datagrams forwarded by the UDP relay.', [['', metrics.udpDatagrams]]);
+  metric('aircatch_udp_bytes_total', 'counter', 'Bytes forwarded by the UDP relay.', [['', metrics.udpBytes]]);
+
+  return lines.join('\n') + '\n';
+}
+
+// MARK: - Bounded Tables
+// Both tables are Maps kept in a useful order so cleanup only ever looks at the head.
+
+const MAX_SESSIONS = Number(process.env.MAX_SESSIONS) || 5000;
+const MAX_RATE_LIMIT_ENTRIES = Number(process.env.MAX_RATE_LIMIT_ENTRIES) || 20000;
+const UNPAIRED_CLIENT_TTL_MS = 2 * 60 * 1000; // A client waiting this long for a host is dropped
+const REGISTER_TIMEOUT_MS = 10 * 1000;        // Sockets must register within this time
+
+// Token bucket per IP: connections and registrations each cost a token
+const RATE_LIMIT_BURST = 20;
+const RATE_LIMIT_REFILL_PER_S = 0.5;
+const FAILED_REGISTRATION_COST = 5;
+// A bucket untouched this long is full again, so forgetting it changes nothing
+const RATE_LIMIT_IDLE_MS = (RATE_LIMIT_BURST / RATE_LIMIT_REFILL_PER_S) * 1000;
+
+// IP -> { tokens, updatedAt }, ordered by last update (oldest first)
+const rateLimitMap = new Map();
+
+function sweepRateLimits(now) {
+  for (const [ip, bucket] of rateLimitMap) {
+    if (now - bucket.updatedAt < RATE_LIMIT_IDLE_MS && rateLimitMap.size <= MAX_RATE_LIMIT_ENTRIES) break;
     rateLimitMap.delete(ip);
   }
-  return false;
 }
 
-function recordAttempt(ip, success) {
-  if (success) {
-    rateLimitMap.delete(ip); // Clear on success
+// Takes `cost` tokens from the IP's bucket; returns false when the bucket is empty
+function takeTokens(ip, cost = 1) {
+  const now = Date.now();
+  let bucket = rateLimitMap.get(ip);
+  if (bucket) {
+    rateLimitMap.delete(ip); // Re-inserted below to move it to the tail
+    bucket.tokens = Math.min(RATE_LIMIT_BURST, bucket.tokens + (now - bucket.updatedAt) / 1000 * RATE_LIMIT_REFILL_PER_S);
+  } else {
+    bucket = { tokens: RATE_LIMIT_BURST, updatedAt: now };
+  }
+  bucket.updatedAt = now;
+
+  const allowed = bucket.tokens >= cost;
+  bucket.tokens = Math.max(0, bucket.tokens - cost);
+  rateLimitMap.set(ip, bucket);
+  sweepRateLimits(now);
+  return allowed;
+}
+
+// Session table with second-chance LRU eviction: activity only sets a flag,
+// and eviction walks from the head, recycling referenced entries to the tail.
+function createSession(sessionId) {
+  while (sessions.size >= MAX_SESSIONS) {
+    const [oldestId, oldest] = sessions.entries().next().value;
+    sessions.delete(oldestId);
+    if (oldest.referenced) {
+      oldest.referenced = false;
+      sessions.set(oldestId, oldest);
+      continue;
+    }
+    metrics.sessionsEvicted++;
+    closeSession(oldest, oldestId, 4008, 'Session evicted');
+  }
+  const session = { host: null, client: null, udp: null, stats: newSessionStats(), referenced: false, unpairedTimer: null };
+  sessions.set(sessionId, session);
+  return session;
+}
+
+function closeSession(session, sessionId, code, reason) {
+  sessions.delete(sessionId);
+  clearTimeout(session.unpairedTimer);
+  releaseUdpRelay(session, sessionId);
+  for (const ws of [session.host, session.client]) {
+    if (!ws) continue;
+    ws.sessionId = undefined;
+    ws.session = null;
+    ws.peer = null;
+    ws.close(code, reason);
+  }
+}
+
+// Clients registering against guessed PINs never get a host; expire them
+function updateUnpairedTimer(session, sessionId) {
+  clearTimeout(session.unpairedTimer);
+  session.unpairedTimer = null;
+  if (session.client && !session.host) {
+    session.unpairedTimer = setTimeout(() => {
+      if (sessions.get(sessionId) === session && !session.host) {
+        metrics.sessionsExpired++;
+        closeSession(session, sessionId, 4008, 'No host for session');
+      }
+    }, UNPAIRED_CLIENT_TTL_MS);
+  }
+}
+
+// Registered sockets cache their session and the opposite peer, so the message
+// path forwards without a table lookup. Re-run whenever either role changes.
+function linkPeers(session) {
+  if (session.host) session.host.peer = session.client;
+  if (session.client) session.client.peer = session.host;
+}
+
+// Removes the socket from its session, deleting the session once empty
+function detachFromSession(ws) {
+  const sessionId = ws.sessionId;
+  if (!sessionId) return;
+  ws.sessionId = undefined;
+  ws.session = null;
+  ws.peer = null;
+  const session = sessions.get(sessionId);
+  if (!session) return;
+  if (session.host === ws) {
+    session.host = null;
+    if (session.udp) session.udp.host.peer = null;
+  }
+  if (session.client === ws) {
+    session.client = null;
+    releaseUdpRelay(session, sessionId);
+  }
+  if (!session.host && !session.client) {
+    clearTimeout(session.unpairedTimer);
+    sessions.delete(sessionId);
+  } else {
+    linkPeers(session);
+    updateUnpairedTimer(session, sessionId);
+  }
+}
+
+// MARK: - Client Addresses
+// X-Forwarded-For is whatever the connecting side says, so it is only believed when the
+// socket itself comes from a trusted proxy (TRUSTED_PROXIES: comma-separated IPs, CIDRs or
+// hostnames) or from another cluster node. Everyone else is keyed by the socket address.
+
+const TRUSTED_PROXIES = (process.env.TRUSTED_PROXIES || '').split(',').map((entry) => entry.trim()).filter(Boolean);
+const TRUSTED_REFRESH_MS = 60 * 1000; // Hostnames (e.g. a proxy container) are re-resolved this often
+let trustedAddresses = new net.BlockList();
+
+function addressFamily(address) {
+  return net.isIPv6(address) ? 'ipv6' : 'ipv4';
+}
+
+// IPv4 clients of a dual-stack socket show up as ::ffff:a.b.c.d
+function normalizeAddress(address) {
+  if (!address) return '';
+  return address.startsWith('::ffff:') && net.isIPv4(address.slice(7)) ? address.slice(7) : address;
+}
+
+async function refreshTrustedAddresses() {
+  const list = new net.BlockList();
+  const peers = CLUSTER_NODES.filter((node) => node !== NODE_URL).map((node) => new URL(node).hostname.replace(/^\[|\]$/g, ''));
+  for (const entry of [...TRUSTED_PROXIES, ...peers]) {
+    const [address, prefix] = entry.split('/');
+    if (net.isIP(address)) {
+      if (prefix !== undefined) list.addSubnet(address, Number(prefix), addressFamily(address));
+      else list.addAddress(address, addressFamily(address));
+      continue;
+    }
+    try {
+      for (const resolved of await dns.lookup(entry, { all: true })) list.addAddress(resolved.address, addressFamily(resolved.address));
+    } catch {
+      // Not resolvable yet (proxy container still starting); the next refresh retries
+    }
+  }
+  trustedAddresses = list;
+}
+
+function isTrusted(address) {
+  return net.isIP(address) !== 0 && trustedAddresses.check(address, addressFamily(address));
+}
+
+// The address rate limits and logs use: the rightmost forwarded hop not added by a trusted
+// proxy, so entries a client prepends itself are skipped
+function clientAddress(req) {
+  const peer = normalizeAddress(req.socket.remoteAddress);
+  if (!peer) return 'unknown';
+  if (!isTrusted(peer)) return peer;
+  const forwarded = (req.headers['x-forwarded-for'] || '').split(',').map((hop) => normalizeAddress(hop.trim())).filter(Boolean);
+  for (let i = forwarded.length - 1; i >= 0; i--) {
+    if (!isTrusted(forwarded[i])) return forwarded[i];
+  }
+  return forwarded[0] || peer;
+}
+
+// MARK: - UDP Relay
+
+const usedUdpPorts = new Set();
+let nextUdpPort = UDP_PORT_MIN;
+
+function takeUdpPort() {
+  const range = UDP_PORT_MAX - UDP_PORT_MIN + 1;
+  for (let i = 0; i < range; i++) {
+    const candidate = nextUdpPort;
+    nextUdpPort = candidate >= UDP_PORT_MAX ? UDP_PORT_MIN : candidate + 1;
+    if (!usedUdpPorts.has(candidate)) {
+      usedUdpPorts.add(candidate);
+      return candidate;
+    }
+  }
+  return null;
+}
+
+// Binds a socket on the next free port in the range, skipping ports held by other processes
+function openRelaySocket(attempt = 0) {
+  return new Promise((resolve, reject) => {
+    const udpPort = attempt <= UDP_PORT_MAX - UDP_PORT_MIN ? takeUdpPort() : null;
+    if (udpPort === null) {
+      reject(new Error('No free UDP relay ports'));
+      return;
+    }
+    const socket = dgram.createSocket('udp4');
+    socket.once('error', () => {
+      usedUdpPorts.delete(udpPort);
+      socket.close();
+      openRelaySocket(attempt + 1).then(resolve, reject);
+    });
+    socket.bind(udpPort, () => {
+      socket.removeAllListeners('error');
+      socket.on('error', (err) => console.log(`UDP relay socket ${udpPort} error: ${err.message}`));
+      resolve({ socket, port: udpPort });
+    });
+  });
+}
+
+function closeRelayLeg(leg) {
+  if (!leg) return;
+  usedUdpPorts.delete(leg.port);
+  try { leg.socket.close(); } catch {}
+}
+
+// Forwards datagrams from one leg's bound peer out of the other leg's socket,
+// so each peer sends to and receives from the same relayed port.
+function wireRelayLeg(from, to, session) {
+  from.socket.on('message', (msg, rinfo) => {
+    if (msg.length === 1 + UDP_TOKEN_BYTES && msg[0] === UDP_BIND_MAGIC) {
+      if (!crypto.timingSafeEqual(msg.subarray(1), from.token)) return;
+      from.peer = { address: rinfo.address, port: rinfo.port };
+      // Ack doubles as keepalive and tells the sender whether the other side is bound
+      from.socket.send(Buffer.from([UDP_BIND_MAGIC, to.peer ? 1 : 0]), rinfo.port, rinfo.address);
+      return;
+    }
+    const peer = from.peer;
+    if (!peer || peer.address !== rinfo.address || peer.port !== rinfo.port) return;
+    if (!to.peer) return;
+    metrics.udpDatagrams++;
+    metrics.udpBytes += msg.length;
+    session.stats.bytesIn += msg.length;
+    session.stats.bytesOut += msg.length;
+    to.socket.send(msg, to.peer.port, to.peer.address);
+  });
+}
+
+function sendAllocation(ws, sessionId, leg) {
+  if (!ws || ws.readyState !== ws.OPEN || !leg) return;
+  const payload = JSON.stringify({ host: PUBLIC_HOST || undefined, port: leg.port, token: leg.token.toString('hex') });
+  ws.send(JSON.stringify({ type: 'allocation', sessionId, payload }));
+}
+
+function releaseUdpRelay(session, sessionId) {
+  const relay = session.udp;
+  if (!relay) return;
+  session.udp = null;
+  closeRelayLeg(relay.host);
+  closeRelayLeg(relay.client);
+  if (session.host && session.host.readyState === session.host.OPEN) {
+    session.host.send(JSON.stringify({ type: 'release', sessionId }));
+  }
+  console.log(`Released UDP relay for session ${sessionLabel(sessionId)}`);
+}
+
+async function allocateUdpRelay(session, sessionId) {
+  releaseUdpRelay(session, sessionId);
+
+  const results = await Promise.allSettled([openRelaySocket(), openRelaySocket()]);
+  const [hostResult, clientResult] = results;
+  if (hostResult.status !== 'fulfilled' || clientResult.status !== 'fulfilled') {
+    for (const result of results) {
+      if (result.status === 'fulfilled') closeRelayLeg(result.value);
+    }
+    console.log(`UDP relay allocation failed for session ${sessionLabel(sessionId)}`);
     return;
   }
-  
-  const record = rateLimitMap.get(ip) || { attempts: 0, blockedUntil: 0 };
-  record.attempts++;
-  
-  if (record.attempts >= MAX_ATTEMPTS) {
-    record.blockedUntil = Date.now() + BLOCK_DURATION_MS;
-    console.log(`Rate limited IP ${ip} for ${BLOCK_DURATION_MS / 1000}s after ${record.attempts} failed attempts`);
+
+  // The session may have ended (or re-allocated) while sockets were binding
+  if (sessions.get(sessionId) !== session || !session.client || session.udp) {
+    closeRelayLeg(hostResult.value);
+    closeRelayLeg(clientResult.value);
+    return;
   }
-  
-  rateLimitMap.set(ip, record);
+
+  const host = { ...hostResult.value, token: crypto.randomBytes(UDP_TOKEN_BYTES), peer: null };
+  const client = { ...clientResult.value, token: crypto.randomBytes(UDP_TOKEN_BYTES), peer: null };
+  wireRelayLeg(host, client, session);
+  wireRelayLeg(client, host, session);
+  session.udp = { host, client };
+
+  sendAllocation(session.client, sessionId, client);
+  sendAllocation(session.host, sessionId, host);
+  console.log(`Allocated UDP relay for session ${sessionLabel(sessionId)}: host ${host.port}, client ${client.port}`);
+}
+
+// MARK: - Cluster Routing
+// Each session is owned by the node picked by rendezvous hashing on its ID, so every node
+// agrees on the owner without a shared registry. A node that receives a registration for a
+// session it doesn't own proxies that socket, unchanged, to the owner over a node-to-node
+// WebSocket. Host and client always meet on the same node, even behind a load balancer.
+
+function ownerNode(sessionId) {
+  if (CLUSTER_NODES.length < 2) return NODE_URL;
+  let owner = NODE_URL;
+  let bestScore = -1n;
+  for (const node of CLUSTER_NODES) {
+    const score = crypto.createHash('sha256').update(`${node}|${sessionId}`).digest().readBigUInt64BE(0);
+    if (score > bestScore) {
+      bestScore = score;
+      owner = node;
+    }
+  }
+  return owner;
+}
+
+function openUpstream(ws, owner) {
+  closeUpstream(ws);
+  metrics.clusterProxied++;
+
+  // The owner rate-limits and logs by the original address
+  const upstream = new WebSocket(owner, { ...SOCKET_OPTIONS, headers: { 'x-forwarded-for': ws.clientIP } });
+  ws.upstream = upstream;
+  ws.upstreamOwner = owner;
+  ws.upstreamPending = [];
+
+  upstream.on('open', () => {
+    for (const [data, isBinary] of ws.upstreamPending) upstream.send(data, isBinary ? BINARY_FRAME : TEXT_FRAME);
+    ws.upstreamPending = [];
+  });
+  upstream.on('message', (data, isBinary) => forward(ws, data, isBinary ? BINARY_FRAME : TEXT_FRAME, null));
+  upstream.on('close', (code, reason) => {
+    if (ws.upstream !== upstream) return;
+    ws.upstream = null;
+    ws.close(code === 1000 || code >= 4000 ? code : 1011, reason.toString() || 'Owner node closed');
+  });
+  upstream.on('error', (err) => {
+    console.log(`Cluster upstream ${owner} error: ${err.message}`); // 'close' follows
+  });
+}
+
+function closeUpstream(ws) {
+  const upstream = ws.upstream;
+  if (!upstream) return;
+  ws.upstream = null;
+  ws.upstreamPending = [];
+  upstream.terminate();
 }
 
-function getSession(sessionId) {
-  if (!sessions.has(sessionId)) {
-    sessions.set(sessionId, { host: null, client: null });
+function sendUpstream(ws, data, isBinary) {
+  const upstream = ws.upstream;
+  if (upstream.readyState === upstream.OPEN) {
+    upstream.send(data, isBinary ? BINARY_FRAME : TEXT_FRAME);
+  } else if (upstream.readyState === upstream.CONNECTING && ws.upstreamPending.length < MAX_PENDING_UPSTREAM) {
+    ws.upstreamPending.push([data, isBinary]);
   }
-  return sessions.get(sessionId);
 }
 
 wss.on('connection', (ws, req) => {
-  // Get client IP (handles proxies)
-  const ip = req.headers['x-forwarded-for']?.split(',')[0]?.trim() || req.socket.remoteAddress || 'unknown';
+  const ip = clientAddress(req);
   
   // Check rate limit on connection
-  if (isRateLimited(ip)) {
-    console.log(`Rejected rate-limited IP: ${ip}`);
+  if (!takeTokens(ip)) {
+    metrics.rateLimitRejects++;
     ws.close(4029, 'Too many attempts. Try again later.');
     return;
   }
   
   ws.clientIP = ip;
+  ws.session = null; // Set on registration, with ws.peer
+  ws.peer = null;
+  metrics.connections++;
+
+  // Unregistered sockets hold no session but still cost memory; don't let them linger
+  const registerTimer = setTimeout(() => {
+    if (!ws.sessionId) ws.close(4008, 'Registration timeout');
+  }, REGISTER_TIMEOUT_MS);
   
   ws.on('message', (data, isBinary) => {
+    metrics.bytesIn += data.length;
+    // Proxied sockets: media goes straight to the owner node
+    if (ws.upstream && isBinary) {
+      sendUpstream(ws, data, true);
+      return;
+    }
+
+    const current = ws.session;
+    if (current) {
+      current.stats.bytesIn += data.length;
+      current.stats.messages++;
+      current.referenced = true;
+    }
+
     // 1. Binary Relay (Video Frames) - Forward transparently
     if (isBinary) {
-      const sessionId = ws.sessionId;
-      if (!sessionId) return; // Ignore if not registered
-
-      const session = sessions.get(sessionId);
-      if (!session) return;
+      metrics.messagesIn.binary++;
+      if (!current) return; // Ignore if not registered
 
-      const target = ws.role === 'host' ? session.client : session.host;
-      if (target && target.readyState === target.OPEN) {
-        target.send(data, { binary: true });
+      const target = ws.peer;
+      if (target && isDroppableChunk(data) && target.bufferedAmount > DROPPABLE_QUEUE_BYTES) {
+        metrics.droppedDroppable++;
+        return;
       }
+      forward(target, data, BINARY_FRAME, current);
       return;
     }
 
@@ -92,72 +624,127 @@ wss.on('connection', (ws, req) => {
       return;
     }
 
-    const { type, sessionId, role, channel, payload } = message || {};
+    const { type, sessionId, role } = message || {};
     if (!type || !sessionId) return;
+    if (type in metrics.messagesIn) metrics.messagesIn[type]++;
+    else metrics.messagesIn.other++;
 
     if (type === 'register') {
-      const session = getSession(sessionId);
-      
-      // Validate: session should have matching counterpart within reasonable time
-      // For now, just track registration
-      if (role === 'host') {
-        if (session.host && session.host !== ws) {
-          // Another host trying to register - suspicious
-          console.log(`Duplicate host registration attempt for session ${sessionId} from ${ip}`);
-          recordAttempt(ip, false);
-          ws.close(4001, 'Session already has a host');
-          return;
-        }
-        session.host = ws;
+      if (role !== 'host' && role !== 'client') return;
+      if (!takeTokens(ip)) {
+        metrics.rateLimitBlocks++;
+        ws.close(4029, 'Too many attempts. Try again later.');
+        return;
       }
-      if (role === 'client') {
-        if (session.client && session.client !== ws) {
-          // Another client trying to register - suspicious
-          console.log(`Duplicate client registration attempt for session ${sessionId} from ${ip}`);
-          recordAttempt(ip, false);
-          ws.close(4001, 'Session already has a client');
-          return;
-        }
-        session.client = ws;
+      // Sessions owned by another node are proxied there as-is
+      const owner = ownerNode(sessionId);
+      if (owner !== NODE_URL) {
+        detachFromSession(ws);
+        clearTimeout(registerTimer);
+        if (!ws.upstream || ws.upstreamOwner !== owner) openUpstream(ws, owner);
+        sendUpstream(ws, data, false);
+        return;
       }
+      closeUpstream(ws);
+
+      // Re-registering under a new session ID leaves the old one
+      if (ws.sessionId && ws.sessionId !== sessionId) detachFromSession(ws);
+
+      const session = sessions.get(sessionId) || createSession(sessionId);
+      const existing = role === 'host' ? session.host : session.client;
+      if (existing && existing !== ws) {
+        // Another peer trying to take the same role - suspicious
+        console.log(`Duplicate ${role} registration attempt for session ${sessionLabel(sessionId)} from ${ip}`);
+        takeTokens(ip, FAILED_REGISTRATION_COST);
+        ws.close(4001, `Session already has a ${role}`);
+        return;
+      }
+      if (role === 'host') session.host = ws;
+      else session.client = ws;
       
       ws.sessionId = sessionId;
+      ws.session = session;
       ws.role = role;
-      recordAttempt(ip, true); // Successful registration
-      console.log(`Registered ${role} for session ${sessionId} from ${ip}`);
+      linkPeers(session);
+      clearTimeout(registerTimer);
+      updateUnpairedTimer(session, sessionId);
+      console.log(`Registered ${role} for session ${sessionLabel(sessionId)} from ${ip}`);
+
+      // A host that (re)registers mid-session gets a fresh token for its leg
+      if (role === 'host' && session.udp) {
+        session.udp.host.token = crypto.randomBytes(UDP_TOKEN_BYTES);
+        session.udp.host.peer = null;
+        sendAllocation(ws, sessionId, session.udp.host);
+      }
+      return;
+    }
+
+    if (ws.upstream) {
+      sendUpstream(ws, data, false);
+      return;
+    }
+
+    // UDP relay is requested by the client once registered; only the registered socket may ask
+    if (type === 'allocate') {
+      if (ws.role !== 'client' || ws.sessionId !== sessionId) return;
+      const session = sessions.get(sessionId);
+      if (!session || session.client !== ws) return;
+      if (!takeTokens(ip)) return; // Each allocation binds two sockets
+      allocateUdpRelay(session, sessionId).catch((err) => {
+        console.log(`UDP relay allocation error for session ${sessionLabel(sessionId)}: ${err.message}`);
+      });
       return;
     }
 
+    // Only forwarded for the sender's own session; never creates one. The received
+    // bytes go out as-is: parsing above validated the message, re-encoding adds nothing.
     if (type === 'relay' || type === 'candidate') {
-      const session = getSession(sessionId);
-      const target = ws.role === 'host' ? session.client : session.host;
-      if (target && target.readyState === target.OPEN) {
-        target.send(JSON.stringify({ type, sessionId, channel, payload }));
-      }
+      if (ws.sessionId !== sessionId || !current) return;
+      forward(ws.peer, data, TEXT_FRAME, current);
     }
   });
 
   ws.on('close', () => {
-    const sessionId = ws.sessionId;
-    if (!sessionId) return;
-    const session = sessions.get(sessionId);
-    if (!session) return;
-    if (session.host === ws) session.host = null;
-    if (session.client === ws) session.client = null;
-    if (!session.host && !session.client) sessions.delete(sessionId);
+    clearTimeout(registerTimer);
+    closeUpstream(ws);
+    detachFromSession(ws);
   });
 });
 
-// Cleanup stale rate limit records every 5 minutes
-setInterval(() => {
-  const now = Date.now();
-  for (const [ip, record] of rateLimitMap.entries()) {
-    if (record.blockedUntil > 0 && now > record.blockedUntil) {
-      rateLimitMap.delete(ip);
+// Idle rate-limit buckets are also dropped on each take; this covers quiet periods
+setInterval(() => sweepRateLimits(Date.now()), 60 * 1000);
+
+// Periodic per-session throughput logs (STATS_INTERVAL seconds)
+if (STATS_INTERVAL_S > 0) {
+  const statsEventLoopDelay = monitorEventLoopDelay({ resolution: EVENT_LOOP_RESOLUTION_MS });
+  statsEventLoopDelay.enable();
+  setInterval(() => {
+    const now = Date.now();
+    for (const [sessionId, session] of sessions) {
+      const stats = session.stats;
+      const elapsed = (now - stats.since) / 1000;
+      if (elapsed <= 0) continue;
+      const queued = (session.host?.bufferedAmount || 0) + (session.client?.bufferedAmount || 0);
+      if (stats.messages > 0 || stats.bytesOut > 0) {
+        console.log(`Session ${sessionLabel(sessionId)}: in ${(stats.bytesIn * 8 / elapsed / 1e6).toFixed(2)} Mbps, ` +
+          `out ${(stats.bytesOut * 8 / elapsed / 1e6).toFixed(2)} Mbps, ` +
+          `${Math.round(stats.messages / elapsed)} msg/s, queued ${queued} B`);
+      }
+      session.stats = newSessionStats();
     }
-  }
-}, 5 * 60 * 1000);
+    console.log(`Relay: ${sessions.size} sessions, event loop lag p99 ${(eventLoopLagSeconds(statsEventLoopDelay.percentile(99)) * 1000).toFixed(1)} ms`);
+    statsEventLoopDelay.reset();
+  }, STATS_INTERVAL_S * 1000);
+}
+
+await refreshTrustedAddresses();
+if (TRUSTED_PROXIES.length > 0 || CLUSTER_NODES.length > 1) {
+  setInterval(refreshTrustedAddresses, TRUSTED_REFRESH_MS).unref();
+}
 
 server.listen(port, () => {
-  console.log(`AirCatch relay listening on :${port} (with rate limiting)`);
+  console.log(`AirCatch relay listening on :${port} (with rate limiting, UDP relay ports ${UDP_PORT_MIN}-${UDP_PORT_MAX})`);
+  if (CLUSTER_NODES.length > 1) {
+    console.log(`Cluster node ${NODE_URL} of ${CLUSTER_NODES.length}`);
+  }
 });
@@ -0,0 +1,118 @@
+// Relay throughput: messages per second and relay CPU-seconds per Gbps forwarded,
+// with metrics off (METRICS=off) and on (scraped every second, STATS_INTERVAL=1).
+// Not part of `npm test`; run with `npm run bench` (BENCH_SECONDS per scenario, default 5).
+//
+// Each scenario starts a fresh relay and pairs BENCH_SESSIONS host/client sockets
+// through it. Hosts keep a window of messages in flight and clients count what
+// arrives, so the relay is the bottleneck rather than its send queues. The load
+// generator runs in this process: on a machine with few cores it competes with the
+// relay, so compare rows from the same run rather than across machines.
+
+import fs from 'fs';
+import { execFileSync } from 'child_process';
+import { setTimeout as sleep } from 'timers/promises';
+import { startRelay, register, randomSessionId, fetchText } from './relay.js';
+
+const SECONDS = Number(process.env.BENCH_SECONDS) || 5;
+const SESSIONS = Number(process.env.BENCH_SESSIONS) || 4;
+const WINDOW_BYTES = 4 * 1024 * 1024;
+const WINDOW_MESSAGES = 256;
+
+// Binary payloads are video chunks as the apps send them; text is a TCP packet relayed as JSON
+const SCENARIOS = [
+  { name: 'binary 1.2 KB', make: () => Buffer.alloc(1200, 7) },
+  { name: 'binary 64 KB', make: () => Buffer.alloc(64 * 1024, 7) },
+  { name: 'relay text 1 KB', make: (sessionId) => JSON.stringify({ type: 'relay', sessionId, channel: 'tcp', payload: 'A'.repeat(1024) }) },
+];
+
+const METRICS_MODES = [
+  { name: 'metrics off', env: { METRICS: 'off' }, scrape: false },
+  { name: 'metrics on', env: { STATS_INTERVAL: '1' }, scrape: true },
+];
+
+// CPU-seconds the process has used (user + system)
+function cpuSeconds(pid) {
+  if (fs.existsSync(`/proc/${pid}/stat`)) {
+    // Fields after the parenthesised command name; utime and stime are the 12th and 13th
+    const fields = fs.readFileSync(`/proc/${pid}/stat`, 'utf8').split(') ')[1].split(' ');
+    const ticksPerSecond = Number(execFileSync('getconf', ['CLK_TCK']).toString()) || 100;
+    return (Number(fields[11]) + Number(fields[12])) / ticksPerSecond;
+  }
+  // [[dd-]hh:]mm:ss(.ss)
+  const time = execFileSync('ps', ['-o', 'time=', '-p', String(pid)]).toString().trim();
+  const [days, clock] = time.includes('-') ? time.split('-') : ['0', time];
+  return Number(days) * 86400 + clock.split(':').reduce((total, part) => total * 60 + Number(part), 0);
+}
+
+async function pair(relay, scenario) {
+  const sessionId = randomSessionId();
+  const host = await register(relay.url, sessionId, 'host');
+  const client = await register(relay.url, sessionId, 'client');
+  // connectPeer queues every message for tests; count them here instead
+  client.removeAllListeners('message');
+  const payload = scenario.make(sessionId);
+  const size = Buffer.byteLength(payload);
+  const link = { host, client, payload, size, sent: 0, received: 0, bytes: 0, running: true };
+  client.on('message', (data) => {
+    link.received++;
+    link.bytes += data.length;
+    pump(link);
+  });
+  return link;
+}
+
+// Sends until the window is full; each delivery makes room for the next message
+function pump(link) {
+  while (link.running && link.sent - link.received < WINDOW_MESSAGES && (link.sent - link.received) * link.size < WINDOW_BYTES) {
+    link.host.send(link.payload);
+    link.sent++;
+  }
+}
+
+async function measure(scenario, mode) {
+  const relay = await startRelay({ env: mode.env });
+  try {
+    const links = [];
+    for (let i = 0; i < SESSIONS; i++) links.push(await pair(relay, scenario));
+
+    // Warm up, then count from a clean start
+    links.forEach(pump);
+    await sleep(500);
+    const startReceived = links.reduce((total, link) => total + link.received, 0);
+    const startBytes = links.reduce((total, link) => total + link.bytes, 0);
+    const startCPU = cpuSeconds(relay.child.pid);
+    const startTime = process.hrtime.bigint();
+
+    // Scrapes go through the same event loop as the traffic, as Prometheus' would
+    const scraper = mode.scrape ? setInterval(() => fetchText(relay.port, '/metrics').catch(() => {}), 1000) : null;
+    await sleep(SECONDS * 1000);
+    clearInterval(scraper);
+
+    const elapsed = Number(process.hrtime.bigint() - startTime) / 1e9;
+    const cpu = cpuSeconds(relay.child.pid) - startCPU;
+    const messages = links.reduce((total, link) => total + link.received, 0) - startReceived;
+    const bytes = links.reduce((total, link) => total + link.bytes, 0) - startBytes;
+    for (const link of links) {
+      link.running = false;
+      link.host.terminate();
+      link.client.terminate();
+    }
+
+    const gbps = bytes * 8 / elapsed / 1e9;
+    return { messagesPerSecond: messages / elapsed, mbps: gbps * 1000, cpuPerGbps: gbps > 0 ? cpu / elapsed / gbps : NaN };
+  } finally {
+    await relay.stop();
+  }
+}
+
+function report(label, result) {
+  console.log(`${label.padEnd(36)} ${result.messagesPerSecond.toFixed(0).padStart(8)} msg/s ${result.mbps.toFixed(1).padStart(8)} Mbps ` +
+    `${result.cpuPerGbps.toFixed(2).padStart(6)} relay CPU-s/Gbps`);
+}
+
+console.log(`Relay throughput, ${SESSIONS} sessions, ${SECONDS} s per scenario`);
+for (const scenario of SCENARIOS) {
+  for (const mode of METRICS_MODES) {
+    report(`${scenario.name}, ${mode.name}`, await measure(scenario, mode));
+  }
+}
@@ -0,0 +1,94 @@
+// Several relay processes on localhost acting as one cluster: host and client may
+// land on different nodes and still pair on the session's owner.
+
+import { test, before, after } from 'node:test';
+import assert from 'node:assert/strict';
+import dgram from 'dgram';
+import { once } from 'events';
+import { startRelay, runRelay, register, randomSessionId, freePort, relayURL } from './relay.js';
+
+const NODE_COUNT = 3;
+let nodes = [];
+
+before(async () => {
+  const ports = [];
+  for (let i = 0; i < NODE_COUNT; i++) ports.push(await freePort());
+  const clusterNodes = ports.map(relayURL).join(',');
+  nodes = await Promise.all(ports.map((port) => startRelay({
+    port,
+    env: { CLUSTER_NODES: clusterNodes, NODE_URL: relayURL(port), PUBLIC_HOST: '127.0.0.1' },
+  })));
+});
+after(() => Promise.all(nodes.map((node) => node.stop())));
+
+// Registrations reach the owner through separate node-to-node sockets, so the first relay
+// message may arrive before the peer's registration and be dropped; resend until it lands
+async function relayUntilDelivered(from, to, sessionId, payload) {
+  const delivered = to.next((message) => message.json?.type === 'relay' && message.json.payload === payload);
+  const timer = setInterval(() => from.sendJSON({ type: 'relay', sessionId, channel: 'tcp', payload }), 100);
+  from.sendJSON({ type: 'relay', sessionId, channel: 'tcp', payload });
+  try {
+    return await delivered;
+  } finally {
+    clearInterval(timer);
+  }
+}
+
+test('refuses to start a cluster node without PUBLIC_HOST', async () => {
+  const port = await freePort();
+  const { code, output } = await runRelay({ PORT: String(port), CLUSTER_NODES: relayURL(port), NODE_URL: relayURL(port), PUBLIC_HOST: '' });
+  assert.equal(code, 1);
+  assert.match(output, /PUBLIC_HOST must be set/);
+});
+
+test('pairs a host and client registered on different nodes', async () => {
+  // Every ordered pair of nodes, so each node is proxied through and owns sessions
+  for (let hostNode = 0; hostNode < NODE_COUNT; hostNode++) {
+    const clientNode = (hostNode + 1) % NODE_COUNT;
+    const sessionId = randomSessionId();
+    const host = await register(nodes[hostNode].url, sessionId, 'host');
+    const client = await register(nodes[clientNode].url, sessionId, 'client');
+
+    await relayUntilDelivered(client, host, sessionId, 'aGk=');
+
+    const frame = Buffer.from([0x01, hostNode, clientNode]);
+    host.send(frame);
+    assert.deepEqual((await client.next((message) => message.isBinary)).data, frame);
+
+    host.close();
+    client.close();
+  }
+});
+
+test('hands out UDP relay ports on the owner node with its public host', async () => {
+  const sessionId = randomSessionId();
+  const host = await register(nodes[0].url, sessionId, 'host');
+  const client = await register(nodes[1].url, sessionId, 'client');
+  await relayUntilDelivered(client, host, sessionId, 'aGk=');
+  client.sendJSON({ type: 'allocate', sessionId });
+  const [clientAllocation, hostAllocation] = await Promise.all([
+    client.nextOfType('allocation').then((message) => JSON.parse(message.json.payload)),
+    host.nextOfType('allocation').then((message) => JSON.parse(message.json.payload)),
+  ]);
+  assert.equal(clientAllocation.host, '127.0.0.1');
+  assert.equal(hostAllocation.host, '127.0.0.1');
+
+  // Bind both legs and push one datagram through the owner's relay
+  const sockets = [];
+  for (const allocation of [hostAllocation, clientAllocation]) {
+    const socket = dgram.createSocket('udp4');
+    socket.bind(0, '127.0.0.1');
+    await once(socket, 'listening');
+    socket.send(Buffer.concat([Buffer.from([0xAB]), Buffer.from(allocation.token, 'hex')]), allocation.port, allocation.host);
+    await once(socket, 'message');
+    sockets.push(socket);
+  }
+  const datagram = Buffer.from([0x01, 0x42]);
+  sockets[0].send(datagram, hostAllocation.port, hostAllocation.host);
+  const [received] = await once(sockets[1], 'message');
+  assert.deepEqual(received, datagram);
+
+  for (const socket of sockets) socket.close();
+  host.close();
+  client.close();
+});
@@ -0,0 +1,71 @@
+// /metrics output and the periodic stats log.
+
+import { test, before, after } from 'node:test';
+import assert from 'node:assert/strict';
+import { setTimeout as sleep } from 'timers/promises';
+import { startRelay, register, randomSessionId, fetchText } from './relay.js';
+
+let relay;
+before(async () => { relay = await startRelay({ env: { STATS_INTERVAL: '1' } }); });
+after(() => relay.stop());
+
+function sample(body, name) {
+  const line = body.split('\n').find((entry) => entry.startsWith(`${name} `));
+  return line === undefined ? undefined : Number(line.slice(name.length + 1));
+}
+
+test('counts sessions and forwarded traffic', async () => {
+  const sessionId = randomSessionId();
+  const host = await register(relay.url, sessionId, 'host');
+  const client = await register(relay.url, sessionId, 'client');
+  host.send(Buffer.alloc(1000));
+  await client.next((message) => message.isBinary);
+
+  const { status, body } = await fetchText(relay.port, '/metrics');
+  assert.equal(status, 200);
+  assert.ok(sample(body, 'aircatch_sessions') >= 1);
+  assert.ok(sample(body, 'aircatch_sent_bytes_total') >= 1000);
+  assert.match(body, /aircatch_event_loop_lag_seconds\{quantile="0.99"\} \d/);
+  host.close();
+  client.close();
+});
+
+test('event loop percentiles cover only the interval since the previous scrape', async () => {
+  await fetchText(relay.port, '/metrics');
+  const { body } = await fetchText(relay.port, '/metrics');
+  // Back-to-back scrapes: the second window has at most a sample or two of an idle loop
+  assert.ok(sample(body, 'aircatch_event_loop_lag_seconds{quantile="1"}') < 0.05, body);
+});
+
+test('stats logs never print session IDs', async () => {
+  const sessionId = randomSessionId();
+  const host = await register(relay.url, sessionId, 'host');
+  const client = await register(relay.url, sessionId, 'client');
+  client.sendJSON({ type: 'allocate', sessionId });
+  await host.nextOfType('allocation');
+  host.send(Buffer.alloc(100));
+  await client.next((message) => message.isBinary);
+  await sleep(1500);
+
+  assert.match(relay.output, /Session [0-9a-f]{10}: in /);
+  assert.match(relay.output, /Registered host for session [0-9a-f]{10} /);
+  assert.ok(!relay.output.includes(sessionId), 'the PIN appears in the log');
+  host.close();
+  client.close();
+});
+
+test('METRICS=off serves no /metrics and still forwards', async () => {
+  const quiet = await startRelay({ env: { METRICS: 'off' } });
+  try {
+    const sessionId = randomSessionId();
+    const host = await register(quiet.url, sessionId, 'host');
+    const client = await register(quiet.url, sessionId, 'client');
+    host.send(Buffer.alloc(1000));
+    await client.next((message) => message.isBinary);
+    assert.equal((await fetchText(quiet.port, '/metrics')).status, 404);
+    host.close();
+    client.close();
+  } finally {
+    await quiet.stop();
+  }
+});
@@ -0,0 +1,63 @@
+// Rate limiting keys on the socket address unless the socket is a trusted proxy.
+
+import { test } from 'node:test';
+import assert from 'node:assert/strict';
+import { startRelay, connectPeer, randomSessionId } from './relay.js';
+
+// Connects and registers once from behind `forwardedFor`; resolves with the close code, if closed
+async function attempt(relay, forwardedFor) {
+  const headers = forwardedFor ? { 'x-forwarded-for': forwardedFor } : {};
+  let ws;
+  try {
+    ws = await connectPeer(relay.url, { headers });
+  } catch {
+    return 4029;
+  }
+  ws.sendJSON({ type: 'register', sessionId: randomSessionId(), role: 'client' });
+  const result = await Promise.race([ws.closed.then(({ code }) => code), new Promise((resolve) => setTimeout(resolve, 150, null))]);
+  ws.terminate();
+  return result;
+}
+
+async function refusedAmong(relay, addresses) {
+  const codes = [];
+  for (const address of addresses) codes.push(await attempt(relay, address));
+  return codes.filter((code) => code === 4029).length;
+}
+
+const spoofed = Array.from({ length: 15 }, (_, i) => `198.51.100.${i + 1}`);
+
+test('ignores X-Forwarded-For from untrusted sockets', async () => {
+  const relay = await startRelay();
+  try {
+    // Every attempt costs two tokens of the same (loopback) bucket, whatever the header says
+    assert.ok(await refusedAmong(relay, spoofed) > 0);
+    assert.match(relay.output, /from 127\.0\.0\.1/);
+    assert.doesNotMatch(relay.output, /198\.51\.100/);
+  } finally {
+    await relay.stop();
+  }
+});
+
+test('believes X-Forwarded-For from a trusted proxy', async () => {
+  const relay = await startRelay({ env: { TRUSTED_PROXIES: '127.0.0.0/8' } });
+  try {
+    assert.equal(await refusedAmong(relay, spoofed), 0);
+    assert.match(relay.output, /from 198\.51\.100\.1\b/);
+  } finally {
+    await relay.stop();
+  }
+});
+
+test('skips hops a client prepends itself', async () => {
+  const relay = await startRelay({ env: { TRUSTED_PROXIES: '127.0.0.1' } });
+  try {
+    // The proxy appends the real address; whatever the client wrote comes first
+    const forged = spoofed.map((address) => `${address}, 203.0.113.7`);
+    assert.ok(await refusedAmong(relay, forged) > 0);
+    assert.match(relay.output, /from 203\.0\.113\.7/);
+    assert.doesNotMatch(relay.output, /198\.51\.100/);
+  } finally {
+    await relay.stop();
+  }
+});
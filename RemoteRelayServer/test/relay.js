@@ -0,0 +1,142 @@
+// Test helpers: relay processes on localhost and scripted peers.
+
+import { spawn } from 'child_process';
+import { once } from 'events';
+import http from 'http';
+import net from 'net';
+import path from 'path';
+import { fileURLToPath } from 'url';
+import { WebSocket } from 'ws';
+
+const SERVER = path.join(path.dirname(fileURLToPath(import.meta.url)), '..', 'server.js');
+const TIMEOUT_MS = 5000;
+
+// Each relay gets its own UDP port range so concurrent test files don't collide
+let nextUdpBase = 41000 + (process.pid % 80) * 200;
+
+export async function freePort() {
+  const server = net.createServer();
+  server.listen(0, '127.0.0.1');
+  await once(server, 'listening');
+  const { port } = server.address();
+  server.close();
+  return port;
+}
+
+export function relayURL(port) {
+  return `ws://127.0.0.1:${port}/ws`;
+}
+
+// Starts server.js as a child process and resolves once it listens.
+// `port` and `env` override the defaults; output keeps everything it logged.
+export function startRelay({ port, env = {} } = {}) {
+  return (async () => {
+    port = port || await freePort();
+    const udpBase = nextUdpBase;
+    nextUdpBase += 200;
+    const child = spawn(process.execPath, [SERVER], {
+      env: { ...process.env, PORT: String(port), UDP_RELAY_PORT_MIN: String(udpBase), UDP_RELAY_PORT_MAX: String(udpBase + 199), ...env },
+      stdio: ['ignore', 'pipe', 'pipe'],
+    });
+    const relay = { port, url: relayURL(port), child, output: '' };
+    relay.stop = async () => {
+      if (child.exitCode !== null) return;
+      child.kill();
+      await once(child, 'exit');
+    };
+
+    await new Promise((resolve, reject) => {
+      const timer = setTimeout(() => reject(new Error(`relay did not start:\n${relay.output}`)), TIMEOUT_MS);
+      const onData = (chunk) => {
+        relay.output += chunk;
+        if (relay.output.includes('listening on')) {
+          clearTimeout(timer);
+          resolve();
+        }
+      };
+      child.stdout.on('data', onData);
+      child.stderr.on('data', onData);
+      child.once('exit', (code) => {
+        clearTimeout(timer);
+        reject(new Error(`relay exited with ${code}:\n${relay.output}`));
+      });
+    });
+    return relay;
+  })();
+}
+
+// Runs server.js to completion (for startup checks) and returns its exit code and output.
+export async function runRelay(env) {
+  const child = spawn(process.execPath, [SERVER], { env: { ...process.env, ...env }, stdio: ['ignore', 'pipe', 'pipe'] });
+  let output = '';
+  child.stdout.on('data', (chunk) => { output += chunk; });
+  child.stderr.on('data', (chunk) => { output += chunk; });
+  const timer = setTimeout(() => child.kill(), TIMEOUT_MS);
+  const [code] = await once(child, 'exit');
+  clearTimeout(timer);
+  return { code, output };
+}
+
+// A WebSocket peer that queues what it receives, so tests can await messages in order.
+export async function connectPeer(url, options = {}) {
+  const ws = new WebSocket(url, options);
+  const queue = [];
+  const waiters = [];
+  ws.on('message', (data, isBinary) => {
+    const message = { data, isBinary, json: isBinary ? null : safeParse(data.toString()) };
+    const index = waiters.findIndex((waiter) => waiter.match(message));
+    if (index >= 0) waiters.splice(index, 1)[0].resolve(message);
+    else queue.push(message);
+  });
+  ws.closed = once(ws, 'close').then(([code, reason]) => ({ code, reason: reason.toString() }));
+
+  // Resolves with the first queued or future message that `match` accepts
+  ws.next = (match = () => true, timeout = TIMEOUT_MS) => {
+    const index = queue.findIndex(match);
+    if (index >= 0) return Promise.resolve(queue.splice(index, 1)[0]);
+    return new Promise((resolve, reject) => {
+      const waiter = { match, resolve: (message) => { clearTimeout(timer); resolve(message); } };
+      const timer = setTimeout(() => {
+        waiters.splice(waiters.indexOf(waiter), 1);
+        reject(new Error('timed out waiting for a message'));
+      }, timeout);
+      waiters.push(waiter);
+    });
+  };
+  ws.nextOfType = (type, timeout) => ws.next((message) => message.json?.type === type, timeout);
+  ws.sendJSON = (message) => ws.send(JSON.stringify(message));
+
+  await Promise.race([
+    once(ws, 'open'),
+    ws.closed.then(({ code, reason }) => { throw new Error(`closed before open: ${code} ${reason}`); }),
+  ]);
+  return ws;
+}
+
+export async function register(url, sessionId, role, options) {
+  const ws = await connectPeer(url, options);
+  ws.sendJSON({ type: 'register', sessionId, role });
+  return ws;
+}
+
+export function randomSessionId() {
+  return Math.random().toString(36).slice(2, 8).toUpperCase();
+}
+
+export function fetchText(port, urlPath, headers = {}) {
+  return new Promise((resolve, reject) => {
+    http.get({ host: '127.0.0.1', port, path: urlPath, headers }, (res) => {
+      let body = '';
+      res.on('data', (chunk) => { body += chunk; });
+      res.on('end', () => resolve({ status: res.statusCode, body }));
+    }).on('error', reject);
+  });
+}
+
+function safeParse(text) {
+  try {
+    return JSON.parse(text);
+  } catch {
+    return null;
+  }
+}
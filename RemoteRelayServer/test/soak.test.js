@@ -0,0 +1,83 @@
+// Soak: a flood of registrations and stray messages for random session IDs from many
+// addresses must leave the session and rate-limit tables capped and RSS flat.
+// SOAK_ROUNDS scales the run (default 2 measured rounds after warm-up).
+
+import { test } from 'node:test';
+import assert from 'node:assert/strict';
+import fs from 'fs';
+import { startRelay, connectPeer, randomSessionId, fetchText } from './relay.js';
+
+const MAX_SESSIONS = 200;
+const MAX_RATE_LIMIT_ENTRIES = 500;
+const CONNECTIONS_PER_ROUND = 1500;
+const CONCURRENCY = 50;
+const OPEN_SOCKETS = 300; // Kept registered so the session table actually fills
+const WARM_UP_ROUNDS = 2;
+const ROUNDS = Number(process.env.SOAK_ROUNDS) || 2;
+const MAX_RSS_GROWTH_MB = 24; // Garbage collection noise; 20 rounds level off within ~12 MB
+
+function rssBytes(pid) {
+  const status = fs.readFileSync(`/proc/${pid}/status`, 'utf8');
+  return Number(status.match(/VmRSS:\s+(\d+) kB/)[1]) * 1024;
+}
+
+function gauge(body, name) {
+  return Number(body.split('\n').find((line) => line.startsWith(`${name} `)).split(' ')[1]);
+}
+
+let addressCounter = 0;
+function nextAddress() {
+  addressCounter++;
+  return `10.${(addressCounter >> 16) & 255}.${(addressCounter >> 8) & 255}.${addressCounter & 255}`;
+}
+
+async function flood(relay, openSockets) {
+  let remaining = CONNECTIONS_PER_ROUND;
+  const worker = async () => {
+    while (remaining-- > 0) {
+      let ws;
+      try {
+        ws = await connectPeer(relay.url, { headers: { 'x-forwarded-for': nextAddress() } });
+      } catch {
+        continue;
+      }
+      ws.on('error', () => {});
+      ws.sendJSON({ type: 'register', sessionId: randomSessionId(), role: 'client' });
+      ws.sendJSON({ type: 'relay', sessionId: randomSessionId(), channel: 'tcp', payload: 'eA==' });
+      ws.sendJSON({ type: 'candidate', sessionId: randomSessionId(), payload: '{}' });
+      openSockets.push(ws);
+      while (openSockets.length > OPEN_SOCKETS) openSockets.shift().terminate();
+    }
+  };
+  await Promise.all(Array.from({ length: CONCURRENCY }, worker));
+}
+
+test('tables stay capped and RSS stays flat under a session-ID flood', { timeout: 300_000, skip: !fs.existsSync('/proc/self/status') && 'needs /proc' }, async () => {
+  const relay = await startRelay({
+    env: { TRUSTED_PROXIES: '127.0.0.1', MAX_SESSIONS: String(MAX_SESSIONS), MAX_RATE_LIMIT_ENTRIES: String(MAX_RATE_LIMIT_ENTRIES) },
+  });
+  const openSockets = [];
+  try {
+    // Warm-up: tables fill to their caps and the heap grows to its working size
+    for (let round = 0; round < WARM_UP_ROUNDS; round++) await flood(relay, openSockets);
+    const baseline = rssBytes(relay.child.pid);
+
+    let peak = baseline;
+    for (let round = 0; round < ROUNDS; round++) {
+      await flood(relay, openSockets);
+      peak = Math.max(peak, rssBytes(relay.child.pid));
+      const { body } = await fetchText(relay.port, '/metrics');
+      assert.ok(gauge(body, 'aircatch_sessions') <= MAX_SESSIONS, `sessions: ${gauge(body, 'aircatch_sessions')}`);
+      assert.ok(gauge(body, 'aircatch_rate_limit_entries') <= MAX_RATE_LIMIT_ENTRIES + 1);
+    }
+
+    const { body } = await fetchText(relay.port, '/metrics');
+    assert.ok(gauge(body, 'aircatch_sessions_evicted_total') > 0, 'the session cap was never reached');
+    const growth = (peak - baseline) / 1024 / 1024;
+    console.log(`soak: RSS ${(baseline / 1024 / 1024).toFixed(1)} MB after warm-up, peak +${growth.toFixed(1)} MB over ${ROUNDS * CONNECTIONS_PER_ROUND} connections`);
+    assert.ok(growth < MAX_RSS_GROWTH_MB, `RSS grew ${growth.toFixed(1)} MB`);
+  } finally {
+    for (const ws of openSockets) ws.terminate();
+    await relay.stop();
+  }
+});
@@ -0,0 +1,112 @@
+// End-to-end: a host and a client pair through a relay on localhost, over the
+// WebSocket and over an allocated UDP port pair.
+
+import { test, before, after } from 'node:test';
+import assert from 'node:assert/strict';
+import dgram from 'dgram';
+import { once } from 'events';
+import { startRelay, register, randomSessionId } from './relay.js';
+
+const UDP_BIND_MAGIC = 0xAB;
+
+let relay;
+before(async () => { relay = await startRelay(); });
+after(() => relay.stop());
+
+async function pair() {
+  const sessionId = randomSessionId();
+  const host = await register(relay.url, sessionId, 'host');
+  const client = await register(relay.url, sessionId, 'client');
+  return { sessionId, host, client };
+}
+
+// Binds a UDP socket to one relayed leg and waits for the relay's ack
+async function bindLeg(allocation) {
+  const socket = dgram.createSocket('udp4');
+  socket.bind(0, '127.0.0.1');
+  await once(socket, 'listening');
+  const token = Buffer.from(allocation.token, 'hex');
+  socket.send(Buffer.concat([Buffer.from([UDP_BIND_MAGIC]), token]), allocation.port, '127.0.0.1');
+  const [ack] = await once(socket, 'message');
+  assert.equal(ack[0], UDP_BIND_MAGIC);
+  return { socket, port: allocation.port, peerBound: ack[1] === 1 };
+}
+
+async function receiveData(socket) {
+  for (;;) {
+    const [message] = await once(socket, 'message');
+    if (message[0] !== UDP_BIND_MAGIC) return message;
+  }
+}
+
+test('relays control and binary messages between registered peers', async () => {
+  const { sessionId, host, client } = await pair();
+
+  const relayMessage = JSON.stringify({ type: 'relay', sessionId, channel: 'tcp', payload: Buffer.from('hello').toString('base64') });
+  client.send(relayMessage);
+  const received = await host.nextOfType('relay');
+  assert.equal(received.data.toString(), relayMessage, 'text is forwarded byte for byte');
+
+  const frame = Buffer.from([0x12, 0, 0, 0, 1, 0, 0, 0, 1, 0, 1, 2, 3]);
+  host.send(frame);
+  const binary = await client.next((message) => message.isBinary);
+  assert.deepEqual(binary.data, frame);
+
+  host.close();
+  client.close();
+});
+
+test('allocates a UDP port pair and forwards datagrams both ways', async () => {
+  const { sessionId, host, client } = await pair();
+  client.sendJSON({ type: 'allocate', sessionId });
+  const [clientAllocation, hostAllocation] = await Promise.all([
+    client.nextOfType('allocation').then((message) => JSON.parse(message.json.payload)),
+    host.nextOfType('allocation').then((message) => JSON.parse(message.json.payload)),
+  ]);
+  assert.notEqual(clientAllocation.port, hostAllocation.port);
+
+  const hostLeg = await bindLeg(hostAllocation);
+  const clientLeg = await bindLeg(clientAllocation);
+  assert.equal(hostLeg.peerBound, false);
+  assert.equal(clientLeg.peerBound, true);
+
+  const video = Buffer.from([0x01, 0xde, 0xad, 0xbe, 0xef]);
+  hostLeg.socket.send(video, hostLeg.port, '127.0.0.1');
+  assert.deepEqual(await receiveData(clientLeg.socket), video);
+
+  const input = Buffer.from([0x20, 0x01, 0x02]);
+  clientLeg.socket.send(input, clientLeg.port, '127.0.0.1');
+  assert.deepEqual(await receiveData(hostLeg.socket), input);
+
+  // A wrong token doesn't bind, so a stranger's datagrams go nowhere
+  const stranger = dgram.createSocket('udp4');
+  stranger.bind(0, '127.0.0.1');
+  await once(stranger, 'listening');
+  stranger.send(Buffer.concat([Buffer.from([UDP_BIND_MAGIC]), Buffer.alloc(16)]), hostLeg.port, '127.0.0.1');
+  stranger.send(Buffer.from([0x01, 0x66]), hostLeg.port, '127.0.0.1');
+  hostLeg.socket.send(video, hostLeg.port, '127.0.0.1');
+  assert.deepEqual(await receiveData(clientLeg.socket), video, 'only the bound host reaches the client');
+
+  // The client leaving releases the pair and tells the host
+  client.close();
+  await host.nextOfType('release');
+
+  for (const socket of [hostLeg.socket, clientLeg.socket, stranger]) socket.close();
+  host.close();
+});
+
+test('does not relay for sockets that never registered', async () => {
+  const { sessionId, host, client } = await pair();
+  const intruder = await register(relay.url, randomSessionId(), 'client');
+  intruder.sendJSON({ type: 'relay', sessionId, channel: 'tcp', payload: 'eA==' });
+  intruder.sendJSON({ type: 'allocate', sessionId });
+
+  // The legitimate client's message arrives; the intruder's never does
+  client.sendJSON({ type: 'relay', sessionId, channel: 'tcp', payload: 'b2s=' });
+  const received = await host.nextOfType('relay');
+  assert.equal(received.json.payload, 'b2s=');
+  await assert.rejects(host.nextOfType('relay', 300));
+  await assert.rejects(host.nextOfType('allocation', 100));
+
+  for (const ws of [host, client, intruder]) ws.close();
+});